@@ -142,64 +142,69 @@ fn buildFipC(b: *std.Build, previous_step: *std.Build.Step, target: std.Build.Re
 }
 
 fn buildExamples(b: *std.Build, target: std.Build.ResolvedTarget, optimize: std.builtin.OptimizeMode) !void {
-    const exe = b.addExecutable(.{
-        .name = "example_master",
-        .root_module = b.createModule(.{
-            .target = target,
-            .optimize = optimize,
-            .link_libc = true,
-        }),
-        .version = try .parse(FIP_VERSION),
-    });
-    b.installArtifact(exe);
-    if (optimize == .Debug) {
-        exe.root_module.addCMacro("DEBUG_BUILD", "");
-    }
-    exe.link_function_sections = true;
-    exe.link_data_sections = true;
-    exe.compress_debug_sections = .zlib;
-    exe.build_id = .fast;
-
-    // Add Include paths
-    exe.root_module.addIncludePath(b.path(""));
-
-    // zig fmt: off
-    // Add C++ src files
-    exe.root_module.addCSourceFile(.{
-        .file = b.path(
-            "modules/example_master.c"
-        ),
-        .flags = &[_][]const u8{
-            "-std=c17",                     // Set C standard to C17
-            "-Werror",                      // Treat warnings as errors
-            "-Wall",                        // Enable most warnings
-            "-Wextra",                      // Enable extra warnings
-            "-Wshadow",                     // Warn about shadow variables
-            "-Wcast-align",                 // Warn about pointer casts that increase alignment requirement
-            "-Wcast-qual",                  // Warn about casts that remove const qualifier
-            "-Wunused",                     // Warn about unused variables
-            "-Wold-style-cast",             // Warn about C-style casts
-            "-Wdouble-promotion",           // Warn about float being implicitly promoted to double
-            "-Wformat=2",                   // Warn about printf/scanf/strftime/strfmon format string issue
-            "-Wundef",                      // Warn if an undefined identifier is evaluated in an #if
-            "-Wpointer-arith",              // Warn about sizeof(void) and add/sub with void*
-            "-Wunreachable-code",           // Warn about unreachable code
-            "-Wno-deprecated-declarations", // Ignore deprecation warnings
-            "-Wno-deprecated",              // Ignore general deprecation warnings
-            "-fno-omit-frame-pointer",      // Prevent omitting frame pointer for debugging and stack unwinding
-            "-funwind-tables",              // Generate unwind tables for stack unwinding
-            "-ffunction-sections",          // Place each function in its own section
-            "-fdata-sections",              // Place each data object in its own section
-            "-fstandalone-debug",           // Emit standalone debug information
-            "-Wdeprecated-declarations",    // Warn about deprecated declarations
-        },
-    });
-    // zig fmt: on
+    // The `bench_master` generates a synthetic C library and measures the
+    // compile pipeline of `fip-c` on it, it's built like any other example
+    const examples = [_][]const u8{ "example_master", "bench_master" };
+    for (examples) |name| {
+        const exe = b.addExecutable(.{
+            .name = name,
+            .root_module = b.createModule(.{
+                .target = target,
+                .optimize = optimize,
+                .link_libc = true,
+            }),
+            .version = try .parse(FIP_VERSION),
+        });
+        b.installArtifact(exe);
+        if (optimize == .Debug) {
+            exe.root_module.addCMacro("DEBUG_BUILD", "");
+        }
+        exe.link_function_sections = true;
+        exe.link_data_sections = true;
+        exe.compress_debug_sections = .zlib;
+        exe.build_id = .fast;
+
+        // Add Include paths
+        exe.root_module.addIncludePath(b.path(""));
+
+        // zig fmt: off
+        // Add C++ src files
+        exe.root_module.addCSourceFile(.{
+            .file = b.path(
+                b.fmt("modules/{s}.c", .{name})
+            ),
+            .flags = &[_][]const u8{
+                "-std=c17",                     // Set C standard to C17
+                "-Werror",                      // Treat warnings as errors
+                "-Wall",                        // Enable most warnings
+                "-Wextra",                      // Enable extra warnings
+                "-Wshadow",                     // Warn about shadow variables
+                "-Wcast-align",                 // Warn about pointer casts that increase alignment requirement
+                "-Wcast-qual",                  // Warn about casts that remove const qualifier
+                "-Wunused",                     // Warn about unused variables
+                "-Wold-style-cast",             // Warn about C-style casts
+                "-Wdouble-promotion",           // Warn about float being implicitly promoted to double
+                "-Wformat=2",                   // Warn about printf/scanf/strftime/strfmon format string issue
+                "-Wundef",                      // Warn if an undefined identifier is evaluated in an #if
+                "-Wpointer-arith",              // Warn about sizeof(void) and add/sub with void*
+                "-Wunreachable-code",           // Warn about unreachable code
+                "-Wno-deprecated-declarations", // Ignore deprecation warnings
+                "-Wno-deprecated",              // Ignore general deprecation warnings
+                "-fno-omit-frame-pointer",      // Prevent omitting frame pointer for debugging and stack unwinding
+                "-funwind-tables",              // Generate unwind tables for stack unwinding
+                "-ffunction-sections",          // Place each function in its own section
+                "-fdata-sections",              // Place each data object in its own section
+                "-fstandalone-debug",           // Emit standalone debug information
+                "-Wdeprecated-declarations",    // Warn about deprecated declarations
+            },
+        });
+        // zig fmt: on
 
-    // Add toml C src file for FIP
-    exe.root_module.addCSourceFile(.{
-        .file = b.path("toml/tomlc17.c"),
-    });
+        // Add toml C src file for FIP
+        exe.root_module.addCSourceFile(.{
+            .file = b.path("toml/tomlc17.c"),
+        });
+    }
 }
 
 fn buildLLVM(b: *std.Build, previous_step: *std.Build.Step, target: std.Build.ResolvedTarget, force_rebuild: bool, jobs: usize, llvm_dir: []const u8) !*std.Build.Step.Run {
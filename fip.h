@@ -33,6 +33,17 @@
 #define FIP_SLAVE
 #endif
 
+// The feature test macros only take effect when they are defined before the
+// first system header is included, `localtime_r` is not declared otherwise
+#ifndef __WIN32__
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+// #define _GNU_SOURCE
+// #define _XOPEN_SOURCE 700
+#endif
+
 #include "toml/tomlc17.h"
 
 #include <assert.h>
@@ -50,14 +61,10 @@
 #include <process.h>
 #include <windows.h>
 #else
-#ifndef _POSIX_C_SOURCE
-#define _POSIX_C_SOURCE 200809L
-#endif
-
-// #define _GNU_SOURCE
-// #define _XOPEN_SOURCE 700
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <signal.h>
 #include <spawn.h>
 #include <sys/ioctl.h>
@@ -83,7 +90,6 @@ extern int clock_gettime(clockid_t clk_id, struct timespec *tp);
 #endif
 #endif
 
-#define FIP_MAX_SLAVES 64
 #define FIP_MSG_SIZE 4096
 #define FIP_SLAVE_DELAY_MS 1
 
@@ -104,13 +110,104 @@ static void msleep(unsigned int ms) {
 }
 #endif
 
+/// @function `fip_now_ms`
+/// @brief Returns the current time of a monotonic clock in milliseconds
+#ifdef __WIN32__
+[[maybe_unused]]
+static double fip_now_ms(void) {
+    return (double)GetTickCount64();
+}
+#else
+[[maybe_unused]]
+static double fip_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+#endif
+
+/*
+ * ===========
+ * TRACEPOINTS
+ * ===========
+ */
+
+// Static tracepoints in the style of SystemTap's `sys/sdt.h`, which tools like
+// `perf` or `bpftrace` can attach to under the provider `fip`, for example
+// `bpftrace -e 'usdt:./fip-c:fip:parse_end { printf("%d\n", arg1); }'`.
+// Every probe compiles to a single `nop` together with a note in the
+// `.note.stapsdt` section which describes where its arguments live, so a
+// probe nothing is attached to costs next to nothing. Every argument is passed
+// as a signed 64 bit integer, strings are passed as pointers. The probes are
+// only emitted by GCC and Clang for x86_64 and AArch64 ELF targets and can be
+// disabled by defining `FIP_NO_PROBES`
+#if !defined(FIP_NO_PROBES) && defined(__ELF__) && defined(__GNUC__) &&        \
+    (defined(__x86_64__) || defined(__aarch64__))
+#define FIP_PROBE_NOTE(name, args)                                             \
+    "990: nop\n"                                                               \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                              \
+    ".balign 4\n"                                                              \
+    ".4byte 992f-991f,994f-993f,3\n"                                           \
+    "991: .asciz \"stapsdt\"\n"                                                \
+    "992: .balign 4\n"                                                         \
+    "993: .8byte 990b\n"                                                       \
+    ".8byte _.stapsdt.base\n"                                                  \
+    ".8byte 0\n"                                                               \
+    ".asciz \"fip\"\n"                                                         \
+    ".asciz \"" #name "\"\n"                                                   \
+    ".asciz \"" args "\"\n"                                                    \
+    "994: .balign 4\n"                                                         \
+    ".popsection\n"                                                            \
+    ".ifndef _.stapsdt.base\n"                                                 \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"    \
+    ".weak _.stapsdt.base\n"                                                   \
+    ".hidden _.stapsdt.base\n"                                                 \
+    "_.stapsdt.base: .space 1\n"                                               \
+    ".size _.stapsdt.base,1\n"                                                 \
+    ".popsection\n"                                                            \
+    ".endif\n"
+#define FIP_PROBE_ARG(n, x) [a##n] "nor"((int64_t)(intptr_t)(x))
+#define FIP_PROBE(name) __asm__ __volatile__(FIP_PROBE_NOTE(name, ""))
+#define FIP_PROBE1(name, x1)                                                   \
+    __asm__ __volatile__(                                                      \
+        FIP_PROBE_NOTE(name, "-8@%[a1]")                                       \
+        :                                                                      \
+        : FIP_PROBE_ARG(1, x1))
+#define FIP_PROBE2(name, x1, x2)                                               \
+    __asm__ __volatile__(                                                      \
+        FIP_PROBE_NOTE(name, "-8@%[a1] -8@%[a2]")                              \
+        :                                                                      \
+        : FIP_PROBE_ARG(1, x1), FIP_PROBE_ARG(2, x2))
+#define FIP_PROBE3(name, x1, x2, x3)                                           \
+    __asm__ __volatile__(                                                      \
+        FIP_PROBE_NOTE(name, "-8@%[a1] -8@%[a2] -8@%[a3]")                     \
+        :                                                                      \
+        : FIP_PROBE_ARG(1, x1), FIP_PROBE_ARG(2, x2), FIP_PROBE_ARG(3, x3))
+#define FIP_PROBE4(name, x1, x2, x3, x4)                                       \
+    __asm__ __volatile__(                                                      \
+        FIP_PROBE_NOTE(name, "-8@%[a1] -8@%[a2] -8@%[a3] -8@%[a4]")            \
+        :                                                                      \
+        : FIP_PROBE_ARG(1, x1), FIP_PROBE_ARG(2, x2),                          \
+          FIP_PROBE_ARG(3, x3), FIP_PROBE_ARG(4, x4))
+#else
+#define FIP_PROBE(name) ((void)0)
+#define FIP_PROBE1(name, x1) ((void)0)
+#define FIP_PROBE2(name, x1, x2) ((void)0)
+#define FIP_PROBE3(name, x1, x2, x3) ((void)0)
+#define FIP_PROBE4(name, x1, x2, x3, x4) ((void)0)
+#endif
+
 // The version of the FIP
 #define FIP_MAJOR 0
-#define FIP_MINOR 3
-#define FIP_PATCH 2
+#define FIP_MINOR 9
+#define FIP_PATCH 0
 
 #define FIP_MAX_MODULE_NAME_LEN 16
 
+// The file in which every interop module lists the files it parsed or compiled,
+// relative to the project root. The `%s` is the name of the module
+#define FIP_DEPS_PATH_FORMAT ".fip/cache/%s.deps"
+
 /// @typedef `fip_type_prim_e`
 /// @brief Enum of all possible primitive types supported by FIP
 typedef enum fip_type_prim_e : uint8_t {
@@ -118,15 +215,29 @@ typedef enum fip_type_prim_e : uint8_t {
     FIP_U8,       // unsigned char
     FIP_U16,      // unsigned short
     FIP_U32,      // unsigned int
-    FIP_U64,      // unsigned long
+    FIP_U64,      // uint64_t
     FIP_I8,       // char
     FIP_I16,      // short
     FIP_I32,      // int
-    FIP_I64,      // long
+    FIP_I64,      // int64_t
     FIP_F32,      // float
     FIP_F64,      // double
     FIP_BOOL,     // bool (byte)
     FIP_STR,      // char*
+    // The types below were added after the ones above, so they are appended to
+    // keep the wire values of the older types stable
+    FIP_ULLONG,  // unsigned long long
+    FIP_LLONG,   // long long
+    FIP_USIZE,   // size_t, uintptr_t
+    FIP_ISIZE,   // ptrdiff_t, ssize_t, intptr_t
+    FIP_LDOUBLE, // long double
+    FIP_F16,     // _Float16
+    FIP_U128,    // unsigned __int128
+    FIP_I128,    // __int128
+    FIP_C16,     // char16_t
+    FIP_C32,     // char32_t
+    FIP_ULONG,   // unsigned long
+    FIP_LONG,    // long
 } fip_type_prim_e;
 
 /// @typedef `fip_msg_type_e`
@@ -160,10 +271,35 @@ typedef enum fip_msg_type_e : uint8_t {
     // The IM's response to the tag request. It sends one symbol at a time and
     // whether that was the last symbol it provides
     FIP_MSG_TAG_SYMBOL_RESPONSE,
+    // The master subscribes to changes of a tag or of a single symbol. There is
+    // no direct response to it, the IM watches the inputs of its index from
+    // now on and pushes change notifications when they change
+    FIP_MSG_SUBSCRIBE_REQUEST,
+    // The IM's notification that a subscribed symbol was added, removed or
+    // changed its ABI after the index was rebuilt, for example after a header
+    // was edited. It is sent at any time, without a request
+    FIP_MSG_CHANGE_NOTIFICATION,
+    // The master asks every IM for the recorded usage of its tags, symbols and
+    // cached objects, the most used first
+    FIP_MSG_USAGE_REQUEST,
+    // The IM's response to the usage request. It sends one entry per message
+    // and ends the list with an empty usage response
+    FIP_MSG_USAGE_RESPONSE,
+    // The master asks every IM to remove its cached objects which were not
+    // used for a given time
+    FIP_MSG_CLEANUP_REQUEST,
+    // The IM's response to the cleanup request, what it removed
+    FIP_MSG_CLEANUP_RESPONSE,
+    // The IM reports that it's still working on the last request. Every
+    // progress message extends the master's deadline for the actual response
+    FIP_MSG_PROGRESS,
     // Kill command comes last
     FIP_MSG_KILL,
 } fip_msg_type_e;
 
+// The number of message types
+#define FIP_MSG_TYPE_COUNT (FIP_MSG_KILL + 1)
+
 /// @typedef `fip_msg_symbol_type_e`
 /// @brief Enum of all possible symbol types
 typedef enum fip_msg_symbol_type_e : uint8_t {
@@ -264,6 +400,34 @@ typedef enum fip_type_e : uint8_t {
     FIP_TYPE_OPAQUE,
 } fip_type_e;
 
+// The members of every type variant, in the form F(kind, member, count) like
+// the members of the signatures, see `FIP_SIG_FN_FIELDS`
+#define FIP_TYPE_PRIMITIVE_FIELDS(F) F(VALUE, u.prim, 0)
+#define FIP_TYPE_PTR_FIELDS(F) F(TYPE, u.ptr.base_type, 0)
+#define FIP_TYPE_STRUCT_FIELDS(F)                                              \
+    F(NAME, u.struct_t.name, 0)                                                \
+    F(TYPES, u.struct_t.fields, u.struct_t.field_count)
+#define FIP_TYPE_RECURSIVE_FIELDS(F) F(VALUE, u.recursive.levels_back, 0)
+#define FIP_TYPE_ENUM_FIELDS(F)                                                \
+    F(NAME, u.enum_t.name, 0)                                                  \
+    F(VALUE, u.enum_t.bit_width, 0)                                            \
+    F(VALUE, u.enum_t.is_signed, 0)                                            \
+    F(VALUES, u.enum_t.values, u.enum_t.value_count)
+#define FIP_TYPE_ARRAY_FIELDS(F)                                               \
+    F(VALUE, u.array.size, 0)                                                  \
+    F(TYPE, u.array.base_type, 0)
+#define FIP_TYPE_OPAQUE_FIELDS(F) F(NAME, u.opaque.name, 0)
+
+// All type variants, in the form X(type, fields)
+#define FIP_TYPE_SCHEMA(X)                                                     \
+    X(FIP_TYPE_PRIMITIVE, FIP_TYPE_PRIMITIVE_FIELDS)                           \
+    X(FIP_TYPE_PTR, FIP_TYPE_PTR_FIELDS)                                       \
+    X(FIP_TYPE_STRUCT, FIP_TYPE_STRUCT_FIELDS)                                 \
+    X(FIP_TYPE_RECURSIVE, FIP_TYPE_RECURSIVE_FIELDS)                           \
+    X(FIP_TYPE_ENUM, FIP_TYPE_ENUM_FIELDS)                                     \
+    X(FIP_TYPE_ARRAY, FIP_TYPE_ARRAY_FIELDS)                                   \
+    X(FIP_TYPE_OPAQUE, FIP_TYPE_OPAQUE_FIELDS)
+
 /// @typedef `fip_type_t`
 /// @brief The struct representing a type in FIP
 typedef struct fip_type_t {
@@ -339,10 +503,46 @@ typedef union {
     fip_sig_opaque_t opaque;
 } fip_sig_u;
 
+// The members of every signature kind, in the form F(kind, member, count).
+// NAME and VALUE members are copied, TYPE members own a single type and ARGS,
+// TYPES, STRS and VALUES members own an array of `count` elements. The deep
+// clones of signatures and types are generated from these tables
+#define FIP_SIG_FN_FIELDS(F)                                                   \
+    F(NAME, name, 0)                                                           \
+    F(ARGS, args, args_len)                                                    \
+    F(TYPES, rets, rets_len)
+#define FIP_SIG_DATA_FIELDS(F)                                                 \
+    F(NAME, name, 0)                                                           \
+    F(STRS, value_names, value_count)                                          \
+    F(TYPES, value_types, value_count)
+#define FIP_SIG_ENUM_FIELDS(F)                                                 \
+    F(NAME, name, 0)                                                           \
+    F(VALUE, type, 0)                                                          \
+    F(STRS, tags, value_count)                                                 \
+    F(VALUES, values, value_count)
+#define FIP_SIG_OPAQUE_FIELDS(F) F(NAME, name, 0)
+
+// All signature kinds, in the form X(symbol type, union member, function
+// suffix, name, fields). Every function which needs to dispatch on the symbol
+// type of a signature is generated from this table
+#define FIP_SIG_SCHEMA(X)                                                      \
+    X(FIP_SYM_FUNCTION, fn, fn, "FUNCTION", FIP_SIG_FN_FIELDS)                 \
+    X(FIP_SYM_DATA, data, data, "DATA", FIP_SIG_DATA_FIELDS)                   \
+    X(FIP_SYM_ENUM, enum_t, enum, "ENUM", FIP_SIG_ENUM_FIELDS)                 \
+    X(FIP_SYM_OPAQUE, opaque, opaque, "OPAQUE", FIP_SIG_OPAQUE_FIELDS)
+
 /// @typedef `fip_sig_t`
 /// @brief Struct representing a signature defined in FIP
 typedef struct {
     fip_msg_symbol_type_e type;
+    /// @var `abi_changed`
+    /// @brief Whether the ABI of the symbol changed since the previous session
+    /// which imported it. Symbols seen for the first time count as changed
+    bool abi_changed;
+    /// @var `fingerprint`
+    /// @brief The ABI fingerprint of the symbol. It covers the signature, the
+    /// layout and the calling convention, but not argument names or comments
+    uint64_t fingerprint;
     fip_sig_u sig;
 } fip_sig_t;
 
@@ -400,7 +600,7 @@ typedef struct {
 } fip_msg_compile_request_t;
 
 #define FIP_PATH_SIZE 8
-#define FIP_PATHS_SIZE FIP_MSG_SIZE - 32
+#define FIP_PATHS_SIZE (FIP_MSG_SIZE - 32)
 
 /// @typedef `fip_msg_object_response_t`
 /// @brief Struct representing the object response message
@@ -408,7 +608,7 @@ typedef struct {
     bool has_obj;
     bool compilation_failed;
     char module_name[FIP_MAX_MODULE_NAME_LEN];
-    uint8_t path_count;
+    uint16_t path_count;
     char paths[FIP_PATHS_SIZE];
 } fip_msg_object_response_t;
 
@@ -429,9 +629,109 @@ typedef struct {
 typedef struct {
     bool is_empty;
     fip_msg_symbol_type_e type;
+    bool abi_changed;
+    uint64_t fingerprint;
     fip_sig_u sig;
 } fip_msg_tag_symbol_response_t;
 
+/// @typedef `fip_msg_subscribe_request_t`
+/// @brief Struct representing the subscribe request message
+typedef struct {
+    /// @var `is_symbol`
+    /// @brief Whether `name` is the name of a single symbol instead of a tag
+    bool is_symbol;
+    /// @var `unsubscribe`
+    /// @brief Whether an earlier subscription of `name` is removed instead
+    bool unsubscribe;
+    char name[128];
+} fip_msg_subscribe_request_t;
+
+/// @typedef `fip_msg_change_kind_e`
+/// @brief The kind of change a change notification reports
+typedef enum fip_msg_change_kind_e : uint8_t {
+    FIP_CHANGE_ADDED = 0,
+    FIP_CHANGE_REMOVED,
+    FIP_CHANGE_ABI,
+} fip_msg_change_kind_e;
+
+/// @typedef `fip_msg_change_notification_t`
+/// @brief Struct representing the change notification message. It only names
+/// the changed symbol, its new signature is requested again if it is needed
+typedef struct {
+    fip_msg_change_kind_e kind;
+    char module_name[FIP_MAX_MODULE_NAME_LEN];
+    char tag[128];
+    char symbol[128];
+    /// @var `fingerprint`
+    /// @brief The new ABI fingerprint of the symbol, 0 if it was removed
+    uint64_t fingerprint;
+} fip_msg_change_notification_t;
+
+/// @typedef `fip_usage_kind_e`
+/// @brief The kind of thing a usage entry counts the uses of
+typedef enum fip_usage_kind_e : uint8_t {
+    FIP_USAGE_TAG = 0,
+    FIP_USAGE_SYMBOL,
+    FIP_USAGE_OBJECT,
+} fip_usage_kind_e;
+
+/// @typedef `fip_msg_usage_request_t`
+/// @brief Struct representing the usage request message
+typedef struct {
+    /// @var `limit`
+    /// @brief The maximum number of entries each IM sends, 0 for all of them
+    uint32_t limit;
+    /// @var `prefetch`
+    /// @brief Whether only the symbol entries are sent, together with their
+    /// signatures, so the master can prefetch the most used symbols
+    bool prefetch;
+} fip_msg_usage_request_t;
+
+/// @typedef `fip_msg_usage_response_t`
+/// @brief Struct representing the usage response message, the usage of a
+/// single tag, symbol or cached object
+typedef struct {
+    bool is_empty;
+    fip_usage_kind_e kind;
+    char module_name[FIP_MAX_MODULE_NAME_LEN];
+    char tag[128];
+    /// @var `name`
+    /// @brief The name of the symbol or the hash of the object, empty for tags
+    char name[128];
+    uint32_t use_count;
+    /// @var `last_used`
+    /// @brief The unix time in seconds at which it was used the last time
+    uint64_t last_used;
+    /// @var `type`
+    /// @brief The symbol type of `sig`, unknown unless the request prefetches
+    fip_msg_symbol_type_e type;
+    fip_sig_u sig;
+} fip_msg_usage_response_t;
+
+/// @typedef `fip_msg_cleanup_request_t`
+/// @brief Struct representing the cleanup request message
+typedef struct {
+    /// @var `max_age_s`
+    /// @brief Objects not used for longer than this many seconds are removed
+    uint64_t max_age_s;
+} fip_msg_cleanup_request_t;
+
+/// @typedef `fip_msg_cleanup_response_t`
+/// @brief Struct representing the cleanup response message
+typedef struct {
+    char module_name[FIP_MAX_MODULE_NAME_LEN];
+    uint32_t removed_count;
+    uint64_t removed_bytes;
+} fip_msg_cleanup_response_t;
+
+/// @typedef `fip_msg_progress_t`
+/// @brief Struct representing the progress message, the amount of work done
+/// of the request currently being worked on
+typedef struct {
+    uint32_t done;
+    uint32_t total;
+} fip_msg_progress_t;
+
 /// @typedef `fip_msg_kill_reason_e`
 /// @brief The reason enum for the kill command
 typedef enum fip_msg_kill_reason_e : uint8_t {
@@ -458,10 +758,229 @@ typedef struct {
         fip_msg_tag_request_t tag_req;
         fip_msg_tag_present_response_t tag_pres_res;
         fip_msg_tag_symbol_response_t tag_sym_res;
+        fip_msg_subscribe_request_t sub_req;
+        fip_msg_change_notification_t change;
+        fip_msg_usage_request_t usage_req;
+        fip_msg_usage_response_t usage_res;
+        fip_msg_cleanup_request_t clean_req;
+        fip_msg_cleanup_response_t clean_res;
+        fip_msg_progress_t progress;
         fip_msg_kill_t kill;
     } u;
 } fip_msg_t;
 
+/*
+ * ==============
+ * MESSAGE SCHEMA
+ * ==============
+ * The wire layout of every message is defined
+ * exactly once, in the tables below. Each table
+ * lists the fields of one message in the order
+ * in which they are sent, and the encoder, the
+ * size computation, the decoder, the free and
+ * the print function of the message are all
+ * generated from it. Each field has the form
+ * F(member, KIND, field, arg), the kinds are:
+ *   U8    A single byte (bools, enums, counts)
+ *   U32   A 4 byte integer
+ *   U64   A 8 byte integer
+ *   CHARS A char array of exactly `arg` bytes
+ *   STR   A string with a 1 byte length prefix
+ *   PATHS The 2 byte count `arg` and that many
+ *         hashes of FIP_PATH_SIZE bytes each
+ *   SYM   The symbol type of a signature
+ *   SIG   The signature union, its kind is the
+ *         SYM field `arg`
+ *   GUARD A bool. If it is set the rest of the
+ *         message is not sent at all
+ * Messages without a table carry no payload.
+ */
+
+#define FIP_CON_REQ_FIELDS(F, m)                                               \
+    F(m, U8, setup_ok, 0)                                                      \
+    F(m, U8, version.major, 0)                                                 \
+    F(m, U8, version.minor, 0)                                                 \
+    F(m, U8, version.patch, 0)                                                 \
+    F(m, CHARS, module_name, FIP_MAX_MODULE_NAME_LEN)
+
+#define FIP_SYM_REQ_FIELDS(F, m)                                               \
+    F(m, SYM, type, 0)                                                         \
+    F(m, SIG, sig, type)
+
+#define FIP_SYM_RES_FIELDS(F, m)                                               \
+    F(m, U8, found, 0)                                                         \
+    F(m, CHARS, module_name, FIP_MAX_MODULE_NAME_LEN)                          \
+    F(m, SYM, type, 0)                                                         \
+    F(m, SIG, sig, type)
+
+#define FIP_COM_REQ_FIELDS(F, m)                                               \
+    F(m, CHARS, target.arch, 16)                                               \
+    F(m, CHARS, target.sub, 16)                                                \
+    F(m, CHARS, target.vendor, 16)                                             \
+    F(m, CHARS, target.sys, 16)                                                \
+    F(m, CHARS, target.abi, 16)
+
+#define FIP_OBJ_RES_FIELDS(F, m)                                               \
+    F(m, U8, has_obj, 0)                                                       \
+    F(m, U8, compilation_failed, 0)                                            \
+    F(m, CHARS, module_name, FIP_MAX_MODULE_NAME_LEN)                          \
+    F(m, PATHS, paths, path_count)
+
+#define FIP_TAG_REQ_FIELDS(F, m) F(m, STR, tag, 0)
+
+#define FIP_TAG_PRES_RES_FIELDS(F, m) F(m, U8, is_present, 0)
+
+// The empty tag symbol response only consists of its `is_empty` flag, which
+// keeps the end-of-list message of every tag stream as small as possible
+#define FIP_TAG_SYM_RES_FIELDS(F, m)                                           \
+    F(m, GUARD, is_empty, 0)                                                   \
+    F(m, SYM, type, 0)                                                         \
+    F(m, U8, abi_changed, 0)                                                   \
+    F(m, U64, fingerprint, 0)                                                  \
+    F(m, SIG, sig, type)
+
+#define FIP_SUB_REQ_FIELDS(F, m)                                               \
+    F(m, U8, is_symbol, 0)                                                     \
+    F(m, U8, unsubscribe, 0)                                                   \
+    F(m, STR, name, 0)
+
+#define FIP_CHANGE_FIELDS(F, m)                                                \
+    F(m, U8, kind, 0)                                                          \
+    F(m, CHARS, module_name, FIP_MAX_MODULE_NAME_LEN)                          \
+    F(m, STR, tag, 0)                                                          \
+    F(m, STR, symbol, 0)                                                       \
+    F(m, U64, fingerprint, 0)
+
+#define FIP_USAGE_REQ_FIELDS(F, m)                                             \
+    F(m, U32, limit, 0)                                                        \
+    F(m, U8, prefetch, 0)
+
+#define FIP_USAGE_RES_FIELDS(F, m)                                             \
+    F(m, GUARD, is_empty, 0)                                                   \
+    F(m, U8, kind, 0)                                                          \
+    F(m, CHARS, module_name, FIP_MAX_MODULE_NAME_LEN)                          \
+    F(m, STR, tag, 0)                                                          \
+    F(m, STR, name, 0)                                                         \
+    F(m, U32, use_count, 0)                                                    \
+    F(m, U64, last_used, 0)                                                    \
+    F(m, SYM, type, 0)                                                         \
+    F(m, SIG, sig, type)
+
+#define FIP_CLEAN_REQ_FIELDS(F, m) F(m, U64, max_age_s, 0)
+
+#define FIP_CLEAN_RES_FIELDS(F, m)                                             \
+    F(m, CHARS, module_name, FIP_MAX_MODULE_NAME_LEN)                          \
+    F(m, U32, removed_count, 0)                                                \
+    F(m, U64, removed_bytes, 0)
+
+#define FIP_PROGRESS_FIELDS(F, m)                                              \
+    F(m, U32, done, 0)                                                         \
+    F(m, U32, total, 0)
+
+#define FIP_KILL_FIELDS(F, m) F(m, U8, reason, 0)
+
+// All messages with a payload, in the form X(message type, union member,
+// field table)
+#define FIP_MSG_SCHEMA(X)                                                      \
+    X(FIP_MSG_CONNECT_REQUEST, con_req, FIP_CON_REQ_FIELDS)                    \
+    X(FIP_MSG_SYMBOL_REQUEST, sym_req, FIP_SYM_REQ_FIELDS)                     \
+    X(FIP_MSG_SYMBOL_RESPONSE, sym_res, FIP_SYM_RES_FIELDS)                    \
+    X(FIP_MSG_COMPILE_REQUEST, com_req, FIP_COM_REQ_FIELDS)                    \
+    X(FIP_MSG_OBJECT_RESPONSE, obj_res, FIP_OBJ_RES_FIELDS)                    \
+    X(FIP_MSG_TAG_REQUEST, tag_req, FIP_TAG_REQ_FIELDS)                        \
+    X(FIP_MSG_TAG_PRESENT_RESPONSE, tag_pres_res, FIP_TAG_PRES_RES_FIELDS)     \
+    X(FIP_MSG_TAG_SYMBOL_RESPONSE, tag_sym_res, FIP_TAG_SYM_RES_FIELDS)        \
+    X(FIP_MSG_SUBSCRIBE_REQUEST, sub_req, FIP_SUB_REQ_FIELDS)                  \
+    X(FIP_MSG_CHANGE_NOTIFICATION, change, FIP_CHANGE_FIELDS)                  \
+    X(FIP_MSG_USAGE_REQUEST, usage_req, FIP_USAGE_REQ_FIELDS)                  \
+    X(FIP_MSG_USAGE_RESPONSE, usage_res, FIP_USAGE_RES_FIELDS)                 \
+    X(FIP_MSG_CLEANUP_REQUEST, clean_req, FIP_CLEAN_REQ_FIELDS)                \
+    X(FIP_MSG_CLEANUP_RESPONSE, clean_res, FIP_CLEAN_RES_FIELDS)               \
+    X(FIP_MSG_PROGRESS, progress, FIP_PROGRESS_FIELDS)                         \
+    X(FIP_MSG_KILL, kill, FIP_KILL_FIELDS)
+
+/*
+ * ================
+ * FRAMES AND LANES
+ * ================
+ * Every encoded message is sent as one or more
+ * frames. A frame starts with its length as a
+ * 4 byte integer, followed by a header byte and
+ * the payload. The header contains the lane of
+ * the frame (its priority class) and whether
+ * more chunks of the same message follow. Each
+ * side keeps one queue per lane, frames of the
+ * higher-priority lanes are always sent first
+ * and messages on the bulk lane are chunked, so
+ * control and lookup traffic never needs to wait
+ * for a whole bulk transfer to finish.
+ */
+
+#define FIP_FRAME_HEADER_SIZE 5
+#define FIP_FRAME_LANE_MASK 0x03
+#define FIP_FRAME_FLAG_MORE 0x80
+#define FIP_CHUNK_SIZE 512
+
+/// @typedef `fip_lane_e`
+/// @brief Enum of all priority classes of messages, lower values are sent first
+typedef enum fip_lane_e : uint8_t {
+    // Connects and kills, they are never delayed
+    FIP_LANE_CONTROL = 0,
+    // Interactive symbol and tag lookups
+    FIP_LANE_LOOKUP,
+    // Symbol streams of tag imports and compilation results
+    FIP_LANE_BULK,
+    // The number of lanes
+    FIP_LANE_COUNT,
+} fip_lane_e;
+
+/// @typedef `fip_queued_msg_t`
+/// @brief A single encoded message waiting in one of the lane queues
+typedef struct fip_queued_msg_t {
+    struct fip_queued_msg_t *next;
+    /// @var `len`
+    /// @brief The length of the encoded message, starting at its type
+    uint32_t len;
+    /// @var `offset`
+    /// @brief How many bytes of the message have been sent already
+    uint32_t offset;
+    char data[FIP_MSG_SIZE];
+} fip_queued_msg_t;
+
+/// @typedef `fip_msg_queue_t`
+/// @brief A FIFO queue of messages of a single lane
+typedef struct {
+    fip_queued_msg_t *head;
+    fip_queued_msg_t *tail;
+} fip_msg_queue_t;
+
+/// @typedef `fip_outbox_t`
+/// @brief The queues of all outgoing messages to a single peer
+typedef struct {
+    fip_msg_queue_t lanes[FIP_LANE_COUNT];
+    /// @var `spare`
+    /// @brief Messages which have been sent already, they are reused for the
+    /// next pushed messages instead of allocating new ones
+    fip_msg_queue_t spare;
+    /// @var `peer`
+    /// @brief The id of the peer as printed by `fip_print`, 0 for the master
+    uint32_t peer;
+} fip_outbox_t;
+
+/// @typedef `fip_inbox_t`
+/// @brief The state of all incoming frames from a single peer. The raw bytes
+/// are buffered until a whole frame is available, chunks are reassembled per
+/// lane and all complete messages are queued in the queue of their lane
+typedef struct {
+    char raw[FIP_MSG_SIZE * 2];
+    uint32_t raw_len;
+    fip_queued_msg_t *partial[FIP_LANE_COUNT];
+    fip_msg_queue_t lanes[FIP_LANE_COUNT];
+    /// @var `peer`
+    /// @brief The id of the peer as printed by `fip_print`, 0 for the master
+    uint32_t peer;
+} fip_inbox_t;
+
 /*
  * =====================
  * GENERAL FUNCTIONALITY
@@ -497,6 +1016,44 @@ void fip_print_msg(uint32_t id, const fip_msg_t *message);
 /// @param `message` The message to encode into the buffer
 void fip_encode_msg(char buffer[FIP_MSG_SIZE], const fip_msg_t *message);
 
+/// @function `fip_size_sig`
+/// @brief Returns the number of bytes the given signature takes up once it is
+/// encoded
+///
+/// @param `type` The symbol type of the signature
+/// @param `sig` The signature to measure
+/// @return `uint32_t` The size of the encoded signature
+uint32_t fip_size_sig(const fip_msg_symbol_type_e type, const fip_sig_u *sig);
+
+/// @function `fip_encode_sig`
+/// @brief Encodes the given signature into the buffer at the given index
+///
+/// @param `buffer` The buffer in which to store the signature in
+/// @param `idx` The index at which to write, advanced past the signature
+/// @param `type` The symbol type of the signature
+/// @param `sig` The signature to encode
+void fip_encode_sig(                  //
+    char buffer[FIP_MSG_SIZE],        //
+    uint32_t *idx,                    //
+    const fip_msg_symbol_type_e type, //
+    const fip_sig_u *sig              //
+);
+
+/// @function `fip_decode_sig`
+/// @brief Decodes a signature of the given symbol type from the buffer at the
+/// given index
+///
+/// @param `buffer` The buffer from which the signature is decoded
+/// @param `idx` The index at which to read, advanced past the signature
+/// @param `type` The symbol type of the signature
+/// @param `sig` The signature where the result is stored
+void fip_decode_sig(                  //
+    const char buffer[FIP_MSG_SIZE],  //
+    uint32_t *idx,                    //
+    const fip_msg_symbol_type_e type, //
+    fip_sig_u *sig                    //
+);
+
 /// @function `fip_decode_msg`
 /// @brief Tries to decode a message from the given buffer and create a message
 /// from it
@@ -517,12 +1074,30 @@ void fip_free_type(fip_type_t *type);
 /// @param `message` The message to free
 void fip_free_msg(fip_msg_t *message);
 
+/// @function `fip_free_sig`
+/// @brief Frees the given signature of the given symbol type
+///
+/// @param `type` The symbol type of the signature
+/// @param `sig` The signature to free
+void fip_free_sig(const fip_msg_symbol_type_e type, fip_sig_u *sig);
+
 /// @function `fip_free_sig_list`
 /// @brief Frees a given signature list
 ///
 /// @param `list` The list to free
 void fip_free_sig_list(fip_sig_list_t *list);
 
+/// @function `fip_sig_name`
+/// @brief Returns the name of the given signature of the given symbol type
+///
+/// @param `type` The symbol type of the signature
+/// @param `sig` The signature to get the name of
+/// @return `const char *` The name, an empty string for unknown symbols
+const char *fip_sig_name(             //
+    const fip_msg_symbol_type_e type, //
+    const fip_sig_u *sig              //
+);
+
 /// @function `fip_create_hash`
 /// @brief Creates a 8 Byte character hash from the given file path to make
 /// differentiating between different files predictable in size. Each character
@@ -605,6 +1180,18 @@ void fip_print_sig_enum(uint32_t id, const fip_sig_enum_t *sig);
 /// @param `sig` The opaque signature to print
 void fip_print_sig_opaque(uint32_t id, const fip_sig_opaque_t *sig);
 
+/// @function `fip_print_sig`
+/// @brief Prints the given signature of the given symbol type
+///
+/// @param `id` The id of the process to print the signature from
+/// @param `type` The symbol type of the signature
+/// @param `sig` The signature to print
+void fip_print_sig(                   //
+    uint32_t id,                      //
+    const fip_msg_symbol_type_e type, //
+    const fip_sig_u *sig              //
+);
+
 /// @function `fip_clone_sig_fn`
 /// @brief Clones a given function signature from the source to the destination
 ///
@@ -633,6 +1220,19 @@ void fip_clone_sig_enum(fip_sig_enum_t *dest, const fip_sig_enum_t *src);
 /// @brief `src` The source to clone
 void fip_clone_sig_opaque(fip_sig_opaque_t *dest, const fip_sig_opaque_t *src);
 
+/// @function `fip_clone_sig`
+/// @brief Clones the source signature of the given symbol type into the
+/// destination
+///
+/// @param `type` The symbol type of the signature
+/// @param `dest` The destination to clone into
+/// @param `src` The source to clone
+void fip_clone_sig(                   //
+    const fip_msg_symbol_type_e type, //
+    fip_sig_u *dest,                  //
+    const fip_sig_u *src              //
+);
+
 /// @function `fip_clone_type`
 /// @brief Clones a given type from the source to the destination
 ///
@@ -650,6 +1250,84 @@ void fip_clone_type(fip_type_t *dest, const fip_type_t *src);
 /// @return `int` The exit code of the executed command
 int fip_execute_and_caputre(char **output, const char *command);
 
+/// @function `fip_msg_lane`
+/// @brief Returns the lane messages of the given type are sent on
+///
+/// @param `type` The type of the message
+/// @return `fip_lane_e` The lane of the message
+fip_lane_e fip_msg_lane(const fip_msg_type_e type);
+
+/// @function `fip_outbox_push`
+/// @brief Queues the given encoded message in the queue of its lane
+///
+/// @param `outbox` The outbox to queue the message in
+/// @param `buffer` The buffer containing the message encoded by
+/// `fip_encode_msg`
+void fip_outbox_push(fip_outbox_t *outbox, const char buffer[FIP_MSG_SIZE]);
+
+/// @function `fip_outbox_is_empty`
+/// @brief Checks whether the given outbox has no frames left to send
+///
+/// @param `outbox` The outbox to check
+/// @return `bool` Whether all queues of the outbox are empty
+bool fip_outbox_is_empty(const fip_outbox_t *outbox);
+
+/// @function `fip_outbox_write_frame`
+/// @brief Writes the next frame of the highest-priority non-empty lane to the
+/// given stream. Messages on the bulk lane are written in chunks of
+/// `FIP_CHUNK_SIZE` bytes, one chunk per call
+///
+/// @param `outbox` The outbox to take the frame from
+/// @param `stream` The stream to write the frame to
+/// @return `bool` Whether a frame was written successfully
+bool fip_outbox_write_frame(fip_outbox_t *outbox, FILE *stream);
+
+/// @function `fip_outbox_flush`
+/// @brief Writes all queued frames of the outbox to the given stream
+///
+/// @param `outbox` The outbox to flush
+/// @param `stream` The stream to write the frames to
+/// @return `bool` Whether all frames were written successfully
+bool fip_outbox_flush(fip_outbox_t *outbox, FILE *stream);
+
+/// @function `fip_inbox_fill`
+/// @brief Reads all bytes currently available on the given stream into the
+/// inbox and queues all messages completed by them. The stream's own buffer is
+/// bypassed, so the stream must never be read through stdio functions
+///
+/// @param `inbox` The inbox to fill
+/// @param `stream` The stream to read from
+/// @param `timeout_ms` How long to wait for data, negative values wait forever
+/// @return `bool` Whether the stream is still intact, false on EOF, read
+/// errors or malformed frames
+bool fip_inbox_fill(fip_inbox_t *inbox, FILE *stream, const int timeout_ms);
+
+/// @function `fip_inbox_pop`
+/// @brief Takes the oldest complete message of the highest-priority lane up to
+/// the given lane out of the inbox
+///
+/// @param `inbox` The inbox to take the message from
+/// @param `max_lane` The lowest-priority lane to consider
+/// @param `buffer` The buffer to store the message in, starting at its type
+/// @return `bool` Whether a message was available
+bool fip_inbox_pop(            //
+    fip_inbox_t *inbox,        //
+    const fip_lane_e max_lane, //
+    char buffer[FIP_MSG_SIZE]  //
+);
+
+/// @function `fip_outbox_clear`
+/// @brief Frees all messages still queued in the outbox and all spare ones
+///
+/// @param `outbox` The outbox to clear
+void fip_outbox_clear(fip_outbox_t *outbox);
+
+/// @function `fip_inbox_clear`
+/// @brief Frees all messages and partial messages still held by the inbox
+///
+/// @param `inbox` The inbox to clear
+void fip_inbox_clear(fip_inbox_t *inbox);
+
 /*
  * ====================
  * MASTER FUNCTIONALITY
@@ -658,24 +1336,188 @@ int fip_execute_and_caputre(char **output, const char *command);
 
 #ifdef FIP_MASTER
 
-#define FIP_MAX_ENABLED_MODULES 16
-
 /// @typedef `fip_interop_modules_t`
 /// @brief A list of all active interop modules spawned by the master
 typedef struct {
-    uint8_t active_count;
-    pid_t pids[FIP_MAX_SLAVES];
+    uint32_t active_count;
+    uint32_t capacity;
+    pid_t *pids;
 } fip_interop_modules_t;
 
+/*
+ * =========
+ * DEADLINES
+ * =========
+ * How long the master waits for a response is
+ * derived from the latencies observed for each
+ * slave and each expected message type. The
+ * latency is the time between sending a request
+ * (or receiving the last response of a stream)
+ * and its response. A smoothed mean and mean
+ * deviation are kept, the deadline is the mean
+ * plus a multiple of the deviation, clamped to
+ * the floor and the ceiling of its message type.
+ * Slaves working on a long request send progress
+ * messages, every progress message starts a new
+ * deadline but is no sample. A timed out wait
+ * counts as a sample too, so a slow slave gets
+ * longer deadlines over time instead of failing
+ * forever.
+ */
+
+#define FIP_LATENCY_GAIN 0.125
+#define FIP_DEVIATION_GAIN 0.25
+#define FIP_DEVIATION_FACTOR 4.0
+
+/// @typedef `fip_deadline_bounds_t`
+/// @brief The bounds of the deadlines of a single message type, values of 0
+/// mean that the default value is used
+typedef struct {
+    /// @var `initial_ms`
+    /// @brief The deadline used until the first latency was observed
+    uint32_t initial_ms;
+    uint32_t floor_ms;
+    uint32_t ceiling_ms;
+} fip_deadline_bounds_t;
+
+/// @typedef `fip_latency_stats_t`
+/// @brief The observed latencies of a single slave for a single message type
+typedef struct {
+    uint32_t samples;
+    double mean_ms;
+    double deviation_ms;
+} fip_latency_stats_t;
+
+/*
+ * =========
+ * LOG DRAIN
+ * =========
+ * The slaves log to their stderr, which is a
+ * pipe to the master. Once the pipe is full a
+ * slave blocks in its next `fip_print` until
+ * the master reads it. A background thread of
+ * the master therefore reads the stderr pipes of
+ * all slaves continuously into a bounded buffer.
+ * The master writes the buffered lines to its
+ * own stderr whenever it prints the slave
+ * streams. When the buffer is full because the
+ * master did not print them for a long time,
+ * further lines are dropped and only counted.
+ */
+
+#define FIP_LOG_BUFFER_SIZE (256 * 1024)
+#define FIP_LOG_LINE_SIZE 4096
+#define FIP_LOG_DRAIN_INTERVAL_MS 50
+
+/// @typedef `fip_log_source_t`
+/// @brief The stderr pipe of a single slave as read by the log drain
+typedef struct {
+#ifdef __WIN32__
+    HANDLE handle;
+#else
+    int fd;
+#endif
+    /// @var `is_closed`
+    /// @brief Whether the slave closed its end of the pipe
+    bool is_closed;
+    /// @var `partial`
+    /// @brief The last line of the slave, which is not complete yet
+    char partial[FIP_LOG_LINE_SIZE];
+    uint32_t partial_len;
+} fip_log_source_t;
+
+/// @typedef `fip_log_drain_t`
+/// @brief The state of the log drain, everything but the thread itself is
+/// guarded by `lock`
+typedef struct {
+#ifdef __WIN32__
+    HANDLE thread;
+    CRITICAL_SECTION lock;
+#else
+    pthread_t thread;
+    pthread_mutex_t lock;
+#endif
+    bool is_running;
+    fip_log_source_t *sources;
+    uint32_t source_count;
+    uint32_t source_capacity;
+    /// @var `lines`
+    /// @brief The buffer complete lines are appended to, holding `len` bytes.
+    /// The `spare` buffer is written to the stderr of the master meanwhile
+    char *lines;
+    char *spare;
+    uint32_t len;
+    /// @var `dropped_count`
+    /// @brief The number of lines dropped since the buffer was last written
+    uint32_t dropped_count;
+} fip_log_drain_t;
+
+/// @typedef `fip_slave_t`
+/// @brief The descriptor of a single slave, containing its streams and all the
+/// state the master keeps per slave
+typedef struct {
+    /// @var `in`
+    /// @brief The stdin of the slave, the master writes to it
+    FILE *in;
+    /// @var `out`
+    /// @brief The stdout of the slave, the master reads messages from it
+    FILE *out;
+    /// @var `err`
+    /// @brief The stderr of the slave, containing its log output
+    FILE *err;
+#ifdef __WIN32__
+    HANDLE process;
+#endif
+    fip_inbox_t inbox;
+    fip_outbox_t outbox;
+    fip_latency_stats_t latencies[FIP_MSG_TYPE_COUNT];
+    /// @var `request_ms`
+    /// @brief When the last request was sent to the slave or its last response
+    /// was received, the latency of the next response is measured from it
+    double request_ms;
+    /// @var `module_name`
+    /// @brief The name of the module the slave was spawned from
+    char module_name[FIP_MAX_MODULE_NAME_LEN];
+    /// @var `has_needed`
+    /// @brief Whether the master uses symbols of this slave, either from an
+    /// imported tag or from a resolved symbol. Only those slaves have something
+    /// to compile
+    bool has_needed;
+} fip_slave_t;
+
+/// @typedef `fip_gather_set_t`
+/// @brief A set of slaves a request is sent to and responses are gathered
+/// from, so requests only wait for the slaves they actually target
+typedef struct {
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *ids;
+} fip_gather_set_t;
+
 /// @typedef `fip_master_state_t`
-/// @brief The structure containing the whole state of the entire master
+/// @brief The structure containing the whole state of the entire master. The
+/// slave descriptors and the response slots grow with the number of spawned
+/// slaves
 typedef struct {
-    FILE *slave_stdin[FIP_MAX_SLAVES];
-    FILE *slave_stdout[FIP_MAX_SLAVES];
-    FILE *slave_stderr[FIP_MAX_SLAVES];
+    fip_slave_t *slaves;
     uint32_t slave_count;
-    fip_msg_t responses[FIP_MAX_SLAVES];
+    uint32_t slave_capacity;
+    /// @var `responses`
+    /// @brief The responses of the last gather, `response_ids` contains the id
+    /// of the slave each response came from
+    fip_msg_t *responses;
+    uint32_t *response_ids;
     uint32_t response_count;
+    fip_deadline_bounds_t deadlines[FIP_MSG_TYPE_COUNT];
+    /// @var `changes`
+    /// @brief The change notifications received from the slaves which have not
+    /// been taken by `fip_master_next_change` yet, oldest first
+    fip_msg_change_notification_t *changes;
+    uint32_t change_count;
+    uint32_t change_capacity;
+    /// @var `log_drain`
+    /// @brief The drain of the stderr pipes of all slaves
+    fip_log_drain_t log_drain;
 } fip_master_state_t;
 
 /// @typedef `fip_tag_request_status_e`
@@ -697,12 +1539,24 @@ typedef struct {
     fip_sig_list_t *list;
 } fip_tag_request_result_t;
 
+/// @typedef `fip_usage_list_t`
+/// @brief Struct representing a list of the usage entries of all slaves
+typedef struct {
+    size_t count;
+    fip_msg_usage_response_t entries[];
+} fip_usage_list_t;
+
 /// @typedef `fip_master_config`
 /// @brief The structure containing the results of the parsed toml file
 typedef struct {
     bool ok;
-    char enabled_modules[FIP_MAX_ENABLED_MODULES][FIP_MAX_MODULE_NAME_LEN];
-    uint8_t enabled_count;
+    char **enabled_modules;
+    uint32_t enabled_count;
+    fip_deadline_bounds_t deadlines[FIP_MSG_TYPE_COUNT];
+    /// @var `prefetch_count`
+    /// @brief How many of the most used symbols of every module are fetched
+    /// right after connecting, 0 to not prefetch anything
+    uint32_t prefetch_count;
 } fip_master_config_t;
 
 #ifndef __WIN32__
@@ -720,9 +1574,23 @@ extern fip_master_state_t master_state;
 /// @param `dest` The destination stream to which lines are copied to
 void fip_copy_stream_lines(FILE *src, FILE *dest);
 
+/// @function `fip_log_drain_add`
+/// @brief Adds the stderr pipe of a slave to the log drain, starting the drain
+/// thread if it is not running yet
+///
+/// @param `err` The stderr stream of the slave
+/// @return `bool` Whether the pipe is drained in the background
+bool fip_log_drain_add(FILE *err);
+
+/// @function `fip_log_drain_stop`
+/// @brief Stops the drain thread, reads what is left in all pipes and prints
+/// it. The pipes are not closed
+void fip_log_drain_stop(void);
+
 /// @function `fip_print_slave_streams`
-/// @brief Prints all the `stderr` streams from all slaves into the `stderr`
-/// stream of the master, to gather all the debug output from all slaves
+/// @brief Prints all the lines the log drain read from the `stderr` streams of
+/// all slaves into the `stderr` stream of the master, to gather all the debug
+/// output from all slaves
 void fip_print_slave_streams();
 
 /// @function `fip_spawn_interop_module`
@@ -766,24 +1634,49 @@ void fip_master_broadcast_message( //
     const fip_msg_t *message       //
 );
 
+/// @function `fip_master_send_to_set`
+/// @brief Sends a given message to all slaves of the gather set
+///
+/// @param `buffer` The buffer in which the message will be encoded before
+/// sending it
+/// @param `set` The slaves to send the message to
+/// @param `message` The message to send
+void fip_master_send_to_set(     //
+    char buffer[FIP_MSG_SIZE],   //
+    const fip_gather_set_t *set, //
+    const fip_msg_t *message     //
+);
+
 /// @function `fip_master_await_responses`
-/// @brief Waits for all slaves to respond with a message from stdin
+/// @brief Waits for all slaves of the gather set to respond with a message.
+/// The responses are stored in `master_state.responses` and the id of the
+/// slave of every response in `master_state.response_ids`
 ///
 /// @param `buffer` The buffer in which the recieved messages will be stored
 /// temporarily
-/// @param `responses` The responses of all slaves where the ID of the response
-/// in the array corresponds to the ID of the slave itself
-/// @param `response_count` How many responses we got
+/// @param `set` The slaves to gather the responses from, `NULL` for all slaves
 /// @param `expected_msg_type` The type of the expected message
-/// @return `uint8_t` How many responses were faulty (unable to be read) or had
-/// the wrong type
-uint8_t fip_master_await_responses(        //
+/// @return `uint32_t` How many responses were faulty (unable to be read) or
+/// had the wrong type
+uint32_t fip_master_await_responses(       //
     char buffer[FIP_MSG_SIZE],             //
-    fip_msg_t responses[FIP_MAX_SLAVES],   //
-    uint32_t *response_count,              //
+    const fip_gather_set_t *set,           //
     const fip_msg_type_e expected_msg_type //
 );
 
+/// @function `fip_gather_set_add`
+/// @brief Adds the slave with the given id to the gather set
+///
+/// @param `set` The set to add the slave to
+/// @param `id` The id of the slave to add
+void fip_gather_set_add(fip_gather_set_t *set, const uint32_t id);
+
+/// @function `fip_gather_set_free`
+/// @brief Frees the ids of the given gather set
+///
+/// @param `set` The set to free
+void fip_gather_set_free(fip_gather_set_t *set);
+
 /// @function `fip_master_symbol_request`
 /// @brief Broadcasts a symbol request message and then awaits all
 /// symbol response messages and returns whether the requested
@@ -800,6 +1693,80 @@ bool fip_master_symbol_request( //
     const fip_msg_t *message    //
 );
 
+/*
+ * ====================
+ * PRE-ENCODED REQUESTS
+ * ====================
+ * Symbol requests for signatures which are known
+ * at build time can be encoded at build time too.
+ * The request then is a constant laid out exactly
+ * like the buffer `fip_encode_msg` would fill, so
+ * it is sent without constructing or encoding the
+ * message at runtime:
+ *
+ *   // extern def add(mut i32* lhs, mut i32 rhs);
+ *   static FIP_ENCODED_FN_REQUEST(add_request, "add",
+ *       FIP_ENC_ARGS(2,
+ *           FIP_ENC_ARG(FIP_ENC_PTR(true, FIP_ENC_PRIM(false, FIP_I32))),
+ *           FIP_ENC_ARG(FIP_ENC_PRIM(true, FIP_I32))),
+ *       FIP_ENC_RETS(0));
+ *   fip_master_symbol_request_encoded(buffer, FIP_ENCODED(add_request));
+ *
+ * Only primitive and pointer types can be encoded
+ * this way, arguments are encoded without names.
+ */
+
+// Every encoded type starts with its kind followed by whether it is mutable
+#define FIP_ENC_PRIM(is_mutable, prim) FIP_TYPE_PRIMITIVE, (is_mutable), (prim)
+#define FIP_ENC_PTR(is_mutable, ...) FIP_TYPE_PTR, (is_mutable), __VA_ARGS__
+#define FIP_ENC_MUT_(kind, is_mutable, ...) is_mutable
+#define FIP_ENC_MUT(...) FIP_ENC_MUT_(__VA_ARGS__)
+// Arguments and return types repeat the mutability of their type in front of
+// it, arguments are preceded by the length of their (empty) name
+#define FIP_ENC_ARG(...) 0, FIP_ENC_MUT(__VA_ARGS__), __VA_ARGS__
+#define FIP_ENC_RET(...) FIP_ENC_MUT(__VA_ARGS__), __VA_ARGS__
+#define FIP_ENC_ARGS(count, ...) (count)__VA_OPT__(, __VA_ARGS__)
+#define FIP_ENC_RETS(count, ...) (count)__VA_OPT__(, __VA_ARGS__)
+
+// The name is stored without its terminator, just like it is encoded
+#if defined(__has_attribute)
+#if __has_attribute(nonstring)
+#define FIP_NONSTRING __attribute__((nonstring))
+#endif
+#endif
+#ifndef FIP_NONSTRING
+#define FIP_NONSTRING
+#endif
+
+#define FIP_ENCODED_FN_REQUEST(var, fn_name, args, rets)                       \
+    const struct {                                                             \
+        uint32_t len;                                                          \
+        char head[3];                                                          \
+        char name[sizeof(fn_name) - 1] FIP_NONSTRING;                          \
+        char tail[sizeof((const char[]){args, rets})];                         \
+    } var = {                                                                  \
+        3 + sizeof(fn_name) - 1 + sizeof((const char[]){args, rets}),          \
+        {FIP_MSG_SYMBOL_REQUEST, FIP_SYM_FUNCTION, sizeof(fn_name) - 1},       \
+        fn_name,                                                               \
+        {args, rets},                                                          \
+    }
+#define FIP_ENCODED(var) ((const char *)&(var))
+
+/// @function `fip_master_symbol_request_encoded`
+/// @brief Broadcasts an already encoded symbol request, for example one
+/// declared through `FIP_ENCODED_FN_REQUEST`, and then awaits all symbol
+/// response messages just like `fip_master_symbol_request`
+///
+/// @param `buffer` The buffer in which the recieved messages will be stored
+/// @param `encoded` The encoded symbol request, starting with its length
+/// @return `bool` Whether the requested symbol was found
+///
+/// @note This function asserts the message type to be FIP_MSG_SYMBOL_REQUEST
+bool fip_master_symbol_request_encoded( //
+    char buffer[FIP_MSG_SIZE],          //
+    const char *encoded                 //
+);
+
 /// @function `fip_master_compile_request`
 /// @brief Broadcasts a compile request message and then awaits
 /// all object response messages and returns whether all modules
@@ -853,6 +1820,178 @@ void fip_master_send_message_to( //
     const fip_msg_t *message     //
 );
 
+/// @function `fip_master_await_message_from`
+/// @brief Waits for the next message of a given IM until its deadline for the
+/// expected message type passes. Progress messages extend the deadline and are
+/// not returned
+///
+/// @param `id` The id of the slave to get the message from
+/// @param `buffer` The buffer where to store the recieved message at
+/// @param `expected_msg_type` The type of the expected message
+/// @return `bool` Whether a message was recieved before the deadline
+bool fip_master_await_message_from(        //
+    uint32_t id,                           //
+    char buffer[FIP_MSG_SIZE],             //
+    const fip_msg_type_e expected_msg_type //
+);
+
+/// @function `fip_master_take_progress`
+/// @brief Checks whether the received message in the buffer is a progress
+/// message and reports it if it is
+///
+/// @param `id` The id of the slave the message was received from
+/// @param `buffer` The buffer containing the received message
+/// @return `bool` Whether the message was a progress message
+bool fip_master_take_progress(uint32_t id, const char buffer[FIP_MSG_SIZE]);
+
+/// @function `fip_master_take_change`
+/// @brief Checks whether the given message is a change notification and queues
+/// it if it is. Change notifications are pushed by the slaves at any time, so
+/// they are taken out of the stream of responses just like progress messages
+///
+/// @param `id` The id of the slave the message came from
+/// @param `buffer` The received message, starting at its type
+/// @return `bool` Whether the message was a change notification
+bool fip_master_take_change(uint32_t id, const char buffer[FIP_MSG_SIZE]);
+
+/// @function `fip_master_subscribe`
+/// @brief Subscribes all slaves to changes of a tag or of a single symbol. The
+/// slaves do not respond to it, they push change notifications whenever their
+/// index of a subscribed tag or symbol changes
+///
+/// @param `buffer` The buffer in which the message will be encoded before
+/// sending it
+/// @param `message` The subscribe request to send
+void fip_master_subscribe(char buffer[FIP_MSG_SIZE], const fip_msg_t *message);
+
+/// @function `fip_master_poll_changes`
+/// @brief Reads all messages the slaves sent while the master was not waiting
+/// for a response and queues their change notifications. Waits for up to
+/// `timeout_ms` milliseconds for the first notification to arrive
+///
+/// @param `buffer` The buffer in which the recieved messages will be stored
+/// temporarily
+/// @param `timeout_ms` How long to wait for a notification, 0 to not wait
+/// @return `uint32_t` The number of queued change notifications
+uint32_t fip_master_poll_changes( //
+    char buffer[FIP_MSG_SIZE],    //
+    const uint32_t timeout_ms     //
+);
+
+/// @function `fip_master_next_change`
+/// @brief Takes the oldest queued change notification
+///
+/// @param `change` Where to store the change notification
+/// @return `bool` Whether a change notification was queued
+bool fip_master_next_change(fip_msg_change_notification_t *change);
+
+/// @function `fip_sig_list_invalidate`
+/// @brief Invalidates the symbol of the given change notification in the given
+/// list. The signature is freed and its entry is left as an unknown symbol, so
+/// the positions of all other symbols in the list stay the same
+///
+/// @param `list` The list to invalidate the symbol in
+/// @param `change` The change notification naming the symbol
+/// @return `bool` Whether the list contained the symbol
+bool fip_sig_list_invalidate(                   //
+    fip_sig_list_t *list,                       //
+    const fip_msg_change_notification_t *change //
+);
+
+/// @function `fip_master_usage_request`
+/// @brief Broadcasts a usage request message and collects the usage entries
+/// of all slaves. Every slave sends its entries most used first
+///
+/// @param `buffer` The buffer in which the to-be-sent message and the recieved
+/// messages will be stored in
+/// @param `message` The usage request message to send
+/// @return `fip_usage_list_t *` The entries of all slaves, NULL if a slave did
+/// not respond
+///
+/// @note This function asserts the message type to be FIP_MSG_USAGE_REQUEST
+fip_usage_list_t *fip_master_usage_request( //
+    char buffer[FIP_MSG_SIZE],              //
+    const fip_msg_t *message                //
+);
+
+/// @function `fip_free_usage_list`
+/// @brief Frees a given usage list and the signatures of its entries
+///
+/// @param `list` The list to free
+void fip_free_usage_list(fip_usage_list_t *list);
+
+/// @function `fip_master_cleanup_request`
+/// @brief Broadcasts a cleanup request message and awaits all cleanup
+/// responses
+///
+/// @param `buffer` The buffer in which the to-be-sent message and the recieved
+/// messages will be stored in
+/// @param `message` The cleanup request message to send
+/// @return `uint32_t` The number of cached objects removed by all slaves
+///
+/// @note This function asserts the message type to be FIP_MSG_CLEANUP_REQUEST
+uint32_t fip_master_cleanup_request( //
+    char buffer[FIP_MSG_SIZE],       //
+    const fip_msg_t *message         //
+);
+
+/// @function `fip_master_deadline_bounds`
+/// @brief Returns the bounds of the deadlines of the given message type, the
+/// configured bounds merged with the defaults
+///
+/// @param `type` The type of the expected message
+/// @return `fip_deadline_bounds_t` The effective bounds
+fip_deadline_bounds_t fip_master_deadline_bounds(const fip_msg_type_e type);
+
+/// @function `fip_master_deadline_ms`
+/// @brief Returns how long to wait for the next frame of the given slave when
+/// expecting a message of the given type
+///
+/// @param `id` The id of the slave
+/// @param `type` The type of the expected message
+/// @return `uint32_t` The deadline in milliseconds
+uint32_t fip_master_deadline_ms(const uint32_t id, const fip_msg_type_e type);
+
+/// @function `fip_master_record_latency`
+/// @brief Adds an observed latency to the statistics of the given slave
+///
+/// @param `id` The id of the slave
+/// @param `type` The type of the expected message
+/// @param `latency_ms` The observed latency in milliseconds
+void fip_master_record_latency( //
+    const uint32_t id,          //
+    const fip_msg_type_e type,  //
+    const double latency_ms     //
+);
+
+/// @function `fip_master_record_response`
+/// @brief Records the latency of the response the given slave just sent, or
+/// failed to send in time, measured from sending its request. The next
+/// response of a stream is measured from this one
+///
+/// @param `id` The id of the slave
+/// @param `type` The type of the expected message
+void fip_master_record_response(const uint32_t id, const fip_msg_type_e type);
+
+/// @function `fip_master_set_deadlines`
+/// @brief Applies the deadline bounds of the given config to the master
+///
+/// @param `config` The loaded master config
+void fip_master_set_deadlines(const fip_master_config_t *config);
+
+/// @function `fip_master_write_depfile`
+/// @brief Writes a Make / Ninja depfile listing the `fip.toml` file, the config
+/// file of every module and every file the modules parsed or compiled, so an
+/// outer build system knows when the compilation has to run again. It must be
+/// called after the compile request and before `fip_master_cleanup`. When a
+/// module did not list its dependencies no depfile is written, since it would
+/// be incomplete
+///
+/// @param `depfile_path` The path of the depfile to write
+/// @param `target` The output of the build step the depfile belongs to
+/// @return `bool` Whether the depfile was written
+bool fip_master_write_depfile(const char *depfile_path, const char *target);
+
 /// @function `fip_master_cleanup`
 /// @brief Cleans up the master
 void fip_master_cleanup();
@@ -865,6 +2004,12 @@ void fip_master_cleanup();
 /// @return `fip_master_config_t` The loaded configuration
 fip_master_config_t fip_master_load_config(const char *config_path);
 
+/// @function `fip_master_free_config`
+/// @brief Frees the module list of the given master config
+///
+/// @param `config` The config to free
+void fip_master_free_config(fip_master_config_t *config);
+
 #endif // End of #ifdef FIP_MASTER
 
 #ifdef FIP_SLAVE
@@ -889,8 +2034,22 @@ bool fip_slave_init(uint32_t slave_id);
 /// @return `bool` Whether a message was recieved
 bool fip_slave_receive_message(char buffer[FIP_MSG_SIZE]);
 
+/// @function `fip_slave_poll_message`
+/// @brief Takes a message of the given lane or any higher-priority lane from
+/// stdin if one is available, without waiting for one. This is used to serve
+/// control and lookup messages while a bulk transfer is still in progress
+///
+/// @param `max_lane` The lowest-priority lane to take messages from
+/// @param `buffer` The buffer where to store the recieved message at
+/// @return `bool` Whether a message was recieved
+bool fip_slave_poll_message(   //
+    const fip_lane_e max_lane, //
+    char buffer[FIP_MSG_SIZE]  //
+);
+
 /// @function `fip_slave_send_message`
-/// @brief Sends a message to stdout
+/// @brief Sends a message to stdout. All messages still queued are sent too,
+/// messages of higher-priority lanes first
 ///
 /// @param `id` The id of the slave who tries to send the message
 /// @param `buffer` The buffer in which the message to send will be stored
@@ -901,6 +2060,58 @@ void fip_slave_send_message(   //
     const fip_msg_t *message   //
 );
 
+/// @function `fip_slave_queue_message`
+/// @brief Queues a message for sending without sending it yet. The queued
+/// frames are sent through `fip_slave_flush_frame` or with the next message
+/// sent through `fip_slave_send_message`
+///
+/// @param `buffer` The buffer in which the message to send will be stored
+/// @param `message` The message which will be queued
+void fip_slave_queue_message(  //
+    char buffer[FIP_MSG_SIZE], //
+    const fip_msg_t *message   //
+);
+
+/// @function `fip_slave_flush_frame`
+/// @brief Sends the next queued frame to stdout, frames of higher-priority
+/// lanes first
+///
+/// @param `id` The id of the slave who tries to send the frame
+/// @return `bool` Whether there are frames left to send
+bool fip_slave_flush_frame(uint32_t id);
+
+/// @function `fip_slave_send_progress`
+/// @brief Tells the master that the current request is still being worked on,
+/// which extends the master's deadline for the response. Progress messages are
+/// sent on the control lane, ahead of all queued frames
+///
+/// @param `id` The id of the slave who sends the progress
+/// @param `done` How many units of the work are done
+/// @param `total` How many units of work there are in total
+void fip_slave_send_progress( //
+    uint32_t id,              //
+    const uint32_t done,      //
+    const uint32_t total      //
+);
+
+/// @function `fip_slave_write_deps`
+/// @brief Lists the given files as the dependencies of this module in the
+/// `.fip/cache/<module_name>.deps` file, which the master collects in its
+/// depfile. The file is replaced on every call, so the list must always be
+/// complete. The `.fip/cache` directory must exist
+///
+/// @param `id` The id of the slave who lists its dependencies
+/// @param `module_name` The name of the module
+/// @param `count` The number of dependencies
+/// @param `paths` The paths of all files the module parsed or compiled
+/// @return `bool` Whether the dependencies could be written
+bool fip_slave_write_deps(   //
+    const uint32_t id,       //
+    const char *module_name, //
+    const uint32_t count,    //
+    char *const *paths       //
+);
+
 /// @function `fip_slave_cleanup`
 /// @brief Cleans up the slave
 void fip_slave_cleanup();
@@ -934,6 +2145,13 @@ const char *fip_msg_type_str[] = {
     "FIP_MSG_TAG_PRESENT_RESPONSE",
     "FIP_MSG_TAG_NEXT_SYMBOL_REQUEST",
     "FIP_MSG_TAG_SYMBOL_RESPONSE",
+    "FIP_MSG_SUBSCRIBE_REQUEST",
+    "FIP_MSG_CHANGE_NOTIFICATION",
+    "FIP_MSG_USAGE_REQUEST",
+    "FIP_MSG_USAGE_RESPONSE",
+    "FIP_MSG_CLEANUP_REQUEST",
+    "FIP_MSG_CLEANUP_RESPONSE",
+    "FIP_MSG_PROGRESS",
     "FIP_MSG_KILL",
 };
 
@@ -954,6 +2172,18 @@ const char *fip_type_names[] = {
     "f64",
     "bool",
     "str",
+    "ullong",
+    "llong",
+    "usize",
+    "isize",
+    "ldouble",
+    "f16",
+    "u128",
+    "i128",
+    "c16",
+    "c32",
+    "ulong",
+    "long",
 };
 
 void fip_print(                      //
@@ -1002,7 +2232,8 @@ void fip_print(                      //
     // Linux/POSIX-specific time handling
     struct timespec ts;
     clock_gettime(0, &ts);
-    struct tm *tm_info = localtime(&ts.tv_sec);
+    struct tm tm_buf;
+    struct tm *tm_info = localtime_r(&ts.tv_sec, &tm_buf);
 
     // Extract date/time components
     year = tm_info->tm_year + 1900;
@@ -1018,12 +2249,13 @@ void fip_print(                      //
     microseconds = microseconds % 1000;
 #endif
 
-    // Buffer for the whole message to fit into
-    static char message[4096];
+    // Buffer for the whole message to fit into. Modules may print from several
+    // threads, so every thread has buffers of its own
+    static _Thread_local char message[4096];
     memset(message, 0, sizeof(message));
-    static char prefix[256];
+    static _Thread_local char prefix[256];
     memset(prefix, 0, sizeof(prefix));
-    static char timestamp[32];
+    static _Thread_local char timestamp[32];
     memset(timestamp, 0, sizeof(timestamp));
 
     // ANSI color constants
@@ -1095,194 +2327,75 @@ void fip_print(                      //
     fflush(stderr);
 }
 
+static const char *fip_sym_type_name(const fip_msg_symbol_type_e type) {
+#define FIP_SIG_CASE_NAME(kind, member, suffix, name, fields)                  \
+    case kind:                                                                 \
+        return name;
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_NAME)
+        case FIP_SYM_UNKNOWN:
+            break;
+    }
+#undef FIP_SIG_CASE_NAME
+    return "UNKNOWN";
+}
+
+// The print functions of all messages, generated from the message schema. A
+// set guard ends the message, just like it does on the wire
+#define FIP_PRINT_U8(m, f, arg)                                                \
+    fip_print(id, FIP_DEBUG, "  ." #f ": %u", (unsigned)message->u.m.f);
+#define FIP_PRINT_U32(m, f, arg)                                               \
+    fip_print(id, FIP_DEBUG, "  ." #f ": %u", (unsigned)message->u.m.f);
+#define FIP_PRINT_U64(m, f, arg)                                               \
+    fip_print(id, FIP_DEBUG, "  ." #f ": %016llx",                             \
+        (unsigned long long)message->u.m.f);
+#define FIP_PRINT_CHARS(m, f, arg)                                             \
+    fip_print(id, FIP_DEBUG, "  ." #f ": %.*s", (int)(arg), message->u.m.f);
+#define FIP_PRINT_STR(m, f, arg)                                               \
+    fip_print(id, FIP_DEBUG, "  ." #f ": %s", message->u.m.f);
+#define FIP_PRINT_PATHS(m, f, arg)                                             \
+    fip_print(id, FIP_DEBUG, "  ." #arg ": %u", (unsigned)message->u.m.arg);   \
+    for (uint16_t i = 0; i < message->u.m.arg; i++) {                          \
+        fip_print(id, FIP_DEBUG, "  ." #f "[%u]: %.*s", (unsigned)i,           \
+            FIP_PATH_SIZE, message->u.m.f + i * FIP_PATH_SIZE);                \
+    }
+#define FIP_PRINT_SYM(m, f, arg)                                               \
+    fip_print(id, FIP_DEBUG, "  ." #f ": %s",                                  \
+        fip_sym_type_name(message->u.m.f));
+#define FIP_PRINT_SIG(m, f, arg)                                               \
+    fip_print(id, FIP_DEBUG, "  ." #f ": {");                                  \
+    fip_print_sig(id, message->u.m.arg, &message->u.m.f);                      \
+    fip_print(id, FIP_DEBUG, "  }");
+#define FIP_PRINT_GUARD(m, f, arg)                                             \
+    FIP_PRINT_U8(m, f, arg)                                                    \
+    if (message->u.m.f) {                                                      \
+        return;                                                                \
+    }
+#define FIP_PRINT_FIELD(m, kind, f, arg) FIP_PRINT_##kind(m, f, arg)
+#define FIP_GEN_PRINT(type, m, FIELDS)                                         \
+    static void fip_print_##m(uint32_t id, const fip_msg_t *message) {         \
+        FIELDS(FIP_PRINT_FIELD, m)                                             \
+    }
+FIP_MSG_SCHEMA(FIP_GEN_PRINT)
+
 void fip_print_msg(uint32_t id, const fip_msg_t *message) {
+    if (message->type >= FIP_MSG_TYPE_COUNT) {
+        fip_print(id, FIP_DEBUG, "FIP_MSG_UNKNOWN: {}");
+        return;
+    }
+    fip_print(id, FIP_DEBUG, "%s: {", fip_msg_type_str[message->type]);
     switch (message->type) {
-        case FIP_MSG_UNKNOWN:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_UNKNOWN: {}");
-            break;
-        case FIP_MSG_CONNECT_REQUEST:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_CONNECT_REQUEST: {");
-            fip_print(id, FIP_DEBUG, "  .setup_ok: %d", //
-                message->u.con_req.setup_ok             //
-            );
-            fip_print(id, FIP_DEBUG, "  .version: %d.%d:%d", //
-                message->u.con_req.version.major,            //
-                message->u.con_req.version.minor,            //
-                message->u.con_req.version.patch             //
-            );
-            fip_print(id, FIP_DEBUG, "  .module_name: %s", //
-                message->u.con_req.module_name             //
-            );
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_SYMBOL_REQUEST:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_SYMBOL_REQUEST: {");
-            switch (message->u.sym_req.type) {
-                case FIP_SYM_UNKNOWN:
-                    fip_print(id, FIP_DEBUG, "  .type: UNKNOWN");
-                    break;
-                case FIP_SYM_FUNCTION:
-                    fip_print(id, FIP_DEBUG, "  .type: FUNCTION");
-                    fip_print(id, FIP_DEBUG, "  .signature: {");
-                    fip_print_sig_fn(id, &message->u.sym_req.sig.fn);
-                    fip_print(id, FIP_DEBUG, "  }");
-                    break;
-                case FIP_SYM_DATA:
-                    fip_print(id, FIP_DEBUG, "  .type: DATA");
-                    fip_print(id, FIP_DEBUG, "  .signature: TODO");
-                    break;
-                case FIP_SYM_ENUM:
-                    fip_print(id, FIP_DEBUG, "  .type: ENUM");
-                    fip_print(id, FIP_DEBUG, "  .signature: TODO");
-                    break;
-                case FIP_SYM_OPAQUE:
-                    fip_print(id, FIP_DEBUG, "  .type: OPAQUE");
-                    fip_print(id, FIP_DEBUG, "  .signature: TODO");
-                    break;
-            }
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_SYMBOL_RESPONSE:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_SYMBOL_RESPONSE: {");
-            fip_print(id, FIP_DEBUG, "  .found: %d", message->u.sym_res.found);
-            fip_print(id, FIP_DEBUG, "  .module_name: %s", //
-                message->u.sym_res.module_name             //
-            );
-            switch (message->u.sym_res.type) {
-                case FIP_SYM_UNKNOWN:
-                    fip_print(id, FIP_DEBUG, "  .type: UNKNOWN");
-                    break;
-                case FIP_SYM_FUNCTION:
-                    fip_print(id, FIP_DEBUG, "  .type: FUNCTION");
-                    fip_print(id, FIP_DEBUG, "  .signature: {");
-                    fip_print_sig_fn(id, &message->u.sym_res.sig.fn);
-                    fip_print(id, FIP_DEBUG, "  }");
-                    break;
-                case FIP_SYM_DATA:
-                    fip_print(id, FIP_DEBUG, "  .type: DATA");
-                    fip_print(id, FIP_DEBUG, "  .signature: {");
-                    fip_print_sig_data(id, &message->u.sym_res.sig.data);
-                    fip_print(id, FIP_DEBUG, "  }");
-                    break;
-                case FIP_SYM_ENUM:
-                    fip_print(id, FIP_DEBUG, "  .type: ENUM");
-                    fip_print(id, FIP_DEBUG, "  .signature: {");
-                    fip_print_sig_enum(id, &message->u.sym_res.sig.enum_t);
-                    fip_print(id, FIP_DEBUG, "  }");
-                    break;
-                case FIP_SYM_OPAQUE:
-                    fip_print(id, FIP_DEBUG, "  .type: OPAQUE");
-                    fip_print(id, FIP_DEBUG, "  .signature: {");
-                    fip_print_sig_opaque(id, &message->u.sym_res.sig.opaque);
-                    fip_print(id, FIP_DEBUG, "  }");
-                    break;
-            }
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_COMPILE_REQUEST:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_COMPILE_REQUEST: {");
-            fip_print(id, FIP_DEBUG, "  .target: {");
-            fip_print(id, FIP_DEBUG, "    .arch: %s", //
-                message->u.com_req.target.arch        //
-            );
-            fip_print(id, FIP_DEBUG, "    .sub: %s", //
-                message->u.com_req.target.sub        //
-            );
-            fip_print(id, FIP_DEBUG, "    .vendor: %s", //
-                message->u.com_req.target.vendor        //
-            );
-            fip_print(id, FIP_DEBUG, "    .sys: %s", //
-                message->u.com_req.target.sys        //
-            );
-            fip_print(id, FIP_DEBUG, "    .abi: %s", //
-                message->u.com_req.target.abi        //
-            );
-            fip_print(id, FIP_DEBUG, "  }");
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_OBJECT_RESPONSE:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_OBJECT_RESPONSE: {");
-            fip_print(id, FIP_DEBUG, "  .has_obj: %d", //
-                message->u.obj_res.has_obj             //
-            );
-            fip_print(id, FIP_DEBUG, "  .compilation_failed: %d", //
-                message->u.obj_res.compilation_failed             //
-            );
-            fip_print(id, FIP_DEBUG, "  .module_name: %s", //
-                message->u.obj_res.module_name             //
-            );
-            fip_print(id, FIP_DEBUG, "  .path_count: %d", //
-                message->u.obj_res.path_count             //
-            );
-            fip_print(id, FIP_DEBUG, "  .paths: %s", //
-                message->u.obj_res.paths             //
-            );
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_TAG_REQUEST:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_TAG_REQUEST: {");
-            fip_print(id, FIP_DEBUG, "  .tag: %s", message->u.tag_req.tag);
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_TAG_PRESENT_RESPONSE:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_TAG_PRESENT_RESPONSE: {");
-            fip_print(id, FIP_DEBUG, "  .is_present: %d", //
-                message->u.tag_pres_res.is_present        //
-            );
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_TAG_NEXT_SYMBOL_REQUEST:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_TAG_NEXT_SYMBOL_REQUEST: {}");
-            break;
-        case FIP_MSG_TAG_SYMBOL_RESPONSE:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_TAG_SYMBOL_RESPONSE: {");
-            fip_print(id, FIP_DEBUG, "  .is_empty: %d", //
-                message->u.tag_sym_res.is_empty         //
-            );
-            if (!message->u.tag_sym_res.is_empty) {
-                switch (message->u.tag_sym_res.type) {
-                    case FIP_SYM_UNKNOWN:
-                        fip_print(id, FIP_DEBUG, "  .type: UNKNOWN");
-                        break;
-                    case FIP_SYM_FUNCTION:
-                        fip_print(id, FIP_DEBUG, "  .type: FUNCTION");
-                        fip_print_sig_fn(id, &message->u.tag_sym_res.sig.fn);
-                        break;
-                    case FIP_SYM_DATA:
-                        fip_print(id, FIP_DEBUG, "  .type: DATA");
-                        fip_print_sig_data(                      //
-                            id, &message->u.tag_sym_res.sig.data //
-                        );
-                        break;
-                    case FIP_SYM_ENUM:
-                        fip_print(id, FIP_DEBUG, "  .type: ENUM");
-                        fip_print_sig_enum(                        //
-                            id, &message->u.tag_sym_res.sig.enum_t //
-                        );
-                        break;
-                    case FIP_SYM_OPAQUE:
-                        fip_print(id, FIP_DEBUG, "  .type: OPAQUE");
-                        fip_print_sig_opaque(                      //
-                            id, &message->u.tag_sym_res.sig.opaque //
-                        );
-                        break;
-                }
-            }
-            fip_print(id, FIP_DEBUG, "}");
-            break;
-        case FIP_MSG_KILL:
-            fip_print(id, FIP_DEBUG, "FIP_MSG_KILL: {");
-            switch (message->u.kill.reason) {
-                case FIP_KILL_FINISH:
-                    fip_print(id, FIP_DEBUG, "  .reason: FINISH");
-                    break;
-                case FIP_KILL_VERSION_MISMATCH:
-                    fip_print(id, FIP_DEBUG, "  .reason: VERSION_MISMATCH");
-                    break;
-            }
-            fip_print(id, FIP_DEBUG, "}");
+#define FIP_PRINT_CASE(type, m, FIELDS)                                        \
+    case type:                                                                 \
+        fip_print_##m(id, message);                                            \
+        break;
+        FIP_MSG_SCHEMA(FIP_PRINT_CASE)
+#undef FIP_PRINT_CASE
+        default:
+            // Messages without a payload
             break;
     }
+    fip_print(id, FIP_DEBUG, "}");
 }
 
 void fip_encode_type(          //
@@ -1451,169 +2564,216 @@ void fip_encode_sig_opaque(     //
     }
 }
 
-void fip_encode_msg(char buffer[FIP_MSG_SIZE], const fip_msg_t *message) {
-    // Clear the buffer
-    memset(buffer, 0, FIP_MSG_SIZE);
-    // The message always starts with the length of the message as a 4 byte
-    // uint32_teger and then the actual message follows. This is why the
-    // 'idx' starts at 4, since the first 4 bytes need to be filled with the
-    // size of the message itself
-    // The first character in the buffer is the message type
-    uint32_t idx = 4;
-    buffer[idx++] = message->type;
-    switch (message->type) {
-        case FIP_MSG_UNKNOWN:
-            // Sending unknown or faulty message
-            break;
-        case FIP_MSG_CONNECT_REQUEST:
-            // The connect request just puts the version info followed by the
-            // module name into the buffer and is done
-            buffer[idx++] = (bool)message->u.con_req.setup_ok;
-            buffer[idx++] = message->u.con_req.version.major;
-            buffer[idx++] = message->u.con_req.version.minor;
-            buffer[idx++] = message->u.con_req.version.patch;
-            memcpy(buffer + idx, message->u.con_req.module_name,
-                FIP_MAX_MODULE_NAME_LEN);
-            idx += FIP_MAX_MODULE_NAME_LEN;
+static uint32_t fip_size_type(const fip_type_t *type) {
+    // The type and its mutability
+    uint32_t size = 2;
+    switch (type->type) {
+        case FIP_TYPE_PRIMITIVE:
+            size += 1;
             break;
-        case FIP_MSG_SYMBOL_REQUEST:
-            buffer[idx++] = message->u.sym_req.type;
-            switch (message->u.sym_req.type) {
-                case FIP_SYM_UNKNOWN:
-                    break;
-                case FIP_SYM_FUNCTION:
-                    fip_encode_sig_fn(buffer, &idx, &message->u.sym_req.sig.fn);
-                    break;
-                case FIP_SYM_DATA:
-                    break;
-                case FIP_SYM_ENUM:
-                    break;
-                case FIP_SYM_OPAQUE:
-                    fip_encode_sig_opaque(             //
-                        buffer, &idx,                  //
-                        &message->u.sym_req.sig.opaque //
-                    );
-                    break;
-            }
+        case FIP_TYPE_PTR:
+            size += fip_size_type(type->u.ptr.base_type);
             break;
-        case FIP_MSG_SYMBOL_RESPONSE:
-            // We place all elements into the buffer one by one until we come to
-            // the union
-            buffer[idx++] = message->u.sym_res.found;
-            memcpy(buffer + idx, message->u.sym_res.module_name,
-                FIP_MAX_MODULE_NAME_LEN);
-            idx += FIP_MAX_MODULE_NAME_LEN;
-            buffer[idx++] = message->u.sym_res.type;
-            switch (message->u.sym_res.type) {
-                case FIP_SYM_UNKNOWN:
-                    break;
-                case FIP_SYM_FUNCTION:
-                    fip_encode_sig_fn(buffer, &idx, &message->u.sym_res.sig.fn);
-                    break;
-                case FIP_SYM_DATA:
-                    fip_encode_sig_data(                 //
-                        buffer, &idx,                    //
-                        &message->u.tag_sym_res.sig.data //
-                    );
-                    break;
-                case FIP_SYM_ENUM:
-                    fip_encode_sig_enum(               //
-                        buffer, &idx,                  //
-                        &message->u.sym_res.sig.enum_t //
-                    );
-                    break;
-                case FIP_SYM_OPAQUE:
-                    fip_encode_sig_opaque(             //
-                        buffer, &idx,                  //
-                        &message->u.sym_res.sig.opaque //
-                    );
-                    break;
+        case FIP_TYPE_STRUCT:
+            size += 2 + (uint8_t)strlen(type->u.struct_t.name);
+            for (uint8_t i = 0; i < type->u.struct_t.field_count; i++) {
+                size += fip_size_type(&type->u.struct_t.fields[i]);
             }
             break;
-        case FIP_MSG_COMPILE_REQUEST:
-            // The compile request places each 16 byte piece of it in the buffer
-            // directly
-            memcpy(buffer + idx, message->u.com_req.target.arch, 16);
-            idx += 16;
-            memcpy(buffer + idx, message->u.com_req.target.sub, 16);
-            idx += 16;
-            memcpy(buffer + idx, message->u.com_req.target.vendor, 16);
-            idx += 16;
-            memcpy(buffer + idx, message->u.com_req.target.sys, 16);
-            idx += 16;
-            memcpy(buffer + idx, message->u.com_req.target.abi, 16);
-            idx += 16;
+        case FIP_TYPE_RECURSIVE:
+            size += 1;
             break;
-        case FIP_MSG_OBJECT_RESPONSE: {
-            // The sizes of the buffers are known so we can put them into the
-            // buffer directly
-            buffer[idx++] = message->u.obj_res.has_obj;
-            buffer[idx++] = message->u.obj_res.compilation_failed;
-            memcpy(buffer + idx, message->u.obj_res.module_name,
-                FIP_MAX_MODULE_NAME_LEN);
-            idx += FIP_MAX_MODULE_NAME_LEN;
-            const uint8_t path_count = message->u.obj_res.path_count;
-            buffer[idx++] = path_count;
-            const uint32_t offset = FIP_PATH_SIZE * path_count;
-            memcpy(buffer + idx, message->u.obj_res.paths, offset);
-            idx += offset;
+        case FIP_TYPE_ENUM:
+            size += 4 + (uint8_t)strlen(type->u.enum_t.name);
+            size += sizeof(size_t) * type->u.enum_t.value_count;
             break;
-        }
-        case FIP_MSG_TAG_REQUEST: {
-            const uint8_t tag_len = strlen(message->u.tag_req.tag);
-            buffer[idx++] = tag_len;
-            memcpy(buffer + idx, message->u.tag_req.tag, tag_len);
-            idx += tag_len;
+        case FIP_TYPE_ARRAY:
+            size += sizeof(size_t) + fip_size_type(type->u.array.base_type);
             break;
-        }
-        case FIP_MSG_TAG_PRESENT_RESPONSE:
-            buffer[idx++] = message->u.tag_pres_res.is_present;
+        case FIP_TYPE_OPAQUE:
+            size += 1 + (uint8_t)strlen(type->u.opaque.name);
             break;
-        case FIP_MSG_TAG_NEXT_SYMBOL_REQUEST:
+    }
+    return size;
+}
+
+static uint32_t fip_size_sig_fn(const fip_sig_fn_t *sig) {
+    uint32_t size = 3 + (uint8_t)strlen(sig->name);
+    for (uint8_t i = 0; i < sig->args_len; i++) {
+        size += 2 + (uint8_t)strlen(sig->args[i].name);
+        size += fip_size_type(&sig->args[i].type);
+    }
+    for (uint8_t i = 0; i < sig->rets_len; i++) {
+        size += 1 + fip_size_type(&sig->rets[i]);
+    }
+    return size;
+}
+
+static uint32_t fip_size_sig_data(const fip_sig_data_t *sig) {
+    uint32_t size = 2 + (uint8_t)strlen(sig->name);
+    for (uint8_t i = 0; i < sig->value_count; i++) {
+        size += 1 + (uint8_t)strlen(sig->value_names[i]);
+        size += fip_size_type(&sig->value_types[i]);
+    }
+    return size;
+}
+
+static uint32_t fip_size_sig_enum(const fip_sig_enum_t *sig) {
+    uint32_t size = 3 + (uint8_t)strlen(sig->name);
+    for (uint8_t i = 0; i < sig->value_count; i++) {
+        size += 1 + (uint8_t)strlen(sig->tags[i]) + sizeof(size_t);
+    }
+    return size;
+}
+
+static uint32_t fip_size_sig_opaque(const fip_sig_opaque_t *sig) {
+    return 1 + (uint8_t)strlen(sig->name);
+}
+
+void fip_encode_sig(                  //
+    char buffer[FIP_MSG_SIZE],        //
+    uint32_t *idx,                    //
+    const fip_msg_symbol_type_e type, //
+    const fip_sig_u *sig              //
+) {
+#define FIP_SIG_CASE_ENCODE(kind, member, suffix, name, fields)                \
+    case kind:                                                                 \
+        fip_encode_sig_##suffix(buffer, idx, &sig->member);                    \
+        break;
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_ENCODE)
+        case FIP_SYM_UNKNOWN:
             break;
-        case FIP_MSG_TAG_SYMBOL_RESPONSE:
-            buffer[idx++] = message->u.tag_sym_res.is_empty;
-            if (!message->u.tag_sym_res.is_empty) {
-                // Only encode the content if it's not empty, to make the
-                // message to send smaller in the empty case
-                buffer[idx++] = message->u.tag_sym_res.type;
-                switch (message->u.tag_sym_res.type) {
-                    case FIP_SYM_UNKNOWN:
-                        break;
-                    case FIP_SYM_FUNCTION:
-                        fip_encode_sig_fn(                 //
-                            buffer, &idx,                  //
-                            &message->u.tag_sym_res.sig.fn //
-                        );
-                        break;
-                    case FIP_SYM_DATA:
-                        fip_encode_sig_data(                 //
-                            buffer, &idx,                    //
-                            &message->u.tag_sym_res.sig.data //
-                        );
-                        break;
-                    case FIP_SYM_ENUM:
-                        fip_encode_sig_enum(                   //
-                            buffer, &idx,                      //
-                            &message->u.tag_sym_res.sig.enum_t //
-                        );
-                        break;
-                    case FIP_SYM_OPAQUE:
-                        fip_encode_sig_opaque(                 //
-                            buffer, &idx,                      //
-                            &message->u.tag_sym_res.sig.opaque //
-                        );
-                        break;
-                }
-            }
+    }
+#undef FIP_SIG_CASE_ENCODE
+}
+
+uint32_t fip_size_sig(const fip_msg_symbol_type_e type, const fip_sig_u *sig) {
+#define FIP_SIG_CASE_SIZE(kind, member, suffix, name, fields)                  \
+    case kind:                                                                 \
+        return fip_size_sig_##suffix(&sig->member);
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_SIZE)
+        case FIP_SYM_UNKNOWN:
             break;
-        case FIP_MSG_KILL:
-            // The kill message just adds why the kill happens
-            buffer[idx++] = message->u.kill.reason;
+    }
+#undef FIP_SIG_CASE_SIZE
+    return 0;
+}
+
+// The size and encode functions of all messages, generated from the message
+// schema. Both return early at a set guard, so they always agree on the size
+#define FIP_SIZE_U8(m, f, arg) size += 1;
+#define FIP_SIZE_U32(m, f, arg) size += sizeof(uint32_t);
+#define FIP_SIZE_U64(m, f, arg) size += sizeof(uint64_t);
+#define FIP_SIZE_CHARS(m, f, arg) size += (arg);
+#define FIP_SIZE_STR(m, f, arg) size += 1 + (uint8_t)strlen(message->u.m.f);
+#define FIP_SIZE_PATHS(m, f, arg)                                              \
+    size += sizeof(uint16_t) + FIP_PATH_SIZE * (uint32_t)message->u.m.arg;
+#define FIP_SIZE_SYM(m, f, arg) size += 1;
+#define FIP_SIZE_SIG(m, f, arg)                                                \
+    size += fip_size_sig(message->u.m.arg, &message->u.m.f);
+#define FIP_SIZE_GUARD(m, f, arg)                                              \
+    size += 1;                                                                 \
+    if (message->u.m.f) {                                                      \
+        return size;                                                           \
+    }
+#define FIP_SIZE_FIELD(m, kind, f, arg) FIP_SIZE_##kind(m, f, arg)
+#define FIP_GEN_SIZE(type, m, FIELDS)                                          \
+    static uint32_t fip_size_##m(const fip_msg_t *message) {                   \
+        uint32_t size = 0;                                                     \
+        (void)message;                                                         \
+        FIELDS(FIP_SIZE_FIELD, m)                                              \
+        return size;                                                           \
+    }
+FIP_MSG_SCHEMA(FIP_GEN_SIZE)
+
+#define FIP_ENCODE_U8(m, f, arg) buffer[idx++] = (char)message->u.m.f;
+#define FIP_ENCODE_U32(m, f, arg)                                              \
+    memcpy(buffer + idx, &message->u.m.f, sizeof(uint32_t));                   \
+    idx += sizeof(uint32_t);
+#define FIP_ENCODE_U64(m, f, arg)                                              \
+    memcpy(buffer + idx, &message->u.m.f, sizeof(uint64_t));                   \
+    idx += sizeof(uint64_t);
+#define FIP_ENCODE_CHARS(m, f, arg)                                            \
+    memcpy(buffer + idx, message->u.m.f, (arg));                               \
+    idx += (arg);
+#define FIP_ENCODE_STR(m, f, arg)                                              \
+    {                                                                          \
+        const uint8_t len = (uint8_t)strlen(message->u.m.f);                   \
+        buffer[idx++] = (char)len;                                             \
+        memcpy(buffer + idx, message->u.m.f, len);                             \
+        idx += len;                                                            \
+    }
+#define FIP_ENCODE_PATHS(m, f, arg)                                            \
+    memcpy(buffer + idx, &message->u.m.arg, sizeof(uint16_t));                 \
+    idx += sizeof(uint16_t);                                                   \
+    memcpy(buffer + idx, message->u.m.f, FIP_PATH_SIZE * message->u.m.arg);    \
+    idx += FIP_PATH_SIZE * message->u.m.arg;
+#define FIP_ENCODE_SYM(m, f, arg) buffer[idx++] = (char)message->u.m.f;
+#define FIP_ENCODE_SIG(m, f, arg)                                              \
+    fip_encode_sig(buffer, &idx, message->u.m.arg, &message->u.m.f);
+#define FIP_ENCODE_GUARD(m, f, arg)                                            \
+    buffer[idx++] = (char)message->u.m.f;                                      \
+    if (message->u.m.f) {                                                      \
+        return;                                                                \
+    }
+#define FIP_ENCODE_FIELD(m, kind, f, arg) FIP_ENCODE_##kind(m, f, arg)
+#define FIP_GEN_ENCODE(type, m, FIELDS)                                        \
+    static void fip_encode_##m(                                                \
+        char buffer[FIP_MSG_SIZE], uint32_t idx, const fip_msg_t *message) {   \
+        FIELDS(FIP_ENCODE_FIELD, m)                                            \
+    }
+FIP_MSG_SCHEMA(FIP_GEN_ENCODE)
+
+static uint32_t fip_msg_size(const fip_msg_t *message) {
+    // The message type always comes first
+    uint32_t size = 1;
+    switch (message->type) {
+#define FIP_SIZE_CASE(type, m, FIELDS)                                         \
+    case type:                                                                 \
+        size += fip_size_##m(message);                                         \
+        break;
+        FIP_MSG_SCHEMA(FIP_SIZE_CASE)
+#undef FIP_SIZE_CASE
+        default:
+            // Messages without a payload
             break;
     }
-    uint32_t msg_len = idx - 4;
+    return size;
+}
+
+void fip_encode_msg(char buffer[FIP_MSG_SIZE], const fip_msg_t *message) {
+    // The message always starts with the length of the message as a 4 byte
+    // integer and then the actual message follows, starting with its type.
+    // Because the length is known before anything is written, only the bytes
+    // of the message itself are touched. A message which would not fit into
+    // the buffer is sent as an unknown message instead of overflowing it
+    uint32_t msg_len = fip_msg_size(message);
+    if (msg_len > FIP_MSG_SIZE - 4) {
+        fip_print(0, FIP_ERROR,
+            "%s of %u bytes exceeds the message size of %u bytes, it is sent "
+            "as FIP_MSG_UNKNOWN instead",
+            fip_msg_type_str[message->type], msg_len, FIP_MSG_SIZE - 4);
+        msg_len = 1;
+        memcpy(&buffer[0], &msg_len, sizeof(uint32_t));
+        buffer[4] = FIP_MSG_UNKNOWN;
+        return;
+    }
     memcpy(&buffer[0], &msg_len, sizeof(uint32_t));
+    buffer[4] = message->type;
+    FIP_PROBE2(encode, message->type, msg_len);
+    switch (message->type) {
+#define FIP_ENCODE_CASE(type, m, FIELDS)                                       \
+    case type:                                                                 \
+        fip_encode_##m(buffer, 5, message);                                    \
+        break;
+        FIP_MSG_SCHEMA(FIP_ENCODE_CASE)
+#undef FIP_ENCODE_CASE
+        default:
+            // Messages without a payload
+            break;
+    }
 }
 
 void fip_decode_type(                //
@@ -1813,162 +2973,82 @@ void fip_decode_sig_opaque(          //
     }
 }
 
+void fip_decode_sig(                  //
+    const char buffer[FIP_MSG_SIZE],  //
+    uint32_t *idx,                    //
+    const fip_msg_symbol_type_e type, //
+    fip_sig_u *sig                    //
+) {
+#define FIP_SIG_CASE_DECODE(kind, member, suffix, name, fields)                \
+    case kind:                                                                 \
+        fip_decode_sig_##suffix(buffer, idx, &sig->member);                    \
+        break;
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_DECODE)
+        case FIP_SYM_UNKNOWN:
+            break;
+    }
+#undef FIP_SIG_CASE_DECODE
+}
+
+// The decode functions of all messages, generated from the message schema.
+// Strings are cut off at the size of their field
+#define FIP_DECODE_U8(m, f, arg) message->u.m.f = (uint8_t)buffer[idx++];
+#define FIP_DECODE_U32(m, f, arg)                                              \
+    memcpy(&message->u.m.f, buffer + idx, sizeof(uint32_t));                   \
+    idx += sizeof(uint32_t);
+#define FIP_DECODE_U64(m, f, arg)                                              \
+    memcpy(&message->u.m.f, buffer + idx, sizeof(uint64_t));                   \
+    idx += sizeof(uint64_t);
+#define FIP_DECODE_CHARS(m, f, arg)                                            \
+    memcpy(message->u.m.f, buffer + idx, (arg));                               \
+    idx += (arg);
+#define FIP_DECODE_STR(m, f, arg)                                              \
+    {                                                                          \
+        const uint8_t len = (uint8_t)buffer[idx++];                            \
+        const size_t max_len = sizeof(message->u.m.f) - 1;                     \
+        memcpy(message->u.m.f, buffer + idx, len < max_len ? len : max_len);   \
+        idx += len;                                                            \
+    }
+#define FIP_DECODE_PATHS(m, f, arg)                                            \
+    memcpy(&message->u.m.arg, buffer + idx, sizeof(uint16_t));                 \
+    idx += sizeof(uint16_t);                                                   \
+    if (message->u.m.arg > FIP_PATHS_SIZE / FIP_PATH_SIZE) {                   \
+        message->u.m.arg = FIP_PATHS_SIZE / FIP_PATH_SIZE;                     \
+    }                                                                          \
+    memcpy(message->u.m.f, buffer + idx, FIP_PATH_SIZE * message->u.m.arg);    \
+    idx += FIP_PATH_SIZE * message->u.m.arg;
+#define FIP_DECODE_SYM(m, f, arg) message->u.m.f = (uint8_t)buffer[idx++];
+#define FIP_DECODE_SIG(m, f, arg)                                              \
+    fip_decode_sig(buffer, &idx, message->u.m.arg, &message->u.m.f);
+#define FIP_DECODE_GUARD(m, f, arg)                                            \
+    message->u.m.f = (uint8_t)buffer[idx++];                                   \
+    if (message->u.m.f) {                                                      \
+        return;                                                                \
+    }
+#define FIP_DECODE_FIELD(m, kind, f, arg) FIP_DECODE_##kind(m, f, arg)
+#define FIP_GEN_DECODE(type, m, FIELDS)                                        \
+    static void fip_decode_##m(                                                \
+        const char buffer[FIP_MSG_SIZE], uint32_t idx, fip_msg_t *message) {   \
+        FIELDS(FIP_DECODE_FIELD, m)                                            \
+    }
+FIP_MSG_SCHEMA(FIP_GEN_DECODE)
+
 void fip_decode_msg(const char buffer[FIP_MSG_SIZE], fip_msg_t *message) {
     memset(message, 0, sizeof(fip_msg_t));
-    uint32_t idx = 0;
-    message->type = (fip_msg_type_e)buffer[idx++];
+    message->type = (fip_msg_type_e)buffer[0];
     switch (message->type) {
-        case FIP_MSG_UNKNOWN:
-            // Received unknown or faulty message
-            break;
-        case FIP_MSG_CONNECT_REQUEST:
-            // The connect request just puts the versions into the buffer one by
-            // one and is done
-            message->u.con_req.setup_ok = (bool)buffer[idx++];
-            message->u.con_req.version.major = buffer[idx++];
-            message->u.con_req.version.minor = buffer[idx++];
-            message->u.con_req.version.patch = buffer[idx++];
-            memcpy(message->u.con_req.module_name, buffer + idx,
-                FIP_MAX_MODULE_NAME_LEN);
-            break;
-        case FIP_MSG_SYMBOL_REQUEST:
-            message->u.sym_req.type = (fip_msg_symbol_type_e)buffer[idx++];
-            switch (message->u.sym_req.type) {
-                case FIP_SYM_UNKNOWN:
-                    break;
-                case FIP_SYM_FUNCTION:
-                    fip_decode_sig_fn(buffer, &idx, &message->u.sym_req.sig.fn);
-                    break;
-                case FIP_SYM_DATA:
-                    fip_decode_sig_data(                           //
-                        buffer, &idx, &message->u.sym_req.sig.data //
-                    );
-                    break;
-                case FIP_SYM_ENUM:
-                    fip_decode_sig_enum(                             //
-                        buffer, &idx, &message->u.sym_req.sig.enum_t //
-                    );
-                    break;
-                case FIP_SYM_OPAQUE:
-                    fip_decode_sig_opaque(                           //
-                        buffer, &idx, &message->u.sym_req.sig.opaque //
-                    );
-                    break;
-            }
-            break;
-        case FIP_MSG_SYMBOL_RESPONSE:
-            // We place all elements into the buffer one by one until we come to
-            // the union
-            message->u.sym_res.found = (bool)buffer[idx++];
-            memcpy(message->u.sym_res.module_name, buffer + idx,
-                FIP_MAX_MODULE_NAME_LEN);
-            idx += FIP_MAX_MODULE_NAME_LEN;
-            message->u.sym_res.type = (fip_msg_symbol_type_e)buffer[idx++];
-            switch (message->u.sym_res.type) {
-                case FIP_SYM_UNKNOWN:
-                    break;
-                case FIP_SYM_FUNCTION:
-                    fip_decode_sig_fn(                           //
-                        buffer, &idx, &message->u.sym_res.sig.fn //
-                    );
-                    break;
-                case FIP_SYM_DATA:
-                    fip_decode_sig_data(                           //
-                        buffer, &idx, &message->u.sym_res.sig.data //
-                    );
-                    break;
-                case FIP_SYM_ENUM:
-                    fip_decode_sig_enum(                             //
-                        buffer, &idx, &message->u.sym_res.sig.enum_t //
-                    );
-                    break;
-                case FIP_SYM_OPAQUE:
-                    fip_decode_sig_opaque(                           //
-                        buffer, &idx, &message->u.sym_res.sig.opaque //
-                    );
-                    break;
-            }
-            break;
-        case FIP_MSG_COMPILE_REQUEST:
-            // The compile request places each 16 byte piece of it in the buffer
-            // directly
-            memcpy(message->u.com_req.target.arch, buffer + idx, 16);
-            idx += 16;
-            memcpy(message->u.com_req.target.sub, buffer + idx, 16);
-            idx += 16;
-            memcpy(message->u.com_req.target.vendor, buffer + idx, 16);
-            idx += 16;
-            memcpy(message->u.com_req.target.sys, buffer + idx, 16);
-            idx += 16;
-            memcpy(message->u.com_req.target.abi, buffer + idx, 16);
-            break;
-        case FIP_MSG_OBJECT_RESPONSE: {
-            // The sizes of the buffers are known so we can read them from the
-            // buffer directly
-            message->u.obj_res.has_obj = (bool)buffer[idx++];
-            message->u.obj_res.compilation_failed = (bool)buffer[idx++];
-            memcpy(message->u.obj_res.module_name, buffer + idx,
-                FIP_MAX_MODULE_NAME_LEN);
-            idx += FIP_MAX_MODULE_NAME_LEN;
-            const uint8_t path_count = buffer[idx++];
-            message->u.obj_res.path_count = path_count;
-            const uint32_t offset = FIP_PATH_SIZE * path_count;
-            memcpy(message->u.obj_res.paths, buffer + idx, offset);
-            break;
-        }
-        case FIP_MSG_TAG_REQUEST: {
-            const uint8_t tag_len = buffer[idx++];
-            memcpy(message->u.tag_req.tag, buffer + idx, tag_len);
-            idx += tag_len;
-            break;
-        }
-        case FIP_MSG_TAG_PRESENT_RESPONSE:
-            message->u.tag_pres_res.is_present = buffer[idx++];
-            break;
-        case FIP_MSG_TAG_NEXT_SYMBOL_REQUEST:
-            break;
-        case FIP_MSG_TAG_SYMBOL_RESPONSE:
-            message->u.tag_sym_res.is_empty = buffer[idx++];
-            if (!message->u.tag_sym_res.is_empty) {
-                // Only decode the content if it's not empty, to make the
-                // message to send smaller in the empty case
-                message->u.tag_sym_res.type =
-                    (fip_msg_symbol_type_e)buffer[idx++];
-                switch (message->u.tag_sym_res.type) {
-                    case FIP_SYM_UNKNOWN:
-                        break;
-                    case FIP_SYM_FUNCTION:
-                        fip_decode_sig_fn(                 //
-                            buffer, &idx,                  //
-                            &message->u.tag_sym_res.sig.fn //
-                        );
-                        break;
-                    case FIP_SYM_DATA:
-                        fip_decode_sig_data(                 //
-                            buffer, &idx,                    //
-                            &message->u.tag_sym_res.sig.data //
-                        );
-                        break;
-                    case FIP_SYM_ENUM:
-                        fip_decode_sig_enum(                   //
-                            buffer, &idx,                      //
-                            &message->u.tag_sym_res.sig.enum_t //
-                        );
-                        break;
-                    case FIP_SYM_OPAQUE:
-                        fip_decode_sig_opaque(                 //
-                            buffer, &idx,                      //
-                            &message->u.tag_sym_res.sig.opaque //
-                        );
-                        break;
-                }
-            }
-            break;
-        case FIP_MSG_KILL:
-            // The kill message just adds why the kill happens
-            message->u.kill.reason = (fip_msg_kill_reason_e)buffer[idx++];
+#define FIP_DECODE_CASE(type, m, FIELDS)                                       \
+    case type:                                                                 \
+        fip_decode_##m(buffer, 1, message);                                    \
+        break;
+        FIP_MSG_SCHEMA(FIP_DECODE_CASE)
+#undef FIP_DECODE_CASE
+        default:
+            // Messages without a payload or unknown and faulty messages
             break;
     }
+    FIP_PROBE1(decode, message->type);
 }
 
 void fip_free_type(fip_type_t *type) {
@@ -2001,257 +3081,127 @@ void fip_free_type(fip_type_t *type) {
     }
 }
 
+static void fip_free_sig_fn(fip_sig_fn_t *sig) {
+    memset(sig->name, 0, sizeof(sig->name));
+    if (sig->args_len > 0) {
+        for (uint8_t i = 0; i < sig->args_len; i++) {
+            fip_free_type(&sig->args[i].type);
+        }
+        free(sig->args);
+    }
+    sig->args = NULL;
+    sig->args_len = 0;
+    if (sig->rets_len > 0) {
+        for (uint8_t i = 0; i < sig->rets_len; i++) {
+            fip_free_type(&sig->rets[i]);
+        }
+        free(sig->rets);
+    }
+    sig->rets = NULL;
+    sig->rets_len = 0;
+}
+
+static void fip_free_sig_data(fip_sig_data_t *sig) {
+    memset(sig->name, 0, sizeof(sig->name));
+    if (sig->value_count > 0) {
+        for (uint8_t i = 0; i < sig->value_count; i++) {
+            free(sig->value_names[i]);
+            fip_free_type(&sig->value_types[i]);
+        }
+        free(sig->value_names);
+        free(sig->value_types);
+    }
+    sig->value_names = NULL;
+    sig->value_types = NULL;
+    sig->value_count = 0;
+}
+
+static void fip_free_sig_enum(fip_sig_enum_t *sig) {
+    memset(sig->name, 0, sizeof(sig->name));
+    sig->type = FIP_VOID;
+    if (sig->value_count > 0) {
+        for (uint8_t i = 0; i < sig->value_count; i++) {
+            free(sig->tags[i]);
+        }
+        free(sig->tags);
+        free(sig->values);
+    }
+    sig->tags = NULL;
+    sig->values = NULL;
+    sig->value_count = 0;
+}
+
+static void fip_free_sig_opaque(fip_sig_opaque_t *sig) {
+    memset(sig->name, 0, sizeof(sig->name));
+}
+
+void fip_free_sig(const fip_msg_symbol_type_e type, fip_sig_u *sig) {
+#define FIP_SIG_CASE_FREE(kind, member, suffix, name, fields)                  \
+    case kind:                                                                 \
+        fip_free_sig_##suffix(&sig->member);                                   \
+        break;
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_FREE)
+        case FIP_SYM_UNKNOWN:
+            // Do nothing on already freed / unknown symbol
+            break;
+    }
+#undef FIP_SIG_CASE_FREE
+}
+
+// The free functions of all messages, generated from the message schema. The
+// signature resets its symbol type, so freeing a message twice is harmless
+#define FIP_FREE_U8(m, f, arg) message->u.m.f = 0;
+#define FIP_FREE_U32(m, f, arg) message->u.m.f = 0;
+#define FIP_FREE_U64(m, f, arg) message->u.m.f = 0;
+#define FIP_FREE_CHARS(m, f, arg) memset(message->u.m.f, 0, (arg));
+#define FIP_FREE_STR(m, f, arg)                                                \
+    memset(message->u.m.f, 0, sizeof(message->u.m.f));
+#define FIP_FREE_PATHS(m, f, arg)                                              \
+    memset(message->u.m.f, 0, FIP_PATH_SIZE * message->u.m.arg);               \
+    message->u.m.arg = 0;
+#define FIP_FREE_SYM(m, f, arg)
+#define FIP_FREE_SIG(m, f, arg)                                                \
+    fip_free_sig(message->u.m.arg, &message->u.m.f);                           \
+    message->u.m.arg = FIP_SYM_UNKNOWN;
+#define FIP_FREE_GUARD(m, f, arg) message->u.m.f = false;
+#define FIP_FREE_FIELD(m, kind, f, arg) FIP_FREE_##kind(m, f, arg)
+#define FIP_GEN_FREE(type, m, FIELDS)                                          \
+    static void fip_free_##m(fip_msg_t *message) {                             \
+        FIELDS(FIP_FREE_FIELD, m)                                              \
+    }
+FIP_MSG_SCHEMA(FIP_GEN_FREE)
+
 void fip_free_msg(fip_msg_t *message) {
     const fip_msg_type_e msg_type = message->type;
     message->type = FIP_MSG_UNKNOWN;
     switch (msg_type) {
-        case FIP_MSG_UNKNOWN:
-            return;
-        case FIP_MSG_CONNECT_REQUEST:
-            message->u.con_req.version.major = 0;
-            message->u.con_req.version.minor = 0;
-            message->u.con_req.version.patch = 0;
-            break;
-        case FIP_MSG_SYMBOL_REQUEST:
-            switch (message->u.sym_req.type) {
-                case FIP_SYM_UNKNOWN:
-                    // Do nothing on already freed / unknwon symbol
-                    break;
-                case FIP_SYM_FUNCTION: {
-                    message->u.sym_req.type = FIP_SYM_UNKNOWN;
-                    memset(                                    //
-                        message->u.sym_req.sig.fn.name, 0,     //
-                        sizeof(message->u.sym_req.sig.fn.name) //
-                    );
-                    uint8_t args_len = message->u.sym_req.sig.fn.args_len;
-                    if (args_len > 0) {
-                        for (uint8_t i = 0; i < args_len; i++) {
-                            fip_free_type(                              //
-                                &message->u.sym_req.sig.fn.args[i].type //
-                            );
-                        }
-                        free(message->u.sym_req.sig.fn.args);
-                    }
-                    message->u.sym_req.sig.fn.args_len = 0;
-                    uint8_t rets_len = message->u.sym_req.sig.fn.rets_len;
-                    if (rets_len > 0) {
-                        for (uint8_t i = 0; i < rets_len; i++) {
-                            fip_free_type(&message->u.sym_req.sig.fn.rets[i]);
-                        }
-                        free(message->u.sym_req.sig.fn.rets);
-                    }
-                    message->u.sym_req.sig.fn.rets_len = 0;
-                    break;
-                }
-                case FIP_SYM_DATA: {
-                    message->u.sym_req.type = FIP_SYM_UNKNOWN;
-                    memset(message->u.sym_req.sig.data.name, 0,
-                        sizeof(message->u.sym_req.sig.data.name));
-                    uint8_t data_val_cnt =
-                        message->u.sym_req.sig.data.value_count;
-                    if (data_val_cnt > 0) {
-                        for (uint8_t i = 0; i < data_val_cnt; i++) {
-                            free(message->u.sym_req.sig.data.value_names[i]);
-                        }
-                        free(message->u.sym_req.sig.data.value_names);
-                        for (uint8_t i = 0; i < data_val_cnt; i++) {
-                            fip_free_type(
-                                &message->u.sym_req.sig.data.value_types[i]);
-                        }
-                        free(message->u.sym_req.sig.data.value_types);
-                    }
-                    message->u.sym_req.sig.data.value_count = 0;
-                    break;
-                }
-                case FIP_SYM_ENUM: {
-                    message->u.sym_req.type = FIP_SYM_UNKNOWN;
-                    memset(message->u.sym_req.sig.enum_t.name, 0,
-                        sizeof(message->u.sym_req.sig.enum_t.name));
-                    message->u.sym_req.sig.enum_t.type = FIP_VOID;
-                    uint8_t enum_val_cnt =
-                        message->u.sym_req.sig.enum_t.value_count;
-                    if (enum_val_cnt > 0) {
-                        for (uint8_t i = 0; i < enum_val_cnt; i++) {
-                            free(message->u.sym_req.sig.enum_t.tags[i]);
-                        }
-                        free(message->u.sym_req.sig.enum_t.tags);
-                        free(message->u.sym_req.sig.enum_t.values);
-                    }
-                    message->u.sym_req.sig.enum_t.value_count = 0;
-                    break;
-                }
-                case FIP_SYM_OPAQUE: {
-                    message->u.sym_req.type = FIP_SYM_UNKNOWN;
-                    memset(message->u.sym_req.sig.opaque.name, 0,
-                        sizeof(message->u.sym_req.sig.opaque.name));
-                    break;
-                }
-            }
-            break;
-        case FIP_MSG_SYMBOL_RESPONSE:
-            message->u.sym_res.found = false;
-            memset(message->u.sym_res.module_name, 0, FIP_MAX_MODULE_NAME_LEN);
-            switch (message->u.sym_res.type) {
-                case FIP_SYM_UNKNOWN:
-                    // Do nothing on already freed / unknwon symbol
-                    break;
-                case FIP_SYM_FUNCTION: {
-                    message->u.sym_res.type = FIP_SYM_UNKNOWN;
-                    memset(                                    //
-                        message->u.sym_res.sig.fn.name, 0,     //
-                        sizeof(message->u.sym_res.sig.fn.name) //
-                    );
-                    uint8_t args_len = message->u.sym_res.sig.fn.args_len;
-                    if (args_len > 0) {
-                        for (uint8_t i = 0; i < args_len; i++) {
-                            fip_free_type(                              //
-                                &message->u.sym_res.sig.fn.args[i].type //
-                            );
-                        }
-                        free(message->u.sym_res.sig.fn.args);
-                    }
-                    message->u.sym_res.sig.fn.args_len = 0;
-                    uint8_t rets_len = message->u.sym_res.sig.fn.rets_len;
-                    if (message->u.sym_res.sig.fn.rets_len > 0) {
-                        for (uint8_t i = 0; i < rets_len; i++) {
-                            fip_free_type(&message->u.sym_res.sig.fn.rets[i]);
-                        }
-                        free(message->u.sym_res.sig.fn.rets);
-                    }
-                    message->u.sym_res.sig.fn.rets_len = 0;
-                    break;
-                }
-                case FIP_SYM_DATA: {
-                    message->u.sym_res.type = FIP_SYM_UNKNOWN;
-                    memset(message->u.sym_res.sig.data.name, 0,
-                        sizeof(message->u.sym_res.sig.data.name));
-                    uint8_t data_val_cnt =
-                        message->u.sym_res.sig.data.value_count;
-                    if (data_val_cnt > 0) {
-                        for (uint8_t i = 0; i < data_val_cnt; i++) {
-                            free(message->u.sym_res.sig.data.value_names[i]);
-                        }
-                        free(message->u.sym_res.sig.data.value_names);
-                        for (uint8_t i = 0; i < data_val_cnt; i++) {
-                            fip_free_type(
-                                &message->u.sym_res.sig.data.value_types[i]);
-                        }
-                        free(message->u.sym_res.sig.data.value_types);
-                    }
-                    message->u.sym_res.sig.data.value_count = 0;
-                    break;
-                }
-                case FIP_SYM_ENUM: {
-                    message->u.sym_res.type = FIP_SYM_UNKNOWN;
-                    memset(message->u.sym_res.sig.enum_t.name, 0,
-                        sizeof(message->u.sym_res.sig.enum_t.name));
-                    message->u.sym_res.sig.enum_t.type = FIP_VOID;
-                    uint8_t enum_val_cnt =
-                        message->u.sym_res.sig.enum_t.value_count;
-                    if (enum_val_cnt > 0) {
-                        for (uint8_t i = 0; i < enum_val_cnt; i++) {
-                            free(message->u.sym_res.sig.enum_t.tags[i]);
-                        }
-                        free(message->u.sym_res.sig.enum_t.tags);
-                        free(message->u.sym_res.sig.enum_t.values);
-                    }
-                    message->u.sym_res.sig.enum_t.value_count = 0;
-                    break;
-                }
-                case FIP_SYM_OPAQUE: {
-                    message->u.sym_res.type = FIP_SYM_UNKNOWN;
-                    memset(message->u.sym_res.sig.opaque.name, 0,
-                        sizeof(message->u.sym_res.sig.opaque.name));
-                    break;
-                }
-            }
-            break;
-        case FIP_MSG_COMPILE_REQUEST:
-            memset(message->u.com_req.target.arch, 0, 16);
-            memset(message->u.com_req.target.sub, 0, 16);
-            memset(message->u.com_req.target.vendor, 0, 16);
-            memset(message->u.com_req.target.sys, 0, 16);
-            memset(message->u.com_req.target.abi, 0, 16);
-            break;
-        case FIP_MSG_OBJECT_RESPONSE:
-            memset(message->u.obj_res.module_name, 0, FIP_MAX_MODULE_NAME_LEN);
-            memset(message->u.obj_res.paths, 0, FIP_PATHS_SIZE);
-            break;
-        case FIP_MSG_TAG_REQUEST:
-            memset(message->u.tag_req.tag, 0, sizeof(message->u.tag_req.tag));
-            break;
-        case FIP_MSG_TAG_PRESENT_RESPONSE:
-            break;
-        case FIP_MSG_TAG_NEXT_SYMBOL_REQUEST:
+#define FIP_FREE_CASE(type, m, FIELDS)                                         \
+    case type:                                                                 \
+        fip_free_##m(message);                                                 \
+        break;
+        FIP_MSG_SCHEMA(FIP_FREE_CASE)
+#undef FIP_FREE_CASE
+        default:
+            // Messages without a payload
             break;
-        case FIP_MSG_TAG_SYMBOL_RESPONSE:
-            message->u.tag_sym_res.is_empty = false;
-            switch (message->u.tag_sym_res.type) {
-                case FIP_SYM_UNKNOWN:
-                    break;
+    }
+}
 
-                case FIP_SYM_FUNCTION: {
-                    fip_sig_fn_t *fn = &message->u.tag_sym_res.sig.fn;
-                    memset(fn->name, 0, sizeof(fn->name));
-                    if (fn->args_len > 0) {
-                        for (uint8_t i = 0; i < fn->args_len; i++) {
-                            fip_free_type(&fn->args[i].type);
-                        }
-                        free(fn->args);
-                    }
-                    fn->args_len = 0;
-                    if (fn->rets_len > 0) {
-                        for (uint8_t i = 0; i < fn->rets_len; i++) {
-                            fip_free_type(&fn->rets[i]);
-                        }
-                        free(fn->rets);
-                    }
-                    fn->rets_len = 0;
-                    break;
-                }
-                case FIP_SYM_DATA: {
-                    fip_sig_data_t *data = &message->u.tag_sym_res.sig.data;
-                    memset(data->name, 0, sizeof(data->name));
-                    if (data->value_count > 0) {
-                        for (uint8_t i = 0; i < data->value_count; i++) {
-                            free(data->value_names[i]);
-                        }
-                        free(data->value_names);
-                        for (uint8_t i = 0; i < data->value_count; i++) {
-                            fip_free_type(&data->value_types[i]);
-                        }
-                        free(data->value_types);
-                    }
-                    data->value_count = 0;
-                    break;
-                }
-                case FIP_SYM_ENUM: {
-                    fip_sig_enum_t *enum_t = &message->u.tag_sym_res.sig.enum_t;
-                    memset(enum_t->name, 0, sizeof(enum_t->name));
-                    enum_t->type = FIP_VOID;
-                    if (enum_t->value_count > 0) {
-                        for (uint8_t i = 0; i < enum_t->value_count; i++) {
-                            free(enum_t->tags[i]);
-                        }
-                        free(enum_t->tags);
-                        free(enum_t->values);
-                    }
-                    enum_t->value_count = 0;
-                    break;
-                }
-                case FIP_SYM_OPAQUE: {
-                    fip_sig_opaque_t *opaque =
-                        &message->u.tag_sym_res.sig.opaque;
-                    memset(opaque->name, 0, sizeof(opaque->name));
-                    break;
-                }
-            }
-            message->u.tag_sym_res.type = FIP_SYM_UNKNOWN;
-            break;
-        case FIP_MSG_KILL:
-            // The enum does not need to be changed at all
+const char *fip_sig_name(             //
+    const fip_msg_symbol_type_e type, //
+    const fip_sig_u *sig              //
+) {
+#define FIP_SIG_CASE_SIG_NAME(kind, member, suffix, str, fields)               \
+    case kind:                                                                 \
+        return sig->member.name;
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_SIG_NAME)
+        case FIP_SYM_UNKNOWN:
             break;
     }
+#undef FIP_SIG_CASE_SIG_NAME
+    return "";
 }
 
 void fip_free_sig_list(fip_sig_list_t *list) {
@@ -2259,66 +3209,9 @@ void fip_free_sig_list(fip_sig_list_t *list) {
         return;
     }
     for (size_t i = 0; i < list->count; i++) {
-        switch (list->sigs[i].type) {
-            case FIP_SYM_UNKNOWN:
-                break;
-            case FIP_SYM_FUNCTION: {
-                fip_sig_fn_t *f = &list->sigs[i].sig.fn;
-                memset(f->name, 0, sizeof(f->name));
-                if (f->args_len > 0) {
-                    for (uint8_t j = 0; j < f->args_len; j++) {
-                        fip_free_type(&f->args[j].type);
-                    }
-                    free(f->args);
-                }
-                f->args = NULL;
-                if (f->rets_len > 0) {
-                    for (uint8_t j = 0; j < f->rets_len; j++) {
-                        fip_free_type(&f->rets[j]);
-                    }
-                    free(f->rets);
-                }
-                f->rets = NULL;
-                break;
-            }
-            case FIP_SYM_DATA: {
-                fip_sig_data_t *d = &list->sigs[i].sig.data;
-                memset(d->name, 0, sizeof(d->name));
-                if (d->value_count > 0) {
-                    for (uint8_t j = 0; j < d->value_count; j++) {
-                        free(d->value_names[j]);
-                        fip_free_type(&d->value_types[j]);
-                    }
-                    free(d->value_names);
-                    free(d->value_types);
-                }
-                d->value_names = NULL;
-                d->value_types = NULL;
-                break;
-            }
-            case FIP_SYM_ENUM: {
-                fip_sig_enum_t *e = &list->sigs[i].sig.enum_t;
-                memset(e->name, 0, sizeof(e->name));
-                e->type = FIP_VOID;
-                if (e->value_count > 0) {
-                    for (uint8_t j = 0; j < e->value_count; j++) {
-                        free(e->tags[j]);
-                    }
-                    free(e->tags);
-                    free(e->values);
-                }
-                e->value_count = 0;
-                e->values = NULL;
-                e->tags = NULL;
-                break;
-            }
-            case FIP_SYM_OPAQUE: {
-                fip_sig_opaque_t *o = &list->sigs[i].sig.opaque;
-                memset(o->name, 0, sizeof(o->name));
-                break;
-            }
-        }
+        fip_free_sig(list->sigs[i].type, &list->sigs[i].sig);
     }
+    free(list);
 }
 
 void fip_create_hash(char hash[8], const char *file_path) {
@@ -2567,145 +3460,97 @@ void fip_print_sig_opaque(uint32_t id, const fip_sig_opaque_t *sig) {
     fip_print(id, FIP_DEBUG, "    name: %s", sig->name);
 }
 
-void fip_clone_sig_fn(fip_sig_fn_t *dest, const fip_sig_fn_t *src) {
-    memcpy(dest->name, src->name, sizeof(src->name));
-    dest->args_len = src->args_len;
-    if (src->args_len > 0) {
-        dest->args = (fip_sig_fn_arg_t *)malloc(     //
-            sizeof(fip_sig_fn_arg_t) * src->args_len //
-        );
-        for (uint8_t i = 0; i < src->args_len; i++) {
-            strcpy(dest->args[i].name, src->args[i].name);
-            fip_clone_type(&dest->args[i].type, &src->args[i].type);
-        }
-    }
-    dest->rets_len = src->rets_len;
-    if (src->rets_len > 0) {
-        dest->rets = (fip_type_t *)malloc(sizeof(fip_type_t) * src->rets_len);
-        for (uint8_t i = 0; i < src->rets_len; i++) {
-            fip_clone_type(&dest->rets[i], &src->rets[i]);
-        }
+void fip_print_sig(                   //
+    uint32_t id,                      //
+    const fip_msg_symbol_type_e type, //
+    const fip_sig_u *sig              //
+) {
+#define FIP_SIG_CASE_PRINT(kind, member, suffix, name, fields)                 \
+    case kind:                                                                 \
+        fip_print_sig_##suffix(id, &sig->member);                              \
+        break;
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_PRINT)
+        case FIP_SYM_UNKNOWN:
+            fip_print(id, FIP_DEBUG, "  Unknown Signature");
+            break;
     }
+#undef FIP_SIG_CASE_PRINT
 }
 
-void fip_clone_sig_data(fip_sig_data_t *dest, const fip_sig_data_t *src) {
-    memcpy(dest->name, src->name, sizeof(src->name));
-    dest->value_count = src->value_count;
-    if (src->value_count > 0) {
-        const size_t names_size = sizeof(char *) * src->value_count;
-        dest->value_names = (char **)malloc(names_size);
-        for (uint8_t i = 0; i < src->value_count; i++) {
-            const size_t name_len = strlen(src->value_names[i]);
-            dest->value_names[i] = (char *)malloc(name_len + 1);
-            if (name_len > 0) {
-                memcpy(dest->value_names[i], src->value_names[i], name_len);
-            }
-            dest->value_names[i][name_len] = '\0';
-        }
-
-        const size_t types_size = sizeof(fip_type_t) * src->value_count;
-        dest->value_types = (fip_type_t *)malloc(types_size);
-        for (uint8_t i = 0; i < src->value_count; i++) {
-            fip_clone_type(&dest->value_types[i], &src->value_types[i]);
-        }
+// The deep clones of all signatures and types, generated from their member
+// tables. Arrays are only allocated when they have elements
+#define FIP_CLONE_NAME(f, count) memcpy(dest->f, src->f, sizeof(src->f));
+#define FIP_CLONE_VALUE(f, count) dest->f = src->f;
+#define FIP_CLONE_TYPE(f, count)                                               \
+    dest->f = (fip_type_t *)malloc(sizeof(fip_type_t));                        \
+    fip_clone_type(dest->f, src->f);
+#define FIP_CLONE_ARRAY(f, count, elem_t, CLONE_ELEM)                          \
+    dest->count = src->count;                                                  \
+    dest->f = NULL;                                                            \
+    if (src->count > 0) {                                                      \
+        dest->f = (elem_t *)malloc(sizeof(elem_t) * src->count);               \
+        for (uint8_t i = 0; i < src->count; i++) {                             \
+            CLONE_ELEM(&dest->f[i], &src->f[i])                                \
+        }                                                                      \
     }
-}
-
-void fip_clone_sig_enum(fip_sig_enum_t *dest, const fip_sig_enum_t *src) {
-    memcpy(dest->name, src->name, sizeof(src->name));
-    dest->type = src->type;
-    dest->value_count = src->value_count;
-    if (src->value_count > 0) {
-        const size_t tags_size = sizeof(char *) * src->value_count;
-        dest->tags = (char **)malloc(tags_size);
-        for (uint8_t i = 0; i < src->value_count; i++) {
-            const size_t tag_len = strlen(src->tags[i]);
-            dest->tags[i] = (char *)malloc(tag_len + 1);
-            if (tag_len > 0) {
-                memcpy(dest->tags[i], src->tags[i], tag_len);
-            }
-            dest->tags[i][tag_len] = '\0';
-        }
-
-        const size_t values_size = sizeof(size_t) * src->value_count;
-        dest->values = (size_t *)malloc(values_size);
-        memcpy(dest->values, src->values, values_size);
+#define FIP_CLONE_ELEM_ARG(dest_arg, src_arg)                                  \
+    memcpy((dest_arg)->name, (src_arg)->name, sizeof((src_arg)->name));        \
+    fip_clone_type(&(dest_arg)->type, &(src_arg)->type);
+#define FIP_CLONE_ELEM_TYPE(dest_type, src_type)                               \
+    fip_clone_type(dest_type, src_type);
+#define FIP_CLONE_ELEM_STR(dest_str, src_str)                                  \
+    {                                                                          \
+        const size_t len = strlen(*(src_str)) + 1;                             \
+        *(dest_str) = (char *)malloc(len);                                     \
+        memcpy(*(dest_str), *(src_str), len);                                  \
     }
-}
+#define FIP_CLONE_ELEM_VALUE(dest_value, src_value)                            \
+    *(dest_value) = *(src_value);
+#define FIP_CLONE_ARGS(f, count)                                               \
+    FIP_CLONE_ARRAY(f, count, fip_sig_fn_arg_t, FIP_CLONE_ELEM_ARG)
+#define FIP_CLONE_TYPES(f, count)                                              \
+    FIP_CLONE_ARRAY(f, count, fip_type_t, FIP_CLONE_ELEM_TYPE)
+#define FIP_CLONE_STRS(f, count)                                               \
+    FIP_CLONE_ARRAY(f, count, char *, FIP_CLONE_ELEM_STR)
+#define FIP_CLONE_VALUES(f, count)                                             \
+    FIP_CLONE_ARRAY(f, count, size_t, FIP_CLONE_ELEM_VALUE)
+#define FIP_CLONE_FIELD(kind, f, count) FIP_CLONE_##kind(f, count)
+#define FIP_GEN_SIG_CLONE(kind, member, suffix, name, FIELDS)                  \
+    void fip_clone_sig_##suffix(                                               \
+        fip_sig_##suffix##_t *dest, const fip_sig_##suffix##_t *src) {         \
+        FIELDS(FIP_CLONE_FIELD)                                                \
+    }
+FIP_SIG_SCHEMA(FIP_GEN_SIG_CLONE)
 
-void fip_clone_sig_opaque(fip_sig_opaque_t *dest, const fip_sig_opaque_t *src) {
-    memcpy(dest->name, src->name, sizeof(src->name));
+void fip_clone_sig(                   //
+    const fip_msg_symbol_type_e type, //
+    fip_sig_u *dest,                  //
+    const fip_sig_u *src              //
+) {
+#define FIP_SIG_CASE_CLONE(kind, member, suffix, name, fields)                 \
+    case kind:                                                                 \
+        fip_clone_sig_##suffix(&dest->member, &src->member);                   \
+        break;
+    switch (type) {
+        FIP_SIG_SCHEMA(FIP_SIG_CASE_CLONE)
+        case FIP_SYM_UNKNOWN:
+            break;
+    }
+#undef FIP_SIG_CASE_CLONE
 }
 
 void fip_clone_type(fip_type_t *dest, const fip_type_t *src) {
     dest->type = src->type;
     dest->is_mutable = src->is_mutable;
+#define FIP_TYPE_CASE_CLONE(kind, FIELDS)                                      \
+    case kind:                                                                 \
+        FIELDS(FIP_CLONE_FIELD)                                                \
+        break;
     switch (src->type) {
-        case FIP_TYPE_PRIMITIVE:
-            dest->u.prim = src->u.prim;
-            break;
-        case FIP_TYPE_PTR:
-            dest->u.ptr.base_type = (fip_type_t *)malloc(sizeof(fip_type_t));
-            fip_clone_type(dest->u.ptr.base_type, src->u.ptr.base_type);
-            break;
-        case FIP_TYPE_STRUCT: {
-            const uint8_t type_name_len = strlen(src->u.struct_t.name);
-            memset(dest->u.struct_t.name, 0, sizeof(dest->u.struct_t.name));
-            if (type_name_len > 0) {
-                memcpy(                    //
-                    dest->u.struct_t.name, //
-                    src->u.struct_t.name,  //
-                    type_name_len          //
-                );
-            }
-            dest->u.struct_t.field_count = src->u.struct_t.field_count;
-            if (src->u.struct_t.field_count > 0) {
-                dest->u.struct_t.fields = (fip_type_t *)malloc(      //
-                    sizeof(fip_type_t) * src->u.struct_t.field_count //
-                );
-                for (uint8_t i = 0; i < src->u.struct_t.field_count; i++) {
-                    fip_clone_type(                  //
-                        &dest->u.struct_t.fields[i], //
-                        &src->u.struct_t.fields[i]   //
-                    );
-                }
-            }
-            break;
-        }
-        case FIP_TYPE_RECURSIVE:
-            dest->u.recursive.levels_back = src->u.recursive.levels_back;
-            break;
-        case FIP_TYPE_ENUM: {
-            const uint8_t type_name_len = strlen(src->u.enum_t.name);
-            memset(dest->u.enum_t.name, 0, sizeof(dest->u.enum_t.name));
-            if (type_name_len > 0) {
-                memcpy(dest->u.enum_t.name, src->u.enum_t.name, type_name_len);
-            }
-            dest->u.enum_t.bit_width = src->u.enum_t.bit_width;
-            dest->u.enum_t.is_signed = src->u.enum_t.bit_width;
-            dest->u.enum_t.value_count = src->u.enum_t.value_count;
-            if (src->u.enum_t.value_count > 0) {
-                const size_t val_size =
-                    sizeof(size_t) * src->u.enum_t.value_count;
-                dest->u.enum_t.values = (size_t *)malloc(val_size);
-                memcpy(dest->u.enum_t.values, src->u.enum_t.values, val_size);
-            }
-            break;
-        }
-        case FIP_TYPE_ARRAY:
-            dest->u.array.size = src->u.array.size;
-            dest->u.array.base_type = (fip_type_t *)malloc(sizeof(fip_type_t));
-            fip_clone_type(dest->u.array.base_type, src->u.array.base_type);
-            break;
-        case FIP_TYPE_OPAQUE: {
-            const uint8_t type_name_len = strlen(src->u.opaque.name);
-            memset(dest->u.opaque.name, 0, sizeof(dest->u.opaque.name));
-            if (type_name_len > 0) {
-                memcpy(dest->u.opaque.name, src->u.opaque.name, type_name_len);
-            }
-            break;
-        }
+        FIP_TYPE_SCHEMA(FIP_TYPE_CASE_CLONE)
     }
+#undef FIP_TYPE_CASE_CLONE
 }
 
 int fip_execute_and_capture(char **output, const char *command) {
@@ -2834,6 +3679,300 @@ int fip_execute_and_capture(char **output, const char *command) {
     return exit_code;
 }
 
+/*
+ * ======================================
+ * FRAMES AND LANES
+ * ======================================
+ */
+
+/// @var `fip_msg_lanes`
+/// @brief The lane of every message type, indexed by the message type
+const fip_lane_e fip_msg_lanes[] = {
+    FIP_LANE_CONTROL, // FIP_MSG_UNKNOWN
+    FIP_LANE_CONTROL, // FIP_MSG_CONNECT_REQUEST
+    FIP_LANE_LOOKUP,  // FIP_MSG_SYMBOL_REQUEST
+    FIP_LANE_LOOKUP,  // FIP_MSG_SYMBOL_RESPONSE
+    FIP_LANE_BULK,    // FIP_MSG_COMPILE_REQUEST
+    FIP_LANE_BULK,    // FIP_MSG_OBJECT_RESPONSE
+    FIP_LANE_LOOKUP,  // FIP_MSG_TAG_REQUEST
+    FIP_LANE_LOOKUP,  // FIP_MSG_TAG_PRESENT_RESPONSE
+    FIP_LANE_BULK,    // FIP_MSG_TAG_NEXT_SYMBOL_REQUEST
+    FIP_LANE_BULK,    // FIP_MSG_TAG_SYMBOL_RESPONSE
+    FIP_LANE_LOOKUP,  // FIP_MSG_SUBSCRIBE_REQUEST
+    FIP_LANE_LOOKUP,  // FIP_MSG_CHANGE_NOTIFICATION
+    FIP_LANE_BULK,    // FIP_MSG_USAGE_REQUEST
+    FIP_LANE_BULK,    // FIP_MSG_USAGE_RESPONSE
+    FIP_LANE_BULK,    // FIP_MSG_CLEANUP_REQUEST
+    FIP_LANE_BULK,    // FIP_MSG_CLEANUP_RESPONSE
+    FIP_LANE_CONTROL, // FIP_MSG_PROGRESS
+    FIP_LANE_CONTROL, // FIP_MSG_KILL
+};
+
+fip_lane_e fip_msg_lane(const fip_msg_type_e type) {
+    if (type > FIP_MSG_KILL) {
+        return FIP_LANE_CONTROL;
+    }
+    return fip_msg_lanes[type];
+}
+
+void fip_msg_queue_push(fip_msg_queue_t *queue, fip_queued_msg_t *msg) {
+    msg->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = msg;
+    } else {
+        queue->head = msg;
+    }
+    queue->tail = msg;
+}
+
+fip_queued_msg_t *fip_msg_queue_pop(fip_msg_queue_t *queue) {
+    fip_queued_msg_t *msg = queue->head;
+    if (msg) {
+        queue->head = msg->next;
+        if (queue->head == NULL) {
+            queue->tail = NULL;
+        }
+    }
+    return msg;
+}
+
+void fip_outbox_push(fip_outbox_t *outbox, const char buffer[FIP_MSG_SIZE]) {
+    fip_queued_msg_t *msg = fip_msg_queue_pop(&outbox->spare);
+    if (msg == NULL) {
+        msg = (fip_queued_msg_t *)malloc(sizeof(fip_queued_msg_t));
+    }
+    memcpy(&msg->len, buffer, sizeof(uint32_t));
+    msg->offset = 0;
+    memcpy(msg->data, buffer + 4, msg->len);
+    const fip_lane_e lane = fip_msg_lane((fip_msg_type_e)msg->data[0]);
+    fip_msg_queue_push(&outbox->lanes[lane], msg);
+}
+
+bool fip_outbox_is_empty(const fip_outbox_t *outbox) {
+    for (uint8_t lane = 0; lane < FIP_LANE_COUNT; lane++) {
+        if (outbox->lanes[lane].head) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool fip_outbox_write_frame(fip_outbox_t *outbox, FILE *stream) {
+    uint8_t lane = 0;
+    while (lane < FIP_LANE_COUNT && outbox->lanes[lane].head == NULL) {
+        lane++;
+    }
+    if (lane == FIP_LANE_COUNT) {
+        return false;
+    }
+    fip_queued_msg_t *msg = outbox->lanes[lane].head;
+    // Only bulk messages are chunked, all other messages are small and are
+    // always sent as a single frame
+    uint32_t chunk_len = msg->len - msg->offset;
+    if (lane == FIP_LANE_BULK && chunk_len > FIP_CHUNK_SIZE) {
+        chunk_len = FIP_CHUNK_SIZE;
+    }
+    const bool is_last = msg->offset + chunk_len == msg->len;
+    char header[FIP_FRAME_HEADER_SIZE];
+    const uint32_t frame_len = chunk_len + 1;
+    memcpy(header, &frame_len, sizeof(uint32_t));
+    header[4] = (char)(lane | (is_last ? 0 : FIP_FRAME_FLAG_MORE));
+    if (fwrite(header, 1, FIP_FRAME_HEADER_SIZE, stream) !=
+            FIP_FRAME_HEADER_SIZE ||
+        fwrite(msg->data + msg->offset, 1, chunk_len, stream) != chunk_len) {
+        return false;
+    }
+    fflush(stream);
+    FIP_PROBE4(frame_send, outbox->peer, msg->data[0], chunk_len, lane);
+    msg->offset += chunk_len;
+    if (is_last) {
+        fip_queued_msg_t *sent = fip_msg_queue_pop(&outbox->lanes[lane]);
+        fip_msg_queue_push(&outbox->spare, sent);
+    }
+    return true;
+}
+
+bool fip_outbox_flush(fip_outbox_t *outbox, FILE *stream) {
+    while (!fip_outbox_is_empty(outbox)) {
+        if (!fip_outbox_write_frame(outbox, stream)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @function `fip_stream_read`
+/// @brief Reads the bytes currently available on the given stream, bypassing
+/// the stream's own buffer. Waits up to `timeout_ms` milliseconds for data to
+/// become available, negative timeouts wait forever
+///
+/// @param `stream` The stream to read from
+/// @param `dest` The buffer to read into
+/// @param `size` The size of the buffer
+/// @param `timeout_ms` How long to wait for data
+/// @return `int64_t` The number of bytes read, 0 on timeout and -1 on EOF or
+/// read errors
+int64_t fip_stream_read( //
+    FILE *stream,        //
+    char *dest,          //
+    const size_t size,   //
+    const int timeout_ms //
+) {
+#ifdef __WIN32__
+    HANDLE handle = (HANDLE)_get_osfhandle(fileno(stream));
+    if (handle == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    DWORD bytes_available = 0;
+    int waited_ms = 0;
+    while (true) {
+        if (!PeekNamedPipe(handle, NULL, 0, NULL, &bytes_available, NULL)) {
+            return -1;
+        }
+        if (bytes_available > 0) {
+            break;
+        }
+        if (timeout_ms >= 0 && waited_ms >= timeout_ms) {
+            return 0;
+        }
+        Sleep(1);
+        waited_ms++;
+    }
+    DWORD bytes_read = 0;
+    const DWORD to_read = bytes_available < size ? bytes_available : size;
+    if (!ReadFile(handle, dest, to_read, &bytes_read, NULL)) {
+        return -1;
+    }
+    return (int64_t)bytes_read;
+#else
+    const int fd = fileno(stream);
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(fd, &read_fds);
+    struct timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    const int activity = select(         //
+        fd + 1, &read_fds, NULL, NULL,   //
+        timeout_ms < 0 ? NULL : &timeout //
+    );
+    if (activity < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    if (activity == 0) {
+        return 0;
+    }
+    const ssize_t bytes_read = read(fd, dest, size);
+    if (bytes_read < 0) {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    // A readable descriptor without any data means the other end was closed
+    return bytes_read == 0 ? -1 : (int64_t)bytes_read;
+#endif
+}
+
+bool fip_inbox_fill(fip_inbox_t *inbox, FILE *stream, const int timeout_ms) {
+    const int64_t bytes_read = fip_stream_read(         //
+        stream, inbox->raw + inbox->raw_len,            //
+        sizeof(inbox->raw) - inbox->raw_len, timeout_ms //
+    );
+    if (bytes_read < 0) {
+        return false;
+    }
+    inbox->raw_len += (uint32_t)bytes_read;
+
+    // Take all complete frames out of the raw buffer
+    uint32_t idx = 0;
+    while (inbox->raw_len - idx >= FIP_FRAME_HEADER_SIZE) {
+        uint32_t frame_len;
+        memcpy(&frame_len, inbox->raw + idx, sizeof(uint32_t));
+        if (frame_len == 0 || frame_len > FIP_MSG_SIZE) {
+            fip_print(0, FIP_ERROR, "Invalid frame length: %u", frame_len);
+            inbox->raw_len = 0;
+            return false;
+        }
+        if (inbox->raw_len - idx < frame_len + 4) {
+            break;
+        }
+        const uint8_t header = (uint8_t)inbox->raw[idx + 4];
+        const uint8_t lane = header & FIP_FRAME_LANE_MASK;
+        const uint32_t chunk_len = frame_len - 1;
+        if (lane >= FIP_LANE_COUNT) {
+            fip_print(0, FIP_ERROR, "Invalid frame lane: %u", lane);
+            inbox->raw_len = 0;
+            return false;
+        }
+        fip_queued_msg_t *msg = inbox->partial[lane];
+        if (msg == NULL) {
+            msg = (fip_queued_msg_t *)malloc(sizeof(fip_queued_msg_t));
+            msg->len = 0;
+            msg->offset = 0;
+            inbox->partial[lane] = msg;
+        }
+        if (msg->len + chunk_len > FIP_MSG_SIZE - 4) {
+            fip_print(0, FIP_ERROR, "Chunked message exceeds %u bytes",
+                FIP_MSG_SIZE - 4);
+            inbox->raw_len = 0;
+            return false;
+        }
+        memcpy(msg->data + msg->len, inbox->raw + idx + FIP_FRAME_HEADER_SIZE,
+            chunk_len);
+        msg->len += chunk_len;
+        FIP_PROBE4(frame_receive, inbox->peer, msg->data[0], chunk_len, lane);
+        if ((header & FIP_FRAME_FLAG_MORE) == 0) {
+            inbox->partial[lane] = NULL;
+            fip_msg_queue_push(&inbox->lanes[lane], msg);
+        }
+        idx += frame_len + 4;
+    }
+    memmove(inbox->raw, inbox->raw + idx, inbox->raw_len - idx);
+    inbox->raw_len -= idx;
+    return true;
+}
+
+bool fip_inbox_pop(            //
+    fip_inbox_t *inbox,        //
+    const fip_lane_e max_lane, //
+    char buffer[FIP_MSG_SIZE]  //
+) {
+    for (uint8_t lane = 0; lane <= max_lane; lane++) {
+        fip_queued_msg_t *msg = fip_msg_queue_pop(&inbox->lanes[lane]);
+        if (msg == NULL) {
+            continue;
+        }
+        memset(buffer, 0, FIP_MSG_SIZE);
+        memcpy(buffer, msg->data, msg->len);
+        free(msg);
+        return true;
+    }
+    return false;
+}
+
+void fip_outbox_clear(fip_outbox_t *outbox) {
+    for (uint8_t lane = 0; lane < FIP_LANE_COUNT; lane++) {
+        fip_queued_msg_t *msg;
+        while ((msg = fip_msg_queue_pop(&outbox->lanes[lane])) != NULL) {
+            free(msg);
+        }
+    }
+    fip_queued_msg_t *msg;
+    while ((msg = fip_msg_queue_pop(&outbox->spare)) != NULL) {
+        free(msg);
+    }
+}
+
+void fip_inbox_clear(fip_inbox_t *inbox) {
+    for (uint8_t lane = 0; lane < FIP_LANE_COUNT; lane++) {
+        fip_queued_msg_t *msg;
+        while ((msg = fip_msg_queue_pop(&inbox->lanes[lane])) != NULL) {
+            free(msg);
+        }
+        free(inbox->partial[lane]);
+        inbox->partial[lane] = NULL;
+    }
+    inbox->raw_len = 0;
+}
+
 /*
  * ======================================
  * PLATFORM-AGNOSTIC STDIO FUNCTIONS
@@ -2877,21 +4016,17 @@ void fip_copy_stream_lines(FILE *src, FILE *dest) {
         }
     }
 #else
-    // Linux approach - use fcntl
-    int fd = fileno(src);
-    int flags = fcntl(fd, F_GETFL, 0);
-    if (flags != -1) {
-        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
-
-        ssize_t bytes_read;
-        while ((bytes_read = read(fd, buffer, sizeof(buffer) - 1)) > 0) {
-            buffer[bytes_read] = '\0';
-            fputs(buffer, dest);
-            fflush(dest);
+    // Linux approach - only read while data is available, so the flags of the
+    // descriptor do not need to be changed
+    struct pollfd poll_fd = {.fd = fileno(src), .events = POLLIN};
+    while (poll(&poll_fd, 1, 0) > 0 && (poll_fd.revents & POLLIN) != 0) {
+        const ssize_t bytes_read = read(poll_fd.fd, buffer, sizeof(buffer) - 1);
+        if (bytes_read <= 0) {
+            break;
         }
-
-        // Restore original flags
-        fcntl(fd, F_SETFL, flags);
+        buffer[bytes_read] = '\0';
+        fputs(buffer, dest);
+        fflush(dest);
     }
 #endif
 
@@ -2899,65 +4034,494 @@ void fip_copy_stream_lines(FILE *src, FILE *dest) {
     clearerr(src);
 }
 
-void fip_print_slave_streams() {
-    for (uint32_t i = 0; i < master_state.slave_count; i++) {
-        fip_copy_stream_lines(master_state.slave_stderr[i], stderr);
+#ifdef __WIN32__
+#define FIP_LOG_LOCK(drain) EnterCriticalSection(&(drain)->lock)
+#define FIP_LOG_UNLOCK(drain) LeaveCriticalSection(&(drain)->lock)
+#else
+#define FIP_LOG_LOCK(drain) pthread_mutex_lock(&(drain)->lock)
+#define FIP_LOG_UNLOCK(drain) pthread_mutex_unlock(&(drain)->lock)
+#endif
+
+/// @function `fip_log_drain_push_line`
+/// @brief Moves the partial line of the given source into the line buffer, or
+/// drops it if the buffer is full. The drain has to be locked
+void fip_log_drain_push_line(fip_log_drain_t *drain, fip_log_source_t *source) {
+    if (source->partial_len == 0) {
+        return;
+    }
+    if (drain->len + source->partial_len > FIP_LOG_BUFFER_SIZE) {
+        drain->dropped_count++;
+    } else {
+        memcpy(drain->lines + drain->len, source->partial, source->partial_len);
+        drain->len += source->partial_len;
     }
+    source->partial_len = 0;
 }
 
-void fip_master_broadcast_message( //
-    char buffer[FIP_MSG_SIZE],     //
-    const fip_msg_t *message       //
+/// @function `fip_log_drain_append`
+/// @brief Appends the bytes read from a source to its partial line, every
+/// completed line is pushed to the line buffer. The drain has to be locked
+void fip_log_drain_append(    //
+    fip_log_drain_t *drain,   //
+    const uint32_t source_id, //
+    const char *data,         //
+    size_t len                //
 ) {
-    fip_print(0, FIP_INFO, "Broadcasting message to %d slaves",
-        master_state.slave_count);
-    fip_encode_msg(buffer, message);
-    uint32_t msg_len;
-    memcpy(&msg_len, buffer, sizeof(uint32_t));
+    fip_log_source_t *source = &drain->sources[source_id];
+    while (len > 0) {
+        const char *newline = (const char *)memchr(data, '\n', len);
+        const size_t line_len = newline ? (size_t)(newline - data) + 1 : len;
+        const size_t space = FIP_LOG_LINE_SIZE - source->partial_len;
+        const size_t take = line_len < space ? line_len : space;
+        memcpy(source->partial + source->partial_len, data, take);
+        source->partial_len += (uint32_t)take;
+        data += take;
+        len -= take;
+        // Overlong lines are split instead of growing the partial line
+        if ((newline && take == line_len)
+            || source->partial_len == FIP_LOG_LINE_SIZE) {
+            fip_log_drain_push_line(drain, source);
+        }
+    }
+}
 
-    for (uint32_t i = 0; i < master_state.slave_count; i++) {
-        if (master_state.slave_stdin[i]) {
-            size_t written =
-                fwrite(buffer, 1, msg_len + 4, master_state.slave_stdin[i]);
-            if (written != (msg_len + 4)) {
-                fip_print(0, FIP_WARN, "Failed to write message to slave %d",
-                    i + 1);
-                continue;
-            }
-            fip_print(0, FIP_DEBUG, "Sent message to slave %d", i + 1);
-            fflush(master_state.slave_stdin[i]);
+/// @function `fip_log_drain_read`
+/// @brief Reads everything available from the given source without blocking
+///
+/// @param `drain` The log drain, which must not be locked
+/// @param `source_id` The index of the source to read from
+void fip_log_drain_read(fip_log_drain_t *drain, const uint32_t source_id) {
+    char buffer[FIP_LOG_LINE_SIZE];
+    while (true) {
+        // The sources could be reallocated by the master thread at any time
+        FIP_LOG_LOCK(drain);
+#ifdef __WIN32__
+        const HANDLE handle = drain->sources[source_id].handle;
+#else
+        const int fd = drain->sources[source_id].fd;
+#endif
+        const bool is_closed = drain->sources[source_id].is_closed;
+        FIP_LOG_UNLOCK(drain);
+        if (is_closed) {
+            return;
+        }
+#ifdef __WIN32__
+        DWORD available = 0;
+        DWORD bytes_read = 0;
+        if (!PeekNamedPipe(handle, NULL, 0, NULL, &available, NULL)) {
+            FIP_LOG_LOCK(drain);
+            drain->sources[source_id].is_closed = true;
+            FIP_LOG_UNLOCK(drain);
+            return;
+        }
+        if (available == 0 ||
+            !ReadFile(handle, buffer,
+                available < sizeof(buffer) ? available : sizeof(buffer),
+                &bytes_read, NULL)) {
+            return;
+        }
+        const long result = (long)bytes_read;
+#else
+        const ssize_t result = read(fd, buffer, sizeof(buffer));
+        if (result < 0) {
+            // Nothing left to read for now
+            return;
+        }
+#endif
+        FIP_LOG_LOCK(drain);
+        if (result == 0) {
+            drain->sources[source_id].is_closed = true;
+            fip_log_drain_push_line(drain, &drain->sources[source_id]);
+        } else {
+            fip_log_drain_append(drain, source_id, buffer, (size_t)result);
+        }
+        FIP_LOG_UNLOCK(drain);
+        if (result == 0) {
+            return;
         }
     }
 }
 
-bool fip_master_symbol_request( //
-    char buffer[FIP_MSG_SIZE],  //
-    const fip_msg_t *message    //
-) {
-    assert(message->type == FIP_MSG_SYMBOL_REQUEST);
-    fip_master_broadcast_message(buffer, message);
-    uint8_t wrong_msg_count =
-        fip_master_await_responses(buffer, master_state.responses,
-            &master_state.response_count, FIP_MSG_SYMBOL_RESPONSE);
-    if (wrong_msg_count > 0) {
-        fip_print(0, FIP_WARN, "Received %u wrong messages", wrong_msg_count);
+/// @function `fip_log_drain_run`
+/// @brief The body of the drain thread, it waits for any of the pipes to have
+/// data and reads it until the drain is stopped
+#ifdef __WIN32__
+DWORD WINAPI fip_log_drain_run(LPVOID arg) {
+#else
+void *fip_log_drain_run(void *arg) {
+#endif
+    fip_log_drain_t *drain = (fip_log_drain_t *)arg;
+#ifndef __WIN32__
+    struct pollfd *poll_fds = NULL;
+    uint32_t poll_capacity = 0;
+#endif
+    while (true) {
+        FIP_LOG_LOCK(drain);
+        const bool is_running = drain->is_running;
+        const uint32_t source_count = drain->source_count;
+#ifndef __WIN32__
+        if (poll_capacity < source_count) {
+            poll_capacity = drain->source_capacity;
+            poll_fds = (struct pollfd *)realloc( //
+                poll_fds, sizeof(struct pollfd) * poll_capacity);
+        }
+        for (uint32_t i = 0; i < source_count; i++) {
+            const fip_log_source_t *source = &drain->sources[i];
+            // Negative descriptors are ignored by poll
+            poll_fds[i].fd = source->is_closed ? -1 : source->fd;
+            poll_fds[i].events = POLLIN;
+            poll_fds[i].revents = 0;
+        }
+#endif
+        FIP_LOG_UNLOCK(drain);
+        if (!is_running) {
+            break;
+        }
+#ifdef __WIN32__
+        for (uint32_t i = 0; i < source_count; i++) {
+            fip_log_drain_read(drain, i);
+        }
+        Sleep(FIP_LOG_DRAIN_INTERVAL_MS / 5);
+#else
+        if (poll(poll_fds, source_count, FIP_LOG_DRAIN_INTERVAL_MS) <= 0) {
+            continue;
+        }
+        for (uint32_t i = 0; i < source_count; i++) {
+            if (poll_fds[i].revents != 0) {
+                fip_log_drain_read(drain, i);
+            }
+        }
+#endif
     }
+#ifdef __WIN32__
+    return 0;
+#else
+    free(poll_fds);
+    return NULL;
+#endif
+}
 
-    bool symbol_found = false;
-    for (uint8_t i = 0; i < master_state.response_count; i++) {
-        fip_print_msg(0, &master_state.responses[i]);
-        if (master_state.responses[i].type == FIP_MSG_SYMBOL_RESPONSE &&
-            master_state.responses[i].u.sym_res.found) {
-            symbol_found = true;
+bool fip_log_drain_add(FILE *err) {
+    fip_log_drain_t *drain = &master_state.log_drain;
+    if (!drain->is_running) {
+        drain->lines = (char *)malloc(FIP_LOG_BUFFER_SIZE);
+        drain->spare = (char *)malloc(FIP_LOG_BUFFER_SIZE);
+        drain->len = 0;
+        drain->dropped_count = 0;
+        drain->source_count = 0;
+        drain->is_running = true;
+#ifdef __WIN32__
+        InitializeCriticalSection(&drain->lock);
+        drain->thread =
+            CreateThread(NULL, 0, fip_log_drain_run, drain, 0, NULL);
+        const bool is_started = drain->thread != NULL;
+#else
+        pthread_mutex_init(&drain->lock, NULL);
+        const bool is_started = pthread_create( //
+            &drain->thread, NULL, fip_log_drain_run, drain) == 0;
+#endif
+        if (!is_started) {
+            fip_print(0, FIP_WARN, "Failed to start the log drain thread");
+            drain->is_running = false;
+            fip_log_drain_stop();
+            return false;
         }
     }
+#ifndef __WIN32__
+    // The pipe is only ever read when there is data, but a read must never
+    // block the drain thread while the master reads another pipe
+    const int fd = fileno(err);
+    const int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+#endif
+    FIP_LOG_LOCK(drain);
+    if (drain->source_count == drain->source_capacity) {
+        drain->source_capacity =
+            drain->source_capacity == 0 ? 4 : drain->source_capacity * 2;
+        drain->sources = (fip_log_source_t *)realloc( //
+            drain->sources,                           //
+            sizeof(fip_log_source_t) * drain->source_capacity);
+    }
+    fip_log_source_t *source = &drain->sources[drain->source_count++];
+#ifdef __WIN32__
+    source->handle = (HANDLE)_get_osfhandle(_fileno(err));
+#else
+    source->fd = fd;
+#endif
+    source->is_closed = false;
+    source->partial_len = 0;
+    FIP_LOG_UNLOCK(drain);
+    return true;
+}
 
-    if (symbol_found) {
-        fip_print(0, FIP_INFO, "Requested symbol found");
-    } else {
-        fip_print(0, FIP_WARN, "Requested symbol not found");
+void fip_print_slave_streams() {
+    fip_log_drain_t *drain = &master_state.log_drain;
+    if (drain->lines == NULL) {
+        return;
+    }
+    // The buffers are swapped, so the drain thread keeps reading into the
+    // other one while the lines are written
+    FIP_LOG_LOCK(drain);
+    char *lines = drain->lines;
+    const uint32_t len = drain->len;
+    const uint32_t dropped_count = drain->dropped_count;
+    drain->lines = drain->spare;
+    drain->spare = lines;
+    drain->len = 0;
+    drain->dropped_count = 0;
+    FIP_LOG_UNLOCK(drain);
+    if (len > 0) {
+        fwrite(lines, 1, len, stderr);
+        fflush(stderr);
+    }
+    if (dropped_count > 0) {
+        fip_print(0, FIP_WARN, "Dropped %u log lines of the slaves",
+            dropped_count);
     }
-    return symbol_found;
+}
+
+void fip_log_drain_stop(void) {
+    fip_log_drain_t *drain = &master_state.log_drain;
+    if (drain->lines == NULL) {
+        return;
+    }
+    if (drain->is_running) {
+        FIP_LOG_LOCK(drain);
+        drain->is_running = false;
+        FIP_LOG_UNLOCK(drain);
+#ifdef __WIN32__
+        WaitForSingleObject(drain->thread, INFINITE);
+        CloseHandle(drain->thread);
+#else
+        pthread_join(drain->thread, NULL);
+#endif
+    }
+    for (uint32_t i = 0; i < drain->source_count; i++) {
+        fip_log_drain_read(drain, i);
+        fip_log_drain_push_line(drain, &drain->sources[i]);
+    }
+    fip_print_slave_streams();
+#ifdef __WIN32__
+    DeleteCriticalSection(&drain->lock);
+#else
+    pthread_mutex_destroy(&drain->lock);
+#endif
+    free(drain->lines);
+    free(drain->spare);
+    free(drain->sources);
+    *drain = (fip_log_drain_t){0};
+}
+
+/// @function `fip_master_add_slave`
+/// @brief Returns the descriptor of the slave with the given id, growing the
+/// slave descriptors and the response slots if needed. A new descriptor is
+/// zero-initialized
+///
+/// @param `id` The id of the slave (its index in the descriptor table)
+/// @return `fip_slave_t *` The descriptor of the slave
+fip_slave_t *fip_master_add_slave(const uint32_t id) {
+    if (id >= master_state.slave_capacity) {
+        uint32_t capacity = master_state.slave_capacity == 0 //
+            ? 4                                              //
+            : master_state.slave_capacity * 2;
+        while (capacity <= id) {
+            capacity *= 2;
+        }
+        master_state.slaves = (fip_slave_t *)realloc( //
+            master_state.slaves, sizeof(fip_slave_t) * capacity);
+        master_state.responses = (fip_msg_t *)realloc( //
+            master_state.responses, sizeof(fip_msg_t) * capacity);
+        master_state.response_ids = (uint32_t *)realloc( //
+            master_state.response_ids, sizeof(uint32_t) * capacity);
+        memset(&master_state.responses[master_state.slave_capacity], 0,
+            sizeof(fip_msg_t) * (capacity - master_state.slave_capacity));
+        master_state.slave_capacity = capacity;
+    }
+    fip_slave_t *slave = &master_state.slaves[id];
+    memset(slave, 0, sizeof(fip_slave_t));
+    slave->inbox.peer = id + 1;
+    slave->outbox.peer = id + 1;
+    // The connect request of the slave is its response to being spawned
+    slave->request_ms = fip_now_ms();
+    return slave;
+}
+
+/// @function `fip_interop_modules_add_pid`
+/// @brief Adds the PID of a newly spawned module to the list of modules
+void fip_interop_modules_add_pid(fip_interop_modules_t *modules, pid_t pid) {
+    if (modules->active_count == modules->capacity) {
+        modules->capacity = modules->capacity == 0 ? 4 : modules->capacity * 2;
+        modules->pids = (pid_t *)realloc( //
+            modules->pids, sizeof(pid_t) * modules->capacity);
+    }
+    modules->pids[modules->active_count] = pid;
+}
+
+/// @function `fip_interop_modules_free`
+/// @brief Frees the PID list of the given modules
+void fip_interop_modules_free(fip_interop_modules_t *modules) {
+    free(modules->pids);
+    modules->pids = NULL;
+    modules->active_count = 0;
+    modules->capacity = 0;
+}
+
+/// @function `fip_master_free_slaves`
+/// @brief Frees the slave descriptors and the response slots of the master
+void fip_master_free_slaves() {
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
+        fip_free_msg(&master_state.responses[i]);
+    }
+    free(master_state.slaves);
+    free(master_state.responses);
+    free(master_state.response_ids);
+    master_state.slaves = NULL;
+    master_state.responses = NULL;
+    master_state.response_ids = NULL;
+    master_state.slave_count = 0;
+    master_state.slave_capacity = 0;
+    master_state.response_count = 0;
+}
+
+void fip_gather_set_add(fip_gather_set_t *set, const uint32_t id) {
+    if (set->count == set->capacity) {
+        set->capacity = set->capacity == 0 ? 4 : set->capacity * 2;
+        set->ids = (uint32_t *)realloc( //
+            set->ids, sizeof(uint32_t) * set->capacity);
+    }
+    set->ids[set->count++] = id;
+}
+
+void fip_gather_set_free(fip_gather_set_t *set) {
+    free(set->ids);
+    set->ids = NULL;
+    set->count = 0;
+    set->capacity = 0;
+}
+
+/// @function `fip_gather_set_size`
+/// @brief Returns the number of slaves in the set, `NULL` being all slaves
+static inline uint32_t fip_gather_set_size(const fip_gather_set_t *set) {
+    return set == NULL ? master_state.slave_count : set->count;
+}
+
+/// @function `fip_gather_set_id`
+/// @brief Returns the id of the slave at the given index of the set
+static inline uint32_t fip_gather_set_id( //
+    const fip_gather_set_t *set,          //
+    const uint32_t idx                    //
+) {
+    return set == NULL ? idx : set->ids[idx];
+}
+
+/// @function `fip_master_send_encoded`
+/// @brief Sends the already encoded message in the buffer to the given slave
+///
+/// @return `bool` Whether the message could be written
+bool fip_master_send_encoded(const uint32_t id, const char *buffer) {
+    fip_slave_t *slave = &master_state.slaves[id];
+    if (slave->in == NULL) {
+        return false;
+    }
+    fip_outbox_push(&slave->outbox, buffer);
+    slave->request_ms = fip_now_ms();
+    if (!fip_outbox_flush(&slave->outbox, slave->in)) {
+        fip_print(0, FIP_WARN, "Failed to write message to slave %u", id + 1);
+        fip_outbox_clear(&slave->outbox);
+        return false;
+    }
+    fip_print(0, FIP_DEBUG, "Sent message to slave %u", id + 1);
+    return true;
+}
+
+void fip_master_broadcast_message( //
+    char buffer[FIP_MSG_SIZE],     //
+    const fip_msg_t *message       //
+) {
+    fip_master_send_to_set(buffer, NULL, message);
+}
+
+void fip_master_send_to_set(     //
+    char buffer[FIP_MSG_SIZE],   //
+    const fip_gather_set_t *set, //
+    const fip_msg_t *message     //
+) {
+    const uint32_t count = fip_gather_set_size(set);
+    fip_print(0, FIP_INFO, "Broadcasting message to %u slaves", count);
+    fip_encode_msg(buffer, message);
+    for (uint32_t i = 0; i < count; i++) {
+        fip_master_send_encoded(fip_gather_set_id(set, i), buffer);
+    }
+}
+
+void fip_master_free_config(fip_master_config_t *config) {
+    for (uint32_t i = 0; i < config->enabled_count; i++) {
+        free(config->enabled_modules[i]);
+    }
+    free(config->enabled_modules);
+    config->enabled_modules = NULL;
+    config->enabled_count = 0;
+}
+
+/// @function `fip_master_config_add_module`
+/// @brief Adds the module of the given name to the enabled modules of the
+/// config
+void fip_master_config_add_module( //
+    fip_master_config_t *config,   //
+    const char *module_name        //
+) {
+    config->enabled_modules = (char **)realloc(   //
+        config->enabled_modules,                  //
+        sizeof(char *) * (config->enabled_count + 1) //
+    );
+    const size_t len = strlen(module_name);
+    char *name = (char *)malloc(len + 1);
+    memcpy(name, module_name, len + 1);
+    config->enabled_modules[config->enabled_count++] = name;
+}
+
+bool fip_master_symbol_request( //
+    char buffer[FIP_MSG_SIZE],  //
+    const fip_msg_t *message    //
+) {
+    assert(message->type == FIP_MSG_SYMBOL_REQUEST);
+    fip_encode_msg(buffer, message);
+    return fip_master_symbol_request_encoded(buffer, buffer);
+}
+
+bool fip_master_symbol_request_encoded( //
+    char buffer[FIP_MSG_SIZE],          //
+    const char *encoded                 //
+) {
+    assert(encoded[4] == FIP_MSG_SYMBOL_REQUEST);
+    fip_print(0, FIP_INFO, "Broadcasting message to %u slaves",
+        master_state.slave_count);
+    for (uint32_t i = 0; i < master_state.slave_count; i++) {
+        fip_master_send_encoded(i, encoded);
+    }
+    const uint32_t wrong_msg_count =
+        fip_master_await_responses(buffer, NULL, FIP_MSG_SYMBOL_RESPONSE);
+    if (wrong_msg_count > 0) {
+        fip_print(0, FIP_WARN, "Received %u wrong messages", wrong_msg_count);
+    }
+
+    bool symbol_found = false;
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
+        fip_print_msg(0, &master_state.responses[i]);
+        if (master_state.responses[i].type == FIP_MSG_SYMBOL_RESPONSE &&
+            master_state.responses[i].u.sym_res.found) {
+            symbol_found = true;
+            // The slave will compile the sources containing the symbol
+            master_state.slaves[master_state.response_ids[i]].has_needed = true;
+        }
+    }
+
+    if (symbol_found) {
+        fip_print(0, FIP_INFO, "Requested symbol found");
+    } else {
+        fip_print(0, FIP_WARN, "Requested symbol not found");
+    }
+    return symbol_found;
 }
 
 bool fip_master_compile_request( //
@@ -2965,19 +4529,26 @@ bool fip_master_compile_request( //
     const fip_msg_t *message     //
 ) {
     assert(message->type == FIP_MSG_COMPILE_REQUEST);
-    fip_master_broadcast_message(buffer, message);
-    uint8_t wrong_msg_count =
-        fip_master_await_responses(buffer, master_state.responses,
-            &master_state.response_count, FIP_MSG_OBJECT_RESPONSE);
+    // Only the slaves whose symbols are used have anything to compile
+    fip_gather_set_t targets = {0};
+    for (uint32_t i = 0; i < master_state.slave_count; i++) {
+        if (master_state.slaves[i].has_needed) {
+            fip_gather_set_add(&targets, i);
+        }
+    }
+    fip_master_send_to_set(buffer, &targets, message);
+    const uint32_t wrong_msg_count =
+        fip_master_await_responses(buffer, &targets, FIP_MSG_OBJECT_RESPONSE);
+    fip_gather_set_free(&targets);
     if (wrong_msg_count > 0) {
         fip_print(0, FIP_WARN, "Received %u faulty messages", wrong_msg_count);
     }
 
-    for (uint8_t i = 0; i < master_state.response_count; i++) {
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
         const fip_msg_t *response = &master_state.responses[i];
         if (response->type != FIP_MSG_OBJECT_RESPONSE) {
-            fip_print(0, FIP_ERROR, "Wrong message as response from slave %d",
-                i);
+            fip_print(0, FIP_ERROR, "Wrong message as response from slave %u",
+                master_state.response_ids[i] + 1);
             return false;
         }
         if (response->u.obj_res.has_obj) {
@@ -2999,10 +4570,8 @@ fip_tag_request_result_t fip_master_tag_request( //
     fip_master_broadcast_message(buffer, message);
 
     // Await which slave has the tag
-    uint8_t wrong_msg_count = fip_master_await_responses( //
-        buffer, master_state.responses,                   //
-        &master_state.response_count,                     //
-        FIP_MSG_TAG_PRESENT_RESPONSE                      //
+    const uint32_t wrong_msg_count = fip_master_await_responses( //
+        buffer, NULL, FIP_MSG_TAG_PRESENT_RESPONSE               //
     );
     if (wrong_msg_count > 0) {
         fip_print(0, FIP_ERROR, "Received %u faulty messages", wrong_msg_count);
@@ -3012,13 +4581,13 @@ fip_tag_request_result_t fip_master_tag_request( //
         };
     }
 
-    uint8_t module_with_tag_count = 0;
-    uint8_t module_with_tag_id = 0;
-    for (uint8_t i = 0; i < master_state.response_count; i++) {
+    uint32_t module_with_tag_count = 0;
+    uint32_t module_with_tag_id = 0;
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
         assert(master_state.responses[i].type == FIP_MSG_TAG_PRESENT_RESPONSE);
         if (master_state.responses[i].u.tag_pres_res.is_present) {
             module_with_tag_count++;
-            module_with_tag_id = i;
+            module_with_tag_id = master_state.response_ids[i];
         }
     }
 
@@ -3029,140 +4598,532 @@ fip_tag_request_result_t fip_master_tag_request( //
             .list = NULL,
         };
     }
-    if (module_with_tag_count > 1) {
-        fip_print(                                              //
-            0, FIP_ERROR, "Tag %s present in more than one IM", //
-            message->u.tag_req.tag                              //
-        );
-        return (fip_tag_request_result_t){
-            .status = FIP_TAG_REQUEST_STATUS_ERR_AMBIGUOUS_TAG,
-            .list = NULL,
-        };
+    if (module_with_tag_count > 1) {
+        fip_print(                                              //
+            0, FIP_ERROR, "Tag %s present in more than one IM", //
+            message->u.tag_req.tag                              //
+        );
+        return (fip_tag_request_result_t){
+            .status = FIP_TAG_REQUEST_STATUS_ERR_AMBIGUOUS_TAG,
+            .list = NULL,
+        };
+    }
+
+    // The slave with the tag compiles the tag's sources from now on
+    const uint32_t slave_index = module_with_tag_id;
+    master_state.slaves[slave_index].has_needed = true;
+
+    // We keep sending `FIP_MSG_TAG_NEXT_SYMBOL_REQUEST` to the slave and we
+    // will recieve `FIP_MSG_TAG_SYMBOL_RESPONSE` messages from the slave until
+    // the symbol is empty, indicating the end of the list. We first tell the
+    // slave to "give" us the next message, then it sends the message contianing
+    // the empty symbol.
+    fip_sig_list_t *sig_list = (fip_sig_list_t *)malloc(sizeof(fip_sig_list_t));
+    sig_list->count = 0;
+    while (true) {
+        // Send the next symbol request message to the slave
+        fip_msg_t request;
+        memset(&request, 0, sizeof(fip_msg_t));
+        request.type = FIP_MSG_TAG_NEXT_SYMBOL_REQUEST;
+        fip_encode_msg(buffer, &request);
+        if (!fip_master_send_encoded(slave_index, buffer)) {
+            fip_print(0, FIP_ERROR, "Failed to write message to slave");
+            return (fip_tag_request_result_t){
+                .status = FIP_TAG_REQUEST_STATUS_ERR_WRITE,
+                .list = sig_list,
+            };
+        }
+
+        // Wait for the response of the slave
+        if (!fip_master_await_message_from(module_with_tag_id, buffer,
+                FIP_MSG_TAG_SYMBOL_RESPONSE)) {
+            fip_print_slave_streams();
+            fip_print(0, FIP_ERROR, "No symbol response from slave %u",
+                slave_index + 1);
+            return (fip_tag_request_result_t){
+                .status = FIP_TAG_REQUEST_STATUS_ERR_FAULTY,
+                .list = sig_list,
+            };
+        }
+        fip_print_slave_streams();
+
+        // Decode the slave's message
+        fip_msg_t incoming;
+        fip_decode_msg(buffer, &incoming);
+        if (incoming.type != FIP_MSG_TAG_SYMBOL_RESPONSE) {
+            fip_print(0, FIP_ERROR,
+                "Received unexpected response from slave %u: %s (expected %s)",
+                slave_index + 1, fip_msg_type_str[incoming.type],
+                fip_msg_type_str[FIP_MSG_TAG_SYMBOL_RESPONSE]);
+            fip_print_slave_streams();
+            break;
+        }
+        // Handle end of symbol list
+        if (incoming.u.tag_sym_res.is_empty) {
+            fip_print(0, FIP_DEBUG, "Slave %u indicated end of symbol list",
+                slave_index + 1);
+            fip_free_msg(&incoming);
+            break;
+        }
+        // Append a new entry to sig_list
+        sig_list = (fip_sig_list_t *)realloc(sig_list,    //
+            sizeof(fip_sig_list_t) +                      //
+                sizeof(fip_sig_t) * (sig_list->count + 1) //
+        );
+        // Pointer to the freshly appended fip_sig_t
+        fip_sig_t *const last_sig = &sig_list->sigs[sig_list->count];
+        memset(last_sig, 0, sizeof(fip_sig_t));
+        // Store the symbol type
+        last_sig->type = incoming.u.tag_sym_res.type;
+        last_sig->abi_changed = incoming.u.tag_sym_res.abi_changed;
+        last_sig->fingerprint = incoming.u.tag_sym_res.fingerprint;
+        fip_clone_sig(                                  //
+            incoming.u.tag_sym_res.type,                //
+            &last_sig->sig, &incoming.u.tag_sym_res.sig //
+        );
+        sig_list->count++;
+        fip_free_msg(&incoming);
+    }
+    return (fip_tag_request_result_t){
+        .status = FIP_TAG_REQUEST_STATUS_OK,
+        .list = sig_list,
+    };
+}
+
+bool fip_master_receive_message_from(uint32_t id, char buffer[FIP_MSG_SIZE]) {
+    if (id >= master_state.slave_count || !master_state.slaves[id].out) {
+        fip_print(0, FIP_ERROR, "Cannot receive msg from nonexistent slave %u",
+            id);
+        return false;
+    }
+    FILE *slave_stdout = master_state.slaves[id].out;
+    // Messages of higher-priority lanes are always received first
+    fip_inbox_t *inbox = &master_state.slaves[id].inbox;
+    while (!fip_inbox_pop(inbox, FIP_LANE_BULK, buffer) ||
+        fip_master_take_progress(id, buffer) ||
+        fip_master_take_change(id, buffer)) {
+        if (!fip_inbox_fill(inbox, slave_stdout, -1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool fip_master_await_message_from(        //
+    uint32_t id,                           //
+    char buffer[FIP_MSG_SIZE],             //
+    const fip_msg_type_e expected_msg_type //
+) {
+    if (id >= master_state.slave_count || !master_state.slaves[id].out) {
+        fip_print(0, FIP_ERROR, "Cannot receive msg from nonexistent slave %u",
+            id);
+        return false;
+    }
+    fip_slave_t *slave = &master_state.slaves[id];
+    FILE *slave_stdout = slave->out;
+    fip_inbox_t *inbox = &slave->inbox;
+    // The deadline runs from sending the request, every progress message of
+    // the slave starts a new one. Once it passed, the messages already waiting
+    // in the pipe are still read before giving up
+    double deadline_start = slave->request_ms;
+    const uint32_t deadline_ms = fip_master_deadline_ms(id, expected_msg_type);
+    bool is_late = false;
+    while (true) {
+        if (fip_inbox_pop(inbox, FIP_LANE_BULK, buffer)) {
+            if (fip_master_take_change(id, buffer)) {
+                continue;
+            }
+            if (fip_master_take_progress(id, buffer)) {
+                deadline_start = fip_now_ms();
+                is_late = false;
+                continue;
+            }
+            fip_master_record_response(id, expected_msg_type);
+            return true;
+        }
+        const double elapsed = fip_now_ms() - deadline_start;
+        if (is_late) {
+            fip_print(0, FIP_WARN,
+                "Timeout waiting for slave %u after %.0f ms (deadline %u ms)",
+                id + 1, elapsed, deadline_ms);
+            fip_master_record_response(id, expected_msg_type);
+            return false;
+        }
+        is_late = elapsed >= (double)deadline_ms;
+        const int remaining_ms = is_late //
+            ? 0                          //
+            : (int)((double)deadline_ms - elapsed) + 1;
+        if (!fip_inbox_fill(inbox, slave_stdout, remaining_ms)) {
+            return false;
+        }
+    }
+}
+
+bool fip_master_take_progress(uint32_t id, const char buffer[FIP_MSG_SIZE]) {
+    if ((fip_msg_type_e)buffer[0] != FIP_MSG_PROGRESS) {
+        return false;
+    }
+    fip_msg_t progress;
+    fip_decode_msg(buffer, &progress);
+    fip_print(0, FIP_DEBUG, "Slave %u progress: %u / %u", id + 1,
+        progress.u.progress.done, progress.u.progress.total);
+    return true;
+}
+
+bool fip_master_take_change(uint32_t id, const char buffer[FIP_MSG_SIZE]) {
+    if ((fip_msg_type_e)buffer[0] != FIP_MSG_CHANGE_NOTIFICATION) {
+        return false;
+    }
+    uint32_t *capacity = &master_state.change_capacity;
+    if (master_state.change_count == *capacity) {
+        *capacity = *capacity == 0 ? 16 : *capacity * 2;
+        master_state.changes = (fip_msg_change_notification_t *)realloc( //
+            master_state.changes,                                        //
+            sizeof(fip_msg_change_notification_t) * *capacity            //
+        );
+    }
+    fip_msg_t change;
+    fip_decode_msg(buffer, &change);
+    fip_print(0, FIP_DEBUG, "Slave %u changed symbol '%s' of tag '%s'", id + 1,
+        change.u.change.symbol, change.u.change.tag);
+    master_state.changes[master_state.change_count++] = change.u.change;
+    return true;
+}
+
+void fip_master_subscribe(char buffer[FIP_MSG_SIZE], const fip_msg_t *message) {
+    assert(message->type == FIP_MSG_SUBSCRIBE_REQUEST);
+    fip_master_broadcast_message(buffer, message);
+}
+
+uint32_t fip_master_poll_changes( //
+    char buffer[FIP_MSG_SIZE],    //
+    const uint32_t timeout_ms     //
+) {
+    const double start = fip_now_ms();
+    while (true) {
+        for (uint32_t i = 0; i < master_state.slave_count; i++) {
+            fip_slave_t *slave = &master_state.slaves[i];
+            if (!slave->out || !fip_inbox_fill(&slave->inbox, slave->out, 0)) {
+                continue;
+            }
+            while (fip_inbox_pop(&slave->inbox, FIP_LANE_BULK, buffer)) {
+                if (fip_master_take_change(i, buffer) ||
+                    fip_master_take_progress(i, buffer)) {
+                    continue;
+                }
+                fip_print(0, FIP_WARN, "Dropping unexpected %s of slave %u",
+                    fip_msg_type_str[(uint8_t)buffer[0] % FIP_MSG_TYPE_COUNT],
+                    i + 1);
+            }
+        }
+        if (master_state.change_count > 0 ||
+            fip_now_ms() - start >= (double)timeout_ms) {
+            break;
+        }
+        msleep(FIP_SLAVE_DELAY_MS);
+    }
+    fip_print_slave_streams();
+    return master_state.change_count;
+}
+
+bool fip_master_next_change(fip_msg_change_notification_t *change) {
+    if (master_state.change_count == 0) {
+        return false;
+    }
+    *change = master_state.changes[0];
+    master_state.change_count--;
+    memmove(master_state.changes, master_state.changes + 1,
+        sizeof(fip_msg_change_notification_t) * master_state.change_count);
+    return true;
+}
+
+bool fip_sig_list_invalidate(                   //
+    fip_sig_list_t *list,                       //
+    const fip_msg_change_notification_t *change //
+) {
+    if (list == NULL) {
+        return false;
+    }
+    bool found = false;
+    for (size_t i = 0; i < list->count; i++) {
+        fip_sig_t *sig = &list->sigs[i];
+        if (strcmp(fip_sig_name(sig->type, &sig->sig), change->symbol) != 0) {
+            continue;
+        }
+        fip_free_sig(sig->type, &sig->sig);
+        sig->type = FIP_SYM_UNKNOWN;
+        found = true;
+    }
+    return found;
+}
+
+fip_usage_list_t *fip_master_usage_request( //
+    char buffer[FIP_MSG_SIZE],              //
+    const fip_msg_t *message                //
+) {
+    assert(message->type == FIP_MSG_USAGE_REQUEST);
+    fip_master_broadcast_message(buffer, message);
+    fip_usage_list_t *list =
+        (fip_usage_list_t *)malloc(sizeof(fip_usage_list_t));
+    list->count = 0;
+    // Every slave streams its entries until it sends the empty usage response,
+    // so the slaves are read one after another
+    for (uint32_t i = 0; i < master_state.slave_count; i++) {
+        while (true) {
+            if (!fip_master_await_message_from(i, buffer,
+                    FIP_MSG_USAGE_RESPONSE)) {
+                fip_print_slave_streams();
+                fip_print(0, FIP_ERROR, "No usage response from slave %u",
+                    i + 1);
+                fip_free_usage_list(list);
+                return NULL;
+            }
+            fip_msg_t incoming;
+            fip_decode_msg(buffer, &incoming);
+            if (incoming.type != FIP_MSG_USAGE_RESPONSE) {
+                fip_print(0, FIP_ERROR,
+                    "Received unexpected response from slave %u: %s", i + 1,
+                    fip_msg_type_str[incoming.type]);
+                fip_free_msg(&incoming);
+                fip_free_usage_list(list);
+                return NULL;
+            }
+            if (incoming.u.usage_res.is_empty) {
+                break;
+            }
+            // The entry takes over the signature of the decoded message
+            list = (fip_usage_list_t *)realloc(list,                     //
+                sizeof(fip_usage_list_t) +                               //
+                    sizeof(fip_msg_usage_response_t) * (list->count + 1) //
+            );
+            list->entries[list->count++] = incoming.u.usage_res;
+        }
+    }
+    fip_print_slave_streams();
+    return list;
+}
+
+void fip_free_usage_list(fip_usage_list_t *list) {
+    if (list == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < list->count; i++) {
+        fip_free_sig(list->entries[i].type, &list->entries[i].sig);
+    }
+    free(list);
+}
+
+uint32_t fip_master_cleanup_request( //
+    char buffer[FIP_MSG_SIZE],       //
+    const fip_msg_t *message         //
+) {
+    assert(message->type == FIP_MSG_CLEANUP_REQUEST);
+    fip_master_broadcast_message(buffer, message);
+    const uint32_t wrong_msg_count =
+        fip_master_await_responses(buffer, NULL, FIP_MSG_CLEANUP_RESPONSE);
+    if (wrong_msg_count > 0) {
+        fip_print(0, FIP_WARN, "Received %u faulty messages", wrong_msg_count);
+    }
+    uint32_t removed_count = 0;
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
+        const fip_msg_t *response = &master_state.responses[i];
+        if (response->type != FIP_MSG_CLEANUP_RESPONSE) {
+            continue;
+        }
+        fip_print(0, FIP_INFO, "Module %s removed %u objects (%llu bytes)",
+            response->u.clean_res.module_name,
+            response->u.clean_res.removed_count,
+            (unsigned long long)response->u.clean_res.removed_bytes);
+        removed_count += response->u.clean_res.removed_count;
+    }
+    return removed_count;
+}
+
+/// @var `fip_deadline_defaults`
+/// @brief The default deadline bounds, indexed by the expected message type
+const fip_deadline_bounds_t fip_deadline_defaults[] = {
+    {1000, 100, 10000},    // FIP_MSG_UNKNOWN
+    {5000, 500, 30000},    // FIP_MSG_CONNECT_REQUEST
+    {1000, 100, 10000},    // FIP_MSG_SYMBOL_REQUEST
+    {1000, 100, 10000},    // FIP_MSG_SYMBOL_RESPONSE
+    {1000, 100, 10000},    // FIP_MSG_COMPILE_REQUEST
+    {30000, 5000, 600000}, // FIP_MSG_OBJECT_RESPONSE
+    {1000, 100, 10000},    // FIP_MSG_TAG_REQUEST
+    {10000, 500, 60000},   // FIP_MSG_TAG_PRESENT_RESPONSE
+    {1000, 100, 10000},    // FIP_MSG_TAG_NEXT_SYMBOL_REQUEST
+    {1000, 100, 10000},    // FIP_MSG_TAG_SYMBOL_RESPONSE
+    {1000, 100, 10000},    // FIP_MSG_SUBSCRIBE_REQUEST
+    {1000, 100, 10000},    // FIP_MSG_CHANGE_NOTIFICATION
+    {1000, 100, 10000},    // FIP_MSG_USAGE_REQUEST
+    {1000, 100, 10000},    // FIP_MSG_USAGE_RESPONSE
+    {1000, 100, 10000},    // FIP_MSG_CLEANUP_REQUEST
+    {10000, 500, 60000},   // FIP_MSG_CLEANUP_RESPONSE
+    {1000, 100, 10000},    // FIP_MSG_PROGRESS
+    {1000, 100, 10000},    // FIP_MSG_KILL
+};
+
+fip_deadline_bounds_t fip_master_deadline_bounds(const fip_msg_type_e type) {
+    if (type >= FIP_MSG_TYPE_COUNT) {
+        return fip_deadline_defaults[FIP_MSG_UNKNOWN];
+    }
+    fip_deadline_bounds_t bounds = fip_deadline_defaults[type];
+    const fip_deadline_bounds_t *custom = &master_state.deadlines[type];
+    if (custom->initial_ms > 0) {
+        bounds.initial_ms = custom->initial_ms;
+    }
+    if (custom->floor_ms > 0) {
+        bounds.floor_ms = custom->floor_ms;
+    }
+    if (custom->ceiling_ms > 0) {
+        bounds.ceiling_ms = custom->ceiling_ms;
+    }
+    if (bounds.ceiling_ms < bounds.floor_ms) {
+        bounds.ceiling_ms = bounds.floor_ms;
+    }
+    return bounds;
+}
+
+uint32_t fip_master_deadline_ms(const uint32_t id, const fip_msg_type_e type) {
+    const fip_deadline_bounds_t bounds = fip_master_deadline_bounds(type);
+    double deadline = (double)bounds.initial_ms;
+    if (id < master_state.slave_count && type < FIP_MSG_TYPE_COUNT) {
+        const fip_latency_stats_t *stats =
+            &master_state.slaves[id].latencies[type];
+        if (stats->samples > 0) {
+            deadline = stats->mean_ms +
+                FIP_DEVIATION_FACTOR * stats->deviation_ms;
+        }
+    }
+    if (deadline < (double)bounds.floor_ms) {
+        deadline = (double)bounds.floor_ms;
+    }
+    if (deadline > (double)bounds.ceiling_ms) {
+        deadline = (double)bounds.ceiling_ms;
+    }
+    return (uint32_t)deadline;
+}
+
+void fip_master_record_latency( //
+    const uint32_t id,          //
+    const fip_msg_type_e type,  //
+    const double latency_ms     //
+) {
+    if (id >= master_state.slave_count || type >= FIP_MSG_TYPE_COUNT) {
+        return;
+    }
+    fip_latency_stats_t *stats = &master_state.slaves[id].latencies[type];
+    if (stats->samples == 0) {
+        stats->mean_ms = latency_ms;
+        stats->deviation_ms = latency_ms / 2.0;
+    } else {
+        const double error = latency_ms - stats->mean_ms;
+        const double abs_error = error < 0.0 ? -error : error;
+        stats->deviation_ms +=
+            FIP_DEVIATION_GAIN * (abs_error - stats->deviation_ms);
+        stats->mean_ms += FIP_LATENCY_GAIN * error;
     }
+    stats->samples++;
+}
 
-    // Get the stdout and stdin of the slave we got the tag id from
-    uint8_t slave_index = module_with_tag_id;
-    FILE *slave_in = master_state.slave_stdin[module_with_tag_id];
+void fip_master_record_response(const uint32_t id, const fip_msg_type_e type) {
+    fip_slave_t *slave = &master_state.slaves[id];
+    const double now = fip_now_ms();
+    fip_master_record_latency(id, type, now - slave->request_ms);
+    slave->request_ms = now;
+}
 
-    // We keep sending `FIP_MSG_TAG_NEXT_SYMBOL_REQUEST` to the slave and we
-    // will recieve `FIP_MSG_TAG_SYMBOL_RESPONSE` messages from the slave until
-    // the symbol is empty, indicating the end of the list. We first tell the
-    // slave to "give" us the next message, then it sends the message contianing
-    // the empty symbol.
-    fip_sig_list_t *sig_list = (fip_sig_list_t *)malloc(sizeof(fip_sig_list_t));
-    sig_list->count = 0;
-    while (true) {
-        // Send the next symbol request message to the slave
-        fip_msg_t request;
-        memset(&request, 0, sizeof(fip_msg_t));
-        request.type = FIP_MSG_TAG_NEXT_SYMBOL_REQUEST;
-        fip_encode_msg(buffer, &request);
-        uint32_t msg_len;
-        memcpy(&msg_len, buffer, sizeof(uint32_t));
-        size_t written_bytes = fwrite(buffer, 1, msg_len + 4, slave_in);
-        if (written_bytes != msg_len + 4) {
-            fip_print(0, FIP_ERROR, "Failed to write message to slave");
-            return (fip_tag_request_result_t){
-                .status = FIP_TAG_REQUEST_STATUS_ERR_WRITE,
-                .list = sig_list,
-            };
-        }
-        fflush(slave_in);
+void fip_master_set_deadlines(const fip_master_config_t *config) {
+    memcpy(master_state.deadlines, config->deadlines,
+        sizeof(master_state.deadlines));
+}
 
-        // Wait for the response of the slave
-        // Simple timeout using non-blocking read
-        while (!fip_master_receive_message_from(module_with_tag_id, buffer)) {
-            fip_print_slave_streams();
-            fip_print(0, FIP_WARN, "No message from slave %u yet...",
-                module_with_tag_id);
+/// @function `fip_master_load_deadline_bounds`
+/// @brief Loads the `initial_ms`, `floor_ms` and `ceiling_ms` fields of the
+/// given table into the given bounds, missing fields are left untouched
+void fip_master_load_deadline_bounds( //
+    const toml_datum_t table,         //
+    fip_deadline_bounds_t *bounds     //
+) {
+    const char *keys[3] = {"initial_ms", "floor_ms", "ceiling_ms"};
+    uint32_t *values[3] = {
+        &bounds->initial_ms, &bounds->floor_ms, &bounds->ceiling_ms
+    };
+    for (uint8_t i = 0; i < 3; i++) {
+        toml_datum_t value = toml_get(table, keys[i]);
+        if (value.type != TOML_INT64) {
+            continue;
         }
-        fip_print_slave_streams();
-
-        // Decode the slave's message
-        fip_msg_t incoming;
-        fip_decode_msg(buffer, &incoming);
-        if (incoming.type != FIP_MSG_TAG_SYMBOL_RESPONSE) {
-            fip_print(0, FIP_ERROR,
-                "Received unexpected response from slave %u: %s (expected %s)",
-                slave_index + 1, fip_msg_type_str[incoming.type],
-                fip_msg_type_str[FIP_MSG_TAG_SYMBOL_RESPONSE]);
-            fip_print_slave_streams();
-            break;
+        if (value.u.int64 <= 0 || value.u.int64 > UINT32_MAX) {
+            fip_print(0, FIP_WARN, "Ignoring invalid deadline %s = %lld",
+                keys[i], (long long)value.u.int64);
+            continue;
         }
-        // Handle end of symbol list
-        if (incoming.u.tag_sym_res.is_empty) {
-            fip_print(0, FIP_DEBUG, "Slave %u indicated end of symbol list",
-                slave_index + 1);
-            fip_free_msg(&incoming);
-            break;
+        *values[i] = (uint32_t)value.u.int64;
+    }
+}
+
+/// @function `fip_master_load_deadlines`
+/// @brief Loads the `[deadlines]` table of the `fip.toml` file. The fields of
+/// the table itself apply to all message types, the `connect`, `symbol`, `tag`,
+/// `compile` and `usage` sub-tables override them for the responses of those
+/// requests
+void fip_master_load_deadlines( //
+    const toml_datum_t toptab,  //
+    fip_master_config_t *config //
+) {
+    toml_datum_t deadlines = toml_get(toptab, "deadlines");
+    if (deadlines.type != TOML_TABLE) {
+        return;
+    }
+    fip_deadline_bounds_t common = {0};
+    fip_master_load_deadline_bounds(deadlines, &common);
+    for (uint8_t i = 0; i < FIP_MSG_TYPE_COUNT; i++) {
+        config->deadlines[i] = common;
+    }
+    const struct {
+        const char *name;
+        fip_msg_type_e types[2];
+    } sections[] = {
+        {"connect", {FIP_MSG_CONNECT_REQUEST, FIP_MSG_CONNECT_REQUEST}},
+        {"symbol", {FIP_MSG_SYMBOL_RESPONSE, FIP_MSG_SYMBOL_RESPONSE}},
+        {"tag", {FIP_MSG_TAG_PRESENT_RESPONSE, FIP_MSG_TAG_SYMBOL_RESPONSE}},
+        {"compile", {FIP_MSG_OBJECT_RESPONSE, FIP_MSG_OBJECT_RESPONSE}},
+        {"usage", {FIP_MSG_USAGE_RESPONSE, FIP_MSG_CLEANUP_RESPONSE}},
+    };
+    for (uint8_t i = 0; i < sizeof(sections) / sizeof(sections[0]); i++) {
+        toml_datum_t section = toml_get(deadlines, sections[i].name);
+        if (section.type != TOML_TABLE) {
+            continue;
         }
-        // Append a new entry to sig_list
-        sig_list = (fip_sig_list_t *)realloc(sig_list,    //
-            sizeof(fip_sig_list_t) +                      //
-                sizeof(fip_sig_t) * (sig_list->count + 1) //
-        );
-        // Pointer to the freshly appended fip_sig_t
-        fip_sig_t *const last_sig = &sig_list->sigs[sig_list->count];
-        memset(last_sig, 0, sizeof(fip_sig_t));
-        // Store the symbol type
-        last_sig->type = incoming.u.tag_sym_res.type;
-        switch (incoming.u.tag_sym_res.type) {
-            case FIP_SYM_UNKNOWN:
-                break;
-            case FIP_SYM_FUNCTION: {
-                fip_clone_sig_fn(                                     //
-                    &last_sig->sig.fn, &incoming.u.tag_sym_res.sig.fn //
-                );
-                break;
-            }
-            case FIP_SYM_DATA: {
-                fip_clone_sig_data(                                       //
-                    &last_sig->sig.data, &incoming.u.tag_sym_res.sig.data //
-                );
-                break;
-            }
-            case FIP_SYM_ENUM: {
-                fip_clone_sig_enum( //
-                    &last_sig->sig.enum_t,
-                    &incoming.u.tag_sym_res.sig.enum_t //
-                );
-                break;
-            }
-            case FIP_SYM_OPAQUE: {
-                fip_clone_sig_opaque(                  //
-                    &last_sig->sig.opaque,             //
-                    &incoming.u.tag_sym_res.sig.opaque //
-                );
-                break;
-            }
+        for (uint8_t j = 0; j < 2; j++) {
+            fip_master_load_deadline_bounds(                   //
+                section, &config->deadlines[sections[i].types[j]] //
+            );
         }
-        sig_list->count++;
-        fip_free_msg(&incoming);
     }
-    return (fip_tag_request_result_t){
-        .status = FIP_TAG_REQUEST_STATUS_OK,
-        .list = sig_list,
-    };
 }
 
-bool fip_master_receive_message_from(uint32_t id, char buffer[FIP_MSG_SIZE]) {
-    FILE *slave_stdout = master_state.slave_stdout[id];
-    if (slave_stdout == NULL) {
-        fip_print(0, FIP_ERROR, "Cannot receive msg from nonexistent slave %u",
-            id);
-    }
-    uint32_t msg_len;
-    if (fread(&msg_len, 1, 4, slave_stdout) != 4) {
-        return false;
+/// @function `fip_master_load_usage`
+/// @brief Loads the `[usage]` table of the `fip.toml` file, its `prefetch`
+/// field is the number of the most used symbols fetched after connecting
+void fip_master_load_usage(     //
+    const toml_datum_t toptab,  //
+    fip_master_config_t *config //
+) {
+    toml_datum_t usage = toml_get(toptab, "usage");
+    if (usage.type != TOML_TABLE) {
+        return;
     }
-    if (msg_len == 0 || msg_len > FIP_MSG_SIZE - 4) {
-        return false;
+    toml_datum_t prefetch = toml_get(usage, "prefetch");
+    if (prefetch.type != TOML_INT64) {
+        return;
     }
-    memset(buffer, 0, FIP_MSG_SIZE);
-    if (fread(buffer, 1, msg_len, slave_stdout) != msg_len) {
-        return false;
+    if (prefetch.u.int64 < 0 || prefetch.u.int64 > UINT32_MAX) {
+        fip_print(0, FIP_WARN, "Ignoring invalid prefetch = %lld",
+            (long long)prefetch.u.int64);
+        return;
     }
-    return true;
+    config->prefetch_count = (uint32_t)prefetch.u.int64;
 }
 
 void fip_master_send_message_to( //
@@ -3170,39 +5131,141 @@ void fip_master_send_message_to( //
     char buffer[FIP_MSG_SIZE],   //
     const fip_msg_t *message     //
 ) {
-    FILE *slave_stdin = master_state.slave_stdin[id];
-    if (slave_stdin == NULL) {
+    if (id >= master_state.slave_count || !master_state.slaves[id].in) {
         fip_print(0, FIP_ERROR, "Cannot send msg to nonexistent slave %u", id);
+        return;
     }
     fip_encode_msg(buffer, message);
     uint32_t msg_len;
     memcpy(&msg_len, buffer, sizeof(uint32_t));
-    size_t written_bytes = fwrite(buffer, 1, msg_len + 4, slave_stdin);
-    if (written_bytes != msg_len + 4) {
+    if (!fip_master_send_encoded(id, buffer)) {
         fip_print(0, FIP_ERROR, "Failed to write message");
         return;
     }
     fip_print(0, FIP_INFO, "Successfully sent message of %u bytes", msg_len);
-    fflush(slave_stdin);
+}
+
+/// @function `fip_depfile_add`
+/// @brief Adds a copy of the given path to the growing list of dependencies
+static void fip_depfile_add( //
+    char ***deps,            //
+    uint32_t *count,         //
+    uint32_t *capacity,      //
+    const char *path         //
+) {
+    if (*count == *capacity) {
+        *capacity = *capacity == 0 ? 64 : *capacity * 2;
+        *deps = (char **)realloc(*deps, sizeof(char *) * *capacity);
+    }
+    const size_t len = strlen(path) + 1;
+    (*deps)[*count] = (char *)malloc(len);
+    memcpy((*deps)[*count], path, len);
+    (*count)++;
+}
+
+/// @function `fip_depfile_cmp`
+/// @brief Compares two dependency paths for sorting them
+static int fip_depfile_cmp(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/// @function `fip_depfile_write_path`
+/// @brief Writes the path into the depfile, escaping all characters which
+/// have a special meaning in Make and Ninja depfiles
+static void fip_depfile_write_path(FILE *fp, const char *path) {
+    for (; *path != '\0'; path++) {
+        if (*path == ' ' || *path == '#') {
+            fputc('\\', fp);
+        } else if (*path == '$') {
+            fputc('$', fp);
+        }
+        fputc(*path, fp);
+    }
+}
+
+bool fip_master_write_depfile(const char *depfile_path, const char *target) {
+    char **deps = NULL;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    bool is_complete = true;
+    char path[FIP_LINE_BUF_SIZE];
+    fip_depfile_add(&deps, &count, &capacity, ".fip/config/fip.toml");
+    for (uint32_t i = 0; i < master_state.slave_count; i++) {
+        const char *module_name = master_state.slaves[i].module_name;
+        snprintf(path, sizeof(path), ".fip/config/%s.toml", module_name);
+        fip_depfile_add(&deps, &count, &capacity, path);
+        snprintf(path, sizeof(path), FIP_DEPS_PATH_FORMAT, module_name);
+        FILE *deps_file = fopen(path, "r");
+        if (deps_file == NULL) {
+            fip_print(0, FIP_WARN, "Module '%s' did not list its dependencies",
+                module_name);
+            is_complete = false;
+            continue;
+        }
+        while (fgets(path, sizeof(path), deps_file)) {
+            path[strcspn(path, "\r\n")] = '\0';
+            if (path[0] != '\0') {
+                fip_depfile_add(&deps, &count, &capacity, path);
+            }
+        }
+        fclose(deps_file);
+    }
+
+    FILE *fp = is_complete ? fopen(depfile_path, "w") : NULL;
+    if (is_complete && fp == NULL) {
+        fip_print(0, FIP_ERROR, "Could not write depfile '%s'", depfile_path);
+        is_complete = false;
+    }
+    if (fp != NULL) {
+        // Many headers are included by multiple sources, every file is only
+        // listed once
+        qsort(deps, count, sizeof(char *), fip_depfile_cmp);
+        fip_depfile_write_path(fp, target);
+        fputc(':', fp);
+        for (uint32_t i = 0; i < count; i++) {
+            if (i > 0 && strcmp(deps[i], deps[i - 1]) == 0) {
+                continue;
+            }
+            fputs(" \\\n  ", fp);
+            fip_depfile_write_path(fp, deps[i]);
+        }
+        fputc('\n', fp);
+        fclose(fp);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        free(deps[i]);
+    }
+    free(deps);
+    return is_complete;
 }
 
 void fip_master_cleanup() {
+    // Everything the slaves logged until now is written before their pipes
+    // are closed
+    fip_log_drain_stop();
     for (uint32_t i = 0; i < master_state.slave_count; i++) {
-        if (master_state.slave_stdin[i]) {
-            fclose(master_state.slave_stdin[i]);
-            master_state.slave_stdin[i] = NULL;
+        fip_slave_t *slave = &master_state.slaves[i];
+        if (slave->in) {
+            fclose(slave->in);
+            slave->in = NULL;
         }
-        if (master_state.slave_stdout[i]) {
-            fclose(master_state.slave_stdout[i]);
-            master_state.slave_stdout[i] = NULL;
+        if (slave->out) {
+            fclose(slave->out);
+            slave->out = NULL;
         }
-        if (master_state.slave_stderr[i]) {
-            fip_copy_stream_lines(master_state.slave_stderr[i], stderr);
-            fclose(master_state.slave_stderr[i]);
-            master_state.slave_stderr[i] = NULL;
+        if (slave->err) {
+            fclose(slave->err);
+            slave->err = NULL;
         }
+        fip_inbox_clear(&slave->inbox);
+        fip_outbox_clear(&slave->outbox);
     }
+    // The descriptors themselves are kept until the slaves are terminated
     master_state.slave_count = 0;
+    free(master_state.changes);
+    master_state.changes = NULL;
+    master_state.change_count = 0;
+    master_state.change_capacity = 0;
     fip_print(0, FIP_INFO, "Master cleaned up");
 }
 
@@ -3210,19 +5273,32 @@ void fip_master_cleanup() {
 
 #ifdef FIP_SLAVE
 
+/// @var `fip_slave_inbox`
+/// @brief The incoming frames from the master
+fip_inbox_t fip_slave_inbox;
+
+/// @var `fip_slave_outbox`
+/// @brief The queued outgoing messages to the master
+fip_outbox_t fip_slave_outbox;
+
 bool fip_slave_receive_message(char buffer[FIP_MSG_SIZE]) {
-    uint32_t msg_len;
-    if (fread(&msg_len, 1, 4, stdin) != 4) {
-        return false;
-    }
-    if (msg_len == 0 || msg_len > FIP_MSG_SIZE - 4) {
-        return false;
+    // Messages of higher-priority lanes are always received first
+    while (!fip_inbox_pop(&fip_slave_inbox, FIP_LANE_BULK, buffer)) {
+        if (!fip_inbox_fill(&fip_slave_inbox, stdin, -1)) {
+            return false;
+        }
     }
-    memset(buffer, 0, FIP_MSG_SIZE);
-    if (fread(buffer, 1, msg_len, stdin) != msg_len) {
+    return true;
+}
+
+bool fip_slave_poll_message(   //
+    const fip_lane_e max_lane, //
+    char buffer[FIP_MSG_SIZE]  //
+) {
+    if (!fip_inbox_fill(&fip_slave_inbox, stdin, 0)) {
         return false;
     }
-    return true;
+    return fip_inbox_pop(&fip_slave_inbox, max_lane, buffer);
 }
 
 void fip_slave_send_message(   //
@@ -3233,16 +5309,80 @@ void fip_slave_send_message(   //
     fip_encode_msg(buffer, message);
     uint32_t msg_len;
     memcpy(&msg_len, buffer, sizeof(uint32_t));
-    size_t written_bytes = fwrite(buffer, 1, msg_len + 4, stdout);
-    if (written_bytes != msg_len + 4) {
+    fip_outbox_push(&fip_slave_outbox, buffer);
+    if (!fip_outbox_flush(&fip_slave_outbox, stdout)) {
         fip_print(id, FIP_ERROR, "Failed to write message");
+        fip_outbox_clear(&fip_slave_outbox);
         return;
     }
     fip_print(id, FIP_INFO, "Successfully sent message of %u bytes", msg_len);
-    fflush(stdout);
+}
+
+void fip_slave_queue_message(  //
+    char buffer[FIP_MSG_SIZE], //
+    const fip_msg_t *message   //
+) {
+    fip_encode_msg(buffer, message);
+    fip_outbox_push(&fip_slave_outbox, buffer);
+}
+
+bool fip_slave_flush_frame(uint32_t id) {
+    if (fip_outbox_is_empty(&fip_slave_outbox)) {
+        return false;
+    }
+    if (!fip_outbox_write_frame(&fip_slave_outbox, stdout)) {
+        fip_print(id, FIP_ERROR, "Failed to write frame");
+        fip_outbox_clear(&fip_slave_outbox);
+        return false;
+    }
+    return !fip_outbox_is_empty(&fip_slave_outbox);
+}
+
+void fip_slave_send_progress( //
+    uint32_t id,              //
+    const uint32_t done,      //
+    const uint32_t total      //
+) {
+    char buffer[FIP_MSG_SIZE];
+    fip_msg_t message = {0};
+    message.type = FIP_MSG_PROGRESS;
+    message.u.progress.done = done;
+    message.u.progress.total = total;
+    fip_encode_msg(buffer, &message);
+    fip_outbox_push(&fip_slave_outbox, buffer);
+    // Only the control lane is flushed, queued bulk frames stay queued
+    while (fip_slave_outbox.lanes[FIP_LANE_CONTROL].head != NULL) {
+        if (!fip_outbox_write_frame(&fip_slave_outbox, stdout)) {
+            fip_print(id, FIP_ERROR, "Failed to write progress");
+            fip_outbox_clear(&fip_slave_outbox);
+            return;
+        }
+    }
+}
+
+bool fip_slave_write_deps(   //
+    const uint32_t id,       //
+    const char *module_name, //
+    const uint32_t count,    //
+    char *const *paths       //
+) {
+    char deps_path[256];
+    snprintf(deps_path, sizeof(deps_path), FIP_DEPS_PATH_FORMAT, module_name);
+    FILE *fp = fopen(deps_path, "w");
+    if (fp == NULL) {
+        fip_print(id, FIP_ERROR, "Could not write '%s'", deps_path);
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        fprintf(fp, "%s\n", paths[i]);
+    }
+    fclose(fp);
+    return true;
 }
 
 void fip_slave_cleanup() {
+    fip_inbox_clear(&fip_slave_inbox);
+    fip_outbox_clear(&fip_slave_outbox);
     fip_print(1, FIP_INFO, "Slave cleaned up");
 }
 
@@ -3264,16 +5404,6 @@ void fip_slave_cleanup() {
 
 #ifdef FIP_MASTER
 
-typedef struct {
-    HANDLE process;
-    HANDLE stdin_write;
-    HANDLE stdout_read;
-    HANDLE stderr_read;
-    pid_t pid; // For compatibility with existing code
-} win_process_info_t;
-
-static win_process_info_t win_processes[FIP_MAX_SLAVES];
-
 bool fip_spawn_interop_module(      //
     fip_interop_modules_t *modules, //
     const char *root_path,          //
@@ -3337,15 +5467,11 @@ bool fip_spawn_interop_module(      //
     CloseHandle(stderr_write);
     CloseHandle(pi.hThread);
 
-    // Store process info
-    win_processes[modules->active_count].process = pi.hProcess;
-    win_processes[modules->active_count].stdin_write = stdin_write;
-    win_processes[modules->active_count].stdout_read = stdout_read;
-    win_processes[modules->active_count].stderr_read = stderr_read;
-    win_processes[modules->active_count].pid = pi.dwProcessId;
-
-    // Store PID in the modules array for compatibility
-    modules->pids[modules->active_count] = pi.dwProcessId;
+    // Store the process and its PID
+    fip_slave_t *slave = fip_master_add_slave(modules->active_count);
+    slave->process = pi.hProcess;
+    strncpy(slave->module_name, module, FIP_MAX_MODULE_NAME_LEN - 1);
+    fip_interop_modules_add_pid(modules, pi.dwProcessId);
 
     // Convert to FILE streams
     int stdin_fd =
@@ -3355,36 +5481,33 @@ bool fip_spawn_interop_module(      //
     int stderr_fd =
         _open_osfhandle((intptr_t)stderr_read, _O_RDONLY | _O_BINARY);
 
-    master_state.slave_stdin[modules->active_count] = _fdopen(stdin_fd, "wb");
-    master_state.slave_stdout[modules->active_count] = _fdopen(stdout_fd, "rb");
-    master_state.slave_stderr[modules->active_count] = _fdopen(stderr_fd, "rb");
+    slave->in = _fdopen(stdin_fd, "wb");
+    slave->out = _fdopen(stdout_fd, "rb");
+    slave->err = _fdopen(stderr_fd, "rb");
 
-    if (!master_state.slave_stdin[modules->active_count] ||
-        !master_state.slave_stdout[modules->active_count]) {
+    if (!slave->in || !slave->out) {
         fip_print(0, FIP_ERROR, "Failed to create FILE streams for slave %s",
             id);
         return false;
     }
+    if (slave->err) {
+        fip_log_drain_add(slave->err);
+    }
 
     modules->active_count++;
     return true;
 }
 
 void fip_terminate_all_slaves(fip_interop_modules_t *modules) {
-    for (uint8_t i = 0; i < modules->active_count; i++) {
-        if (win_processes[i].process) {
-            TerminateProcess(win_processes[i].process, 1);
-            CloseHandle(win_processes[i].process);
-            win_processes[i].process = NULL;
+    for (uint32_t i = 0; i < modules->active_count; i++) {
+        if (i < master_state.slave_capacity && master_state.slaves[i].process) {
+            TerminateProcess(master_state.slaves[i].process, 1);
+            CloseHandle(master_state.slaves[i].process);
+            master_state.slaves[i].process = NULL;
         }
     }
-    modules->active_count = 0;
-    master_state.slave_count = 0;
-    memset(&master_state.responses, 0, sizeof(fip_msg_t) + FIP_MAX_SLAVES);
-    master_state.response_count = 0;
-    memset(&master_state.slave_stdin, 0, sizeof(FILE *) * FIP_MAX_SLAVES);
-    memset(&master_state.slave_stdout, 0, sizeof(FILE *) * FIP_MAX_SLAVES);
-    memset(&master_state.slave_stderr, 0, sizeof(FILE *) * FIP_MAX_SLAVES);
+    fip_interop_modules_free(modules);
+    fip_master_free_slaves();
 }
 
 bool fip_master_init(fip_interop_modules_t *modules) {
@@ -3396,63 +5519,45 @@ bool fip_master_init(fip_interop_modules_t *modules) {
     return true;
 }
 
-uint8_t fip_master_await_responses(        //
+uint32_t fip_master_await_responses(       //
     char buffer[FIP_MSG_SIZE],             //
-    fip_msg_t responses[FIP_MAX_SLAVES],   //
-    uint32_t *response_count,              //
+    const fip_gather_set_t *set,           //
     const fip_msg_type_e expected_msg_type //
 ) {
     fip_print(0, FIP_INFO, "Awaiting Responses");
 
-    for (uint8_t i = 0; i < *response_count; i++) {
+    fip_msg_t *responses = master_state.responses;
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
         fip_free_msg(&responses[i]);
     }
-    *response_count = 0;
-    uint8_t wrong_count = 0;
-
-    for (uint32_t i = 0; i < master_state.slave_count; i++) {
-        if (!master_state.slave_stdout[i]) {
-            fip_print(0, FIP_WARN, "No output stream for slave %d", i + 1);
-            wrong_count++;
-            continue;
-        }
-
-        // Simple timeout using non-blocking read
-        uint32_t msg_len;
-        if (fread(&msg_len, 1, 4, master_state.slave_stdout[i]) != 4) {
-            fip_print(0, FIP_WARN,
-                "Failed to read message length from slave %d", i + 1);
-            wrong_count++;
-            continue;
-        }
+    master_state.response_count = 0;
+    uint32_t wrong_count = 0;
 
-        if (msg_len == 0 || msg_len > FIP_MSG_SIZE - 4) {
-            fip_print(0, FIP_WARN, "Invalid message length from slave %d: %u",
-                i + 1, msg_len);
+    const uint32_t set_size = fip_gather_set_size(set);
+    for (uint32_t s = 0; s < set_size; s++) {
+        const uint32_t i = fip_gather_set_id(set, s);
+        if (!master_state.slaves[i].out) {
+            fip_print(0, FIP_WARN, "No output stream for slave %u", i + 1);
             wrong_count++;
             continue;
         }
 
-        memset(buffer, 0, FIP_MSG_SIZE);
-        if (fread(buffer, 1, msg_len, master_state.slave_stdout[i]) !=
-            msg_len) {
-            fip_print(0, FIP_WARN,
-                "Failed to read complete message from slave %d", i + 1);
+        if (!fip_master_await_message_from(i, buffer, expected_msg_type)) {
+            fip_print(0, FIP_WARN, "Failed to read message from slave %u",
+                i + 1);
             wrong_count++;
             continue;
         }
 
-        fip_decode_msg(buffer, &responses[*response_count]);
-        fip_print(0, FIP_INFO, "Received message from slave %d: %s", i + 1,
-            fip_msg_type_str[responses[*response_count].type]);
+        const uint32_t idx = master_state.response_count++;
+        fip_decode_msg(buffer, &responses[idx]);
+        master_state.response_ids[idx] = i;
+        fip_print(0, FIP_INFO, "Received message from slave %u: %s", i + 1,
+            fip_msg_type_str[responses[idx].type]);
 
-        if (responses[*response_count].type != expected_msg_type) {
+        if (responses[idx].type != expected_msg_type) {
             wrong_count++;
         }
-
-        (*response_count)++;
-        if (*response_count >= FIP_MAX_SLAVES)
-            break;
     }
 
     // Print all the debug output of all the slaves
@@ -3494,21 +5599,14 @@ fip_master_config_t fip_master_load_config(const char *config_path) {
                 "Module %s is disabled or missing enable field", section_name);
             continue;
         }
-        if (config.enabled_count >= FIP_MAX_ENABLED_MODULES) {
-            fip_print(0, FIP_ERROR, "There are too many active modules (%d)!",
-                config.enabled_count);
-            continue;
-        }
-        strncpy(config.enabled_modules[config.enabled_count], section_name,
-            FIP_MAX_MODULE_NAME_LEN - 1);
-        config.enabled_modules[config.enabled_count]
-                              [FIP_MAX_MODULE_NAME_LEN - 1] = '\0';
-        config.enabled_count++;
+        fip_master_config_add_module(&config, section_name);
         fip_print(0, FIP_INFO, "Enabled module: %s", section_name);
     }
 
+    fip_master_load_deadlines(toml.toptab, &config);
+    fip_master_load_usage(toml.toptab, &config);
     toml_free(toml);
-    fip_print(0, FIP_INFO, "Found %d enabled modules", config.enabled_count);
+    fip_print(0, FIP_INFO, "Found %u enabled modules", config.enabled_count);
     config.ok = true;
     return config;
 }
@@ -3659,19 +5757,16 @@ bool fip_spawn_interop_module(      //
     close(stderr_pipe[1]); // parent's read end is stderr_pipe[0]
 
     // Store PID
-    modules->pids[modules->active_count] = pid;
+    fip_interop_modules_add_pid(modules, pid);
 
     // Store master's ends of the pipes
-    master_state.slave_stdin[modules->active_count] =
-        fdopen(stdin_pipe[1], "w");
-    master_state.slave_stdout[modules->active_count] =
-        fdopen(stdout_pipe[0], "r");
-    master_state.slave_stderr[modules->active_count] =
-        fdopen(stderr_pipe[0], "r");
-
-    if (!master_state.slave_stdin[modules->active_count] ||
-        !master_state.slave_stdout[modules->active_count] ||
-        !master_state.slave_stderr[modules->active_count]) {
+    fip_slave_t *slave = fip_master_add_slave(modules->active_count);
+    slave->in = fdopen(stdin_pipe[1], "w");
+    slave->out = fdopen(stdout_pipe[0], "r");
+    slave->err = fdopen(stderr_pipe[0], "r");
+    strncpy(slave->module_name, module, FIP_MAX_MODULE_NAME_LEN - 1);
+
+    if (!slave->in || !slave->out || !slave->err) {
         fip_print(0, FIP_ERROR, "Failed to create FILE streams for slave %s",
             id);
         // Cleanup: if needed, kill child? up to your policy. We'll close fds.
@@ -3680,6 +5775,7 @@ bool fip_spawn_interop_module(      //
         close(stderr_pipe[0]);
         return false;
     }
+    fip_log_drain_add(slave->err);
 
     modules->active_count++;
     return true;
@@ -3689,19 +5785,14 @@ void fip_terminate_all_slaves(fip_interop_modules_t *modules) {
     // We terminate all slaves as their workloads must have been finished by
     // now (the master has collected the results in the form of the .o
     // files)
-    for (uint8_t i = 0; i < modules->active_count; i++) {
+    for (uint32_t i = 0; i < modules->active_count; i++) {
         if (kill(modules->pids[i], 0)) {
             // Is still running and we are allowed to kill it
             kill(modules->pids[i], SIGTERM);
         }
     }
-    modules->active_count = 0;
-    master_state.slave_count = 0;
-    memset(&master_state.responses, 0, sizeof(fip_msg_t) + FIP_MAX_SLAVES);
-    master_state.response_count = 0;
-    memset(&master_state.slave_stdin, 0, sizeof(FILE *) * FIP_MAX_SLAVES);
-    memset(&master_state.slave_stdout, 0, sizeof(FILE *) * FIP_MAX_SLAVES);
-    memset(&master_state.slave_stderr, 0, sizeof(FILE *) * FIP_MAX_SLAVES);
+    fip_interop_modules_free(modules);
+    fip_master_free_slaves();
 }
 
 bool fip_master_init(fip_interop_modules_t *modules) {
@@ -3715,63 +5806,83 @@ bool fip_master_init(fip_interop_modules_t *modules) {
     return true;
 }
 
-uint8_t fip_master_await_responses(        //
+uint32_t fip_master_await_responses(       //
     char buffer[FIP_MSG_SIZE],             //
-    fip_msg_t responses[FIP_MAX_SLAVES],   //
-    uint32_t *response_count,              //
+    const fip_gather_set_t *set,           //
     const fip_msg_type_e expected_msg_type //
 ) {
-#define FIP_TIMEOUT 1.0
     fip_print(0, FIP_INFO, "Awaiting Responses");
 
     // First we need to clear all old message responses
-    for (uint8_t i = 0; i < *response_count; i++) {
+    fip_msg_t *responses = master_state.responses;
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
         fip_free_msg(&responses[i]);
     }
-    *response_count = 0;
-    uint8_t wrong_count = 0;
-
-    // Set all stderr file descriptors to non-blocking mode
-    for (uint32_t i = 0; i < master_state.slave_count; i++) {
-        if (master_state.slave_stderr[i]) {
-            int stderr_fd = fileno(master_state.slave_stderr[i]);
-            int flags = fcntl(stderr_fd, F_GETFL, 0);
-            fcntl(stderr_fd, F_SETFL, flags | O_NONBLOCK);
-        }
-    }
-
-    // Read responses from each slave with timeout
-    for (uint32_t i = 0; i < master_state.slave_count; i++) {
-        if (!master_state.slave_stdout[i]) {
-            fip_print(0, FIP_WARN, "No output stream for slave %d", i + 1);
+    master_state.response_count = 0;
+    uint32_t wrong_count = 0;
+    const uint32_t set_size = fip_gather_set_size(set);
+
+    // Read responses from each targeted slave until its deadline
+    for (uint32_t s = 0; s < set_size; s++) {
+        const uint32_t i = fip_gather_set_id(set, s);
+        fip_slave_t *slave = &master_state.slaves[i];
+        if (!slave->out) {
+            fip_print(0, FIP_WARN, "No output stream for slave %u", i + 1);
             wrong_count++;
             continue;
         }
 
-        int stdout_fd = fileno(master_state.slave_stdout[i]);
-        int stderr_fd = master_state.slave_stderr[i]
-            ? fileno(master_state.slave_stderr[i])
-            : -1;
+        int stdout_fd = fileno(slave->out);
 
         fd_set read_fds;
         struct timeval timeout;
-        struct timespec start;
-        clock_gettime(CLOCK_MONOTONIC, &start);
+        double deadline_start = slave->request_ms;
+        const uint32_t deadline_ms =
+            fip_master_deadline_ms(i, expected_msg_type);
 
         bool message_received = false;
-
-        // Keep trying until we get a message or timeout (1 second)
+        bool is_late = false;
+        fip_inbox_t *inbox = &slave->inbox;
+
+        // Keep trying until we get a message or the deadline passes, every
+        // progress message of the slave starts a new deadline. The deadline
+        // runs from sending the request, so it may have passed while waiting
+        // for the slaves before. The data already waiting in the pipe is still
+        // read before giving up
         while (!message_received) {
-            // Check if we've exceeded timeout
-            struct timespec now;
-            clock_gettime(CLOCK_MONOTONIC, &now);
-            double elapsed = ((double)(now.tv_sec - start.tv_sec)) +
-                ((double)(now.tv_nsec - start.tv_nsec) / 1000000000.0);
+            // Frames already read from the pipe are not visible to select, so
+            // complete messages in the inbox need to be checked first
+            if (fip_inbox_pop(inbox, FIP_LANE_BULK, buffer)) {
+                if (fip_master_take_change(i, buffer)) {
+                    continue;
+                }
+                if (fip_master_take_progress(i, buffer)) {
+                    deadline_start = fip_now_ms();
+                    is_late = false;
+                    continue;
+                }
+                fip_master_record_response(i, expected_msg_type);
+                const uint32_t idx = master_state.response_count++;
+                fip_decode_msg(buffer, &responses[idx]);
+                master_state.response_ids[idx] = i;
+                fip_print(0, FIP_INFO, "Received message from slave %u: %s",
+                    i + 1, fip_msg_type_str[responses[idx].type]);
+
+                if (responses[idx].type != expected_msg_type) {
+                    wrong_count++;
+                }
+                message_received = true;
+                break;
+            }
 
-            if (elapsed > FIP_TIMEOUT) {
+            // Check if the deadline has passed
+            const double elapsed = fip_now_ms() - deadline_start;
+            if (is_late) {
                 fip_print(0, FIP_WARN,
-                    "Timeout waiting for slave %d response for %f seconds",
-                    i + 1, elapsed);
+                    "Timeout waiting for slave %d response after %.0f ms "
+                    "(deadline %u ms)",
+                    i + 1, elapsed, deadline_ms);
+                fip_master_record_response(i, expected_msg_type);
                 wrong_count++;
                 break;
             }
@@ -3779,18 +5890,16 @@ uint8_t fip_master_await_responses(        //
             // Set up select with remaining time
             FD_ZERO(&read_fds);
             FD_SET(stdout_fd, &read_fds);
-            int max_fd = stdout_fd;
-            if (stderr_fd >= 0) {
-                FD_SET(stderr_fd, &read_fds);
-                if (stderr_fd > max_fd)
-                    max_fd = stderr_fd;
-            }
 
-            double remaining = FIP_TIMEOUT - elapsed;
-            timeout.tv_sec = (long)remaining;
-            timeout.tv_usec = (long)((remaining - timeout.tv_sec) * 1000000);
+            is_late = elapsed > (double)deadline_ms;
+            const long remaining_us = is_late //
+                ? 0                           //
+                : (long)(((double)deadline_ms - elapsed) * 1000.0);
+            timeout.tv_sec = remaining_us / 1000000;
+            timeout.tv_usec = remaining_us % 1000000;
 
-            int activity = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
+            int activity =
+                select(stdout_fd + 1, &read_fds, NULL, NULL, &timeout);
 
             if (activity < 0) {
                 fip_print(0, FIP_WARN, "Select error for slave %d", i + 1);
@@ -3798,90 +5907,29 @@ uint8_t fip_master_await_responses(        //
                 break;
             }
 
-            // Always drain stderr if available (non-blocking)
-            if (stderr_fd >= 0) {
-                char stderr_buf[4096];
-                ssize_t n;
-                while ((n = read(stderr_fd, stderr_buf,
-                            sizeof(stderr_buf) - 1)) > 0) {
-                    stderr_buf[n] = '\0';
-                    fprintf(stderr, "%s", stderr_buf);
-                    fflush(stderr);
-                }
-            }
+            // The log drain reads stderr in the background, only the lines it
+            // collected so far are written here
+            fip_print_slave_streams();
 
-            // Check if stdout has data
+            // Check if stdout has data, all complete frames are read into the
+            // inbox and the message is taken from it in the next iteration
             if (FD_ISSET(stdout_fd, &read_fds)) {
-                // Read message length (4 bytes)
-                uint32_t msg_len;
-                if (fread(&msg_len, 1, 4, master_state.slave_stdout[i]) != 4) {
-                    fip_print(0, FIP_WARN,
-                        "Failed to read message length from slave %d", i + 1);
-                    wrong_count++;
-                    break;
-                }
-
-                // Validate message length
-                if (msg_len == 0 || msg_len > FIP_MSG_SIZE - 4) {
-                    fip_print(0, FIP_WARN,
-                        "Invalid message length from slave %d: %u", i + 1,
-                        msg_len);
-                    wrong_count++;
-                    break;
-                }
-                fip_print(0, FIP_DEBUG, "Received message length: %u", msg_len);
-
-                // Read message data
-                memset(buffer, 0, FIP_MSG_SIZE);
-                if (fread(buffer, 1, msg_len, master_state.slave_stdout[i]) !=
-                    msg_len) {
+                if (!fip_inbox_fill(inbox, slave->out, 0)) {
                     fip_print(0, FIP_WARN,
                         "Failed to read complete message from slave %d", i + 1);
                     wrong_count++;
                     break;
                 }
-
-                // Decode message
-                fip_decode_msg(buffer, &responses[*response_count]);
-                fip_print(0, FIP_INFO, "Received message from slave %d: %s",
-                    i + 1, fip_msg_type_str[responses[*response_count].type]);
-
-                if (responses[*response_count].type != expected_msg_type) {
-                    wrong_count++;
-                }
-
-                (*response_count)++;
-                message_received = true;
-
-                // Prevent buffer overflow
-                if (*response_count >= FIP_MAX_SLAVES) {
-                    break;
-                }
+                continue;
             }
 
             // Small sleep to avoid busy-waiting
-            if (!message_received) {
-                struct timespec sleep_time = {0, 1000000}; // 1ms
-                nanosleep(&sleep_time, NULL);
-            }
-        }
-    }
-
-    // Final drain of all stderr streams
-    for (uint32_t i = 0; i < master_state.slave_count; i++) {
-        if (master_state.slave_stderr[i]) {
-            int stderr_fd = fileno(master_state.slave_stderr[i]);
-            char stderr_buf[4096];
-            ssize_t n;
-            while (
-                (n = read(stderr_fd, stderr_buf, sizeof(stderr_buf) - 1)) > 0) {
-                stderr_buf[n] = '\0';
-                fprintf(stderr, "%s", stderr_buf);
-                fflush(stderr);
-            }
+            struct timespec sleep_time = {0, 1000000}; // 1ms
+            nanosleep(&sleep_time, NULL);
         }
     }
 
+    fip_print_slave_streams();
     return wrong_count;
 }
 
@@ -3928,24 +5976,15 @@ fip_master_config_t fip_master_load_config(const char *config_path) {
             continue;
         }
 
-        // Check whether we have reached the maximum module count
-        if (config.enabled_count >= FIP_MAX_ENABLED_MODULES) {
-            fip_print(0, FIP_ERROR, "There are too many active modules (%d)!",
-                config.enabled_count);
-            continue;
-        }
-
         // Add to enabled modules list
-        strncpy(config.enabled_modules[config.enabled_count], section_name,
-            FIP_MAX_MODULE_NAME_LEN - 1);
-        config.enabled_modules[config.enabled_count]
-                              [FIP_MAX_MODULE_NAME_LEN - 1] = '\0';
-        config.enabled_count++;
+        fip_master_config_add_module(&config, section_name);
         fip_print(0, FIP_INFO, "Enabled module: %s", section_name);
     }
 
+    fip_master_load_deadlines(toml.toptab, &config);
+    fip_master_load_usage(toml.toptab, &config);
     toml_free(toml);
-    fip_print(0, FIP_INFO, "Found %d enabled modules", config.enabled_count);
+    fip_print(0, FIP_INFO, "Found %u enabled modules", config.enabled_count);
     config.ok = true;
     return config;
 }
@@ -0,0 +1,905 @@
+#pragma once
+
+/*
+ * This is the C++ companion of the `fip.h` header for masters written in C++.
+ * It wraps the master side of the C API into move-only types owning the
+ * messages and signature lists they hold, non-owning views over signatures and
+ * coroutine awaitables for the requests. Ownership of everything the C API
+ * allocates is moved into these types instead of being cloned, so neither
+ * `fip_free_*` calls nor defensive `fip_clone_sig_*` copies are needed.
+ *
+ * The C API itself still has to be compiled in a C translation unit defining
+ * `FIP_MASTER` and `FIP_IMPLEMENTATION`, together with `LOG_LEVEL` and
+ * `master_state`. This header only includes its declarations. Spawning the
+ * interop modules and awaiting their connect requests is done through the C
+ * API as before, `fip::Master` drives the requests once they are connected.
+ */
+
+#ifndef FIP_MASTER
+#define FIP_MASTER
+#endif
+
+extern "C" {
+#include "fip.h"
+}
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <coroutine>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fip {
+
+/// @function `name_view`
+/// @brief Returns a view of one of the fixed-size, zero-terminated names of
+/// the C structures
+///
+/// @param `name` The name buffer
+/// @return `std::string_view` The name, without its terminator
+template <size_t N> inline std::string_view name_view(const char (&name)[N]) {
+    const void *end = std::memchr(name, '\0', N);
+    return std::string_view(name,
+        end ? static_cast<size_t>(static_cast<const char *>(end) - name) : N);
+}
+
+/*
+ * =====
+ * VIEWS
+ * =====
+ * The views only point into signatures owned by
+ * a `Message`, a `SigList` or a `UsageList`, they
+ * are only valid as long as their owner lives.
+ */
+
+/// @class `FnView`
+/// @brief A view of the signature of a function
+class FnView {
+  public:
+    explicit FnView(const fip_sig_fn_t &sig) : sig_(&sig) {}
+
+    std::string_view name() const {
+        return name_view(sig_->name);
+    }
+
+    std::span<const fip_sig_fn_arg_t> args() const {
+        return {sig_->args, sig_->args_len};
+    }
+
+    std::span<const fip_type_t> rets() const {
+        return {sig_->rets, sig_->rets_len};
+    }
+
+    const fip_sig_fn_t &raw() const {
+        return *sig_;
+    }
+
+  private:
+    const fip_sig_fn_t *sig_;
+};
+
+/// @class `DataView`
+/// @brief A view of the signature of a data type
+class DataView {
+  public:
+    explicit DataView(const fip_sig_data_t &sig) : sig_(&sig) {}
+
+    std::string_view name() const {
+        return name_view(sig_->name);
+    }
+
+    size_t size() const {
+        return sig_->value_count;
+    }
+
+    std::string_view value_name(const size_t idx) const {
+        return sig_->value_names[idx];
+    }
+
+    std::span<const fip_type_t> value_types() const {
+        return {sig_->value_types, sig_->value_count};
+    }
+
+    const fip_sig_data_t &raw() const {
+        return *sig_;
+    }
+
+  private:
+    const fip_sig_data_t *sig_;
+};
+
+/// @class `EnumView`
+/// @brief A view of the signature of an enum
+class EnumView {
+  public:
+    explicit EnumView(const fip_sig_enum_t &sig) : sig_(&sig) {}
+
+    std::string_view name() const {
+        return name_view(sig_->name);
+    }
+
+    fip_type_prim_e type() const {
+        return sig_->type;
+    }
+
+    size_t size() const {
+        return sig_->value_count;
+    }
+
+    std::string_view tag(const size_t idx) const {
+        return sig_->tags[idx];
+    }
+
+    std::span<const size_t> values() const {
+        return {sig_->values, sig_->value_count};
+    }
+
+    const fip_sig_enum_t &raw() const {
+        return *sig_;
+    }
+
+  private:
+    const fip_sig_enum_t *sig_;
+};
+
+/// @class `SigView`
+/// @brief A view of a signature of any symbol type. The view of the concrete
+/// signature is only returned for the matching symbol type
+class SigView {
+  public:
+    SigView(const fip_msg_symbol_type_e type, const fip_sig_u &sig)
+        : type_(type), sig_(&sig) {}
+
+    explicit SigView(const fip_sig_t &sig)
+        : type_(sig.type), sig_(&sig.sig), abi_changed_(sig.abi_changed),
+          fingerprint_(sig.fingerprint) {}
+
+    fip_msg_symbol_type_e type() const {
+        return type_;
+    }
+
+    std::string_view name() const {
+        return fip_sig_name(type_, sig_);
+    }
+
+    /// @function `abi_changed`
+    /// @brief Whether the ABI of the symbol changed since the previous session,
+    /// only known for the symbols of a tag
+    bool abi_changed() const {
+        return abi_changed_;
+    }
+
+    uint64_t fingerprint() const {
+        return fingerprint_;
+    }
+
+    std::optional<FnView> fn() const {
+        if (type_ != FIP_SYM_FUNCTION) {
+            return std::nullopt;
+        }
+        return FnView(sig_->fn);
+    }
+
+    std::optional<DataView> data() const {
+        if (type_ != FIP_SYM_DATA) {
+            return std::nullopt;
+        }
+        return DataView(sig_->data);
+    }
+
+    std::optional<EnumView> enum_t() const {
+        if (type_ != FIP_SYM_ENUM) {
+            return std::nullopt;
+        }
+        return EnumView(sig_->enum_t);
+    }
+
+    const fip_sig_u &raw() const {
+        return *sig_;
+    }
+
+  private:
+    fip_msg_symbol_type_e type_;
+    const fip_sig_u *sig_;
+    bool abi_changed_ = false;
+    uint64_t fingerprint_ = 0;
+};
+
+/*
+ * ===========
+ * OWNER TYPES
+ * ===========
+ */
+
+/// @class `Message`
+/// @brief An owned message, its payload is freed with `fip_free_msg` once the
+/// message is destroyed. Moving a message moves its payload and leaves the
+/// moved-from message empty
+class Message {
+  public:
+    explicit Message(const fip_msg_type_e type = FIP_MSG_UNKNOWN) {
+        std::memset(&msg_, 0, sizeof(msg_));
+        msg_.type = type;
+    }
+
+    /// @function `adopt`
+    /// @brief Takes over the payload of the given message of the C API, which
+    /// is left as an empty unknown message
+    static Message adopt(fip_msg_t &msg) {
+        Message adopted;
+        adopted.msg_ = msg;
+        std::memset(&msg, 0, sizeof(msg));
+        return adopted;
+    }
+
+    static Message tag_request(const std::string_view tag) {
+        Message message(FIP_MSG_TAG_REQUEST);
+        const size_t len =
+            std::min(tag.size(), sizeof(message->u.tag_req.tag) - 1);
+        std::memcpy(message->u.tag_req.tag, tag.data(), len);
+        return message;
+    }
+
+    static Message compile_request() {
+        return Message(FIP_MSG_COMPILE_REQUEST);
+    }
+
+    static Message usage_request(const uint32_t limit, const bool prefetch) {
+        Message message(FIP_MSG_USAGE_REQUEST);
+        message->u.usage_req.limit = limit;
+        message->u.usage_req.prefetch = prefetch;
+        return message;
+    }
+
+    static Message cleanup_request(const uint64_t max_age_s) {
+        Message message(FIP_MSG_CLEANUP_REQUEST);
+        message->u.clean_req.max_age_s = max_age_s;
+        return message;
+    }
+
+    Message(Message &&other) noexcept : msg_(other.msg_) {
+        std::memset(&other.msg_, 0, sizeof(other.msg_));
+    }
+
+    Message &operator=(Message &&other) noexcept {
+        if (this != &other) {
+            fip_free_msg(&msg_);
+            msg_ = other.msg_;
+            std::memset(&other.msg_, 0, sizeof(other.msg_));
+        }
+        return *this;
+    }
+
+    Message(const Message &) = delete;
+    Message &operator=(const Message &) = delete;
+
+    ~Message() {
+        fip_free_msg(&msg_);
+    }
+
+    fip_msg_type_e type() const {
+        return msg_.type;
+    }
+
+    fip_msg_t *operator->() {
+        return &msg_;
+    }
+
+    const fip_msg_t *operator->() const {
+        return &msg_;
+    }
+
+    const fip_msg_t *get() const {
+        return &msg_;
+    }
+
+  private:
+    fip_msg_t msg_;
+};
+
+/// @class `SigList`
+/// @brief An owned list of signatures, as returned by tag requests
+class SigList {
+  public:
+    explicit SigList(fip_sig_list_t *list = nullptr) : list_(list) {}
+
+    SigList(SigList &&other) noexcept
+        : list_(std::exchange(other.list_, nullptr)) {}
+
+    SigList &operator=(SigList &&other) noexcept {
+        if (this != &other) {
+            fip_free_sig_list(list_);
+            list_ = std::exchange(other.list_, nullptr);
+        }
+        return *this;
+    }
+
+    SigList(const SigList &) = delete;
+    SigList &operator=(const SigList &) = delete;
+
+    ~SigList() {
+        fip_free_sig_list(list_);
+    }
+
+    size_t size() const {
+        return list_ ? list_->count : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::span<const fip_sig_t> sigs() const {
+        if (list_ == nullptr) {
+            return {};
+        }
+        return {list_->sigs, list_->count};
+    }
+
+    SigView operator[](const size_t idx) const {
+        return SigView(list_->sigs[idx]);
+    }
+
+    auto begin() const {
+        return sigs().begin();
+    }
+
+    auto end() const {
+        return sigs().end();
+    }
+
+    /// @function `invalidate`
+    /// @brief Invalidates the symbol named by the change notification, see
+    /// `fip_sig_list_invalidate`
+    bool invalidate(const fip_msg_change_notification_t &change) {
+        return list_ && fip_sig_list_invalidate(list_, &change);
+    }
+
+    /// @function `release`
+    /// @brief Gives up the ownership of the list, which then has to be freed
+    /// with `fip_free_sig_list`
+    fip_sig_list_t *release() {
+        return std::exchange(list_, nullptr);
+    }
+
+  private:
+    fip_sig_list_t *list_;
+};
+
+/// @class `UsageList`
+/// @brief An owned list of the usage entries of all slaves
+class UsageList {
+  public:
+    explicit UsageList(fip_usage_list_t *list = nullptr) : list_(list) {}
+
+    UsageList(UsageList &&other) noexcept
+        : list_(std::exchange(other.list_, nullptr)) {}
+
+    UsageList &operator=(UsageList &&other) noexcept {
+        if (this != &other) {
+            fip_free_usage_list(list_);
+            list_ = std::exchange(other.list_, nullptr);
+        }
+        return *this;
+    }
+
+    UsageList(const UsageList &) = delete;
+    UsageList &operator=(const UsageList &) = delete;
+
+    ~UsageList() {
+        fip_free_usage_list(list_);
+    }
+
+    /// @function `is_valid`
+    /// @brief Whether all slaves responded to the usage request
+    bool is_valid() const {
+        return list_ != nullptr;
+    }
+
+    std::span<const fip_msg_usage_response_t> entries() const {
+        if (list_ == nullptr) {
+            return {};
+        }
+        return {list_->entries, list_->count};
+    }
+
+    auto begin() const {
+        return entries().begin();
+    }
+
+    auto end() const {
+        return entries().end();
+    }
+
+  private:
+    fip_usage_list_t *list_;
+};
+
+/// @typedef `TagResult`
+/// @brief The result of a tag request, the list is empty unless the status is
+/// `FIP_TAG_REQUEST_STATUS_OK`
+struct TagResult {
+    fip_tag_request_status_e status;
+    SigList list;
+};
+
+/// @typedef `SymbolResult`
+/// @brief The result of a symbol request. The response of the slave which
+/// found the symbol is kept, so its signature can be used without copying it
+struct SymbolResult {
+    std::optional<Message> response;
+
+    bool found() const {
+        return response.has_value();
+    }
+
+    SigView sig() const {
+        return SigView(
+            (*response)->u.sym_res.type, (*response)->u.sym_res.sig);
+    }
+};
+
+/// @typedef `CompileResult`
+/// @brief The result of a compile request together with the object responses
+/// of all slaves which compiled anything
+struct CompileResult {
+    bool ok;
+    std::vector<Message> objects;
+};
+
+/*
+ * =====
+ * TASKS
+ * =====
+ * `Task` is a lazily started coroutine which can
+ * await the requests of a `Master` and other
+ * tasks. All slaves answer the requests in the
+ * order they were sent and the state of the C
+ * master is global, so the requests are never
+ * performed concurrently. Every awaited request
+ * is queued on the master instead, and
+ * `Master::run` performs the queued requests in
+ * the order they were awaited, resuming every
+ * awaiting task with its result. Independent
+ * tasks, like the imports of different files,
+ * interleave at every request this way.
+ */
+
+template <typename T = void> class Task;
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr exception;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept {
+            return false;
+        }
+
+        template <typename P>
+        std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<P> handle) noexcept {
+            return handle.promise().continuation;
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() noexcept {
+        return {};
+    }
+
+    void unhandled_exception() {
+        exception = std::current_exception();
+    }
+};
+
+template <typename T> struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+
+    void return_value(T result) {
+        value.emplace(std::move(result));
+    }
+};
+
+template <> struct Promise<void> : PromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() {}
+};
+
+} // namespace detail
+
+/// @class `Task`
+/// @brief A lazily started coroutine producing a value of type `T`. It starts
+/// once it is awaited or passed to `Master::run`
+template <typename T> class Task {
+  public:
+    using promise_type = detail::Promise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle_(handle) {}
+
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool done() const {
+        return handle_.done();
+    }
+
+    /// @function `start`
+    /// @brief Runs the task until it awaits its first request
+    void start() {
+        handle_.resume();
+    }
+
+    bool await_ready() const noexcept {
+        return handle_.done();
+    }
+
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> caller) noexcept {
+        handle_.promise().continuation = caller;
+        return handle_;
+    }
+
+    T await_resume() {
+        return result();
+    }
+
+    /// @function `result`
+    /// @brief Returns the result of the finished task, rethrowing the exception
+    /// it ended with
+    T result() {
+        promise_type &promise = handle_.promise();
+        if (promise.exception) {
+            std::rethrow_exception(promise.exception);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*promise.value);
+        }
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T> Task<T> Promise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() {
+    return Task<void>(
+        std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/*
+ * ====================
+ * PRE-ENCODED REQUESTS
+ * ====================
+ * The constexpr counterpart of the
+ * `FIP_ENCODED_FN_REQUEST` macro of `fip.h`. A
+ * request built from these functions in a
+ * constexpr context is encoded at build time:
+ *
+ *   // extern def add(mut i32* lhs, mut i32 rhs);
+ *   constexpr auto add_request = fip::enc::fn_request("add",
+ *       fip::enc::args(
+ *           fip::enc::arg(fip::enc::ptr(fip::enc::prim(FIP_I32), true)),
+ *           fip::enc::arg(fip::enc::prim(FIP_I32, true))),
+ *       fip::enc::rets());
+ *   master.symbol_encoded(add_request.data());
+ */
+
+namespace enc {
+
+template <size_t N> using Bytes = std::array<char, N>;
+
+template <size_t A, size_t B>
+constexpr Bytes<A + B> concat(const Bytes<A> &lhs, const Bytes<B> &rhs) {
+    Bytes<A + B> result{};
+    for (size_t i = 0; i < A; i++) {
+        result[i] = lhs[i];
+    }
+    for (size_t i = 0; i < B; i++) {
+        result[A + i] = rhs[i];
+    }
+    return result;
+}
+
+// Every encoded type starts with its kind followed by whether it is mutable
+constexpr Bytes<3> prim(          //
+    const fip_type_prim_e prim,   //
+    const bool is_mutable = false //
+) {
+    return {FIP_TYPE_PRIMITIVE, is_mutable, static_cast<char>(prim)};
+}
+
+template <size_t N>
+constexpr Bytes<N + 2> ptr(       //
+    const Bytes<N> &base,         //
+    const bool is_mutable = false //
+) {
+    return concat(Bytes<2>{FIP_TYPE_PTR, is_mutable}, base);
+}
+
+// Arguments and return types repeat the mutability of their type in front of
+// it, arguments are preceded by the length of their (empty) name
+template <size_t N> constexpr Bytes<N + 2> arg(const Bytes<N> &type) {
+    return concat(Bytes<2>{0, type[1]}, type);
+}
+
+template <size_t N> constexpr Bytes<N + 1> ret(const Bytes<N> &type) {
+    return concat(Bytes<1>{type[1]}, type);
+}
+
+template <size_t... N>
+constexpr Bytes<1 + (N + ... + 0)> args(const Bytes<N> &...list) {
+    static_assert(sizeof...(N) < 256, "too many arguments");
+    Bytes<1 + (N + ... + 0)> result{static_cast<char>(sizeof...(N))};
+    size_t idx = 1;
+    ((std::copy(list.begin(), list.end(), result.begin() + idx), idx += N),
+        ...);
+    return result;
+}
+
+template <size_t... N>
+constexpr Bytes<1 + (N + ... + 0)> rets(const Bytes<N> &...list) {
+    return args(list...);
+}
+
+/// @function `fn_request`
+/// @brief Encodes a symbol request of a function, starting with the length of
+/// the message just like the buffers filled by `fip_encode_msg`
+template <size_t L, size_t A, size_t R>
+constexpr Bytes<4 + 3 + (L - 1) + A + R> fn_request( //
+    const char (&name)[L],                           //
+    const Bytes<A> &arg_list,                        //
+    const Bytes<R> &ret_list                         //
+) {
+    static_assert(L - 1 < 128, "the name is too long");
+    constexpr uint32_t len = 3 + (L - 1) + A + R;
+    Bytes<4 + 3 + (L - 1) + A + R> result{};
+    for (size_t i = 0; i < 4; i++) {
+        const size_t shift = std::endian::native == std::endian::little
+            ? i * 8
+            : (3 - i) * 8;
+        result[i] = static_cast<char>((len >> shift) & 0xFF);
+    }
+    result[4] = FIP_MSG_SYMBOL_REQUEST;
+    result[5] = FIP_SYM_FUNCTION;
+    result[6] = static_cast<char>(L - 1);
+    size_t idx = 7;
+    for (size_t i = 0; i + 1 < L; i++) {
+        result[idx++] = name[i];
+    }
+    for (size_t i = 0; i < A; i++) {
+        result[idx++] = arg_list[i];
+    }
+    for (size_t i = 0; i < R; i++) {
+        result[idx++] = ret_list[i];
+    }
+    return result;
+}
+
+} // namespace enc
+
+/*
+ * ======
+ * MASTER
+ * ======
+ */
+
+/// @class `Master`
+/// @brief Drives the requests of the master once all interop modules are
+/// connected. Every request exists as a blocking call and as an awaitable for
+/// tasks, which is queued until `run` performs it
+class Master {
+  public:
+    /// @class `Request`
+    /// @brief The awaitable of a single request, resuming the awaiting task
+    /// with the result of the request once the master performed it
+    template <typename R, typename A = Message> class Request {
+      public:
+        using Perform = R (Master::*)(const A &);
+
+        Request(Master &master, A message, const Perform perform)
+            : master_(&master), message_(std::move(message)),
+              perform_(perform) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            master_->pending_.push_back({handle, this, &Request::complete});
+        }
+
+        R await_resume() {
+            return std::move(*result_);
+        }
+
+      private:
+        static void complete(void *request) {
+            Request *self = static_cast<Request *>(request);
+            self->result_.emplace(
+                (self->master_->*self->perform_)(self->message_));
+        }
+
+        Master *master_;
+        A message_;
+        Perform perform_;
+        std::optional<R> result_;
+    };
+
+    Master() = default;
+    Master(const Master &) = delete;
+    Master &operator=(const Master &) = delete;
+
+    SymbolResult symbol(const Message &request) {
+        fip_encode_msg(buffer_, request.get());
+        return symbol_encoded(buffer_);
+    }
+
+    /// @function `symbol_encoded`
+    /// @brief Performs a symbol request which was encoded already, for example
+    /// by `fip::enc::fn_request`
+    SymbolResult symbol_encoded(const char *const &encoded) {
+        SymbolResult result;
+        if (!fip_master_symbol_request_encoded(buffer_, encoded)) {
+            return result;
+        }
+        // The response is taken out of the response slots of the master, so
+        // the signature is moved instead of cloned
+        for (uint32_t i = 0; i < master_state.response_count; i++) {
+            fip_msg_t &response = master_state.responses[i];
+            if (response.type == FIP_MSG_SYMBOL_RESPONSE
+                && response.u.sym_res.found) {
+                result.response.emplace(Message::adopt(response));
+                break;
+            }
+        }
+        return result;
+    }
+
+    TagResult tag(const Message &request) {
+        const fip_tag_request_result_t result =
+            fip_master_tag_request(buffer_, request.get());
+        return TagResult{result.status, SigList(result.list)};
+    }
+
+    CompileResult compile(const Message &request) {
+        CompileResult result;
+        result.ok = fip_master_compile_request(buffer_, request.get());
+        const uint32_t count = result.ok ? master_state.response_count : 0;
+        for (uint32_t i = 0; i < count; i++) {
+            fip_msg_t &response = master_state.responses[i];
+            if (response.type == FIP_MSG_OBJECT_RESPONSE
+                && response.u.obj_res.has_obj) {
+                result.objects.push_back(Message::adopt(response));
+            }
+        }
+        return result;
+    }
+
+    UsageList usage(const Message &request) {
+        return UsageList(fip_master_usage_request(buffer_, request.get()));
+    }
+
+    uint32_t cleanup(const Message &request) {
+        return fip_master_cleanup_request(buffer_, request.get());
+    }
+
+    Request<SymbolResult> symbol_async(Message request) {
+        return {*this, std::move(request), &Master::symbol};
+    }
+
+    Request<SymbolResult, const char *> symbol_encoded_async(
+        const char *encoded) {
+        return {*this, encoded, &Master::symbol_encoded};
+    }
+
+    Request<TagResult> tag_async(Message request) {
+        return {*this, std::move(request), &Master::tag};
+    }
+
+    Request<CompileResult> compile_async(Message request) {
+        return {*this, std::move(request), &Master::compile};
+    }
+
+    Request<UsageList> usage_async(Message request) {
+        return {*this, std::move(request), &Master::usage};
+    }
+
+    Request<uint32_t> cleanup_async(Message request) {
+        return {*this, std::move(request), &Master::cleanup};
+    }
+
+    /// @function `next_change`
+    /// @brief Returns the oldest change notification the slaves pushed, waiting
+    /// up to `timeout_ms` milliseconds for one to arrive
+    std::optional<fip_msg_change_notification_t> next_change(
+        const uint32_t timeout_ms = 0) {
+        fip_msg_change_notification_t change;
+        if (fip_master_next_change(&change)) {
+            return change;
+        }
+        if (fip_master_poll_changes(buffer_, timeout_ms) > 0
+            && fip_master_next_change(&change)) {
+            return change;
+        }
+        return std::nullopt;
+    }
+
+    /// @function `run`
+    /// @brief Performs all queued requests in the order they were awaited and
+    /// resumes their tasks, until no request is queued anymore
+    void run() {
+        while (!pending_.empty()) {
+            const Pending pending = pending_.front();
+            pending_.pop_front();
+            pending.complete(pending.request);
+            pending.handle.resume();
+        }
+    }
+
+    /// @function `run`
+    /// @brief Starts the given task and performs requests until it finished
+    ///
+    /// @return `T` The result of the task
+    template <typename T> T run(Task<T> task) {
+        task.start();
+        run();
+        return task.result();
+    }
+
+  private:
+    struct Pending {
+        std::coroutine_handle<> handle;
+        void *request;
+        void (*complete)(void *request);
+    };
+
+    char buffer_[FIP_MSG_SIZE] = {0};
+    std::deque<Pending> pending_;
+};
+
+} // namespace fip
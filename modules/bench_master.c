@@ -0,0 +1,692 @@
+#define FIP_MASTER
+#define FIP_IMPLEMENTATION
+#include "fip.h"
+
+#ifdef DEBUG_BUILD
+fip_log_level_e LOG_LEVEL = FIP_INFO;
+#else
+fip_log_level_e LOG_LEVEL = FIP_ERROR;
+#endif
+fip_master_state_t master_state = {0};
+
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef __WIN32__
+#include <direct.h> // _mkdir, _chdir, _getcwd
+#define getcwd _getcwd
+#define chdir _chdir
+#else
+#include <dirent.h>
+#include <unistd.h>
+
+// Explicit function declarations for POSIX functions
+extern ssize_t readlink(const char *path, char *buf, size_t bufsiz);
+#endif
+
+/*
+ * ==============================================
+ * THIS IS THE COMPILE-PIPELINE BENCHMARK MASTER
+ * ==============================================
+ * The benchmark generates a synthetic C library
+ * of a configurable size together with its own
+ * `fip.toml` and `fip-c.toml` files and then
+ * drives the `fip-c` Interop Module through a
+ * full import + compile session for a set of
+ * scenarios:
+ *   - cold:   empty `.fip/cache` directory
+ *   - warm:   nothing changed since last run
+ *   - source: a single source file changed
+ *   - header: a header every source sees changed
+ * For each scenario it reports the wall time of
+ * the session, how often the compiler has been
+ * invoked, how many objects were served from the
+ * cache and how many bytes were written into the
+ * cache directory. The compiler invocations are
+ * counted by running the compiler through this
+ * very executable (`--cc` mode), which appends a
+ * line to a counter file for every invocation.
+ * Before that, the symbol requests encoded at
+ * build time are checked to be byte-identical to
+ * the ones `fip_encode_msg` encodes at runtime.
+ * ==============================================
+ */
+
+#define BENCH_TAG "bench"
+#define BENCH_COUNTER_FILE "compiles.log"
+#define BENCH_MAX_CACHE_FILES 4096
+
+typedef struct {
+    uint32_t files;
+    uint32_t functions;
+    uint32_t depth;
+    const char *compiler;
+    const char *dir;
+} bench_config_t;
+
+typedef struct {
+    const char *name;
+    bool ok;
+    double wall_ms;
+    uint32_t compiles;
+    uint32_t cache_hits;
+    uint64_t bytes_written;
+} bench_result_t;
+
+typedef struct {
+    char name[256];
+    int64_t size;
+    int64_t mtime;
+    uint64_t hash;
+} bench_cache_file_t;
+
+typedef struct {
+    uint32_t count;
+    bench_cache_file_t files[BENCH_MAX_CACHE_FILES];
+} bench_cache_snapshot_t;
+
+double bench_now_ms(void) {
+#ifdef __WIN32__
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+#endif
+}
+
+bool bench_mkdir(const char *path) {
+#ifdef __WIN32__
+    return _mkdir(path) == 0 || errno == EEXIST;
+#else
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+/// @function `bench_write_file`
+/// @brief Writes the given formatted content to the file at the given path,
+/// the file is either truncated or appended to
+__attribute__((format(printf, 3, 4))) bool bench_write_file( //
+    const char *path,                                        //
+    const bool append,                                       //
+    const char *format,                                      //
+    ...                                                      //
+) {
+    FILE *fp = fopen(path, append ? "a" : "w");
+    if (fp == NULL) {
+        fip_print(0, FIP_ERROR, "Could not open '%s' for writing", path);
+        return false;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(fp, format, args);
+    va_end(args);
+    fclose(fp);
+    return true;
+}
+
+/// @function `bench_generate_library`
+/// @brief Generates the synthetic C library and the config files of the
+/// benchmark in the current working directory. Every header includes a chain
+/// of `depth` common headers, and every source file implements the functions
+/// declared in its header
+///
+/// @param `config` The configuration of the library to generate
+/// @param `self_path` The path of this executable, used as compiler wrapper
+/// @return `bool` Whether all files could be written
+bool bench_generate_library(      //
+    const bench_config_t *config, //
+    const char *self_path         //
+) {
+    if (!bench_mkdir(".fip") || !bench_mkdir(".fip/config") ||
+        !bench_mkdir("include") || !bench_mkdir("src")) {
+        fip_print(0, FIP_ERROR, "Could not create the library directories");
+        return false;
+    }
+    char path[256];
+    for (uint32_t d = 0; d < config->depth; d++) {
+        snprintf(path, sizeof(path), "include/common_%u.h", d);
+        FILE *fp = fopen(path, "w");
+        if (fp == NULL) {
+            return false;
+        }
+        fprintf(fp, "#ifndef COMMON_%u_H\n#define COMMON_%u_H\n\n", d, d);
+        if (d > 0) {
+            fprintf(fp, "#include \"common_%u.h\"\n\n", d - 1);
+        }
+        fprintf(fp, "#define COMMON_%u_SCALE %u\n\n", d, d + 2);
+        fprintf(fp, "typedef struct common_%u_t {\n", d);
+        fprintf(fp, "    int id;\n    double weight;\n");
+        if (d > 0) {
+            fprintf(fp, "    struct common_%u_t *parent;\n", d - 1);
+        }
+        fprintf(fp, "} common_%u_t;\n\n#endif\n", d);
+        fclose(fp);
+    }
+    const uint32_t top = config->depth > 0 ? config->depth - 1 : 0;
+    for (uint32_t i = 0; i < config->files; i++) {
+        snprintf(path, sizeof(path), "include/lib_%u.h", i);
+        FILE *fp = fopen(path, "w");
+        if (fp == NULL) {
+            return false;
+        }
+        fprintf(fp, "#ifndef LIB_%u_H\n#define LIB_%u_H\n\n", i, i);
+        if (config->depth > 0) {
+            fprintf(fp, "#include \"common_%u.h\"\n\n", top);
+        }
+        for (uint32_t f = 0; f < config->functions; f++) {
+            fprintf(fp, "int lib_%u_fn_%u(int value, int factor);\n", i, f);
+        }
+        fprintf(fp, "\n#endif\n");
+        fclose(fp);
+
+        snprintf(path, sizeof(path), "src/lib_%u.c", i);
+        fp = fopen(path, "w");
+        if (fp == NULL) {
+            return false;
+        }
+        fprintf(fp, "#include \"lib_%u.h\"\n\n", i);
+        for (uint32_t f = 0; f < config->functions; f++) {
+            fprintf(fp,
+                "int lib_%u_fn_%u(int value, int factor) {\n"
+                "    int result = value;\n"
+                "    for (int i = 0; i < factor; i++) {\n"
+                "        result = result * %u + i;\n"
+                "    }\n"
+                "    return result ^ %u;\n"
+                "}\n\n",
+                i, f, f + 3, i * 31 + f);
+        }
+        fclose(fp);
+    }
+
+    if (!bench_write_file(".fip/config/fip.toml", false,
+            "[fip-c]\nenable = true\n")) {
+        return false;
+    }
+    return bench_write_file(".fip/config/fip-c.toml", false,
+        "[" BENCH_TAG "]\n"
+        "headers = [\"include\"]\n"
+        "sources = [\"src\"]\n"
+        "command = [\"%s\", \"--cc\", \"%s\", \"-Iinclude\", \"-c\", "
+        "\"__SOURCES__\", \"-o\", \"__OUTPUT__\", \"-MD\", \"-MF\", "
+        "\"__DEPFILE__\"]\n",
+        self_path, config->compiler);
+}
+
+/// @function `bench_hash_file`
+/// @brief Hashes the content of the given file (FNV-1a). Modification times
+/// alone are too coarse to detect rewrites within the same second
+uint64_t bench_hash_file(const char *path) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return hash;
+    }
+    unsigned char chunk[4096];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        for (size_t i = 0; i < len; i++) {
+            hash ^= chunk[i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    fclose(fp);
+    return hash;
+}
+
+/// @function `bench_snapshot_cache`
+/// @brief Records the size, modification time and content hash of all files
+/// in the `.fip/cache` directory
+void bench_snapshot_cache(bench_cache_snapshot_t *snapshot) {
+    snapshot->count = 0;
+#ifdef __WIN32__
+    WIN32_FIND_DATAA find_data;
+    HANDLE find = FindFirstFileA(".fip\\cache\\*", &find_data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ||
+            snapshot->count == BENCH_MAX_CACHE_FILES) {
+            continue;
+        }
+        bench_cache_file_t *file = &snapshot->files[snapshot->count++];
+        snprintf(file->name, sizeof(file->name), "%s", find_data.cFileName);
+        file->size = ((int64_t)find_data.nFileSizeHigh << 32) |
+            find_data.nFileSizeLow;
+        file->mtime = ((int64_t)find_data.ftLastWriteTime.dwHighDateTime
+                          << 32) |
+            find_data.ftLastWriteTime.dwLowDateTime;
+        char path[512];
+        snprintf(path, sizeof(path), ".fip/cache/%s", find_data.cFileName);
+        file->hash = bench_hash_file(path);
+    } while (FindNextFileA(find, &find_data));
+    FindClose(find);
+#else
+    DIR *dir = opendir(".fip/cache");
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL &&
+        snapshot->count < BENCH_MAX_CACHE_FILES) {
+        char path[512];
+        snprintf(path, sizeof(path), ".fip/cache/%s", entry->d_name);
+        struct stat st;
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        bench_cache_file_t *file = &snapshot->files[snapshot->count++];
+        snprintf(file->name, sizeof(file->name), "%s", entry->d_name);
+        file->size = (int64_t)st.st_size;
+        file->mtime = (int64_t)st.st_mtime;
+        file->hash = bench_hash_file(path);
+    }
+    closedir(dir);
+#endif
+}
+
+/// @function `bench_bytes_written`
+/// @brief Sums up the sizes of all cache files which were created or modified
+/// between the two snapshots
+uint64_t bench_bytes_written(             //
+    const bench_cache_snapshot_t *before, //
+    const bench_cache_snapshot_t *after   //
+) {
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < after->count; i++) {
+        const bench_cache_file_t *file = &after->files[i];
+        bool unchanged = false;
+        for (uint32_t j = 0; j < before->count; j++) {
+            if (strcmp(before->files[j].name, file->name) == 0) {
+                unchanged = before->files[j].size == file->size &&
+                    before->files[j].mtime == file->mtime &&
+                    before->files[j].hash == file->hash;
+                break;
+            }
+        }
+        if (!unchanged) {
+            bytes += (uint64_t)file->size;
+        }
+    }
+    return bytes;
+}
+
+/// @function `bench_count_compiles`
+/// @brief Counts the compiler invocations recorded in the counter file and
+/// resets the counter file afterwards
+uint32_t bench_count_compiles(void) {
+    FILE *fp = fopen(BENCH_COUNTER_FILE, "r");
+    if (fp == NULL) {
+        return 0;
+    }
+    uint32_t count = 0;
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+        if (c == '\n') {
+            count++;
+        }
+    }
+    fclose(fp);
+    remove(BENCH_COUNTER_FILE);
+    return count;
+}
+
+/// @function `bench_run_session`
+/// @brief Runs a whole FIP session: spawning the `fip-c` module, importing the
+/// benchmark's tag, compiling it and shutting the module down again
+///
+/// @param `root_path` The directory of the generated library
+/// @param `result` The result to fill with the measurements of the session
+void bench_run_session(const char *root_path, bench_result_t *result) {
+    fip_interop_modules_t interop_modules = {0};
+    char msg_buf[FIP_MSG_SIZE] = {0};
+    fip_msg_t msg = {0};
+    uint32_t object_count = 0;
+    result->ok = false;
+
+    bench_cache_snapshot_t *before = //
+        (bench_cache_snapshot_t *)malloc(sizeof(bench_cache_snapshot_t));
+    bench_cache_snapshot_t *after = //
+        (bench_cache_snapshot_t *)malloc(sizeof(bench_cache_snapshot_t));
+    bench_snapshot_cache(before);
+    remove(BENCH_COUNTER_FILE);
+
+    const double start = bench_now_ms();
+    if (!fip_spawn_interop_module(&interop_modules, root_path, "fip-c") ||
+        !fip_master_init(&interop_modules)) {
+        fip_print(0, FIP_ERROR, "Failed to start the fip-c module");
+        goto kill;
+    }
+    const uint32_t faulty_count = fip_master_await_responses( //
+        msg_buf, NULL, FIP_MSG_CONNECT_REQUEST                //
+    );
+    if (faulty_count > 0 || !master_state.responses[0].u.con_req.setup_ok) {
+        fip_print(0, FIP_ERROR, "The fip-c module failed to connect");
+        goto kill;
+    }
+
+    msg.type = FIP_MSG_TAG_REQUEST;
+    strcpy(msg.u.tag_req.tag, BENCH_TAG);
+    fip_tag_request_result_t tag_result = fip_master_tag_request(msg_buf, &msg);
+    fip_free_sig_list(tag_result.list);
+    if (tag_result.status != FIP_TAG_REQUEST_STATUS_OK) {
+        fip_print(0, FIP_ERROR, "Importing the '%s' tag failed", BENCH_TAG);
+        goto kill;
+    }
+
+    msg = (fip_msg_t){0};
+    msg.type = FIP_MSG_COMPILE_REQUEST;
+    if (!fip_master_compile_request(msg_buf, &msg)) {
+        goto kill;
+    }
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
+        const fip_msg_object_response_t *obj_res =
+            &master_state.responses[i].u.obj_res;
+        if (obj_res->compilation_failed) {
+            goto kill;
+        }
+        object_count += obj_res->path_count;
+    }
+    result->ok = true;
+
+kill:
+    result->wall_ms = bench_now_ms() - start;
+    msg = (fip_msg_t){0};
+    msg.type = FIP_MSG_KILL;
+    msg.u.kill.reason = FIP_KILL_FINISH;
+    fip_master_broadcast_message(msg_buf, &msg);
+#ifndef __WIN32__
+    // Wait for the module to shut down, it could still be writing its caches
+    for (uint32_t i = 0; i < interop_modules.active_count; i++) {
+        waitpid(interop_modules.pids[i], NULL, 0);
+    }
+#else
+    msleep(100);
+#endif
+    fip_master_cleanup();
+    fip_terminate_all_slaves(&interop_modules);
+
+    bench_snapshot_cache(after);
+    result->compiles = bench_count_compiles();
+    result->cache_hits = object_count > result->compiles //
+        ? object_count - result->compiles                //
+        : 0;
+    result->bytes_written = bench_bytes_written(before, after);
+    free(before);
+    free(after);
+}
+
+/// @function `bench_remove_cache`
+/// @brief Removes all files of the `.fip/cache` directory
+void bench_remove_cache(void) {
+    bench_cache_snapshot_t *snapshot = //
+        (bench_cache_snapshot_t *)malloc(sizeof(bench_cache_snapshot_t));
+    bench_snapshot_cache(snapshot);
+    for (uint32_t i = 0; i < snapshot->count; i++) {
+        char path[512];
+        snprintf(path, sizeof(path), ".fip/cache/%s", snapshot->files[i].name);
+        remove(path);
+    }
+    free(snapshot);
+}
+
+/// @function `bench_compile_wrapper`
+/// @brief The `--cc` mode of the benchmark. Records the invocation in the
+/// counter file and runs the actual compiler with all remaining arguments
+int bench_compile_wrapper(int argc, char *argv[]) {
+    bench_write_file(BENCH_COUNTER_FILE, true, "%s\n", argv[2]);
+    // Every argument is quoted, so paths containing spaces or shell
+    // characters reach the compiler unchanged. A quote within an argument
+    // takes up to four characters once escaped
+    size_t command_size = 1;
+    for (int i = 2; i < argc; i++) {
+        command_size += strlen(argv[i]) * 4 + 3;
+    }
+    char *command = (char *)malloc(command_size);
+    size_t idx = 0;
+    for (int i = 2; i < argc; i++) {
+#ifdef __WIN32__
+        command[idx++] = '"';
+        for (const char *c = argv[i]; *c != '\0'; c++) {
+            if (*c == '"') {
+                command[idx++] = '\\';
+            }
+            command[idx++] = *c;
+        }
+        command[idx++] = '"';
+#else
+        command[idx++] = '\'';
+        for (const char *c = argv[i]; *c != '\0'; c++) {
+            if (*c == '\'') {
+                memcpy(command + idx, "'\\''", 4);
+                idx += 4;
+                continue;
+            }
+            command[idx++] = *c;
+        }
+        command[idx++] = '\'';
+#endif
+        command[idx++] = ' ';
+    }
+    command[idx > 0 ? idx - 1 : 0] = '\0';
+    int exit_code = system(command);
+    free(command);
+#ifndef __WIN32__
+    if (exit_code != -1) {
+        exit_code = WEXITSTATUS(exit_code);
+    }
+#endif
+    return exit_code;
+}
+
+/// @function `bench_self_path`
+/// @brief Gets the absolute path of this executable
+bool bench_self_path(char *path, const size_t size) {
+#ifdef __WIN32__
+    const DWORD len = GetModuleFileNameA(NULL, path, (DWORD)size);
+    return len > 0 && len < size;
+#else
+    const ssize_t len = readlink("/proc/self/exe", path, size - 1);
+    if (len <= 0) {
+        return false;
+    }
+    path[len] = '\0';
+    return true;
+#endif
+}
+
+/// @function `bench_check_encoded_request`
+/// @brief Checks whether a request encoded at build time is byte-identical to
+/// the request `fip_encode_msg` encodes from the same signature at runtime
+///
+/// @param `name` The name of the checked request
+/// @param `encoded` The request encoded at build time
+/// @param `fn` The signature the request was encoded from
+/// @return `bool` Whether both encodings are identical
+bool bench_check_encoded_request( //
+    const char *name,             //
+    const char *encoded,          //
+    const fip_sig_fn_t *fn        //
+) {
+    fip_msg_t message = {.type = FIP_MSG_SYMBOL_REQUEST};
+    message.u.sym_req.type = FIP_SYM_FUNCTION;
+    message.u.sym_req.sig.fn = *fn;
+    char buffer[FIP_MSG_SIZE] = {0};
+    fip_encode_msg(buffer, &message);
+    uint32_t encoded_len = 0;
+    uint32_t expected_len = 0;
+    memcpy(&encoded_len, encoded, sizeof(uint32_t));
+    memcpy(&expected_len, buffer, sizeof(uint32_t));
+    if (encoded_len != expected_len) {
+        fip_print(0, FIP_ERROR,
+            "The pre-encoded request '%s' has %u bytes, fip_encode_msg "
+            "encodes %u bytes",
+            name, encoded_len, expected_len);
+        return false;
+    }
+    for (uint32_t i = 0; i < 4 + encoded_len; i++) {
+        if (encoded[i] != buffer[i]) {
+            fip_print(0, FIP_ERROR,
+                "The pre-encoded request '%s' differs from fip_encode_msg "
+                "at byte %u",
+                name, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @function `bench_check_encoded_requests`
+/// @brief Checks the requests encoded at build time through
+/// `FIP_ENCODED_FN_REQUEST` against the encoding of `fip_encode_msg`. The
+/// benchmark does not run when they differ, since a master sending them would
+/// not find the symbols
+///
+/// @return `bool` Whether all checked requests are identical
+bool bench_check_encoded_requests(void) {
+    fip_type_t i32 = {.type = FIP_TYPE_PRIMITIVE, .u.prim = FIP_I32};
+    fip_type_t u8 = {.type = FIP_TYPE_PRIMITIVE, .u.prim = FIP_U8};
+
+    // extern def add(mut i32* lhs, mut i32 rhs);
+    static FIP_ENCODED_FN_REQUEST(add_request, "add",
+        FIP_ENC_ARGS(2,
+            FIP_ENC_ARG(FIP_ENC_PTR(true, FIP_ENC_PRIM(false, FIP_I32))),
+            FIP_ENC_ARG(FIP_ENC_PRIM(true, FIP_I32))),
+        FIP_ENC_RETS(0));
+    fip_sig_fn_arg_t add_args[2] = {
+        {.type = {.type = FIP_TYPE_PTR, .is_mutable = true}},
+        {.type = i32},
+    };
+    add_args[0].type.u.ptr.base_type = &i32;
+    add_args[1].type.is_mutable = true;
+    const fip_sig_fn_t add = {.name = "add", .args_len = 2, .args = add_args};
+
+    // extern def name(u8 tag) -> mut u8*;
+    static FIP_ENCODED_FN_REQUEST(name_request, "name",
+        FIP_ENC_ARGS(1, FIP_ENC_ARG(FIP_ENC_PRIM(false, FIP_U8))),
+        FIP_ENC_RETS(1,
+            FIP_ENC_RET(FIP_ENC_PTR(true, FIP_ENC_PRIM(false, FIP_U8)))));
+    fip_sig_fn_arg_t name_args[1] = {{.type = u8}};
+    fip_type_t name_rets[1] = {{.type = FIP_TYPE_PTR, .is_mutable = true}};
+    name_rets[0].u.ptr.base_type = &u8;
+    const fip_sig_fn_t name = {
+        .name = "name",
+        .args_len = 1,
+        .args = name_args,
+        .rets_len = 1,
+        .rets = name_rets,
+    };
+
+    return bench_check_encoded_request("add", FIP_ENCODED(add_request), &add)
+        && bench_check_encoded_request("name", FIP_ENCODED(name_request),
+            &name);
+}
+
+void bench_print_usage(const char *name) {
+    printf("Usage: %s [options]\n", name);
+    printf("  --files <n>      Number of headers and sources (default 32)\n");
+    printf("  --functions <n>  Number of functions per file (default 64)\n");
+    printf("  --depth <n>      Include depth of the common headers "
+           "(default 4)\n");
+    printf("  --compiler <cc>  The C compiler to use (default cc)\n");
+    printf("  --dir <path>     Where to generate the library "
+           "(default fip-bench)\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--cc") == 0) {
+        return bench_compile_wrapper(argc, argv);
+    }
+    bench_config_t config = {
+        .files = 32,
+        .functions = 64,
+        .depth = 4,
+        .compiler = "cc",
+        .dir = "fip-bench",
+    };
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--files") == 0 && has_value) {
+            config.files = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--functions") == 0 && has_value) {
+            config.functions = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--depth") == 0 && has_value) {
+            config.depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--compiler") == 0 && has_value) {
+            config.compiler = argv[++i];
+        } else if (strcmp(argv[i], "--dir") == 0 && has_value) {
+            config.dir = argv[++i];
+        } else {
+            bench_print_usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (config.files == 0) {
+        bench_print_usage(argv[0]);
+        return 1;
+    }
+    if (!bench_check_encoded_requests()) {
+        return 1;
+    }
+
+    char self_path[512];
+    if (!bench_self_path(self_path, sizeof(self_path))) {
+        fip_print(0, FIP_ERROR, "Could not resolve the benchmark's own path");
+        return 1;
+    }
+    if (!bench_mkdir(config.dir) || chdir(config.dir) != 0) {
+        fip_print(0, FIP_ERROR, "Could not enter '%s'", config.dir);
+        return 1;
+    }
+    char root_path[512];
+    if (getcwd(root_path, sizeof(root_path)) == NULL) {
+        fip_print(0, FIP_ERROR, "getcwd() failed");
+        return 1;
+    }
+    if (!bench_generate_library(&config, self_path)) {
+        return 1;
+    }
+    printf("Library: %u files, %u functions per file, include depth %u\n",
+        config.files, config.functions, config.depth);
+
+    bench_result_t results[4] = {
+        {.name = "cold"},
+        {.name = "warm"},
+        {.name = "source changed"},
+        {.name = "header changed"},
+    };
+    // Cold: nothing is cached yet
+    bench_remove_cache();
+    bench_run_session(root_path, &results[0]);
+    // Warm: nothing changed since the last session
+    bench_run_session(root_path, &results[1]);
+    // Source changed: a single source file gets a new function
+    bench_write_file("src/lib_0.c", true,
+        "int lib_0_bench_extra(void) {\n    return 42;\n}\n");
+    bench_run_session(root_path, &results[2]);
+    // Header changed: the root of the common include chain changes, which is
+    // (transitively) included by every single source
+    const char *changed_header = config.depth > 0 //
+        ? "include/common_0.h"                    //
+        : "include/lib_0.h";
+    bench_write_file(changed_header, true,
+        "\n#define BENCH_HEADER_CHANGED 1\n");
+    bench_run_session(root_path, &results[3]);
+
+    printf("\n%-16s %12s %10s %11s %15s\n", "scenario", "wall [ms]",
+        "compiles", "cache hits", "bytes written");
+    bool all_ok = true;
+    for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); i++) {
+        const bench_result_t *r = &results[i];
+        printf("%-16s %12.1f %10u %11u %15llu%s\n", r->name, r->wall_ms,
+            r->compiles, r->cache_hits, (unsigned long long)r->bytes_written,
+            r->ok ? "" : "  (failed)");
+        all_ok &= r->ok;
+    }
+    return all_ok ? 0 : 1;
+}
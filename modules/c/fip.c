@@ -1,3 +1,8 @@
+// The type of directory entries (`d_type`) is no part of POSIX, glibc and
+// macOS only declare it next to the POSIX functions with these macros
+#define _DEFAULT_SOURCE
+#define _DARWIN_C_SOURCE
+
 #define FIP_SLAVE
 #define FIP_IMPLEMENTATION
 #include "fip.h"
@@ -15,9 +20,22 @@ fip_log_level_e LOG_LEVEL = FIP_WARN;
 #include <stdlib.h>
 #include <time.h>
 
+#include <sys/stat.h>
+
 #ifdef _WIN32
 #include <fcntl.h> // _O_BINARY
 #include <io.h>    // _setmode, _fileno
+#else
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+// Explicit function declarations for POSIX functions
+extern int lstat(const char *path, struct stat *buf);
+extern int getloadavg(double loadavg[], int nelem);
+extern pid_t wait4(pid_t pid, int *status, int options, struct rusage *usage);
 #endif
 
 /*
@@ -47,36 +65,73 @@ const char *c_type_names[] = {
     "unsigned char",
     "unsigned short",
     "unsigned int",
-    "unsigned long",
+    "uint64_t",
     "char",
     "short",
     "int",
-    "long",
+    "int64_t",
     "float",
     "double",
     "bool",
     "char *",
+    "unsigned long long",
+    "long long",
+    "size_t",
+    "ptrdiff_t",
+    "long double",
+    "_Float16",
+    "unsigned __int128",
+    "__int128",
+    "char16_t",
+    "char32_t",
+    "unsigned long",
+    "long",
 };
 
 typedef struct {
     char source_file_path[512];
     int line_number;
     fip_msg_symbol_type_e type;
-    union {
-        fip_sig_fn_t fn;
-        fip_sig_data_t data;
-        fip_sig_enum_t enum_t;
-        fip_sig_opaque_t opaque;
-    } sig;
+    /// @var `fingerprint`
+    /// @brief The ABI fingerprint of the symbol, see `fingerprint_symbol`
+    uint64_t fingerprint;
+    /// @var `abi_changed`
+    /// @brief Whether the fingerprint differs from the one persisted by the
+    /// last session which imported the tag of this symbol
+    bool abi_changed;
+    fip_sig_u sig;
 } fip_c_symbol_t;
 
 typedef struct {
     char tag[128];
     uint32_t headers_len;
     char **headers;
+    uint32_t sources_len;
+    char **sources;
+    /// @var `header_extensions`
+    /// @brief The file extensions of the headers collected from directory
+    /// entries of `headers`
+    uint32_t header_extensions_len;
+    char **header_extensions;
+    /// @var `source_extensions`
+    /// @brief The file extensions of the sources collected from directory
+    /// entries of `sources`
+    uint32_t source_extensions_len;
+    char **source_extensions;
+    /// @var `command`
+    /// @brief The command template, it still contains the `__SOURCES__` and
+    /// `__OUTPUT__` substitutes which are replaced for every compiled source
     uint32_t command_len;
     char **command;
-    char output[FIP_PATH_SIZE + 1];
+    /// @var `clang_modules`
+    /// @brief Whether the headers are parsed with Clang modules enabled. Modular
+    /// headers are then only parsed once and loaded from the module cache in
+    /// `.fip/cache/clang-modules` afterwards, even across restarts
+    bool clang_modules;
+    /// @var `auto_pch`
+    /// @brief Whether a precompiled header is built for the include all sources
+    /// of the tag start with, and used when compiling them
+    bool auto_pch;
 } fip_module_config_t;
 
 typedef struct {
@@ -84,6 +139,57 @@ typedef struct {
     fip_module_config_t *configs;
 } fip_modules_config_t;
 
+typedef struct {
+    /// @var `operand`
+    /// @brief The operand of the `#include` directive in the header which is
+    /// precompiled, for example `<stdio.h>` or `"../../include/lib.h"`
+    char operand[512];
+    /// @var `path`
+    /// @brief The included file if it was found next to the source, empty if
+    /// it is found through the include paths of the command
+    char path[512];
+} prefix_include_t;
+
+#define CLANG_MODULES_CACHE_PATH ".fip/cache/clang-modules"
+
+#define SYMBOL_INDEX_END UINT32_MAX
+
+typedef struct {
+    /// @var `seeds`
+    /// @brief The seed of every bucket. A positive seed hashes all names of the
+    /// bucket to their slots, a negative seed `-s - 1` is the slot of the only
+    /// name of the bucket
+    int32_t *seeds;
+    /// @var `slots`
+    /// @brief The first symbol of the name hashed to each slot
+    uint32_t *slots;
+    /// @var `next`
+    /// @brief The next symbol sharing the name of each symbol, or
+    /// `SYMBOL_INDEX_END`
+    uint32_t *next;
+    /// @var `size`
+    /// @brief The number of distinct names, buckets and slots
+    uint32_t size;
+} symbol_index_t;
+
+typedef enum symbol_data_state_e : uint8_t {
+    SYMBOL_DATA_UNCHECKED = 0,
+    // The persisted symbol data matches the current inputs of the tag
+    SYMBOL_DATA_VALID,
+    // There is no persisted symbol data or it is stale, the headers of the tag
+    // have to be parsed
+    SYMBOL_DATA_MISSING,
+} symbol_data_state_e;
+
+typedef struct {
+    symbol_data_state_e state;
+    /// @var `bytes`
+    /// @brief The mapped `.fip/cache/<tag>.sym` file, only set while the data
+    /// is valid and the collection is not loaded yet. It is mapped read-only
+    char *bytes;
+    size_t size;
+} symbol_data_t;
+
 #define MAX_SYMBOLS 1000
 typedef struct {
     /// @var `needed`
@@ -93,9 +199,24 @@ typedef struct {
     /// (or more) symbol(s) of that module are used then the whole module is
     /// compiled and returned.
     bool needed;
+    /// @var `abi_reported`
+    /// @brief Whether the ABI changes of this collection were reported to the
+    /// master in this session, only then its fingerprints are persisted
+    bool abi_reported;
+    /// @var `is_loaded`
+    /// @brief Whether the symbols of this collection are loaded. A collection
+    /// is only loaded once a request touches its tag, see `collection_load`
+    bool is_loaded;
+    /// @var `data`
+    /// @brief The persisted symbol data of the tag
+    symbol_data_t data;
     char tag[128];
     size_t symbol_count;
     fip_c_symbol_t symbols[MAX_SYMBOLS];
+    /// @var `index`
+    /// @brief The index over the names of all symbols, built once the headers
+    /// of the tag are parsed
+    symbol_index_t index;
 } fip_c_symbol_collection_t;
 
 typedef struct {
@@ -104,29 +225,22 @@ typedef struct {
 } fip_c_symbol_list_t;
 
 typedef struct {
-    fip_type_t *fields;
-    int current_index;
-    uint32_t module_id;
-} field_visitor_data;
-
-typedef struct {
-    char **field_names;
-    int current_index;
-    uint32_t module_id;
-} field_name_visitor_data;
-
-typedef struct {
+    char **names;
+    fip_type_t *types;
     size_t *values;
-    int current_index;
-    uint32_t module_id;
-} enum_visitor_data;
+    uint32_t len;
+    uint32_t cap;
+} member_scratch_t;
 
 typedef struct {
-    char **tags;
-    size_t *values;
-    int current_index;
-    uint32_t module_id;
-} enum_sig_visitor_data;
+    /// @var `base`
+    /// @brief The length of the scratch buffer when the traversal started, the
+    /// members of the traversed record start there
+    uint32_t base;
+    bool with_names;
+    bool with_types;
+    bool failed;
+} member_visitor_data;
 
 /*
  * ==============================================
@@ -197,1361 +311,4292 @@ int stack_find_equal(cx_type_stack *s, CXType canonical) {
 
 uint32_t ID;
 fip_c_symbol_list_t symbol_list;
-fip_c_symbol_collection_t *curr_coll;
+/// @var `curr_coll`
+/// @brief The collection the symbols found by the parsing thread are added to
+_Thread_local fip_c_symbol_collection_t *curr_coll;
 fip_modules_config_t CONFIGS;
-cx_type_stack stack;
+_Thread_local cx_type_stack stack;
 
-bool parse_toml_file(toml_result_t toml) {
-    // Validate top-level is a table (toml.toptab)
-    if (toml.toptab.type != TOML_TABLE) {
-        fip_print(ID, FIP_ERROR, "TOML root is not a table");
+/// @function `ensure_cache_dir`
+/// @brief Ensures the `.fip/cache` directory exists
+///
+/// @return `bool` Whether the directory exists or could be created
+bool ensure_cache_dir(void) {
+#ifdef __WIN32__
+    if (CreateDirectoryA(".fip", NULL) ||
+        GetLastError() == ERROR_ALREADY_EXISTS) {
+        if (!CreateDirectoryA(".fip/cache", NULL) &&
+            GetLastError() != ERROR_ALREADY_EXISTS) {
+            fip_print(ID, FIP_ERROR, "Failed to create .fip/cache directory");
+            return false;
+        }
+    } else {
+        fip_print(ID, FIP_ERROR, "Failed to create .fip directory");
         return false;
     }
-
-    // First pass: count top-level tables (each is a module config)
-    const int32_t top_count = toml.toptab.u.tab.size;
-    if (top_count <= 0) {
-        fip_print(ID, FIP_ERROR, "No top-level entries in TOML");
+#else
+    if (mkdir(".fip", 0755) != 0 && errno != EEXIST) {
+        fip_print(ID, FIP_ERROR, "Failed to create .fip directory: %s",
+            strerror(errno));
         return false;
     }
-
-    for (int32_t i = 0; i < top_count; ++i) {
-        toml_datum_t v = toml.toptab.u.tab.value[i];
-        if (v.type != TOML_TABLE) {
-            fip_print(ID, FIP_ERROR, "Incorrect top-level entry in TOML");
-            return false;
-        }
+    if (mkdir(".fip/cache", 0755) != 0 && errno != EEXIST) {
+        fip_print(ID, FIP_ERROR, "Failed to create .fip/cache directory: %s",
+            strerror(errno));
+        return false;
     }
+#endif
+    return true;
+}
 
-    // Allocate CONFIGS
-    CONFIGS.count = (size_t)top_count;
-    CONFIGS.configs = (fip_module_config_t *)malloc( //
-        sizeof(fip_module_config_t) * CONFIGS.count  //
-    );
-    memset(CONFIGS.configs, 0, sizeof(fip_module_config_t) * CONFIGS.count);
+/*
+ * ==============================================
+ * PATH EXPANSION Functions
+ * ==============================================
+ * Entries of the `headers` and `sources` lists
+ * may not only be plain files but also whole
+ * directories or glob patterns. Directories are
+ * walked recursively and globs support `*`, `?`
+ * and `**` (any number of directories). Walking
+ * large SDK trees on every startup is slow, so
+ * the listing of every visited directory is kept
+ * in the `.fip/cache/scan.cache` file together
+ * with the directory's modification time. A dir
+ * whose mtime did not change is not read again.
+ * All configured entries are expanded in parallel
+ * ==============================================
+ */
 
-    // Second pass: fill CONFIGS
-    size_t cfg_idx = 0;
-    for (int32_t i = 0; i < top_count; ++i) {
-        toml_datum_t v = toml.toptab.u.tab.value[i];
-        const char *keyname = toml.toptab.u.tab.key[i];
-        int keylen = toml.toptab.u.tab.len[i];
+#define SCAN_CACHE_PATH ".fip/cache/scan.cache"
+#define SCAN_CACHE_MAGIC "fip-scan-cache 1"
+#define SCAN_MAX_THREADS 8
 
-        fip_module_config_t *cfg = &CONFIGS.configs[cfg_idx];
-        memset(cfg, 0, sizeof(fip_module_config_t));
-        // copy tag (may be empty)
-        int copy_len = keylen < (int)sizeof(cfg->tag) - 1
-            ? keylen
-            : (int)sizeof(cfg->tag) - 1;
-        if (copy_len > 0) {
-            memcpy(cfg->tag, keyname, (size_t)copy_len);
-        }
-        cfg->tag[copy_len] = '\0';
+typedef struct {
+    char **items;
+    uint32_t len;
+    uint32_t cap;
+} path_list_t;
 
-        // module table datum, this is the table itself
-        toml_datum_t module = v;
+typedef struct {
+    char *name;
+    bool is_dir;
+} scan_entry_t;
 
-        // headers (required, array of strings)
-        toml_datum_t headers_d = toml_get(module, "headers");
-        if (headers_d.type != TOML_ARRAY) {
-            fip_print(ID, FIP_ERROR,
-                "Missing or invalid 'headers' in table '%s'", cfg->tag);
-            goto fail;
-        }
-        size_t headers_len = headers_d.u.arr.size;
-        if (headers_len < 0) {
-            headers_len = 0;
-        }
-        cfg->headers = (char **)malloc(sizeof(char *) * (size_t)headers_len);
-        cfg->headers_len = (uint32_t)headers_len;
-        toml_datum_t *header_elems = headers_d.u.arr.elem;
-        for (size_t j = 0; j < headers_len; ++j) {
-            if (header_elems[j].type != TOML_STRING) {
-                fip_print(ID, FIP_ERROR,
-                    "Non-string in 'headers' of table '%s'", cfg->tag);
-                // free allocated so far for this cfg
-                for (size_t k = 0; k < j; ++k) {
-                    free(cfg->headers[k]);
-                }
-                free(cfg->headers);
-                cfg->headers = NULL;
-                cfg->headers_len = 0;
-                goto fail;
-            }
-            int32_t slen = header_elems[j].u.str.len;
-            cfg->headers[j] = (char *)malloc((size_t)slen + 1);
-            memcpy(cfg->headers[j], header_elems[j].u.str.ptr, (size_t)slen);
-            cfg->headers[j][slen] = '\0';
-        }
+typedef struct {
+    char *path;
+    int64_t mtime;
+    uint32_t entry_count;
+    scan_entry_t *entries;
+} scan_dir_t;
 
-        // sources (optional, array of strings)
-        toml_datum_t sources_d = toml_get(module, "sources");
-        size_t sources_len = 0;
-        char **sources = NULL;
-        const bool sources_present = sources_d.type == TOML_ARRAY;
-        if (sources_present) {
-            sources_len = sources_d.u.arr.size;
-            if (sources_len < 0) {
-                sources_len = 0;
-            }
-            sources = (char **)malloc(               //
-                sizeof(char *) * (size_t)sources_len //
-            );
-            toml_datum_t *elems = sources_d.u.arr.elem;
-            for (size_t j = 0; j < sources_len; ++j) {
-                if (elems[j].type != TOML_STRING) {
-                    fip_print(ID, FIP_ERROR,
-                        "Non-string in 'sources' of table '%s'", cfg->tag);
-                    // free allocated so far for this cfg
-                    for (size_t k = 0; k < j; ++k) {
-                        free(sources[k]);
-                    }
-                    free(sources);
-                    sources = NULL;
-                    sources_len = 0;
-                    goto fail;
-                }
-                int32_t slen = elems[j].u.str.len;
-                sources[j] = (char *)malloc((size_t)slen + 1);
-                memcpy(sources[j], elems[j].u.str.ptr, (size_t)slen);
-                sources[j][slen] = '\0';
-            }
-        }
+typedef struct {
+    /// @var `scan_time`
+    /// @brief The time at which the scan which produced this cache started.
+    /// Directories modified in the same second or later could have changed
+    /// without their mtime changing, so they are never trusted
+    int64_t scan_time;
+    uint32_t len;
+    uint32_t cap;
+    scan_dir_t *dirs;
+} scan_cache_t;
 
-        // command (optional, array of strings)
-        // Fails if command is present but no sources are present
-        toml_datum_t command_d = toml_get(module, "command");
-        const bool command_present = command_d.type == TOML_ARRAY;
-        bool command_sources_substituted = false;
-        bool command_output_substituted = false;
-        if (command_present) {
-            if (!sources_present || sources_len == 0) {
-                fip_print(ID, FIP_ERROR,
-                    "Missing, invalid or empty 'sources' in table '%s'",
-                    cfg->tag);
-                goto fail;
-            }
-            size_t command_len = command_d.u.arr.size;
-            if (command_len < 0) {
-                command_len = 0;
+typedef struct {
+    /// @var `entry`
+    /// @brief The directory or glob entry as written in the config
+    const char *entry;
+    /// @var `extensions`
+    /// @brief The file extensions matched when `entry` is a plain directory
+    char *const *extensions;
+    uint32_t extension_count;
+    /// @var `files`
+    /// @brief All files matched by the entry, in a deterministic order
+    path_list_t files;
+    /// @var `scanned`
+    /// @brief All directories visited by this job, used to update the cache
+    scan_cache_t scanned;
+} scan_job_t;
+
+scan_cache_t SCAN_CACHE;
+
+void path_list_push(path_list_t *list, char *path) {
+    if (list->len == list->cap) {
+        list->cap = list->cap == 0 ? 16 : list->cap * 2;
+        list->items = (char **)realloc(list->items, sizeof(char *) * list->cap);
+    }
+    list->items[list->len++] = path;
+}
+
+void path_list_free(path_list_t *list) {
+    for (uint32_t i = 0; i < list->len; i++) {
+        free(list->items[i]);
+    }
+    free(list->items);
+    *list = (path_list_t){0};
+}
+
+char *clone_string(const char *str) {
+    const size_t len = strlen(str) + 1;
+    char *clone = (char *)malloc(len);
+    memcpy(clone, str, len);
+    return clone;
+}
+
+char *path_join(const char *dir, const char *name) {
+    if (strcmp(dir, ".") == 0) {
+        return clone_string(name);
+    }
+    size_t dir_len = strlen(dir);
+    const size_t name_len = strlen(name);
+    char *path = (char *)malloc(dir_len + name_len + 2);
+    memcpy(path, dir, dir_len);
+    if (dir_len == 0 || dir[dir_len - 1] != '/') {
+        path[dir_len++] = '/';
+    }
+    memcpy(path + dir_len, name, name_len + 1);
+    return path;
+}
+
+bool path_is_glob(const char *path) {
+    return strpbrk(path, "*?") != NULL;
+}
+
+bool path_is_directory(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/// @function `glob_match`
+/// @brief Matches the given path against the given glob pattern. The `*` and
+/// `?` wildcards never match a `/`, the `**` wildcard matches across
+/// directories and `**/` also matches no directory at all
+///
+/// @param `pattern` The glob pattern to match against
+/// @param `str` The relative path to match
+/// @return `bool` Whether the path matches the pattern
+bool glob_match(const char *pattern, const char *str) {
+    while (*pattern) {
+        if (pattern[0] == '*' && pattern[1] == '*') {
+            pattern += 2;
+            const bool dir_wildcard = *pattern == '/';
+            if (dir_wildcard) {
+                pattern++;
             }
-            // The command needs to be the size of the actual command strings +
-            // the number of sources - 1 (since the `__SOURCES__` string is
-            // substituted with the sources)
-            command_len += sources_len - 1;
-            cfg->command = (char **)malloc(          //
-                sizeof(char *) * (size_t)command_len //
-            );
-            cfg->command_len = (uint32_t)command_len;
-            toml_datum_t *elems = command_d.u.arr.elem;
-            for (size_t j = 0; j < command_len - sources_len + 1; ++j) {
-                size_t cmd_idx = command_sources_substituted //
-                    ? j + sources_len - 1                    //
-                    : j;
-                if (elems[j].type != TOML_STRING) {
-                    fip_print(ID, FIP_ERROR,
-                        "Non-string in 'command' of table '%s'", cfg->tag);
-                    // Clean up all command string so far
-                    for (size_t k = 0; k < cmd_idx; ++k) {
-                        free(cfg->command[k]);
-                    }
-                    free(cfg->command);
-                    cfg->command = NULL;
-                    cfg->command_len = 0;
-                    for (size_t k = 0; k < sources_len; ++k) {
-                        free(sources[k]);
-                    }
-                    free(sources);
-                    sources = NULL;
-                    sources_len = 0;
-                    goto fail;
-                }
-                int32_t slen = elems[j].u.str.len;
-                if (strncmp(                                                  //
-                        elems[j].u.str.ptr, "__SOURCES__", (size_t)slen) == 0 //
-                ) {
-                    if (command_sources_substituted) {
-                        // Substituting the sources twice is not allowed
-                        fip_print(ID, FIP_ERROR,
-                            "Substituting '__SOURCES__' twice in 'command' in table '%s'",
-                            cfg->tag);
-                        // Clean up all command string so far
-                        for (size_t k = 0; k < cmd_idx; ++k) {
-                            free(cfg->command[k]);
-                        }
-                        free(cfg->command);
-                        cfg->command = NULL;
-                        cfg->command_len = 0;
-                        for (size_t k = 0; k < sources_len; ++k) {
-                            free(sources[k]);
-                        }
-                        free(sources);
-                        goto fail;
-                    }
-                    // Substitute the sources' content into the command by
-                    // simply copying over the pointer shallowly and then just
-                    // freeing the `sources` itself instead of freeing the
-                    // strings themselves.
-                    assert(cmd_idx == j);
-                    for (size_t k = 0; k < sources_len; k++) {
-                        cfg->command[j + k] = sources[k];
-                    }
-                    free(sources);
-                    sources = NULL;
-                    command_sources_substituted = true;
-                } else if (strncmp(elems[j].u.str.ptr, "__OUTPUT__", //
-                               (size_t)slen) == 0                    //
+            for (const char *s = str;; s++) {
+                if ((!dir_wildcard || s == str || s[-1] == '/') //
+                    && glob_match(pattern, s)                   //
                 ) {
-                    if (command_output_substituted) {
-                        // Substituting the sources twice is not allowed
-                        fip_print(ID, FIP_ERROR,
-                            "Substituting '__OUTPUT__' twice in 'command' in table '%s'",
-                            cfg->tag);
-                        // Clean up all command string so far
-                        for (size_t k = 0; k < j; ++k) {
-                            free(cfg->command[k]);
-                        }
-                        free(cfg->command);
-                        cfg->command = NULL;
-                        cfg->command_len = 0;
-                        for (size_t k = 0; k < sources_len; ++k) {
-                            free(sources[k]);
-                        }
-                        free(sources);
-                        goto fail;
-                    }
-                    const char *cache_dir = ".fip/cache/";
-                    const size_t cache_dir_len = 11;
-#ifdef __WIN32__
-                    const char *file_ext = ".obj";
-                    const size_t ext_len = 4;
-                    const size_t output_len = //
-                        cache_dir_len         // The length of the cache dir
-                        + FIP_PATH_SIZE       // The length of the hash itself
-                        + ext_len             // '.obj'
-                        + 1;                  // Zero-terminator
-#else
-                    const char *file_ext = ".o";
-                    const size_t ext_len = 2;
-                    const size_t output_len = //
-                        cache_dir_len         // The length of the cache dir
-                        + FIP_PATH_SIZE       // The length of the hash itself
-                        + ext_len             // '.o'
-                        + 1;                  // Zero-terminator
-#endif
-                    // Hash the full path `.fip/cache/<tag>` as input so the
-                    // string is always long enough for good hash distribution.
-                    char hash_input[128];
-                    snprintf(                           //
-                        hash_input, sizeof(hash_input), //
-                        "%s%s", cache_dir, cfg->tag     //
-                    );
-                    cfg->command[cmd_idx] = (char *)malloc(output_len);
-                    char *insert_ptr = cfg->command[cmd_idx];
-                    memcpy(insert_ptr, cache_dir, cache_dir_len);
-                    insert_ptr += cache_dir_len;
-                    fip_create_hash(insert_ptr, hash_input);
-                    memcpy(cfg->output, insert_ptr, FIP_PATH_SIZE);
-                    insert_ptr += FIP_PATH_SIZE;
-                    memcpy(insert_ptr, file_ext, ext_len);
-                    cfg->command[cmd_idx][output_len - 1] = '\0';
-                    cfg->output[FIP_PATH_SIZE] = '\0';
-                    command_output_substituted = true;
-                } else {
-                    cfg->command[cmd_idx] = (char *)malloc((size_t)slen + 1);
-                    memcpy(                    //
-                        cfg->command[cmd_idx], //
-                        elems[j].u.str.ptr,    //
-                        (size_t)slen           //
-                    );
-                    cfg->command[cmd_idx][slen] = '\0';
+                    return true;
                 }
-            }
-        }
-
-        if (command_present && !command_sources_substituted) {
-            fip_print(ID, FIP_ERROR,
-                "Missing substitute '__SOURCES__' in 'command' in table '%s'",
-                cfg->tag);
-            if (sources_present) {
-                for (size_t j = 0; j < sources_len; ++j) {
-                    free(sources[j]);
+                if (*s == '\0') {
+                    return false;
                 }
-                free(sources);
             }
-            goto fail;
         }
-        if (command_present && !command_output_substituted) {
-            fip_print(ID, FIP_ERROR,
-                "Missing substitute '__OUTPUT__' in 'command' in table '%s'",
-                cfg->tag);
-            if (sources_present) {
-                for (size_t j = 0; j < sources_len; ++j) {
-                    free(sources[j]);
+        if (*pattern == '*') {
+            pattern++;
+            for (const char *s = str;; s++) {
+                if (glob_match(pattern, s)) {
+                    return true;
+                }
+                if (*s == '\0' || *s == '/') {
+                    return false;
                 }
-                free(sources);
             }
-            goto fail;
         }
-
-        // Check if 'sources' are present but 'command' is not. In this case we
-        // need to free the 'sources' manually here since otherwise they would
-        // leak since nothin consumed them
-        if (sources_present && !command_present) {
-            fip_print(ID, FIP_ERROR,
-                "Missing or invalid 'command' in table '%s'", cfg->tag);
-            for (size_t j = 0; j < sources_len; ++j) {
-                free(sources[j]);
-            }
-            free(sources);
-            goto fail;
+        if (*str == '\0') {
+            return false;
         }
-
-        // finished filling this cfg
-        cfg_idx++;
-    }
-
-    // Success: cfg_idx should equal CONFIGS.count
-    if (cfg_idx != CONFIGS.count) {
-        // Shouldn't happen; defensive handling
-        fip_print(ID, FIP_WARN, "Parsed %zu module tables but expected %zu",
-            cfg_idx, CONFIGS.count);
-        CONFIGS.count = cfg_idx;
-    }
-
-    return true;
-
-// On error: free everything allocated in CONFIGS
-fail:
-    for (size_t i = 0; i < CONFIGS.count; ++i) {
-        fip_module_config_t *c = &CONFIGS.configs[i];
-        if (c->headers) {
-            for (uint32_t j = 0; j < c->headers_len; ++j) {
-                free(c->headers[j]);
+        if (*pattern == '?') {
+            if (*str == '/') {
+                return false;
             }
-            free(c->headers);
-            c->headers = NULL;
-            c->headers_len = 0;
-        }
-        if (c->command) {
-            for (uint32_t j = 0; j < c->command_len; ++j)
-                free(c->command[j]);
-            free(c->command);
-            c->command = NULL;
-            c->command_len = 0;
+        } else if (*pattern != *str) {
+            return false;
         }
+        pattern++;
+        str++;
     }
-    free(CONFIGS.configs);
-    CONFIGS.configs = NULL;
-    CONFIGS.count = 0;
-    return false;
+    return *str == '\0';
 }
 
-/*
- * ==============================================
- * CLANG TO FIP TYPE Conversion Functions
- * ==============================================
- * The conversion functions work with a visitor
- * pattern of functions which get executed
- * depending on the type at hand. The `fip-c`
- * Interop Module is single-threaded only which
- * means we can have a global type stack to
- * detect recursion effectively. This uses the
- * above recursion handling functions extensively
- * to keep track of the current type and all
- * types which came before.
- * ==============================================
- */
-
-static bool symbol_name_exists(const char *name) {
-    if (strlen(name) == 0) {
-        return false;
-    }
-    for (size_t i = 0; i < curr_coll->symbol_count; i++) {
-        const char *existing_name = NULL;
-        switch (curr_coll->symbols[i].type) {
-            case FIP_SYM_DATA:
-                existing_name = curr_coll->symbols[i].sig.data.name;
-                break;
-            case FIP_SYM_ENUM:
-                existing_name = curr_coll->symbols[i].sig.enum_t.name;
-                break;
-            case FIP_SYM_OPAQUE:
-                existing_name = curr_coll->symbols[i].sig.opaque.name;
-                break;
-            default:
-                continue;
-        }
-        if (strcmp(existing_name, name) == 0) {
-            return true;
-        }
-    }
-    return false;
+int scan_entry_cmp(const void *a, const void *b) {
+    return strcmp(((const scan_entry_t *)a)->name,
+        ((const scan_entry_t *)b)->name);
 }
 
-enum CXChildVisitResult count_struct_fields_visitor( //
-    CXCursor cursor,                                 //
-    [[maybe_unused]] CXCursor parent,                //
-    CXClientData client_data                         //
-) {
-    int *field_count = (int *)client_data;
-    if (clang_getCursorKind(cursor) == CXCursor_FieldDecl) {
-        (*field_count)++;
-    }
-    return CXChildVisit_Continue;
+int scan_dir_cmp(const void *a, const void *b) {
+    return strcmp(((const scan_dir_t *)a)->path,
+        ((const scan_dir_t *)b)->path);
 }
 
-bool clang_type_to_fip_type(CXType clang_type, fip_type_t *fip_type);
-
-enum CXChildVisitResult struct_field_name_visitor( //
-    CXCursor cursor,                               //
-    [[maybe_unused]] CXCursor parent,              //
-    CXClientData client_data                       //
-) {
-    field_name_visitor_data *data = (field_name_visitor_data *)client_data;
-
-    if (clang_getCursorKind(cursor) == CXCursor_FieldDecl) {
-        CXString field_name = clang_getCursorSpelling(cursor);
-        const char *field_name_cstr = clang_getCString(field_name);
-        size_t name_len = strlen(field_name_cstr);
-
-        data->field_names[data->current_index] = (char *)malloc(name_len + 1);
-        strcpy(data->field_names[data->current_index], field_name_cstr);
-        clang_disposeString(field_name);
-
-        data->current_index++;
-    }
-
-    return CXChildVisit_Continue;
+int scan_dir_path_cmp(const void *path, const void *dir) {
+    return strcmp((const char *)path, ((const scan_dir_t *)dir)->path);
 }
 
-enum CXChildVisitResult struct_field_visitor( //
-    CXCursor cursor,                          //
-    [[maybe_unused]] CXCursor parent,         //
-    CXClientData client_data                  //
-) {
-    field_visitor_data *data = (field_visitor_data *)client_data;
-
-    if (clang_getCursorKind(cursor) == CXCursor_FieldDecl) {
-        CXType field_type = clang_getCursorType(cursor);
-
-        if (!clang_type_to_fip_type(                            //
-                field_type, &data->fields[data->current_index]) //
-        ) {
-            fip_print(data->module_id, FIP_TRACE,
-                "Failed to convert field type at index %d",
-                data->current_index);
-            return CXChildVisit_Break;
-        }
-
-        data->current_index++;
+void scan_dir_free(scan_dir_t *dir) {
+    for (uint32_t i = 0; i < dir->entry_count; i++) {
+        free(dir->entries[i].name);
     }
-
-    return CXChildVisit_Continue;
+    free(dir->entries);
+    free(dir->path);
 }
 
-enum CXChildVisitResult enum_value_visitor( //
-    CXCursor cursor,                        //
-    [[maybe_unused]] CXCursor parent,       //
-    CXClientData client_data                //
-) {
-    enum_visitor_data *data = (enum_visitor_data *)client_data;
-
-    if (clang_getCursorKind(cursor) == CXCursor_EnumConstantDecl) {
-        data->values[data->current_index++] =
-            (size_t)clang_getEnumConstantDeclValue(cursor);
+void scan_cache_push(scan_cache_t *cache, scan_dir_t dir) {
+    if (cache->len == cache->cap) {
+        cache->cap = cache->cap == 0 ? 16 : cache->cap * 2;
+        cache->dirs = (scan_dir_t *)realloc( //
+            cache->dirs, sizeof(scan_dir_t) * cache->cap);
     }
-
-    return CXChildVisit_Continue;
+    cache->dirs[cache->len++] = dir;
 }
 
-enum CXChildVisitResult enum_sig_visitor( //
-    CXCursor cursor,                      //
-    [[maybe_unused]] CXCursor parent,     //
-    CXClientData client_data              //
-) {
-    enum_sig_visitor_data *data = (enum_sig_visitor_data *)client_data;
-
-    if (clang_getCursorKind(cursor) == CXCursor_EnumConstantDecl) {
-        CXString name_str = clang_getCursorSpelling(cursor);
-        const char *name = clang_getCString(name_str);
-        size_t len = strlen(name);
-        data->tags[data->current_index] = (char *)malloc(len + 1);
-        strcpy(data->tags[data->current_index], name);
-        clang_disposeString(name_str);
-        data->values[data->current_index] =
-            (size_t)clang_getEnumConstantDeclValue(cursor);
-        data->current_index++;
+void scan_cache_free(scan_cache_t *cache) {
+    for (uint32_t i = 0; i < cache->len; i++) {
+        scan_dir_free(&cache->dirs[i]);
     }
+    free(cache->dirs);
+    *cache = (scan_cache_t){0};
+}
 
-    return CXChildVisit_Continue;
+/// @function `scan_cache_find`
+/// @brief Looks up a directory in the sorted scan cache
+///
+/// @param `cache` The cache to search in, must be sorted by path
+/// @param `path` The path of the directory to look up
+/// @return `const scan_dir_t *` The cached directory or NULL if not cached
+const scan_dir_t *scan_cache_find(const scan_cache_t *cache, const char *path) {
+    return (const scan_dir_t *)bsearch(                    //
+        path, cache->dirs, cache->len, sizeof(scan_dir_t), //
+        scan_dir_path_cmp                                  //
+    );
 }
 
-enum CXChildVisitResult count_enum_constants_visitor( //
-    CXCursor cursor,                                  //
-    [[maybe_unused]] CXCursor parent,                 //
-    CXClientData client_data                          //
-) {
-    int *count = (int *)client_data;
-    if (clang_getCursorKind(cursor) == CXCursor_EnumConstantDecl) {
-        (*count)++;
+/// @function `scan_cache_load`
+/// @brief Loads the scan cache from the `.fip/cache/scan.cache` file. A
+/// missing or malformed cache file results in an empty cache
+void scan_cache_load(scan_cache_t *cache) {
+    *cache = (scan_cache_t){0};
+    FILE *fp = fopen(SCAN_CACHE_PATH, "r");
+    if (fp == NULL) {
+        return;
     }
+    char line[4096];
+    long long scan_time = 0;
+    const size_t magic_len = strlen(SCAN_CACHE_MAGIC);
+    if (!fgets(line, sizeof(line), fp)                       //
+        || strncmp(line, SCAN_CACHE_MAGIC, magic_len) != 0   //
+        || sscanf(line + magic_len, "%lld", &scan_time) != 1 //
+    ) {
+        fclose(fp);
+        return;
+    }
+    cache->scan_time = (int64_t)scan_time;
+    scan_dir_t *dir = NULL;
+    uint32_t entries_cap = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '\0' || line[1] != '\t') {
+            continue;
+        }
+        if (line[0] == 'D') {
+            char *path = strchr(line + 2, '\t');
+            if (path == NULL) {
+                continue;
+            }
+            scan_cache_push(cache, (scan_dir_t){
+                .path = clone_string(path + 1),
+                .mtime = (int64_t)strtoll(line + 2, NULL, 10),
+            });
+            dir = &cache->dirs[cache->len - 1];
+            entries_cap = 0;
+        } else if (dir != NULL && (line[0] == 'F' || line[0] == 'S')) {
+            if (dir->entry_count == entries_cap) {
+                entries_cap = entries_cap == 0 ? 16 : entries_cap * 2;
+                dir->entries = (scan_entry_t *)realloc( //
+                    dir->entries, sizeof(scan_entry_t) * entries_cap);
+            }
+            dir->entries[dir->entry_count++] = (scan_entry_t){
+                .name = clone_string(line + 2),
+                .is_dir = line[0] == 'S',
+            };
+        }
+    }
+    fclose(fp);
+    qsort(cache->dirs, cache->len, sizeof(scan_dir_t), scan_dir_cmp);
+}
+
+/// @function `scan_cache_save`
+/// @brief Writes the given scan cache to the `.fip/cache/scan.cache` file. The
+/// cache must be sorted and free of duplicates
+void scan_cache_save(const scan_cache_t *cache) {
+    if (!ensure_cache_dir()) {
+        return;
+    }
+    FILE *fp = fopen(SCAN_CACHE_PATH, "w");
+    if (fp == NULL) {
+        fip_print(ID, FIP_WARN, "Could not write %s", SCAN_CACHE_PATH);
+        return;
+    }
+    fprintf(fp, "%s %lld\n", SCAN_CACHE_MAGIC, (long long)cache->scan_time);
+    for (uint32_t i = 0; i < cache->len; i++) {
+        const scan_dir_t *dir = &cache->dirs[i];
+        fprintf(fp, "D\t%lld\t%s\n", (long long)dir->mtime, dir->path);
+        for (uint32_t j = 0; j < dir->entry_count; j++) {
+            fprintf(fp, "%c\t%s\n", dir->entries[j].is_dir ? 'S' : 'F',
+                dir->entries[j].name);
+        }
+    }
+    fclose(fp);
+}
+
+/// @function `read_directory`
+/// @brief Reads all entries of the given directory, sorted by name. Hidden
+/// entries are skipped and symlinked directories are not followed to prevent
+/// walking in cycles
+///
+/// @param `path` The path of the directory to read
+/// @param `dir` The directory to fill
+/// @return `bool` Whether the directory could be read
+bool read_directory(const char *path, scan_dir_t *dir) {
+    uint32_t entries_cap = 0;
+#ifdef __WIN32__
+    char search[1024];
+    snprintf(search, sizeof(search), "%s\\*", path);
+    WIN32_FIND_DATAA find_data;
+    HANDLE find = FindFirstFileA(search, &find_data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    do {
+        const char *name = find_data.cFileName;
+        if (name[0] == '.') {
+            continue;
+        }
+        const bool is_dir = //
+            (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        if (is_dir &&
+            (find_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+            continue;
+        }
+#else
+    DIR *handle = opendir(path);
+    if (handle == NULL) {
+        return false;
+    }
+    struct dirent *dirent;
+    while ((dirent = readdir(handle)) != NULL) {
+        const char *name = dirent->d_name;
+        if (name[0] == '.') {
+            continue;
+        }
+        // Most file systems report the type of every entry, only symlinks and
+        // entries of an unknown type need to be stat'ed
+        bool is_dir = false;
+        bool is_link = true;
+#ifdef DT_DIR
+        if (dirent->d_type != DT_UNKNOWN) {
+            is_dir = dirent->d_type == DT_DIR;
+            is_link = dirent->d_type == DT_LNK;
+        }
+#endif
+        if (is_link) {
+            char *child = path_join(path, name);
+            struct stat st;
+            bool stat_ok = lstat(child, &st) == 0;
+            is_link = stat_ok && S_ISLNK(st.st_mode);
+            if (is_link) {
+                stat_ok = stat(child, &st) == 0;
+            }
+            free(child);
+            if (!stat_ok || (is_link && S_ISDIR(st.st_mode))) {
+                continue;
+            }
+            is_dir = S_ISDIR(st.st_mode);
+        }
+#endif
+        if (dir->entry_count == entries_cap) {
+            entries_cap = entries_cap == 0 ? 16 : entries_cap * 2;
+            dir->entries = (scan_entry_t *)realloc( //
+                dir->entries, sizeof(scan_entry_t) * entries_cap);
+        }
+        dir->entries[dir->entry_count++] = (scan_entry_t){
+            .name = clone_string(name),
+            .is_dir = is_dir,
+        };
+#ifdef __WIN32__
+    } while (FindNextFileA(find, &find_data));
+    FindClose(find);
+#else
+    }
+    closedir(handle);
+#endif
+    qsort(dir->entries, dir->entry_count, sizeof(scan_entry_t), scan_entry_cmp);
+    return true;
+}
+
+/// @function `scan_directory`
+/// @brief Walks the given directory and adds all matching files to the job's
+/// file list. The listing of a directory is taken from the scan cache if the
+/// directory did not change since it was cached
+///
+/// @param `job` The scan job to add the files and visited directories to
+/// @param `path` The path of the directory to walk
+/// @param `base_len` The length of the walk's base path prefix in `path`
+/// @param `pattern` The glob pattern relative paths need to match, or NULL
+/// @param `recursive` Whether to descend into sub-directories
+void scan_directory(       //
+    scan_job_t *job,       //
+    const char *path,      //
+    const size_t base_len, //
+    const char *pattern,   //
+    const bool recursive   //
+) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return;
+    }
+    scan_dir_t dir = {
+        .path = clone_string(path),
+        .mtime = (int64_t)st.st_mtime,
+    };
+    const scan_dir_t *cached = scan_cache_find(&SCAN_CACHE, path);
+    if (cached != NULL && cached->mtime == dir.mtime //
+        && dir.mtime < SCAN_CACHE.scan_time          //
+    ) {
+        dir.entry_count = cached->entry_count;
+        dir.entries = (scan_entry_t *)malloc( //
+            sizeof(scan_entry_t) * (cached->entry_count + 1));
+        for (uint32_t i = 0; i < cached->entry_count; i++) {
+            dir.entries[i].name = clone_string(cached->entries[i].name);
+            dir.entries[i].is_dir = cached->entries[i].is_dir;
+        }
+    } else if (!read_directory(path, &dir)) {
+        fip_print(ID, FIP_WARN, "Could not read directory '%s'", path);
+        scan_dir_free(&dir);
+        return;
+    }
+    scan_cache_push(&job->scanned, dir);
+    // The job's dir list may be reallocated while recursing, so we iterate over
+    // a stable copy of the directory descriptor
+    for (uint32_t i = 0; i < dir.entry_count; i++) {
+        char *child = path_join(path, dir.entries[i].name);
+        if (dir.entries[i].is_dir) {
+            if (recursive) {
+                scan_directory(job, child, base_len, pattern, recursive);
+            }
+            free(child);
+            continue;
+        }
+        // Relative path of the child to the walk's base directory
+        const char *relative = child + base_len;
+        if (*relative == '/') {
+            relative++;
+        }
+        bool matches;
+        if (pattern != NULL) {
+            matches = glob_match(pattern, relative);
+        } else {
+            const size_t len = strlen(child);
+            matches = false;
+            for (uint32_t j = 0; !matches && j < job->extension_count; j++) {
+                const size_t ext_len = strlen(job->extensions[j]);
+                matches = len > ext_len //
+                    && strcmp(child + len - ext_len, job->extensions[j]) == 0;
+            }
+        }
+        if (matches) {
+            path_list_push(&job->files, child);
+        } else {
+            free(child);
+        }
+    }
+}
+
+/// @function `run_scan_job`
+/// @brief Expands a single directory or glob entry into the job's file list
+void run_scan_job(scan_job_t *job) {
+    const char *entry = job->entry;
+    if (!path_is_glob(entry)) {
+        // A plain directory, all files with the job's extensions are collected
+        size_t len = strlen(entry);
+        while (len > 1 && entry[len - 1] == '/') {
+            len--;
+        }
+        char *base = (char *)malloc(len + 1);
+        memcpy(base, entry, len);
+        base[len] = '\0';
+        scan_directory(job, base, len, NULL, true);
+        free(base);
+        return;
+    }
+    // Split the glob into its literal base directory and the pattern part. The
+    // base ends at the last separator before the first wildcard
+    const size_t wildcard = strcspn(entry, "*?");
+    size_t base_len = wildcard;
+    while (base_len > 0 && entry[base_len - 1] != '/') {
+        base_len--;
+    }
+    const char *pattern = entry + base_len;
+    char *base;
+    if (base_len == 0) {
+        base = clone_string(".");
+    } else if (base_len == 1) {
+        // The glob starts at the root directory
+        base = clone_string("/");
+    } else {
+        base = (char *)malloc(base_len);
+        memcpy(base, entry, base_len - 1);
+        base[base_len - 1] = '\0';
+    }
+    const bool recursive = strchr(pattern, '/') != NULL;
+    scan_directory(job, base, strcmp(base, ".") == 0 ? 0 : strlen(base),
+        pattern, recursive);
+    free(base);
+}
+
+#ifndef __WIN32__
+typedef struct {
+    scan_job_t *jobs;
+    size_t job_count;
+    atomic_size_t next_job;
+} scan_pool_t;
+
+void *scan_worker(void *arg) {
+    scan_pool_t *pool = (scan_pool_t *)arg;
+    while (true) {
+        const size_t idx = atomic_fetch_add(&pool->next_job, 1);
+        if (idx >= pool->job_count) {
+            break;
+        }
+        run_scan_job(&pool->jobs[idx]);
+    }
+    return NULL;
+}
+#endif
+
+/// @function `run_scan_jobs`
+/// @brief Runs all given scan jobs, in parallel where threads are available
+void run_scan_jobs(scan_job_t *jobs, const size_t job_count) {
+#ifdef __WIN32__
+    for (size_t i = 0; i < job_count; i++) {
+        run_scan_job(&jobs[i]);
+    }
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = cores > 0 ? (size_t)cores : 1;
+    if (thread_count > SCAN_MAX_THREADS) {
+        thread_count = SCAN_MAX_THREADS;
+    }
+    if (thread_count > job_count) {
+        thread_count = job_count;
+    }
+    scan_pool_t pool = {.jobs = jobs, .job_count = job_count};
+    atomic_init(&pool.next_job, 0);
+    pthread_t threads[SCAN_MAX_THREADS];
+    size_t started = 0;
+    // The calling thread takes part in the scan, so one thread less is spawned
+    for (; started + 1 < thread_count; started++) {
+        if (pthread_create(&threads[started], NULL, scan_worker, &pool) != 0) {
+            break;
+        }
+    }
+    scan_worker(&pool);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+#endif
+}
+
+/// @function `expand_path_list`
+/// @brief Replaces all directory and glob entries of the given path list with
+/// the files they matched
+///
+/// @param `paths` The path list to expand in place
+/// @param `paths_len` The length of the path list, updated in place
+/// @param `jobs` The scan jobs of all entries, consumed by this function
+/// @param `next_job` The index of the next job belonging to this list
+void expand_path_list(   //
+    char ***paths,       //
+    uint32_t *paths_len, //
+    scan_job_t *jobs,    //
+    size_t *next_job     //
+) {
+    path_list_t expanded = {0};
+    for (uint32_t i = 0; i < *paths_len; i++) {
+        char *entry = (*paths)[i];
+        if (jobs[*next_job].entry != entry) {
+            path_list_push(&expanded, entry);
+            continue;
+        }
+        scan_job_t *job = &jobs[(*next_job)++];
+        if (job->files.len == 0) {
+            fip_print(ID, FIP_WARN, "'%s' did not match any files", entry);
+        }
+        for (uint32_t j = 0; j < job->files.len; j++) {
+            path_list_push(&expanded, job->files.items[j]);
+        }
+        free(job->files.items);
+        job->files = (path_list_t){0};
+        free(entry);
+    }
+    free(*paths);
+    *paths = expanded.items;
+    *paths_len = expanded.len;
+}
+
+/// @function `expand_config_paths`
+/// @brief Expands all directory and glob entries in the `headers` and
+/// `sources` lists of all configs. All entries are scanned in parallel and the
+/// scan cache is updated with all directories visited
+void expand_config_paths(void) {
+    // Collect one job per entry which needs expansion, in config order
+    size_t job_count = 0;
+    size_t jobs_cap = 16;
+    scan_job_t *jobs = (scan_job_t *)malloc(sizeof(scan_job_t) * jobs_cap);
+    for (size_t i = 0; i < CONFIGS.count; i++) {
+        fip_module_config_t *cfg = &CONFIGS.configs[i];
+        for (int kind = 0; kind < 2; kind++) {
+            char **paths = kind == 0 ? cfg->headers : cfg->sources;
+            const uint32_t paths_len = //
+                kind == 0 ? cfg->headers_len : cfg->sources_len;
+            for (uint32_t j = 0; j < paths_len; j++) {
+                if (!path_is_glob(paths[j]) && !path_is_directory(paths[j])) {
+                    continue;
+                }
+                if (job_count + 1 == jobs_cap) {
+                    jobs_cap *= 2;
+                    jobs = (scan_job_t *)realloc( //
+                        jobs, sizeof(scan_job_t) * jobs_cap);
+                }
+                jobs[job_count++] = (scan_job_t){
+                    .entry = paths[j],
+                    .extensions = kind == 0 ? cfg->header_extensions
+                                            : cfg->source_extensions,
+                    .extension_count = kind == 0 ? cfg->header_extensions_len
+                                                 : cfg->source_extensions_len,
+                };
+            }
+        }
+    }
+    // Sentinel job so the expansion never needs to check the job count
+    jobs[job_count] = (scan_job_t){0};
+    if (job_count == 0) {
+        free(jobs);
+        return;
+    }
+
+    scan_cache_load(&SCAN_CACHE);
+    const int64_t scan_time = (int64_t)time(NULL);
+    clock_t start = clock();
+    run_scan_jobs(jobs, job_count);
+    clock_t end = clock();
+    fip_print(ID, FIP_DEBUG, "Expanding %zu path entries took %f s", job_count,
+        ((double)(end - start)) / CLOCKS_PER_SEC);
+
+    size_t next_job = 0;
+    for (size_t i = 0; i < CONFIGS.count; i++) {
+        fip_module_config_t *cfg = &CONFIGS.configs[i];
+        expand_path_list(&cfg->headers, &cfg->headers_len, jobs, &next_job);
+        expand_path_list(&cfg->sources, &cfg->sources_len, jobs, &next_job);
+    }
+
+    // Merge the directories visited by all jobs into the new cache. Multiple
+    // jobs could have visited the same directory, only one copy is kept
+    scan_cache_t new_cache = {.scan_time = scan_time};
+    for (size_t i = 0; i < job_count; i++) {
+        for (uint32_t j = 0; j < jobs[i].scanned.len; j++) {
+            scan_cache_push(&new_cache, jobs[i].scanned.dirs[j]);
+        }
+        free(jobs[i].scanned.dirs);
+    }
+    free(jobs);
+    qsort(new_cache.dirs, new_cache.len, sizeof(scan_dir_t), scan_dir_cmp);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < new_cache.len; i++) {
+        if (unique > 0 &&
+            strcmp(new_cache.dirs[unique - 1].path, new_cache.dirs[i].path) ==
+                0) {
+            scan_dir_free(&new_cache.dirs[i]);
+            continue;
+        }
+        new_cache.dirs[unique++] = new_cache.dirs[i];
+    }
+    new_cache.len = unique;
+    scan_cache_save(&new_cache);
+    scan_cache_free(&new_cache);
+    scan_cache_free(&SCAN_CACHE);
+}
+
+/// @function `copy_string_array`
+/// @brief Copies the TOML string array `key` of the given module table into a
+/// newly allocated array of strings
+///
+/// @param `module` The module table to read the array from
+/// @param `key` The key of the array in the module table
+/// @param `tag` The tag of the module table, used for error messages
+/// @param `out` Where to store the allocated string array
+/// @param `out_len` Where to store the length of the string array
+/// @return `bool` Whether all elements of the array were strings
+bool copy_string_array(  //
+    toml_datum_t module, //
+    const char *key,     //
+    const char *tag,     //
+    char ***out,         //
+    uint32_t *out_len    //
+) {
+    toml_datum_t array = toml_get(module, key);
+    const size_t len = (size_t)array.u.arr.size;
+    *out = (char **)malloc(sizeof(char *) * (len + 1));
+    *out_len = 0;
+    toml_datum_t *elems = array.u.arr.elem;
+    for (size_t i = 0; i < len; ++i) {
+        if (elems[i].type != TOML_STRING) {
+            fip_print(ID, FIP_ERROR, "Non-string in '%s' of table '%s'", key,
+                tag);
+            return false;
+        }
+        const size_t slen = (size_t)elems[i].u.str.len;
+        (*out)[i] = (char *)malloc(slen + 1);
+        memcpy((*out)[i], elems[i].u.str.ptr, slen);
+        (*out)[i][slen] = '\0';
+        (*out_len)++;
+    }
+    return true;
+}
+
+/// @function `copy_extensions`
+/// @brief Copies the optional TOML string array `key` of file extensions of
+/// the given module table. Without the array only the given default extension
+/// is used
+///
+/// @param `module` The module table to read the array from
+/// @param `key` The key of the array in the module table
+/// @param `tag` The tag of the module table, used for error messages
+/// @param `fallback` The extension used when the array is not present
+/// @param `out` Where to store the allocated string array
+/// @param `out_len` Where to store the length of the string array
+/// @return `bool` Whether the array is missing or only contains strings
+bool copy_extensions(     //
+    toml_datum_t module,  //
+    const char *key,      //
+    const char *tag,      //
+    const char *fallback, //
+    char ***out,          //
+    uint32_t *out_len     //
+) {
+    const toml_datum_t array = toml_get(module, key);
+    if (array.type == TOML_UNKNOWN) {
+        *out = (char **)malloc(sizeof(char *));
+        (*out)[0] = clone_string(fallback);
+        *out_len = 1;
+        return true;
+    }
+    if (array.type != TOML_ARRAY) {
+        fip_print(ID, FIP_ERROR, "Invalid '%s' in table '%s'", key, tag);
+        return false;
+    }
+    return copy_string_array(module, key, tag, out, out_len);
+}
+
+bool parse_toml_file(toml_result_t toml) {
+    // Validate top-level is a table (toml.toptab)
+    if (toml.toptab.type != TOML_TABLE) {
+        fip_print(ID, FIP_ERROR, "TOML root is not a table");
+        return false;
+    }
+
+    // First pass: count top-level tables (each is a module config)
+    const int32_t top_count = toml.toptab.u.tab.size;
+    if (top_count <= 0) {
+        fip_print(ID, FIP_ERROR, "No top-level entries in TOML");
+        return false;
+    }
+
+    for (int32_t i = 0; i < top_count; ++i) {
+        toml_datum_t v = toml.toptab.u.tab.value[i];
+        if (v.type != TOML_TABLE) {
+            fip_print(ID, FIP_ERROR, "Incorrect top-level entry in TOML");
+            return false;
+        }
+    }
+
+    // Allocate CONFIGS
+    CONFIGS.count = (size_t)top_count;
+    CONFIGS.configs = (fip_module_config_t *)malloc( //
+        sizeof(fip_module_config_t) * CONFIGS.count  //
+    );
+    memset(CONFIGS.configs, 0, sizeof(fip_module_config_t) * CONFIGS.count);
+
+    // Second pass: fill CONFIGS
+    size_t cfg_idx = 0;
+    for (int32_t i = 0; i < top_count; ++i) {
+        toml_datum_t v = toml.toptab.u.tab.value[i];
+        const char *keyname = toml.toptab.u.tab.key[i];
+        int keylen = toml.toptab.u.tab.len[i];
+
+        fip_module_config_t *cfg = &CONFIGS.configs[cfg_idx];
+        // copy tag (may be empty)
+        int copy_len = keylen < (int)sizeof(cfg->tag) - 1
+            ? keylen
+            : (int)sizeof(cfg->tag) - 1;
+        if (copy_len > 0) {
+            memcpy(cfg->tag, keyname, (size_t)copy_len);
+        }
+        cfg->tag[copy_len] = '\0';
+        // Count the config right away so that everything allocated for it is
+        // freed on failure
+        cfg_idx++;
+
+        // module table datum, this is the table itself
+        toml_datum_t module = v;
+
+        // headers (required, array of strings)
+        if (toml_get(module, "headers").type != TOML_ARRAY) {
+            fip_print(ID, FIP_ERROR,
+                "Missing or invalid 'headers' in table '%s'", cfg->tag);
+            goto fail;
+        }
+        if (!copy_string_array(                   //
+                module, "headers", cfg->tag,      //
+                &cfg->headers, &cfg->headers_len) //
+        ) {
+            goto fail;
+        }
+
+        // header_extensions and source_extensions (optional, array of strings)
+        if (!copy_extensions(                                         //
+                module, "header_extensions", cfg->tag, ".h",          //
+                &cfg->header_extensions, &cfg->header_extensions_len) //
+            || !copy_extensions(                                      //
+                module, "source_extensions", cfg->tag, ".c",          //
+                &cfg->source_extensions, &cfg->source_extensions_len) //
+        ) {
+            goto fail;
+        }
+
+        // clang_modules (optional, boolean)
+        const toml_datum_t clang_modules = toml_get(module, "clang_modules");
+        if (clang_modules.type == TOML_BOOLEAN) {
+            cfg->clang_modules = clang_modules.u.boolean;
+        } else if (clang_modules.type != TOML_UNKNOWN) {
+            fip_print(ID, FIP_ERROR,
+                "Invalid 'clang_modules' in table '%s'", cfg->tag);
+            goto fail;
+        }
+
+        // auto_pch (optional, boolean)
+        const toml_datum_t auto_pch = toml_get(module, "auto_pch");
+        if (auto_pch.type == TOML_BOOLEAN) {
+            cfg->auto_pch = auto_pch.u.boolean;
+        } else if (auto_pch.type != TOML_UNKNOWN) {
+            fip_print(ID, FIP_ERROR,
+                "Invalid 'auto_pch' in table '%s'", cfg->tag);
+            goto fail;
+        }
+
+        // sources and command (optional, array of strings)
+        // The command is needed when sources are present and vice versa
+        const bool sources_present = //
+            toml_get(module, "sources").type == TOML_ARRAY;
+        const bool command_present = //
+            toml_get(module, "command").type == TOML_ARRAY;
+        if (command_present &&
+            (!sources_present ||
+                toml_get(module, "sources").u.arr.size == 0)) {
+            fip_print(ID, FIP_ERROR,
+                "Missing, invalid or empty 'sources' in table '%s'",
+                cfg->tag);
+            goto fail;
+        }
+        if (sources_present && !command_present) {
+            fip_print(ID, FIP_ERROR,
+                "Missing or invalid 'command' in table '%s'", cfg->tag);
+            goto fail;
+        }
+        if (!command_present) {
+            continue;
+        }
+        if (!copy_string_array(                   //
+                module, "sources", cfg->tag,      //
+                &cfg->sources, &cfg->sources_len) //
+            || !copy_string_array(                //
+                module, "command", cfg->tag,      //
+                &cfg->command, &cfg->command_len) //
+        ) {
+            goto fail;
+        }
+
+        // The command is kept as a template, the `__SOURCES__` and `__OUTPUT__`
+        // substitutes are replaced for every single source file when compiling
+        bool command_sources_substituted = false;
+        bool command_output_substituted = false;
+        for (uint32_t j = 0; j < cfg->command_len; ++j) {
+            if (strcmp(cfg->command[j], "__SOURCES__") == 0) {
+                if (command_sources_substituted) {
+                    // Substituting the sources twice is not allowed
+                    fip_print(ID, FIP_ERROR,
+                        "Substituting '__SOURCES__' twice in 'command' in table '%s'",
+                        cfg->tag);
+                    goto fail;
+                }
+                command_sources_substituted = true;
+            } else if (strcmp(cfg->command[j], "__OUTPUT__") == 0) {
+                if (command_output_substituted) {
+                    // Substituting the output twice is not allowed
+                    fip_print(ID, FIP_ERROR,
+                        "Substituting '__OUTPUT__' twice in 'command' in table '%s'",
+                        cfg->tag);
+                    goto fail;
+                }
+                command_output_substituted = true;
+            }
+        }
+        if (!command_sources_substituted) {
+            fip_print(ID, FIP_ERROR,
+                "Missing substitute '__SOURCES__' in 'command' in table '%s'",
+                cfg->tag);
+            goto fail;
+        }
+        if (!command_output_substituted) {
+            fip_print(ID, FIP_ERROR,
+                "Missing substitute '__OUTPUT__' in 'command' in table '%s'",
+                cfg->tag);
+            goto fail;
+        }
+    }
+
+    // Directory and glob entries are expanded once all configs are known, so
+    // that all of them can be scanned in parallel
+    expand_config_paths();
+    return true;
+
+// On error: free everything allocated in CONFIGS
+fail:
+    for (size_t i = 0; i < cfg_idx; ++i) {
+        fip_module_config_t *c = &CONFIGS.configs[i];
+        char **lists[5] = {c->headers, c->sources, c->command,
+            c->header_extensions, c->source_extensions};
+        const uint32_t lens[5] = {c->headers_len, c->sources_len,
+            c->command_len, c->header_extensions_len, c->source_extensions_len};
+        for (size_t j = 0; j < 5; ++j) {
+            for (uint32_t k = 0; k < lens[j]; ++k) {
+                free(lists[j][k]);
+            }
+            free(lists[j]);
+        }
+    }
+    free(CONFIGS.configs);
+    CONFIGS.configs = NULL;
+    CONFIGS.count = 0;
+    return false;
+}
+
+/*
+ * ==============================================
+ * CLANG TO FIP TYPE Conversion Functions
+ * ==============================================
+ * The conversion functions work with a visitor
+ * pattern of functions which get executed
+ * depending on the type at hand. The headers of
+ * a tag are parsed on several threads at once,
+ * so every thread has a type stack of its own
+ * to detect recursion effectively. This uses the
+ * above recursion handling functions extensively
+ * to keep track of the current type and all
+ * types which came before.
+ * ==============================================
+ */
+
+static bool symbol_name_exists(const char *name) {
+    if (strlen(name) == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < curr_coll->symbol_count; i++) {
+        const char *existing_name = NULL;
+        switch (curr_coll->symbols[i].type) {
+            case FIP_SYM_DATA:
+                existing_name = curr_coll->symbols[i].sig.data.name;
+                break;
+            case FIP_SYM_ENUM:
+                existing_name = curr_coll->symbols[i].sig.enum_t.name;
+                break;
+            case FIP_SYM_OPAQUE:
+                existing_name = curr_coll->symbols[i].sig.opaque.name;
+                break;
+            default:
+                continue;
+        }
+        if (strcmp(existing_name, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool clang_type_to_fip_type(CXType clang_type, fip_type_t *fip_type);
+
+/// @var `members`
+/// @brief The scratch buffer the members of records are collected in. It only
+/// ever grows, so after the first few records no allocation is needed anymore.
+/// Nested records push their members after the ones of the outer record and
+/// pop them again before the outer record continues. Every parsing thread has a
+/// scratch buffer of its own
+_Thread_local member_scratch_t members;
+
+/// @function `members_free`
+/// @brief Frees the scratch buffer of the calling thread
+void members_free(void) {
+    free(members.names);
+    free(members.types);
+    free(members.values);
+    members = (member_scratch_t){0};
+}
+
+/// @function `members_push`
+/// @brief Pushes a member onto the scratch buffer
+void members_push(char *name, const fip_type_t *type, const size_t value) {
+    if (members.len == members.cap) {
+        members.cap = members.cap == 0 ? 64 : members.cap * 2;
+        members.names = (char **)realloc( //
+            members.names, sizeof(char *) * members.cap);
+        members.types = (fip_type_t *)realloc( //
+            members.types, sizeof(fip_type_t) * members.cap);
+        members.values = (size_t *)realloc( //
+            members.values, sizeof(size_t) * members.cap);
+    }
+    members.names[members.len] = name;
+    members.types[members.len] = *type;
+    members.values[members.len] = value;
+    members.len++;
+}
+
+/// @function `members_pop`
+/// @brief Frees all members collected since `base` and removes them from the
+/// scratch buffer. Members which were moved into a signature already have to
+/// be removed by resetting the length instead
+void members_pop(const uint32_t base) {
+    for (uint32_t i = base; i < members.len; i++) {
+        free(members.names[i]);
+        fip_free_type(&members.types[i]);
+    }
+    members.len = base;
+}
+
+enum CXChildVisitResult collect_members_visitor( //
+    CXCursor cursor,                             //
+    [[maybe_unused]] CXCursor parent,            //
+    CXClientData client_data                     //
+) {
+    member_visitor_data *data = (member_visitor_data *)client_data;
+    const enum CXCursorKind kind = clang_getCursorKind(cursor);
+    if (kind != CXCursor_FieldDecl && kind != CXCursor_EnumConstantDecl) {
+        return CXChildVisit_Continue;
+    }
+    // The type is converted before the member is pushed, converting it could
+    // push and pop the members of a nested record
+    fip_type_t type = {0};
+    size_t value = 0;
+    if (kind == CXCursor_EnumConstantDecl) {
+        value = (size_t)clang_getEnumConstantDeclValue(cursor);
+    } else if (data->with_types &&
+        !clang_type_to_fip_type(clang_getCursorType(cursor), &type)) {
+        fip_print(ID, FIP_TRACE, "Failed to convert field type at index %u",
+            members.len - data->base);
+        data->failed = true;
+        return CXChildVisit_Break;
+    }
+    char *name = NULL;
+    if (data->with_names) {
+        CXString spelling = clang_getCursorSpelling(cursor);
+        const char *spelling_cstr = clang_getCString(spelling);
+        name = (char *)malloc(strlen(spelling_cstr) + 1);
+        strcpy(name, spelling_cstr);
+        clang_disposeString(spelling);
+    }
+    members_push(name, &type, value);
+    return CXChildVisit_Continue;
+}
+
+/// @function `collect_members`
+/// @brief Collects the names, types and values of all fields of a struct or
+/// all constants of an enum in a single traversal of its children. The members
+/// are pushed onto the `members` scratch buffer, starting at the returned base
+///
+/// @param `cursor` The cursor of the struct or enum declaration
+/// @param `with_names` Whether to collect the names of the members
+/// @param `with_types` Whether to convert the types of the fields
+/// @param `count` Where to store the number of collected members
+/// @return `uint32_t` The index of the first collected member
+uint32_t collect_members(  //
+    CXCursor cursor,       //
+    const bool with_names, //
+    const bool with_types, //
+    int *count             //
+) {
+    member_visitor_data data = {
+        .base = members.len,
+        .with_names = with_names,
+        .with_types = with_types,
+        .failed = false,
+    };
+    clang_visitChildren(cursor, collect_members_visitor, &data);
+    *count = data.failed ? -1 : (int)(members.len - data.base);
+    return data.base;
+}
+
+/// @var `typedef_prims`
+/// @brief The typedefs which are mapped to a primitive type by their name
+/// instead of by their canonical type. The size types would otherwise resolve
+/// to whichever integer type the platform defines them as, and the fixed-width
+/// types would change their primitive between platforms where `int64_t` is a
+/// `long` and where it is a `long long`
+static const struct {
+    const char *name;
+    fip_type_prim_e prim;
+} typedef_prims[] = {
+    {"size_t", FIP_USIZE},
+    {"uintptr_t", FIP_USIZE},
+    {"ptrdiff_t", FIP_ISIZE},
+    {"ssize_t", FIP_ISIZE},
+    {"intptr_t", FIP_ISIZE},
+    {"char16_t", FIP_C16},
+    {"char32_t", FIP_C32},
+    {"uint8_t", FIP_U8},
+    {"uint16_t", FIP_U16},
+    {"uint32_t", FIP_U32},
+    {"uint64_t", FIP_U64},
+    {"int8_t", FIP_I8},
+    {"int16_t", FIP_I16},
+    {"int32_t", FIP_I32},
+    {"int64_t", FIP_I64},
+};
+
+/// @function `typedef_to_fip_prim`
+/// @brief Walks the typedef chain of the given type and checks whether one of
+/// the typedefs in it is listed in `typedef_prims`. The outermost listed
+/// typedef wins, so a `typedef size_t my_size` still resolves to `usize`
+///
+/// @param `type` The type whose typedef chain to walk
+/// @param `prim` Where to store the primitive type of the found typedef
+/// @return `bool` Whether a listed typedef was found in the chain
+bool typedef_to_fip_prim(CXType type, fip_type_prim_e *prim) {
+    const size_t prim_count = sizeof(typedef_prims) / sizeof(typedef_prims[0]);
+    while (true) {
+        if (type.kind == CXType_Elaborated) {
+            type = clang_Type_getNamedType(type);
+            continue;
+        }
+        if (type.kind != CXType_Typedef) {
+            return false;
+        }
+        CXString typedef_name = clang_getTypedefName(type);
+        const char *name = clang_getCString(typedef_name);
+        for (size_t i = 0; i < prim_count; i++) {
+            if (strcmp(name, typedef_prims[i].name) == 0) {
+                *prim = typedef_prims[i].prim;
+                clang_disposeString(typedef_name);
+                return true;
+            }
+        }
+        clang_disposeString(typedef_name);
+        CXCursor decl = clang_getTypeDeclaration(type);
+        type = clang_getTypedefDeclUnderlyingType(decl);
+    }
+}
+
+bool clang_type_to_fip_type(CXType clang_type, fip_type_t *fip_type) {
+    CXType canonical = clang_getCanonicalType(clang_type);
+    fip_print(ID, FIP_DEBUG, "Resolving type at depth %u", stack.len);
+
+    fip_type->is_mutable = !clang_isConstQualifiedType(clang_type);
+
+    // Check if the type resolves to a pointer-to-void (named opaque or
+    // anonymous void*) libclang sets the CXType kind from the canonical type's
+    // class, so a `typedef void* NamedOpaque` has kind CXType_Pointer (not
+    // CXType_Typedef). Use clang_getTypeSpelling to recover the original name
+    // in that case.
+    if (canonical.kind == CXType_Pointer) {
+        CXType pointee = clang_getPointeeType(canonical);
+        if (clang_getCanonicalType(pointee).kind == CXType_Void) {
+            CXString type_spelling = clang_getTypeSpelling(clang_type);
+            const char *spelling = clang_getCString(type_spelling);
+            bool is_anonymous_void_ptr = (strstr(spelling, "void *") != NULL ||
+                strstr(spelling, "void*") != NULL);
+            if (!is_anonymous_void_ptr) {
+                const size_t name_len = strlen(spelling);
+                fip_print(ID, FIP_TRACE, "Detected opaque type: '%s'",
+                    spelling);
+                fip_type->type = FIP_TYPE_OPAQUE;
+                memset(fip_type->u.opaque.name, 0,
+                    sizeof(fip_type->u.opaque.name));
+                if (name_len > 0) {
+                    memcpy(fip_type->u.opaque.name, spelling, name_len);
+                }
+                clang_disposeString(type_spelling);
+                return true;
+            }
+            clang_disposeString(type_spelling);
+            // Anonymous void*: fall through to normal CXType_Pointer handling
+            // in the switch
+        }
+    }
+
+    // The size and character types are typedefs in C, so they have to be
+    // detected by their name before the type is resolved to its canonical type
+    if (typedef_to_fip_prim(clang_type, &fip_type->u.prim)) {
+        fip_type->type = FIP_TYPE_PRIMITIVE;
+        return true;
+    }
+
+    int found = stack_find_equal(&stack, canonical);
+    if (found >= 0) {
+        fip_type->type = FIP_TYPE_RECURSIVE;
+        fip_type->u.recursive.levels_back = (uint8_t)(stack.len - found);
+        return true;
+    }
+
+    // Type not seen yet, push and process
+    stack_push(&stack, canonical);
+
+    switch (canonical.kind) {
+        case CXType_UChar:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_U8;
+            goto ok;
+        case CXType_UShort:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_U16;
+            goto ok;
+        case CXType_UInt:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_U32;
+            goto ok;
+        case CXType_ULong:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_ULONG;
+            goto ok;
+        case CXType_ULongLong:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_ULLONG;
+            goto ok;
+        case CXType_UInt128:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_U128;
+            goto ok;
+        case CXType_Char_U:
+        case CXType_Char_S:
+        case CXType_SChar:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_I8;
+            goto ok;
+        case CXType_Short:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_I16;
+            goto ok;
+        case CXType_Int:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_I32;
+            goto ok;
+        case CXType_Long:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_LONG;
+            goto ok;
+        case CXType_LongLong:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_LLONG;
+            goto ok;
+        case CXType_Int128:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_I128;
+            goto ok;
+        case CXType_Char16:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_C16;
+            goto ok;
+        case CXType_Char32:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_C32;
+            goto ok;
+        case CXType_Float16:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_F16;
+            goto ok;
+        case CXType_Float:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_F32;
+            goto ok;
+        case CXType_Double:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_F64;
+            goto ok;
+        case CXType_LongDouble:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_LDOUBLE;
+            goto ok;
+        case CXType_Bool:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_BOOL;
+            goto ok;
+        case CXType_Void:
+            fip_type->type = FIP_TYPE_PRIMITIVE;
+            fip_type->u.prim = FIP_VOID;
+            goto ok;
+        case CXType_Pointer: {
+            // Use the original type's pointee when it's directly a pointer
+            // (preserves typedef info for e.g. NamedOpaque * -> NamedOpaque).
+            // When clang_type is a Typedef of a pointer (e.g. typedef
+            // Transform* ModelAnimPose), clang_getPointeeType on a Typedef
+            // returns an invalid type, so fall back to canonical.
+            CXType pointee = (clang_type.kind == CXType_Pointer)
+                ? clang_getPointeeType(clang_type)
+                : clang_getPointeeType(canonical);
+            if (pointee.kind == CXType_Char_S || pointee.kind == CXType_SChar ||
+                pointee.kind == CXType_Char_U) {
+                // char* -> treat as C string
+                fip_type->is_mutable = !clang_isConstQualifiedType(pointee);
+                fip_type->type = FIP_TYPE_PRIMITIVE;
+                fip_type->u.prim = FIP_STR;
+                goto ok;
+            } else {
+                // Other pointer types
+                fip_type->type = FIP_TYPE_PTR;
+                fip_type->u.ptr.base_type = malloc(sizeof(fip_type_t));
+                const bool success = clang_type_to_fip_type( //
+                    pointee, fip_type->u.ptr.base_type       //
+                );
+                if (success) {
+                    fip_type->is_mutable =
+                        fip_type->u.ptr.base_type->is_mutable;
+                    goto ok;
+                }
+                goto fail;
+            }
+        }
+        case CXType_Elaborated: {
+            // For elaborated types (like 'struct Foo', 'union Bar'), get the
+            // named type
+            CXType named_type = clang_Type_getNamedType(canonical);
+
+            CXString elaborated_name = clang_getTypeSpelling(canonical);
+            CXString named_name = clang_getTypeSpelling(named_type);
+            fip_print(                                      //
+                ID, FIP_TRACE,                              //
+                "Elaborated '%s' -> named '%s' (kind: %d)", //
+                clang_getCString(elaborated_name),          //
+                clang_getCString(named_name),               //
+                named_type.kind                             //
+            );
+            clang_disposeString(elaborated_name);
+            clang_disposeString(named_name);
+
+            // Recursively process the named type
+            if (clang_type_to_fip_type(named_type, fip_type)) {
+                fip_type->is_mutable = !clang_isConstQualifiedType(canonical);
+                goto ok;
+            } else {
+                goto fail;
+            }
+        }
+        case CXType_Typedef: {
+            // For typedef'ed types, get the canonical (underlying) type
+            CXType canonical_type = clang_getCanonicalType(canonical);
+
+            CXString typedef_name = clang_getTypeSpelling(canonical);
+            CXString canonical_name = clang_getTypeSpelling(canonical_type);
+            fip_print(                            //
+                ID, FIP_TRACE,                    //
+                "Typedef '%s' -> canonical '%s'", //
+                clang_getCString(typedef_name),   //
+                clang_getCString(canonical_name)  //
+            );
+            clang_disposeString(typedef_name);
+            clang_disposeString(canonical_name);
+
+            // Recursively process the canonical type
+            if (clang_type_to_fip_type(canonical_type, fip_type)) {
+                fip_type->is_mutable = !clang_isConstQualifiedType(canonical);
+                goto ok;
+            } else {
+                goto fail;
+            }
+        }
+        case CXType_Record: { // CXType_Record represents structs/unions
+            fip_print(ID, FIP_TRACE, "Processing struct/record type");
+            fip_type->type = FIP_TYPE_STRUCT;
+
+            // Get the struct declaration cursor
+            CXCursor type_cursor = clang_getTypeDeclaration(canonical);
+
+            // Check if this is an opaque / forward-declared struct (no body)
+            if (!clang_isCursorDefinition(type_cursor)) {
+                fip_print(ID, FIP_TRACE,
+                    "Incomplete/opaque struct, treating as void");
+                fip_type->type = FIP_TYPE_PRIMITIVE;
+                fip_type->u.prim = FIP_VOID;
+                goto ok;
+            }
+
+            // Extracting the type name
+            CXString struct_name = clang_getCursorSpelling(type_cursor);
+            const char *name_cstr = clang_getCString(struct_name);
+            const size_t name_len = strlen(name_cstr);
+            memset(                               //
+                fip_type->u.struct_t.name, 0,     //
+                sizeof(fip_type->u.struct_t.name) //
+            );
+            memcpy(fip_type->u.struct_t.name, name_cstr, name_len);
+            clang_disposeString(struct_name);
+
+            // Collect the types of all fields
+            int field_count = 0;
+            const uint32_t base = collect_members( //
+                type_cursor, false, true, &field_count);
+            fip_print(ID, FIP_TRACE, "Struct has %d fields", field_count);
+            if (field_count <= 0 || field_count > 255) {
+                fip_print(ID, FIP_WARN, "Invalid struct field count: %d",
+                    field_count);
+                members_pop(base);
+                goto fail;
+            }
+
+            fip_type->u.struct_t.field_count = (uint8_t)field_count;
+            fip_type->u.struct_t.fields = malloc( //
+                sizeof(fip_type_t) * field_count  //
+            );
+            memcpy(fip_type->u.struct_t.fields, &members.types[base],
+                sizeof(fip_type_t) * field_count);
+            members.len = base;
+
+            fip_print(ID, FIP_TRACE,
+                "Successfully processed struct with %d fields", field_count);
+            goto ok;
+        }
+        case CXType_Enum: {
+            fip_print(ID, FIP_TRACE, "Processing enum type");
+            fip_type->type = FIP_TYPE_ENUM;
+
+            CXCursor type_cursor = clang_getTypeDeclaration(canonical);
+            CXType integer_type = clang_getEnumDeclIntegerType(type_cursor);
+            CXType canon_int = clang_getCanonicalType(integer_type);
+
+            // Extracting the type name
+            CXString enum_name = clang_getCursorSpelling(type_cursor);
+            const char *name_cstr = clang_getCString(enum_name);
+            const size_t name_len = strlen(name_cstr);
+            memset(                             //
+                fip_type->u.enum_t.name, 0,     //
+                sizeof(fip_type->u.enum_t.name) //
+            );
+            memcpy(fip_type->u.enum_t.name, name_cstr, name_len);
+            clang_disposeString(enum_name);
+
+            // Determine is_signed
+            uint8_t is_signed = 1;
+            switch (canon_int.kind) {
+                case CXType_Char_U:
+                case CXType_UChar:
+                case CXType_UShort:
+                case CXType_UInt:
+                case CXType_ULong:
+                case CXType_ULongLong:
+                case CXType_UInt128:
+                    is_signed = 0;
+                    break;
+                default:
+                    is_signed = 1;
+            }
+            fip_type->u.enum_t.is_signed = is_signed;
+
+            // bit_width, for now enums are just 'int' values internally, so 4
+            // byte signed
+            long long byte_size = clang_Type_getSizeOf(canon_int);
+            if (byte_size <= 0) {
+                fip_print(ID, FIP_WARN, "Invalid enum underlying type size");
+                goto fail;
+            }
+            fip_type->u.enum_t.bit_width = (uint8_t)(byte_size * 8);
+
+            // Collect the values of all constants
+            int value_count = 0;
+            const uint32_t base = collect_members( //
+                type_cursor, false, false, &value_count);
+            fip_print(ID, FIP_TRACE, "Enum has %d constants", value_count);
+            if (value_count <= 0 || value_count > 255) {
+                fip_print(ID, FIP_WARN, "Invalid enum constant count: %d",
+                    value_count);
+                members_pop(base);
+                goto fail;
+            }
+
+            fip_type->u.enum_t.value_count = (uint8_t)value_count;
+            fip_type->u.enum_t.values = malloc( //
+                sizeof(size_t) * value_count    //
+            );
+            memcpy(fip_type->u.enum_t.values, &members.values[base],
+                sizeof(size_t) * value_count);
+            members.len = base;
+
+            fip_print(ID, FIP_TRACE,
+                "Successfully processed enum with %d constants", value_count);
+            goto ok;
+        }
+        case CXType_ConstantArray: {
+            CXType element_type = clang_getArrayElementType(canonical);
+            size_t array_size = clang_getArraySize(canonical);
+            fip_type->type = FIP_TYPE_ARRAY;
+            fip_type->u.array.size = array_size;
+            fip_type->u.array.base_type = malloc(sizeof(fip_type_t));
+            if (!clang_type_to_fip_type(                       //
+                    element_type, fip_type->u.array.base_type) //
+            ) {
+                goto fail;
+            }
+            goto ok;
+        }
+        case CXType_IncompleteArray: {
+            CXType element_type = clang_getArrayElementType(canonical);
+            fip_type->type = FIP_TYPE_PTR;
+            fip_type->u.ptr.base_type = malloc(sizeof(fip_type_t));
+            if (!clang_type_to_fip_type(                     //
+                    element_type, fip_type->u.ptr.base_type) //
+            ) {
+                fip_print(ID, FIP_WARN, "Unsupported array element type");
+                free(fip_type->u.ptr.base_type);
+                goto fail;
+            }
+            goto ok;
+        }
+        case CXType_Complex: {
+            // TODO: Handle complex types if needed
+            fip_print(ID, FIP_ERROR, "Complex types not yet supported");
+            goto fail;
+        }
+        default:
+            goto fail;
+    }
+
+ok:
+    stack_pop(&stack);
+    return true;
+fail:
+    stack_pop(&stack);
+    return false;
+}
+
+bool extract_function_signature(CXCursor cursor, fip_sig_fn_t *fn_sig) {
+    // Get function name
+    CXString name = clang_getCursorSpelling(cursor);
+    const char *name_cstr = clang_getCString(name);
+    strncpy(fn_sig->name, name_cstr, sizeof(fn_sig->name) - 1);
+    clang_disposeString(name);
+
+    CXType function_type = clang_getCursorType(cursor);
+
+    // Get return type
+    CXType return_type = clang_getResultType(function_type);
+    if (return_type.kind != CXType_Void) {
+        fn_sig->rets_len = 1;
+        fn_sig->rets = malloc(sizeof(fip_type_t));
+        stack_clear(&stack);
+        if (!clang_type_to_fip_type(return_type, &fn_sig->rets[0])) {
+            fip_print(ID, FIP_WARN, "Unsupported return type for function %s",
+                fn_sig->name);
+            free(fn_sig->rets);
+            stack_clear(&stack);
+            return false;
+        }
+        stack_clear(&stack);
+    } else {
+        fn_sig->rets_len = 0;
+        fn_sig->rets = NULL;
+    }
+
+    // Get parameter count and types
+    int num_args = clang_getNumArgTypes(function_type);
+    if (num_args < 0) {
+        fip_print(                                                        //
+            ID, FIP_WARN, "Could not get argument count for function %s", //
+            fn_sig->name                                                  //
+        );
+        free(fn_sig->rets);
+        return false;
+    }
+
+    fn_sig->args_len = num_args;
+    if (num_args > 0) {
+        fn_sig->args = malloc(sizeof(fip_sig_fn_arg_t) * num_args);
+        for (int i = 0; i < num_args; i++) {
+            CXType arg_type = clang_getArgType(function_type, i);
+            stack_clear(&stack);
+            CXCursor arg_cursor = clang_Cursor_getArgument(cursor, i);
+            CXString arg_name_str = clang_getCursorSpelling(arg_cursor);
+            const char *arg_name = clang_getCString(arg_name_str);
+            strncpy(                             //
+                fn_sig->args[i].name,            //
+                arg_name,                        //
+                sizeof(fn_sig->args[i].name) - 1 //
+            );
+            clang_disposeString(arg_name_str);
+            if (!clang_type_to_fip_type(arg_type, &fn_sig->args[i].type)) {
+                fip_print(                                          //
+                    ID, FIP_WARN,                                   //
+                    "Unsupported argument type %d for function %s", //
+                    i, fn_sig->name                                 //
+                );
+                free(fn_sig->args);
+                free(fn_sig->rets);
+                return false;
+            }
+        }
+        stack_clear(&stack);
+    } else {
+        fn_sig->args = NULL;
+    }
+
+    return true;
+}
+
+bool extract_struct_signature(CXCursor cursor, fip_sig_data_t *data_sig) {
+    CXString cname = clang_getCursorSpelling(cursor);
+    const char *name_cstr = clang_getCString(cname);
+    if (strlen(name_cstr) == 0) {
+        clang_disposeString(cname);
+        return false;
+    }
+    strncpy(data_sig->name, name_cstr, sizeof(data_sig->name) - 1);
+    clang_disposeString(cname);
+
+    // Collect the names and types of all fields in one traversal
+    int field_count = 0;
+    const uint32_t base = collect_members(cursor, true, true, &field_count);
+    if (field_count <= 0 || field_count > 255) {
+        fip_print(ID, FIP_WARN, "Invalid struct field count: %d", field_count);
+        members_pop(base);
+        return false;
+    }
+    data_sig->value_count = (uint8_t)field_count;
+    data_sig->value_names = (char **)malloc(sizeof(char *) * field_count);
+    data_sig->value_types =
+        (fip_type_t *)malloc(sizeof(fip_type_t) * field_count);
+    memcpy(data_sig->value_names, &members.names[base],
+        sizeof(char *) * field_count);
+    memcpy(data_sig->value_types, &members.types[base],
+        sizeof(fip_type_t) * field_count);
+    // The names and types are owned by the signature now
+    members.len = base;
+    return true;
+}
+
+bool extract_enum_signature(CXCursor cursor, fip_sig_enum_t *enum_sig) {
+    CXString cname = clang_getCursorSpelling(cursor);
+    const char *name_cstr = clang_getCString(cname);
+    if (strlen(name_cstr) == 0) {
+        clang_disposeString(cname);
+        return false;
+    }
+    strncpy(enum_sig->name, name_cstr, sizeof(enum_sig->name) - 1);
+    clang_disposeString(cname);
+
+    CXType integer_type = clang_getEnumDeclIntegerType(cursor);
+    CXType canon = clang_getCanonicalType(integer_type);
+    fip_type_prim_e prim;
+    switch (canon.kind) {
+        case CXType_Char_U:
+        case CXType_UChar:
+            prim = FIP_U8;
+            break;
+        case CXType_UShort:
+            prim = FIP_U16;
+            break;
+        case CXType_UInt:
+            prim = FIP_U32;
+            break;
+        case CXType_ULong:
+            prim = FIP_ULONG;
+            break;
+        case CXType_ULongLong:
+            prim = FIP_ULLONG;
+            break;
+        case CXType_Char_S:
+        case CXType_SChar:
+            prim = FIP_I8;
+            break;
+        case CXType_Short:
+            prim = FIP_I16;
+            break;
+        case CXType_Int:
+            prim = FIP_I32;
+            break;
+        case CXType_Long:
+            prim = FIP_LONG;
+            break;
+        case CXType_LongLong:
+            prim = FIP_LLONG;
+            break;
+        default:
+            fip_print(ID, FIP_WARN, "Unsupported underlying enum type for %s",
+                enum_sig->name);
+            return false;
+    }
+    enum_sig->type = prim;
+
+    // Collect the names and values of all constants in one traversal
+    int value_count = 0;
+    const uint32_t base = collect_members(cursor, true, false, &value_count);
+    if (value_count <= 0 || value_count > 255) {
+        fip_print(ID, FIP_WARN, "Invalid enum constant count: %d", value_count);
+        members_pop(base);
+        return false;
+    }
+    enum_sig->value_count = (uint8_t)value_count;
+    enum_sig->tags = (char **)malloc(sizeof(char *) * value_count);
+    enum_sig->values = (size_t *)malloc(sizeof(size_t) * value_count);
+    memcpy(enum_sig->tags, &members.names[base], sizeof(char *) * value_count);
+    memcpy(enum_sig->values, &members.values[base],
+        sizeof(size_t) * value_count);
+    // The names are owned by the signature now
+    members.len = base;
+
+    return true;
+}
+
+/*
+ * ==============================================
+ * ABI FINGERPRINT Functions
+ * ==============================================
+ * Every symbol gets a fingerprint of its ABI:
+ * the signature with all nested types, the size,
+ * alignment and field offsets of structs and the
+ * calling convention of functions. Names of
+ * function arguments, comments and formatting do
+ * not take part in it. The fingerprints of each
+ * imported tag are persisted in the file
+ * `.fip/cache/<tag>.abi` at the end of a session
+ * so the next session can report which symbols
+ * actually changed their ABI. Flint then only
+ * needs to recompile the code which uses them.
+ * ==============================================
+ */
+
+#define HASH_SEED 0xcbf29ce484222325ULL
+#define ABI_CACHE_MAGIC "fip-abi 2"
+
+typedef struct {
+    char name[128];
+    uint64_t fingerprint;
+} abi_entry_t;
+
+/// @function `hash_bytes`
+/// @brief Continues a 64-bit FNV-1a hash with the given bytes
+uint64_t hash_bytes(uint64_t hash, const void *data, const size_t len) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/// @function `hash_string`
+/// @brief Continues the given hash with a string, including its terminator
+uint64_t hash_string(uint64_t hash, const char *str) {
+    return hash_bytes(hash, str, strlen(str) + 1);
+}
+
+/// @function `fingerprint_type`
+/// @brief Continues the given hash with the given type and all its nested
+/// types
+uint64_t fingerprint_type(uint64_t hash, const fip_type_t *type) {
+    hash = hash_bytes(hash, &type->type, sizeof(type->type));
+    hash = hash_bytes(hash, &type->is_mutable, sizeof(type->is_mutable));
+    switch (type->type) {
+        case FIP_TYPE_PRIMITIVE:
+            return hash_bytes(hash, &type->u.prim, sizeof(type->u.prim));
+        case FIP_TYPE_PTR:
+            return fingerprint_type(hash, type->u.ptr.base_type);
+        case FIP_TYPE_STRUCT: {
+            const fip_type_struct_t *struct_t = &type->u.struct_t;
+            hash = hash_string(hash, struct_t->name);
+            hash = hash_bytes(hash, &struct_t->field_count, sizeof(uint8_t));
+            for (uint8_t i = 0; i < struct_t->field_count; i++) {
+                hash = fingerprint_type(hash, &struct_t->fields[i]);
+            }
+            return hash;
+        }
+        case FIP_TYPE_RECURSIVE:
+            return hash_bytes(hash, &type->u.recursive.levels_back,
+                sizeof(uint8_t));
+        case FIP_TYPE_ENUM: {
+            const fip_type_enum_t *enum_t = &type->u.enum_t;
+            hash = hash_string(hash, enum_t->name);
+            hash = hash_bytes(hash, &enum_t->bit_width, sizeof(uint8_t));
+            hash = hash_bytes(hash, &enum_t->is_signed, sizeof(uint8_t));
+            hash = hash_bytes(hash, &enum_t->value_count, sizeof(uint8_t));
+            return hash_bytes(hash, enum_t->values,
+                sizeof(size_t) * enum_t->value_count);
+        }
+        case FIP_TYPE_ARRAY:
+            hash = hash_bytes(hash, &type->u.array.size, sizeof(size_t));
+            return fingerprint_type(hash, type->u.array.base_type);
+        case FIP_TYPE_OPAQUE:
+            return hash_string(hash, type->u.opaque.name);
+    }
+    return hash;
+}
+
+enum CXChildVisitResult fingerprint_layout_visitor( //
+    CXCursor cursor,                                //
+    [[maybe_unused]] CXCursor parent,               //
+    CXClientData client_data                        //
+);
+
+/// @function `fingerprint_layout`
+/// @brief Continues the given hash with the size and alignment of the given
+/// type. For structs the offset and layout of every field is hashed too and
+/// for arrays the layout of the element type, so packing or alignment
+/// attributes change the fingerprint even when all field types stay the same
+///
+/// @param `hash` The hash to continue
+/// @param `type` The clang type whose layout to hash
+/// @return `uint64_t` The continued hash
+uint64_t fingerprint_layout(uint64_t hash, const CXType type) {
+    const CXType canonical = clang_getCanonicalType(type);
+    const int64_t layout[2] = {
+        (int64_t)clang_Type_getSizeOf(canonical),
+        (int64_t)clang_Type_getAlignOf(canonical),
+    };
+    hash = hash_bytes(hash, layout, sizeof(layout));
+    switch (canonical.kind) {
+        case CXType_ConstantArray:
+            return fingerprint_layout( //
+                hash, clang_getArrayElementType(canonical));
+        case CXType_Record: {
+            const CXCursor decl = clang_getTypeDeclaration(canonical);
+            clang_visitChildren(decl, fingerprint_layout_visitor, &hash);
+            return hash;
+        }
+        default:
+            return hash;
+    }
+}
+
+enum CXChildVisitResult fingerprint_layout_visitor( //
+    CXCursor cursor,                                //
+    [[maybe_unused]] CXCursor parent,               //
+    CXClientData client_data                        //
+) {
+    if (clang_getCursorKind(cursor) != CXCursor_FieldDecl) {
+        return CXChildVisit_Continue;
+    }
+    uint64_t *hash = (uint64_t *)client_data;
+    const int64_t offset = (int64_t)clang_Cursor_getOffsetOfField(cursor);
+    *hash = hash_bytes(*hash, &offset, sizeof(offset));
+    *hash = fingerprint_layout(*hash, clang_getCursorType(cursor));
     return CXChildVisit_Continue;
 }
 
-bool clang_type_to_fip_type(CXType clang_type, fip_type_t *fip_type) {
-    CXType canonical = clang_getCanonicalType(clang_type);
-    fip_print(ID, FIP_DEBUG, "Resolving type at depth %u", stack.len);
+/// @function `fingerprint_symbol`
+/// @brief Computes the ABI fingerprint of an extracted symbol. The layout
+/// and calling convention are taken from the cursor the symbol was extracted
+/// from, since the FIP signature does not contain them
+///
+/// @param `cursor` The cursor of the symbol's declaration
+/// @param `symbol` The extracted symbol
+/// @return `uint64_t` The fingerprint of the symbol
+uint64_t fingerprint_symbol(CXCursor cursor, const fip_c_symbol_t *symbol) {
+    uint64_t hash = hash_bytes(HASH_SEED, &symbol->type, sizeof(symbol->type));
+    const CXType cursor_type = clang_getCursorType(cursor);
+    switch (symbol->type) {
+        case FIP_SYM_UNKNOWN:
+            break;
+        case FIP_SYM_FUNCTION: {
+            const fip_sig_fn_t *fn = &symbol->sig.fn;
+            hash = hash_string(hash, fn->name);
+            hash = hash_bytes(hash, &fn->args_len, sizeof(uint8_t));
+            for (uint8_t i = 0; i < fn->args_len; i++) {
+                hash = fingerprint_type(hash, &fn->args[i].type);
+            }
+            hash = hash_bytes(hash, &fn->rets_len, sizeof(uint8_t));
+            for (uint8_t i = 0; i < fn->rets_len; i++) {
+                hash = fingerprint_type(hash, &fn->rets[i]);
+            }
+            // Structs passed or returned by value are part of the ABI with
+            // their whole layout
+            const int arg_count = clang_getNumArgTypes(cursor_type);
+            for (int i = 0; i < arg_count; i++) {
+                hash = fingerprint_layout( //
+                    hash, clang_getArgType(cursor_type, (unsigned)i));
+            }
+            hash = fingerprint_layout(hash, clang_getResultType(cursor_type));
+            const int32_t conv[2] = {
+                (int32_t)clang_getFunctionTypeCallingConv(cursor_type),
+                (int32_t)clang_isFunctionTypeVariadic(cursor_type),
+            };
+            hash = hash_bytes(hash, conv, sizeof(conv));
+            break;
+        }
+        case FIP_SYM_DATA: {
+            const fip_sig_data_t *data = &symbol->sig.data;
+            hash = hash_string(hash, data->name);
+            hash = hash_bytes(hash, &data->value_count, sizeof(uint8_t));
+            for (uint8_t i = 0; i < data->value_count; i++) {
+                hash = hash_string(hash, data->value_names[i]);
+                hash = fingerprint_type(hash, &data->value_types[i]);
+            }
+            hash = fingerprint_layout(hash, cursor_type);
+            break;
+        }
+        case FIP_SYM_ENUM: {
+            const fip_sig_enum_t *enum_t = &symbol->sig.enum_t;
+            hash = hash_string(hash, enum_t->name);
+            hash = hash_bytes(hash, &enum_t->type, sizeof(enum_t->type));
+            hash = hash_bytes(hash, &enum_t->value_count, sizeof(uint8_t));
+            for (uint8_t i = 0; i < enum_t->value_count; i++) {
+                hash = hash_string(hash, enum_t->tags[i]);
+                hash = hash_bytes(hash, &enum_t->values[i], sizeof(size_t));
+            }
+            break;
+        }
+        case FIP_SYM_OPAQUE:
+            hash = hash_string(hash, symbol->sig.opaque.name);
+            break;
+    }
+    return hash;
+}
 
-    fip_type->is_mutable = !clang_isConstQualifiedType(clang_type);
+/// @function `symbol_name`
+/// @brief Returns the name of the given symbol
+const char *symbol_name(const fip_c_symbol_t *symbol) {
+    return fip_sig_name(symbol->type, &symbol->sig);
+}
 
-    // Check if the type resolves to a pointer-to-void (named opaque or
-    // anonymous void*) libclang sets the CXType kind from the canonical type's
-    // class, so a `typedef void* NamedOpaque` has kind CXType_Pointer (not
-    // CXType_Typedef). Use clang_getTypeSpelling to recover the original name
-    // in that case.
-    if (canonical.kind == CXType_Pointer) {
-        CXType pointee = clang_getPointeeType(canonical);
-        if (clang_getCanonicalType(pointee).kind == CXType_Void) {
-            CXString type_spelling = clang_getTypeSpelling(clang_type);
-            const char *spelling = clang_getCString(type_spelling);
-            bool is_anonymous_void_ptr = (strstr(spelling, "void *") != NULL ||
-                strstr(spelling, "void*") != NULL);
-            if (!is_anonymous_void_ptr) {
-                const size_t name_len = strlen(spelling);
-                fip_print(ID, FIP_TRACE, "Detected opaque type: '%s'",
-                    spelling);
-                fip_type->type = FIP_TYPE_OPAQUE;
-                memset(fip_type->u.opaque.name, 0,
-                    sizeof(fip_type->u.opaque.name));
-                if (name_len > 0) {
-                    memcpy(fip_type->u.opaque.name, spelling, name_len);
-                }
-                clang_disposeString(type_spelling);
-                return true;
-            }
-            clang_disposeString(type_spelling);
-            // Anonymous void*: fall through to normal CXType_Pointer handling
-            // in the switch
+int abi_entry_cmp(const void *a, const void *b) {
+    const abi_entry_t *lhs = (const abi_entry_t *)a;
+    const abi_entry_t *rhs = (const abi_entry_t *)b;
+    return strcmp(lhs->name, rhs->name);
+}
+
+/// @function `abi_cache_path`
+/// @brief Writes the path of the ABI cache file of the given tag to `path`
+void abi_cache_path(char path[256], const char *tag) {
+    snprintf(path, 256, ".fip/cache/%s.abi", tag);
+}
+
+/// @function `abi_cache_apply`
+/// @brief Marks every symbol of the given collection whose fingerprint
+/// differs from the one persisted by the last session as changed. When there
+/// is no persisted fingerprint for a symbol it is new and counts as changed
+///
+/// @param `coll` The collection whose symbols to compare
+void abi_cache_apply(fip_c_symbol_collection_t *coll) {
+    for (size_t i = 0; i < coll->symbol_count; i++) {
+        coll->symbols[i].abi_changed = true;
+    }
+    char path[256];
+    abi_cache_path(path, coll->tag);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return;
+    }
+    char line[256];
+    if (!fgets(line, sizeof(line), fp)                                  //
+        || strncmp(line, ABI_CACHE_MAGIC, strlen(ABI_CACHE_MAGIC)) != 0 //
+    ) {
+        fclose(fp);
+        return;
+    }
+    size_t entry_count = 0;
+    size_t entry_cap = 0;
+    abi_entry_t *entries = NULL;
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        char *name = strchr(line, '\t');
+        if (name == NULL) {
+            continue;
         }
+        if (entry_count == entry_cap) {
+            entry_cap = entry_cap == 0 ? 64 : entry_cap * 2;
+            entries = (abi_entry_t *)realloc( //
+                entries, sizeof(abi_entry_t) * entry_cap);
+        }
+        abi_entry_t *entry = &entries[entry_count++];
+        entry->fingerprint = (uint64_t)strtoull(line, NULL, 16);
+        strncpy(entry->name, name + 1, sizeof(entry->name) - 1);
+        entry->name[sizeof(entry->name) - 1] = '\0';
+    }
+    fclose(fp);
+    qsort(entries, entry_count, sizeof(abi_entry_t), abi_entry_cmp);
+    for (size_t i = 0; i < coll->symbol_count; i++) {
+        fip_c_symbol_t *symbol = &coll->symbols[i];
+        abi_entry_t key = {0};
+        strncpy(key.name, symbol_name(symbol), sizeof(key.name) - 1);
+        const abi_entry_t *entry = (const abi_entry_t *)bsearch( //
+            &key, entries, entry_count, sizeof(abi_entry_t), abi_entry_cmp);
+        symbol->abi_changed = entry == NULL //
+            || entry->fingerprint != symbol->fingerprint;
     }
+    free(entries);
+}
 
-    int found = stack_find_equal(&stack, canonical);
-    if (found >= 0) {
-        fip_type->type = FIP_TYPE_RECURSIVE;
-        fip_type->u.recursive.levels_back = (uint8_t)(stack.len - found);
-        return true;
+/// @function `abi_cache_save`
+/// @brief Persists the fingerprints of all symbols of the given collection,
+/// they become the baseline the next session compares against
+///
+/// @param `coll` The collection whose fingerprints to persist
+void abi_cache_save(const fip_c_symbol_collection_t *coll) {
+    if (!ensure_cache_dir()) {
+        return;
+    }
+    char path[256];
+    abi_cache_path(path, coll->tag);
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        fip_print(ID, FIP_WARN, "Could not write %s", path);
+        return;
     }
+    fprintf(fp, "%s\n", ABI_CACHE_MAGIC);
+    for (size_t i = 0; i < coll->symbol_count; i++) {
+        const fip_c_symbol_t *symbol = &coll->symbols[i];
+        fprintf(fp, "%016llx\t%s\n", (unsigned long long)symbol->fingerprint,
+            symbol_name(symbol));
+    }
+    fclose(fp);
+}
 
-    // Type not seen yet, push and process
-    stack_push(&stack, canonical);
+enum CXChildVisitResult visit_ast_node( //
+    CXCursor cursor,                    //
+    [[maybe_unused]] CXCursor parent,   //
+    CXClientData client_data            //
+) {
+    const char *file_path = (const char *)client_data;
 
-    switch (canonical.kind) {
-        case CXType_UChar:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_U8;
-            goto ok;
-        case CXType_UShort:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_U16;
-            goto ok;
-        case CXType_UInt:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_U32;
-            goto ok;
-        case CXType_ULong:
-        case CXType_ULongLong:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_U64;
-            goto ok;
-        case CXType_Char_S:
-        case CXType_SChar:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_I8;
-            goto ok;
-        case CXType_Short:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_I16;
-            goto ok;
-        case CXType_Int:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_I32;
-            goto ok;
-        case CXType_Long:
-        case CXType_LongLong:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_I64;
-            goto ok;
-        case CXType_Float:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_F32;
-            goto ok;
-        case CXType_Double:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_F64;
-            goto ok;
-        case CXType_Bool:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_BOOL;
-            goto ok;
-        case CXType_Void:
-            fip_type->type = FIP_TYPE_PRIMITIVE;
-            fip_type->u.prim = FIP_VOID;
-            goto ok;
-        case CXType_Pointer: {
-            // Use the original type's pointee when it's directly a pointer
-            // (preserves typedef info for e.g. NamedOpaque * -> NamedOpaque).
-            // When clang_type is a Typedef of a pointer (e.g. typedef
-            // Transform* ModelAnimPose), clang_getPointeeType on a Typedef
-            // returns an invalid type, so fall back to canonical.
-            CXType pointee = (clang_type.kind == CXType_Pointer)
-                ? clang_getPointeeType(clang_type)
-                : clang_getPointeeType(canonical);
-            if (pointee.kind == CXType_Char_S || pointee.kind == CXType_SChar) {
-                // char* -> treat as C string
-                fip_type->is_mutable = !clang_isConstQualifiedType(pointee);
-                fip_type->type = FIP_TYPE_PRIMITIVE;
-                fip_type->u.prim = FIP_STR;
-                goto ok;
-            } else {
-                // Other pointer types
-                fip_type->type = FIP_TYPE_PTR;
-                fip_type->u.ptr.base_type = malloc(sizeof(fip_type_t));
-                const bool success = clang_type_to_fip_type( //
-                    pointee, fip_type->u.ptr.base_type       //
+    // Only process nodes from the file we're parsing (not from #includes)
+    CXSourceLocation location = clang_getCursorLocation(cursor);
+    CXFile file;
+    unsigned line, column, offset;
+    clang_getExpansionLocation(location, &file, &line, &column, &offset);
+
+    if (file) {
+        CXString filename = clang_getFileName(file);
+        const char *filename_cstr = clang_getCString(filename);
+
+        // Skip if this cursor is not from our target file
+        if (strcmp(filename_cstr, file_path) != 0) {
+            clang_disposeString(filename);
+            return CXChildVisit_Continue;
+        }
+        clang_disposeString(filename);
+    }
+
+    enum CXCursorKind kind = clang_getCursorKind(cursor);
+    switch (kind) {
+        default:
+            return CXChildVisit_Recurse;
+        case CXCursor_FunctionDecl: {
+            // Get function name first to check if it's main
+            CXString name = clang_getCursorSpelling(cursor);
+            const char *name_cstr = clang_getCString(name);
+            fip_print(ID, FIP_TRACE, "Visit AST Node FunctionDecl: %s",
+                name_cstr);
+            // Skip main function
+            if (strcmp(name_cstr, "main") == 0) {
+                clang_disposeString(name);
+                return CXChildVisit_Continue;
+            }
+            clang_disposeString(name);
+
+            // Check if function has external linkage
+            enum CXLinkageKind linkage = clang_getCursorLinkage(cursor);
+            if (linkage != CXLinkage_External) {
+                fip_print(ID, FIP_TRACE, "Has no external linkage");
+                return CXChildVisit_Continue;
+            }
+
+            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
+                fip_print(                                                  //
+                    ID, FIP_WARN,                                           //
+                    "Maximum symbols reached, skipping remaining functions" //
                 );
-                if (success) {
-                    fip_type->is_mutable =
-                        fip_type->u.ptr.base_type->is_mutable;
-                    goto ok;
-                }
-                goto fail;
+                return CXChildVisit_Break;
+            }
+
+            // Extract function information
+            fip_c_symbol_t symbol = {0};
+            strncpy(                                //
+                symbol.source_file_path, file_path, //
+                sizeof(symbol.source_file_path) - 1 //
+            );
+            symbol.line_number = (int)line;
+            symbol.type = FIP_SYM_FUNCTION;
+
+            if (extract_function_signature(cursor, &symbol.sig.fn)) {
+                symbol.fingerprint = fingerprint_symbol(cursor, &symbol);
+                curr_coll->symbols[curr_coll->symbol_count] = symbol;
+
+                fip_print(                                                  //
+                    ID, FIP_INFO, "Found extern function: '%s' at line %d", //
+                    symbol.sig.fn.name, symbol.line_number                  //
+                );
+                fip_print_sig_fn(ID, &symbol.sig.fn);
+
+                curr_coll->symbol_count++;
             }
+            break;
         }
-        case CXType_Elaborated: {
-            // For elaborated types (like 'struct Foo', 'union Bar'), get the
-            // named type
-            CXType named_type = clang_Type_getNamedType(canonical);
+        case CXCursor_StructDecl: {
+            if (!clang_isCursorDefinition(cursor)) {
+                return CXChildVisit_Continue;
+            }
 
-            CXString elaborated_name = clang_getTypeSpelling(canonical);
-            CXString named_name = clang_getTypeSpelling(named_type);
-            fip_print(                                      //
-                ID, FIP_TRACE,                              //
-                "Elaborated '%s' -> named '%s' (kind: %d)", //
-                clang_getCString(elaborated_name),          //
-                clang_getCString(named_name),               //
-                named_type.kind                             //
+            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
+                fip_print(                                                //
+                    ID, FIP_WARN,                                         //
+                    "Maximum symbols reached, skipping remaining structs" //
+                );
+                return CXChildVisit_Break;
+            }
+
+            // Extract struct information
+            fip_c_symbol_t symbol = {0};
+            strncpy(                                //
+                symbol.source_file_path, file_path, //
+                sizeof(symbol.source_file_path) - 1 //
             );
-            clang_disposeString(elaborated_name);
-            clang_disposeString(named_name);
+            symbol.line_number = (int)line;
+            symbol.type = FIP_SYM_DATA;
 
-            // Recursively process the named type
-            if (clang_type_to_fip_type(named_type, fip_type)) {
-                fip_type->is_mutable = !clang_isConstQualifiedType(canonical);
-                goto ok;
-            } else {
-                goto fail;
+            if (extract_struct_signature(cursor, &symbol.sig.data) //
+                && !symbol_name_exists(symbol.sig.data.name)       //
+            ) {
+                symbol.fingerprint = fingerprint_symbol(cursor, &symbol);
+                curr_coll->symbols[curr_coll->symbol_count] = symbol;
+                fip_print(                                         //
+                    ID, FIP_INFO, "Found struct: '%s' at line %d", //
+                    symbol.sig.data.name, symbol.line_number       //
+                );
+                curr_coll->symbol_count++;
             }
+            break;
         }
-        case CXType_Typedef: {
-            // For typedef'ed types, get the canonical (underlying) type
-            CXType canonical_type = clang_getCanonicalType(canonical);
+        case CXCursor_EnumDecl: {
+            if (!clang_isCursorDefinition(cursor)) {
+                return CXChildVisit_Continue;
+            }
 
-            CXString typedef_name = clang_getTypeSpelling(canonical);
-            CXString canonical_name = clang_getTypeSpelling(canonical_type);
-            fip_print(                            //
-                ID, FIP_TRACE,                    //
-                "Typedef '%s' -> canonical '%s'", //
-                clang_getCString(typedef_name),   //
-                clang_getCString(canonical_name)  //
+            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
+                fip_print(                                              //
+                    ID, FIP_WARN,                                       //
+                    "Maximum symbols reached, skipping remaining enums" //
+                );
+                return CXChildVisit_Break;
+            }
+
+            // Extract enum information
+            fip_c_symbol_t symbol = {0};
+            strncpy(                                //
+                symbol.source_file_path, file_path, //
+                sizeof(symbol.source_file_path) - 1 //
             );
-            clang_disposeString(typedef_name);
-            clang_disposeString(canonical_name);
+            symbol.line_number = (int)line;
+            symbol.type = FIP_SYM_ENUM;
 
-            // Recursively process the canonical type
-            if (clang_type_to_fip_type(canonical_type, fip_type)) {
-                fip_type->is_mutable = !clang_isConstQualifiedType(canonical);
-                goto ok;
-            } else {
-                goto fail;
+            if (extract_enum_signature(cursor, &symbol.sig.enum_t) //
+                && !symbol_name_exists(symbol.sig.enum_t.name)     //
+            ) {
+                symbol.fingerprint = fingerprint_symbol(cursor, &symbol);
+                curr_coll->symbols[curr_coll->symbol_count] = symbol;
+                fip_print(                                       //
+                    ID, FIP_INFO, "Found enum: '%s' at line %d", //
+                    symbol.sig.enum_t.name, symbol.line_number   //
+                );
+                curr_coll->symbol_count++;
             }
+            break;
         }
-        case CXType_Record: { // CXType_Record represents structs/unions
-            fip_print(ID, FIP_TRACE, "Processing struct/record type");
-            fip_type->type = FIP_TYPE_STRUCT;
-
-            // Get the struct declaration cursor
-            CXCursor type_cursor = clang_getTypeDeclaration(canonical);
+        case CXCursor_TypedefDecl: {
+            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
+                fip_print(                                                 //
+                    ID, FIP_WARN,                                          //
+                    "Maximum symbols reached, skipping remaining typedefs" //
+                );
+                return CXChildVisit_Break;
+            }
 
-            // Check if this is an opaque / forward-declared struct (no body)
-            if (!clang_isCursorDefinition(type_cursor)) {
-                fip_print(ID, FIP_TRACE,
-                    "Incomplete/opaque struct, treating as void");
-                fip_type->type = FIP_TYPE_PRIMITIVE;
-                fip_type->u.prim = FIP_VOID;
-                goto ok;
+            // Check if this typedef is an opaque type (typedef void* NAME)
+            CXType underlying = clang_getTypedefDeclUnderlyingType(cursor);
+            CXType canonical = clang_getCanonicalType(underlying);
+            bool is_opaque = false;
+            if (canonical.kind == CXType_Pointer) {
+                CXType pointee = clang_getPointeeType(canonical);
+                CXType pointee_canonical = clang_getCanonicalType(pointee);
+                if (pointee_canonical.kind == CXType_Void) {
+                    is_opaque = true;
+                }
             }
 
-            // Extracting the type name
-            CXString struct_name = clang_getCursorSpelling(type_cursor);
-            const char *name_cstr = clang_getCString(struct_name);
-            const size_t name_len = strlen(name_cstr);
-            memset(                               //
-                fip_type->u.struct_t.name, 0,     //
-                sizeof(fip_type->u.struct_t.name) //
-            );
-            memcpy(fip_type->u.struct_t.name, name_cstr, name_len);
-            clang_disposeString(struct_name);
+            if (!is_opaque) {
+                return CXChildVisit_Recurse;
+            }
 
-            // Count fields first
-            int field_count = 0;
-            clang_visitChildren(                                       //
-                type_cursor, count_struct_fields_visitor, &field_count //
-            );
-            fip_print(ID, FIP_TRACE, "Struct has %d fields", field_count);
-            if (field_count <= 0 || field_count > 255) {
-                fip_print(ID, FIP_WARN, "Invalid struct field count: %d",
-                    field_count);
-                goto fail;
+            CXString typedef_name = clang_getCursorSpelling(cursor);
+            const char *name_cstr = clang_getCString(typedef_name);
+            if (strlen(name_cstr) == 0) {
+                clang_disposeString(typedef_name);
+                return CXChildVisit_Continue;
             }
 
-            fip_type->u.struct_t.field_count = (uint8_t)field_count;
-            fip_type->u.struct_t.fields = malloc( //
-                sizeof(fip_type_t) * field_count  //
+            // Extract opaque type information
+            fip_c_symbol_t symbol = {0};
+            strncpy(                                //
+                symbol.source_file_path, file_path, //
+                sizeof(symbol.source_file_path) - 1 //
             );
+            symbol.line_number = (int)line;
+            symbol.type = FIP_SYM_OPAQUE;
 
-            // Structure to pass data to the visitor
-            field_visitor_data visitor_data = {
-                .fields = fip_type->u.struct_t.fields,
-                .current_index = 0,
-                .module_id = ID,
-            };
-
-            // Visit each field and convert its type
-            clang_visitChildren(                                 //
-                type_cursor, struct_field_visitor, &visitor_data //
+            strncpy(                               //
+                symbol.sig.opaque.name, name_cstr, //
+                sizeof(symbol.sig.opaque.name) - 1 //
             );
+            symbol.sig.opaque.name[sizeof(symbol.sig.opaque.name) - 1] = '\0';
+            clang_disposeString(typedef_name);
 
-            // Check if we processed the expected number of fields
-            if (visitor_data.current_index != field_count) {
-                fip_print(                                               //
-                    ID, FIP_WARN, "Processed %d fields but expected %d", //
-                    visitor_data.current_index, field_count              //
+            if (!symbol_name_exists(symbol.sig.opaque.name)) {
+                symbol.fingerprint = fingerprint_symbol(cursor, &symbol);
+                curr_coll->symbols[curr_coll->symbol_count] = symbol;
+                fip_print(                                              //
+                    ID, FIP_INFO, "Found opaque type: '%s' at line %d", //
+                    symbol.sig.opaque.name, symbol.line_number          //
                 );
-                free(fip_type->u.struct_t.fields);
-                goto fail;
+                curr_coll->symbol_count++;
             }
-
-            fip_print(ID, FIP_TRACE,
-                "Successfully processed struct with %d fields", field_count);
-            goto ok;
+            break;
         }
-        case CXType_Enum: {
-            fip_print(ID, FIP_TRACE, "Processing enum type");
-            fip_type->type = FIP_TYPE_ENUM;
+    }
 
-            CXCursor type_cursor = clang_getTypeDeclaration(canonical);
-            CXType integer_type = clang_getEnumDeclIntegerType(type_cursor);
-            CXType canon_int = clang_getCanonicalType(integer_type);
+    return CXChildVisit_Recurse;
+}
 
-            // Extracting the type name
-            CXString enum_name = clang_getCursorSpelling(type_cursor);
-            const char *name_cstr = clang_getCString(enum_name);
-            const size_t name_len = strlen(name_cstr);
-            memset(                             //
-                fip_type->u.enum_t.name, 0,     //
-                sizeof(fip_type->u.enum_t.name) //
-            );
-            memcpy(fip_type->u.enum_t.name, name_cstr, name_len);
-            clang_disposeString(enum_name);
+/*
+ * ==============================================
+ * SYMBOL INDEX Functions
+ * ==============================================
+ * Once the headers of a tag are parsed its
+ * symbols do not change anymore until the tag
+ * is parsed again. The collection is frozen then
+ * by building a minimal perfect hash over all
+ * distinct symbol names: the names are spread
+ * over as many buckets as there are names, and
+ * every bucket gets a seed which hashes all of
+ * its names into distinct free slots, largest
+ * buckets first. Buckets with a single name
+ * directly store their slot. A lookup hashes the
+ * name twice and compares the name of the one
+ * symbol in its slot, there are no collisions to
+ * resolve. Symbols sharing a name, like a struct
+ * tag and a function, are chained behind the
+ * first of them. The whole index takes three
+ * 32-bit integers per symbol.
+ * ==============================================
+ */
 
-            // Determine is_signed
-            uint8_t is_signed = 1;
-            switch (canon_int.kind) {
-                case CXType_Char_U:
-                case CXType_UChar:
-                case CXType_UShort:
-                case CXType_UInt:
-                case CXType_ULong:
-                case CXType_ULongLong:
-                case CXType_UInt128:
-                    is_signed = 0;
+/// @function `index_mix`
+/// @brief Derives the hash of a name for the given seed from the seedless
+/// hash of the name
+uint64_t index_mix(uint64_t hash, const uint32_t seed) {
+    hash ^= (uint64_t)seed * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+typedef struct {
+    const char *name;
+    uint32_t symbol;
+} index_entry_t;
+
+int index_entry_cmp(const void *a, const void *b) {
+    const index_entry_t *lhs = (const index_entry_t *)a;
+    const index_entry_t *rhs = (const index_entry_t *)b;
+    const int cmp = strcmp(lhs->name, rhs->name);
+    if (cmp != 0) {
+        return cmp;
+    }
+    // Symbols sharing a name stay in the order they were found in
+    return (lhs->symbol > rhs->symbol) - (lhs->symbol < rhs->symbol);
+}
+
+/// @function `sort_symbols_by_name`
+/// @brief Fills the given order with the indices of all symbols of the given
+/// collection, sorted by their names. The names are sorted together with the
+/// indices, so the comparison needs no collection to look them up in and
+/// several threads can sort at once
+///
+/// @param `coll` The collection whose symbols to sort
+/// @param `order` The array to fill, it holds one index per symbol
+void sort_symbols_by_name(                 //
+    const fip_c_symbol_collection_t *coll, //
+    uint32_t *order                        //
+) {
+    const uint32_t symbol_count = (uint32_t)coll->symbol_count;
+    index_entry_t *entries = (index_entry_t *)malloc( //
+        sizeof(index_entry_t) * (symbol_count + 1));
+    for (uint32_t i = 0; i < symbol_count; i++) {
+        entries[i].name = symbol_name(&coll->symbols[i]);
+        entries[i].symbol = i;
+    }
+    qsort(entries, symbol_count, sizeof(index_entry_t), index_entry_cmp);
+    for (uint32_t i = 0; i < symbol_count; i++) {
+        order[i] = entries[i].symbol;
+    }
+    free(entries);
+}
+
+/// @function `symbol_index_free`
+/// @brief Frees the index of the given collection
+void symbol_index_free(symbol_index_t *index) {
+    free(index->seeds);
+    free(index->slots);
+    free(index->next);
+    *index = (symbol_index_t){0};
+}
+
+/// @function `symbol_index_build`
+/// @brief Freezes the given collection by building the minimal perfect hash
+/// index over the names of all its symbols
+///
+/// @param `coll` The collection to freeze
+void symbol_index_build(fip_c_symbol_collection_t *coll) {
+    symbol_index_t *index = &coll->index;
+    symbol_index_free(index);
+    const uint32_t symbol_count = (uint32_t)coll->symbol_count;
+    if (symbol_count == 0) {
+        return;
+    }
+
+    // Sorting the symbols by name groups the ones sharing a name, only the
+    // first of every group is hashed and the others are chained behind it
+    uint32_t *order = (uint32_t *)malloc(sizeof(uint32_t) * symbol_count);
+    sort_symbols_by_name(coll, order);
+    index->next = (uint32_t *)malloc(sizeof(uint32_t) * symbol_count);
+    uint32_t *heads = (uint32_t *)malloc(sizeof(uint32_t) * symbol_count);
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < symbol_count; i++) {
+        const uint32_t sym = order[i];
+        const bool is_chained = i > 0 &&
+            strcmp(symbol_name(&coll->symbols[sym]),
+                symbol_name(&coll->symbols[order[i - 1]])) == 0;
+        if (is_chained) {
+            index->next[order[i - 1]] = sym;
+        } else {
+            heads[size++] = sym;
+        }
+        index->next[sym] = SYMBOL_INDEX_END;
+    }
+    index->size = size;
+
+    // Distribute the distinct names over the buckets, the names of a bucket
+    // are stored next to each other in `order`
+    uint64_t *hashes = (uint64_t *)malloc(sizeof(uint64_t) * size);
+    uint32_t *bucket_of = (uint32_t *)malloc(sizeof(uint32_t) * size);
+    uint32_t *bucket_start = (uint32_t *)calloc(size + 1, sizeof(uint32_t));
+    for (uint32_t i = 0; i < size; i++) {
+        const char *name = symbol_name(&coll->symbols[heads[i]]);
+        hashes[i] = hash_string(HASH_SEED, name);
+        bucket_of[i] = (uint32_t)(index_mix(hashes[i], 0) % size);
+        bucket_start[bucket_of[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < size; b++) {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    uint32_t *fill = (uint32_t *)malloc(sizeof(uint32_t) * size);
+    memcpy(fill, bucket_start, sizeof(uint32_t) * size);
+    for (uint32_t i = 0; i < size; i++) {
+        order[fill[bucket_of[i]]++] = i;
+    }
+
+    // Buckets are placed from the largest to the smallest, small buckets fill
+    // the gaps the large ones left
+    uint32_t max_bucket = 0;
+    for (uint32_t b = 0; b < size; b++) {
+        const uint32_t len = bucket_start[b + 1] - bucket_start[b];
+        max_bucket = len > max_bucket ? len : max_bucket;
+    }
+    index->seeds = (int32_t *)calloc(size, sizeof(int32_t));
+    index->slots = (uint32_t *)malloc(sizeof(uint32_t) * size);
+    bool *is_taken = (bool *)calloc(size, sizeof(bool));
+    uint32_t *placed = (uint32_t *)malloc(sizeof(uint32_t) * max_bucket);
+    uint32_t free_slot = 0;
+    for (uint32_t len = max_bucket; len > 0; len--) {
+        for (uint32_t b = 0; b < size; b++) {
+            const uint32_t start = bucket_start[b];
+            if (bucket_start[b + 1] - start != len) {
+                continue;
+            }
+            if (len == 1) {
+                while (is_taken[free_slot]) {
+                    free_slot++;
+                }
+                is_taken[free_slot] = true;
+                index->slots[free_slot] = heads[order[start]];
+                index->seeds[b] = -(int32_t)free_slot - 1;
+                continue;
+            }
+            for (uint32_t seed = 1;; seed++) {
+                uint32_t k = 0;
+                for (; k < len; k++) {
+                    const uint64_t hash = hashes[order[start + k]];
+                    placed[k] = (uint32_t)(index_mix(hash, seed) % size);
+                    if (is_taken[placed[k]]) {
+                        break;
+                    }
+                    is_taken[placed[k]] = true;
+                }
+                if (k == len) {
+                    index->seeds[b] = (int32_t)seed;
+                    for (k = 0; k < len; k++) {
+                        index->slots[placed[k]] = heads[order[start + k]];
+                    }
                     break;
-                default:
-                    is_signed = 1;
+                }
+                // Release the slots taken by this attempt
+                for (uint32_t r = 0; r < k; r++) {
+                    is_taken[placed[r]] = false;
+                }
             }
-            fip_type->u.enum_t.is_signed = is_signed;
+        }
+    }
+    free(placed);
+    free(is_taken);
+    free(fill);
+    free(bucket_start);
+    free(bucket_of);
+    free(hashes);
+    free(heads);
+    free(order);
+    fip_print(ID, FIP_DEBUG, "Indexed %u names of %u symbols of tag '%s'",
+        size, symbol_count, coll->tag);
+}
 
-            // bit_width, for now enums are just 'int' values internally, so 4
-            // byte signed
-            long long byte_size = clang_Type_getSizeOf(canon_int);
-            if (byte_size <= 0) {
-                fip_print(ID, FIP_WARN, "Invalid enum underlying type size");
-                goto fail;
-            }
-            fip_type->u.enum_t.bit_width = (uint8_t)(byte_size * 8);
+/// @function `symbol_index_find`
+/// @brief Looks up the first symbol with the given name in the given frozen
+/// collection, the others sharing its name follow through `index.next`
+///
+/// @param `coll` The collection to search
+/// @param `name` The name of the symbol
+/// @return `uint32_t` The index of the symbol, `SYMBOL_INDEX_END` if there is
+/// no symbol with the name
+uint32_t symbol_index_find(                //
+    const fip_c_symbol_collection_t *coll, //
+    const char *name                       //
+) {
+    const symbol_index_t *index = &coll->index;
+    if (index->size == 0) {
+        return SYMBOL_INDEX_END;
+    }
+    const uint64_t hash = hash_string(HASH_SEED, name);
+    const int32_t seed = index->seeds[index_mix(hash, 0) % index->size];
+    uint32_t slot;
+    if (seed < 0) {
+        slot = (uint32_t)(-seed - 1);
+    } else {
+        slot = (uint32_t)(index_mix(hash, (uint32_t)seed) % index->size);
+    }
+    const uint32_t sym = index->slots[slot];
+    if (strcmp(symbol_name(&coll->symbols[sym]), name) != 0) {
+        return SYMBOL_INDEX_END;
+    }
+    return sym;
+}
 
-            // Count constants first
-            int value_count = 0;
-            clang_visitChildren(                                        //
-                type_cursor, count_enum_constants_visitor, &value_count //
-            );
-            fip_print(ID, FIP_TRACE, "Enum has %d constants", value_count);
-            if (value_count <= 0 || value_count > 255) {
-                fip_print(ID, FIP_WARN, "Invalid enum constant count: %d",
-                    value_count);
-                goto fail;
-            }
+/*
+ * ==============================================
+ * DEPENDENCY Functions
+ * ==============================================
+ * Every file this module parsed or compiled is a
+ * dependency of the Flint compilation. This is
+ * every header, every file they include (as
+ * recorded by libclang), every compiled source
+ * and every file the compiler reported in the
+ * depfile it wrote to `__DEPFILE__`. The list is
+ * handed to the master through the
+ * `.fip/cache/fip-c.deps` file which combines the
+ * lists of all modules into a single depfile for
+ * the outer build system.
+ * ==============================================
+ */
 
-            fip_type->u.enum_t.value_count = (uint8_t)value_count;
-            fip_type->u.enum_t.values = malloc( //
-                sizeof(size_t) * value_count    //
-            );
+/// @var `DEPENDENCIES`
+/// @brief The dependencies recorded by the calling thread. A header parsed on
+/// another thread records its dependencies there, and they are merged into the
+/// ones of the main thread in the order of the headers
+_Thread_local path_list_t DEPENDENCIES;
+
+/// @function `record_dependency`
+/// @brief Adds the given file to the dependencies of this module
+void record_dependency(const char *path) {
+    // Paths are recorded the same way no matter how they were spelled
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) {
+        path += 2;
+    }
+    path_list_push(&DEPENDENCIES, clone_string(path));
+}
 
-            // Structure to pass data to the visitor
-            enum_visitor_data visitor_data = {
-                .values = fip_type->u.enum_t.values,
-                .current_index = 0,
-                .module_id = ID,
-            };
+/// @function `record_inclusion`
+/// @brief Inclusion visitor adding every file of a translation unit, the
+/// parsed file itself included, to the dependencies
+void record_inclusion(                                 //
+    CXFile included_file,                              //
+    [[maybe_unused]] CXSourceLocation *inclusion_stack, //
+    [[maybe_unused]] unsigned include_len,             //
+    [[maybe_unused]] CXClientData client_data          //
+) {
+    CXString file_name = clang_getFileName(included_file);
+    const char *file_name_cstr = clang_getCString(file_name);
+    if (file_name_cstr != NULL && file_name_cstr[0] != '\0') {
+        record_dependency(file_name_cstr);
+    }
+    clang_disposeString(file_name);
+}
 
-            // Visit each constant and collect its value
-            clang_visitChildren(                               //
-                type_cursor, enum_value_visitor, &visitor_data //
-            );
+/// @function `record_module_headers`
+/// @brief Visitor adding the files of all inclusion directives of a translation
+/// unit and the headers of the modules they resolve to. Headers loaded from a
+/// Clang module are no inclusions, so they are not found by `record_inclusion`
+enum CXChildVisitResult record_module_headers( //
+    CXCursor cursor,                           //
+    [[maybe_unused]] CXCursor parent,          //
+    CXClientData client_data                   //
+) {
+    if (clang_getCursorKind(cursor) != CXCursor_InclusionDirective) {
+        return CXChildVisit_Continue;
+    }
+    CXTranslationUnit unit = (CXTranslationUnit)client_data;
+    CXFile file = clang_getIncludedFile(cursor);
+    if (file == NULL) {
+        return CXChildVisit_Continue;
+    }
+    record_inclusion(file, NULL, 0, NULL);
+    CXModule module = clang_getModuleForFile(unit, file);
+    if (module == NULL) {
+        return CXChildVisit_Continue;
+    }
+    const unsigned header_count = clang_Module_getNumTopLevelHeaders( //
+        unit, module                                                  //
+    );
+    for (unsigned i = 0; i < header_count; i++) {
+        record_inclusion(                                    //
+            clang_Module_getTopLevelHeader(unit, module, i), //
+            NULL, 0, NULL                                    //
+        );
+    }
+    return CXChildVisit_Continue;
+}
 
-            // Check if we processed the expected number of constants
-            if (visitor_data.current_index != value_count) {
-                fip_print(                                                  //
-                    ID, FIP_WARN, "Processed %d constants but expected %d", //
-                    visitor_data.current_index, value_count                 //
-                );
-                free(fip_type->u.enum_t.values);
-                goto fail;
+/// @function `record_depfile`
+/// @brief Adds all prerequisites listed in the given Make-style depfile, as
+/// written by `-MD -MF` of gcc and clang, to the dependencies. A missing
+/// depfile is ignored
+///
+/// @param `path` The path of the depfile
+void record_depfile(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return;
+    }
+    char token[1024];
+    size_t len = 0;
+    bool in_prerequisites = false;
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+        bool ends_token = c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        if (c == '\\') {
+            int next = fgetc(fp);
+            if (next == '\r') {
+                next = fgetc(fp);
+            }
+            if (next == '\n') {
+                // A line continuation only separates two paths
+                ends_token = true;
+            } else if (next == ' ' || next == '#') {
+                c = next;
+            } else {
+                // A plain backslash is part of a Windows path
+                ungetc(next, fp);
+            }
+        } else if (c == '$') {
+            const int next = fgetc(fp);
+            if (next != '$') {
+                ungetc(next, fp);
             }
-
-            fip_print(ID, FIP_TRACE,
-                "Successfully processed enum with %d constants", value_count);
-            goto ok;
         }
-        case CXType_ConstantArray: {
-            CXType element_type = clang_getArrayElementType(canonical);
-            size_t array_size = clang_getArraySize(canonical);
-            fip_type->type = FIP_TYPE_ARRAY;
-            fip_type->u.array.size = array_size;
-            fip_type->u.array.base_type = malloc(sizeof(fip_type_t));
-            if (!clang_type_to_fip_type(                       //
-                    element_type, fip_type->u.array.base_type) //
-            ) {
-                goto fail;
+        if (ends_token) {
+            if (in_prerequisites && len > 0) {
+                token[len] = '\0';
+                record_dependency(token);
             }
-            goto ok;
+            len = 0;
+            if (c == '\n') {
+                // Every line is a rule of its own
+                in_prerequisites = false;
+            }
+            continue;
         }
-        case CXType_IncompleteArray: {
-            CXType element_type = clang_getArrayElementType(canonical);
-            fip_type->type = FIP_TYPE_PTR;
-            fip_type->u.ptr.base_type = malloc(sizeof(fip_type_t));
-            if (!clang_type_to_fip_type(                     //
-                    element_type, fip_type->u.ptr.base_type) //
+        if (c == ':' && !in_prerequisites) {
+            // The colon of a drive letter is followed by a path, the colon
+            // which ends the targets is not
+            const int next = fgetc(fp);
+            ungetc(next, fp);
+            if (next == EOF || next == ' ' || next == '\t' || next == '\n' //
+                || next == '\r'                                          //
             ) {
-                fip_print(ID, FIP_WARN, "Unsupported array element type");
-                free(fip_type->u.ptr.base_type);
-                goto fail;
+                in_prerequisites = true;
+                len = 0;
+                continue;
             }
-            goto ok;
         }
-        case CXType_Complex: {
-            // TODO: Handle complex types if needed
-            fip_print(ID, FIP_ERROR, "Complex types not yet supported");
-            goto fail;
+        if (len < sizeof(token) - 1) {
+            token[len++] = (char)c;
         }
-        default:
-            goto fail;
     }
+    if (in_prerequisites && len > 0) {
+        token[len] = '\0';
+        record_dependency(token);
+    }
+    fclose(fp);
+}
 
-ok:
-    stack_pop(&stack);
-    return true;
-fail:
-    stack_pop(&stack);
+/// @function `write_dependencies`
+/// @brief Hands all dependencies recorded so far to the master
+void write_dependencies(void) {
+    if (!ensure_cache_dir()) {
+        return;
+    }
+    fip_slave_write_deps(ID, MODULE_NAME, DEPENDENCIES.len, DEPENDENCIES.items);
+}
+
+/*
+ * ==============================================
+ * FAILURE CACHE Functions
+ * ==============================================
+ * A broken source or header stays broken until
+ * one of its inputs is edited, so running the
+ * failing compiler or parse again on every build
+ * only delays the error the user already knows
+ * about. Failures are cached just like results:
+ * a failed compilation writes the key of its
+ * inputs, including the headers listed in its
+ * depfile, its exit code and the output of the
+ * compiler to `.fip/cache/<hash>.fail`, and as
+ * long as the key matches the failure is
+ * reported again right away. Headers which can
+ * not be parsed, or which fail to parse with
+ * Clang modules, are recorded together with
+ * every file they include in
+ * `.fip/cache/<hash>.parse`, the next parse
+ * skips the header or the modules attempt until
+ * one of these files changed.
+ * ==============================================
+ */
+
+#define PARSE_FAILURE_MAGIC "fip-parse-failure 1"
+
+typedef enum parse_failure_e : uint8_t {
+    PARSE_FAILURE_NONE = 0,
+    // The header could only be parsed without Clang modules
+    PARSE_FAILURE_MODULES,
+    // The header could not be parsed at all, it provides no symbols
+    PARSE_FAILURE_HEADER,
+} parse_failure_e;
+
+uint64_t hash_inputs(const path_list_t *inputs);
+
+/// @function `read_rest`
+/// @brief Reads the rest of the given stream into a string, which has to be
+/// freed by the caller
+char *read_rest(FILE *fp) {
+    const long start = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    const long end = ftell(fp);
+    fseek(fp, start, SEEK_SET);
+    const size_t size = end > start ? (size_t)(end - start) : 0;
+    char *text = (char *)malloc(size + 1);
+    const size_t read = fread(text, 1, size, fp);
+    text[read] = '\0';
+    return text;
+}
+
+/// @function `open_failure`
+/// @brief Opens the failure file at the given path if it was written for the
+/// inputs of the given key
+///
+/// @param `fail_path` The path of the failure file
+/// @param `key_str` The key of the current inputs
+/// @return `FILE *` The failure file positioned after its key, NULL if there
+/// is no failure of these inputs
+FILE *open_failure(const char *fail_path, const char key_str[17]) {
+    FILE *fp = fopen(fail_path, "r");
+    if (fp == NULL) {
+        return NULL;
+    }
+    char line[32];
+    if (!fgets(line, sizeof(line), fp) || strncmp(line, key_str, 16) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+/// @function `is_lasting_failure`
+/// @brief Checks whether a compiler which exited with the given exit code
+/// failed because of its inputs. A compiler killed by a signal, for example
+/// when running out of memory, or a command which could not be found or run
+/// (126 and 127) may succeed next time with the very same inputs, so these
+/// failures are not cached. Shells report a signal as an exit code above 128
+///
+/// @param `exit_code` The exit code of the compiler, -1 if it was killed
+/// @return `bool` Whether the failure lasts until the inputs change
+bool is_lasting_failure(const int exit_code) {
+    return exit_code > 0 && exit_code < 126;
+}
+
+/// @function `parse_failure_path`
+/// @brief Writes the path of the parse failure file of the given header to
+/// `path`
+void parse_failure_path(char path[32], const char *c_file) {
+    char hash_input[1024];
+    snprintf(hash_input, sizeof(hash_input), ".fip/cache/__parse__/%s",
+        c_file);
+    char hash[FIP_PATH_SIZE + 1] = {0};
+    fip_create_hash(hash, hash_input);
+    snprintf(path, 32, ".fip/cache/%s.parse", hash);
+}
+
+/// @function `format_errors`
+/// @brief Formats all error diagnostics of the given translation unit, one per
+/// line. The returned string has to be freed by the caller
+char *format_errors(CXTranslationUnit unit) {
+    size_t len = 0;
+    char *text = (char *)malloc(1);
+    text[0] = '\0';
+    const unsigned diagnostic_count = clang_getNumDiagnostics(unit);
+    for (unsigned i = 0; i < diagnostic_count; i++) {
+        CXDiagnostic diagnostic = clang_getDiagnostic(unit, i);
+        if (clang_getDiagnosticSeverity(diagnostic) >= CXDiagnostic_Error) {
+            CXString line = clang_formatDiagnostic(                 //
+                diagnostic, clang_defaultDiagnosticDisplayOptions() //
+            );
+            const char *line_cstr = clang_getCString(line);
+            const size_t line_len = strlen(line_cstr);
+            text = (char *)realloc(text, len + line_len + 2);
+            memcpy(text + len, line_cstr, line_len);
+            len += line_len;
+            text[len++] = '\n';
+            text[len] = '\0';
+            clang_disposeString(line);
+        }
+        clang_disposeDiagnostic(diagnostic);
+    }
+    return text;
+}
+
+/// @function `parse_failure_save`
+/// @brief Records that the given header failed to parse. All dependencies
+/// recorded since `first_dependency` are the inputs of the failure
+///
+/// @param `c_file` The header which failed to parse
+/// @param `failure` How the parse failed
+/// @param `first_dependency` The length of the dependencies before the parse
+/// @param `diagnostics` The errors of the parse, one per line
+void parse_failure_save(             //
+    const char *c_file,              //
+    const parse_failure_e failure,   //
+    const uint32_t first_dependency, //
+    const char *diagnostics          //
+) {
+    if (!ensure_cache_dir()) {
+        return;
+    }
+    char path[32];
+    parse_failure_path(path, c_file);
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        fip_print(ID, FIP_WARN, "Could not write %s", path);
+        return;
+    }
+    const path_list_t inputs = {
+        .items = DEPENDENCIES.items + first_dependency,
+        .len = DEPENDENCIES.len - first_dependency,
+    };
+    fprintf(fp, "%s\n%c\t%016llx\n", PARSE_FAILURE_MAGIC,
+        failure == PARSE_FAILURE_HEADER ? 'H' : 'M',
+        (unsigned long long)hash_inputs(&inputs));
+    for (uint32_t i = 0; i < inputs.len; i++) {
+        fprintf(fp, "I\t%s\n", inputs.items[i]);
+    }
+    fputs(diagnostics, fp);
+    fclose(fp);
+}
+
+/// @function `parse_failure_load`
+/// @brief Loads the recorded parse failure of the given header. A failure is
+/// only returned while none of its inputs changed. The inputs of a header which
+/// is skipped are added to the dependencies, as it is not parsed to find them
+///
+/// @param `c_file` The header to load the failure of
+/// @param `diagnostics` Where to store the errors of the failed parse, which
+/// have to be freed by the caller
+/// @return `parse_failure_e` The recorded failure, `PARSE_FAILURE_NONE` if
+/// there is no valid one
+parse_failure_e parse_failure_load(const char *c_file, char **diagnostics) {
+    *diagnostics = NULL;
+    char path[32];
+    parse_failure_path(path, c_file);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return PARSE_FAILURE_NONE;
+    }
+    char line[1024];
+    char kind = '\0';
+    unsigned long long key = 0;
+    const size_t magic_len = strlen(PARSE_FAILURE_MAGIC);
+    if (!fgets(line, sizeof(line), fp)                        //
+        || strncmp(line, PARSE_FAILURE_MAGIC, magic_len) != 0 //
+        || fscanf(fp, "%c\t%llx\n", &kind, &key) != 2         //
+    ) {
+        fclose(fp);
+        return PARSE_FAILURE_NONE;
+    }
+    path_list_t inputs = {0};
+    long diagnostics_start = ftell(fp);
+    while (fgets(line, sizeof(line), fp) && strncmp(line, "I\t", 2) == 0) {
+        line[strcspn(line, "\n")] = '\0';
+        path_list_push(&inputs, clone_string(line + 2));
+        diagnostics_start = ftell(fp);
+    }
+    const bool is_valid = inputs.len > 0 && hash_inputs(&inputs) == key;
+    if (is_valid && kind == 'H') {
+        for (uint32_t i = 0; i < inputs.len; i++) {
+            record_dependency(inputs.items[i]);
+        }
+    }
+    if (is_valid) {
+        fseek(fp, diagnostics_start, SEEK_SET);
+        *diagnostics = read_rest(fp);
+    }
+    path_list_free(&inputs);
+    fclose(fp);
+    if (!is_valid) {
+        return PARSE_FAILURE_NONE;
+    }
+    return kind == 'H' ? PARSE_FAILURE_HEADER : PARSE_FAILURE_MODULES;
+}
+
+/// @function `has_errors`
+/// @brief Checks whether parsing the given translation unit produced errors
+bool has_errors(CXTranslationUnit unit) {
+    const unsigned diagnostic_count = clang_getNumDiagnostics(unit);
+    for (unsigned i = 0; i < diagnostic_count; i++) {
+        CXDiagnostic diagnostic = clang_getDiagnostic(unit, i);
+        const enum CXDiagnosticSeverity severity = //
+            clang_getDiagnosticSeverity(diagnostic);
+        clang_disposeDiagnostic(diagnostic);
+        if (severity >= CXDiagnostic_Error) {
+            return true;
+        }
+    }
     return false;
 }
 
-bool extract_function_signature(CXCursor cursor, fip_sig_fn_t *fn_sig) {
-    // Get function name
-    CXString name = clang_getCursorSpelling(cursor);
-    const char *name_cstr = clang_getCString(name);
-    strncpy(fn_sig->name, name_cstr, sizeof(fn_sig->name) - 1);
-    clang_disposeString(name);
+/// @function `has_missing_include`
+/// @brief Checks whether parsing the given translation unit stopped at an
+/// include which could not be found. The missing file is none of the recorded
+/// dependencies, so a failure caused by it would stay cached even once the
+/// file exists, for example when it is generated or installed later
+bool has_missing_include(CXTranslationUnit unit) {
+    const unsigned diagnostic_count = clang_getNumDiagnostics(unit);
+    for (unsigned i = 0; i < diagnostic_count; i++) {
+        CXDiagnostic diagnostic = clang_getDiagnostic(unit, i);
+        bool is_missing = false;
+        if (clang_getDiagnosticSeverity(diagnostic) == CXDiagnostic_Fatal) {
+            CXString spelling = clang_getDiagnosticSpelling(diagnostic);
+            const char *spelling_cstr = clang_getCString(spelling);
+            is_missing = strstr(spelling_cstr, "file not found") != NULL;
+            clang_disposeString(spelling);
+        }
+        clang_disposeDiagnostic(diagnostic);
+        if (is_missing) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    CXType function_type = clang_getCursorType(cursor);
+/// @function `parse_c_file`
+/// @brief Parses the given header and adds all its symbols to the current
+/// collection. With Clang modules enabled, modular headers are loaded from the
+/// module cache. Headers which fail to build as a module, for example because
+/// of a broken module map, fall back to being parsed without modules. Recorded
+/// failures of the header are not run into again while its inputs are the same
+///
+/// @param `c_file` The header to parse
+/// @param `use_modules` Whether to parse the header with Clang modules
+/// @return `bool` Whether all files the header includes were found, the found
+/// symbols only depend on the recorded dependencies then
+bool parse_c_file(char *c_file, const bool use_modules) {
+    FIP_PROBE1(parse_start, c_file);
+    char *diagnostics = NULL;
+    const parse_failure_e failure = parse_failure_load(c_file, &diagnostics);
+    if (failure == PARSE_FAILURE_HEADER) {
+        fip_print(ID, FIP_WARN, "Skipping %s, it failed to parse before",
+            c_file);
+        if (diagnostics[0] != '\0') {
+            fip_print(ID, FIP_WARN, "%s", diagnostics);
+        }
+        free(diagnostics);
+        FIP_PROBE2(parse_end, c_file, -1);
+        return true;
+    }
+    free(diagnostics);
+    const bool try_modules = use_modules && failure != PARSE_FAILURE_MODULES;
+    const uint32_t first_dependency = DEPENDENCIES.len;
+    const size_t first_symbol = curr_coll->symbol_count;
 
-    // Get return type
-    CXType return_type = clang_getResultType(function_type);
-    if (return_type.kind != CXType_Void) {
-        fn_sig->rets_len = 1;
-        fn_sig->rets = malloc(sizeof(fip_type_t));
-        stack_clear(&stack);
-        if (!clang_type_to_fip_type(return_type, &fn_sig->rets[0])) {
-            fip_print(ID, FIP_WARN, "Unsupported return type for function %s",
-                fn_sig->name);
-            free(fn_sig->rets);
-            stack_clear(&stack);
-            return false;
+    CXIndex index = clang_createIndex(0, 0);
+    FILE *fp = popen("gcc -print-file-name=include", "r");
+    char buf[512];
+    if (fgets(buf, sizeof(buf), fp)) {
+        buf[strcspn(buf, "\n")] = 0; // strip newline
+        // buf now holds the include path, e.g.
+        // "/usr/lib/gcc/x86_64-pc-linux-gnu/15.2.1/include"
+    }
+    pclose(fp);
+    const char *args[] = {
+        "-x",
+        "c",
+        "-std=gnu23",
+        "-I",
+        buf,
+        "-fmodules",
+        "-fimplicit-module-maps",
+        "-fmodules-cache-path=" CLANG_MODULES_CACHE_PATH,
+    };
+    const size_t num_args = try_modules ? 8 : 5;
+    // The inclusion directives are needed to find the headers of the modules
+    const unsigned options = try_modules                //
+        ? CXTranslationUnit_DetailedPreprocessingRecord //
+        : CXTranslationUnit_None;
+    fip_print(ID, FIP_DEBUG, "Clang Parse Arguments:");
+    for (size_t i = 0; i < num_args; i++) {
+        fip_print(ID, FIP_DEBUG, "  %s", args[i]);
+    }
+    CXTranslationUnit unit = clang_parseTranslationUnit( //
+        index, c_file, args, num_args, NULL, 0, options  //
+    );
+    bool modules_failed = false;
+    if (try_modules && (unit == NULL || has_errors(unit))) {
+        fip_print(                                                    //
+            ID, FIP_WARN,                                             //
+            "Parsing %s with Clang modules failed, parsing it again", //
+            c_file                                                    //
+        );
+        if (unit != NULL) {
+            clang_disposeTranslationUnit(unit);
         }
-        stack_clear(&stack);
-    } else {
-        fn_sig->rets_len = 0;
-        fn_sig->rets = NULL;
+        unit = clang_parseTranslationUnit(                          //
+            index, c_file, args, 5, NULL, 0, CXTranslationUnit_None //
+        );
+        modules_failed = true;
     }
 
-    // Get parameter count and types
-    int num_args = clang_getNumArgTypes(function_type);
-    if (num_args < 0) {
-        fip_print(                                                        //
-            ID, FIP_WARN, "Could not get argument count for function %s", //
-            fn_sig->name                                                  //
+    if (unit == NULL) {
+        fip_print(ID, FIP_WARN, "Unable to parse file %s", c_file);
+        record_dependency(c_file);
+        parse_failure_save(c_file, PARSE_FAILURE_HEADER, first_dependency, "");
+        clang_disposeIndex(index);
+        FIP_PROBE2(parse_end, c_file, -1);
+        return true;
+    }
+
+    fip_print(                                                             //
+        ID, FIP_INFO,                                                      //
+        "Scanning %s for extern functions with implementations...", c_file //
+    );
+
+    CXCursor cursor = clang_getTranslationUnitCursor(unit);
+    clang_visitChildren(cursor, visit_ast_node, (CXClientData)c_file);
+    clang_getInclusions(unit, record_inclusion, NULL);
+    if (use_modules) {
+        clang_visitChildren(cursor, record_module_headers, unit);
+    }
+
+    // A header providing nothing but errors is skipped until it changes. A
+    // missing include is looked for again on every parse instead
+    const bool is_complete = !has_missing_include(unit);
+    if (!is_complete) {
+        fip_print(ID, FIP_WARN, "%s includes a file which does not exist",
+            c_file);
+    } else if (curr_coll->symbol_count == first_symbol && has_errors(unit)) {
+        char *errors = format_errors(unit);
+        parse_failure_save(                                        //
+            c_file, PARSE_FAILURE_HEADER, first_dependency, errors //
         );
-        free(fn_sig->rets);
-        return false;
+        free(errors);
+    } else if (modules_failed) {
+        parse_failure_save(c_file, PARSE_FAILURE_MODULES, first_dependency, "");
+    } else if (failure == PARSE_FAILURE_NONE) {
+        char path[32];
+        parse_failure_path(path, c_file);
+        remove(path);
     }
 
-    fn_sig->args_len = num_args;
-    if (num_args > 0) {
-        fn_sig->args = malloc(sizeof(fip_sig_fn_arg_t) * num_args);
-        for (int i = 0; i < num_args; i++) {
-            CXType arg_type = clang_getArgType(function_type, i);
-            stack_clear(&stack);
-            CXCursor arg_cursor = clang_Cursor_getArgument(cursor, i);
-            CXString arg_name_str = clang_getCursorSpelling(arg_cursor);
-            const char *arg_name = clang_getCString(arg_name_str);
-            strncpy(                             //
-                fn_sig->args[i].name,            //
-                arg_name,                        //
-                sizeof(fn_sig->args[i].name) - 1 //
-            );
-            clang_disposeString(arg_name_str);
-            if (!clang_type_to_fip_type(arg_type, &fn_sig->args[i].type)) {
-                fip_print(                                          //
-                    ID, FIP_WARN,                                   //
-                    "Unsupported argument type %d for function %s", //
-                    i, fn_sig->name                                 //
-                );
-                free(fn_sig->args);
-                free(fn_sig->rets);
-                return false;
-            }
-        }
-        stack_clear(&stack);
-    } else {
-        fn_sig->args = NULL;
+    clang_disposeTranslationUnit(unit);
+    clang_disposeIndex(index);
+    FIP_PROBE2(parse_end, c_file, curr_coll->symbol_count - first_symbol);
+
+    fip_print(                                  //
+        ID, FIP_INFO, "Found %d symbols in %s", //
+        curr_coll->symbol_count, c_file         //
+    );
+    return is_complete;
+}
+
+/*
+ * ==============================================
+ * JOB CONTROL Functions
+ * ==============================================
+ * The sources of a tag are compiled by compiler
+ * processes running in parallel. A fixed number
+ * of them either leaves cores idle or, when a
+ * single translation unit needs gigabytes, runs
+ * the machine out of memory. The job controller
+ * therefore decides before every start whether
+ * one more job fits: a core has to be free of
+ * our own jobs and of the load of everything
+ * else, and the available memory has to hold
+ * the peak memory of one more job while leaving
+ * room for the running jobs to still grow. The
+ * peak memory of a job is learned from the
+ * `rusage` of every finished compiler and kept
+ * in `.fip/cache/jobs.cache`, so even the first
+ * jobs of a session are sized by the history of
+ * the last one. A single job may always run, so
+ * the work makes progress under any pressure.
+ * The threads parsing the headers of a tag take
+ * their slots from the job controller as well.
+ * ==============================================
+ */
+
+#define JOBS_CACHE_PATH ".fip/cache/jobs.cache"
+#define JOBS_CACHE_MAGIC "fip-jobs 1"
+// The peak memory assumed for a job as long as none has finished yet
+#define JOB_DEFAULT_RSS_KB (256ULL * 1024)
+// The memory which is always left to the rest of the system
+#define JOB_MEMORY_RESERVE_KB (512ULL * 1024)
+
+typedef struct {
+    /// @var `cores`
+    /// @brief The number of online cores
+    uint32_t cores;
+    /// @var `running`
+    /// @brief The number of jobs currently running
+    uint32_t running;
+    /// @var `job_rss_kb`
+    /// @brief The estimated peak memory of a job in KiB. It follows the peak
+    /// memory of finished jobs, rising right away and falling slowly
+    uint64_t job_rss_kb;
+} job_controller_t;
+
+job_controller_t JOBS;
+
+/// @function `available_memory_kb`
+/// @brief Returns the memory in KiB which is available for new processes
+/// without swapping, `UINT64_MAX` if it is unknown
+uint64_t available_memory_kb(void) {
+#ifdef __WIN32__
+    MEMORYSTATUSEX status = {.dwLength = sizeof(MEMORYSTATUSEX)};
+    if (!GlobalMemoryStatusEx(&status)) {
+        return UINT64_MAX;
+    }
+    return (uint64_t)(status.ullAvailPhys / 1024);
+#else
+    FILE *fp = fopen("/proc/meminfo", "r");
+    if (fp == NULL) {
+        return UINT64_MAX;
+    }
+    char line[256];
+    unsigned long long available = 0;
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), fp)) {
+        found = sscanf(line, "MemAvailable: %llu kB", &available) == 1;
+    }
+    fclose(fp);
+    return found ? (uint64_t)available : UINT64_MAX;
+#endif
+}
+
+/// @function `system_load`
+/// @brief Returns the number of runnable processes averaged over the last
+/// minute, 0 if it is unknown
+double system_load(void) {
+#ifdef __WIN32__
+    return 0.0;
+#else
+    double load[1];
+    if (getloadavg(load, 1) != 1) {
+        return 0.0;
+    }
+    return load[0];
+#endif
+}
+
+/// @function `job_controller_init`
+/// @brief Detects the cores of the machine and loads the job memory estimate
+/// of the last session
+void job_controller_init(void) {
+#ifdef __WIN32__
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const long cores = (long)info.dwNumberOfProcessors;
+#else
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    JOBS.cores = cores > 0 ? (uint32_t)cores : 1;
+    JOBS.running = 0;
+    JOBS.job_rss_kb = JOB_DEFAULT_RSS_KB;
+    FILE *fp = fopen(JOBS_CACHE_PATH, "r");
+    if (fp == NULL) {
+        return;
     }
+    char line[64];
+    unsigned long long rss_kb = 0;
+    if (fgets(line, sizeof(line), fp)                                     //
+        && strncmp(line, JOBS_CACHE_MAGIC, strlen(JOBS_CACHE_MAGIC)) == 0 //
+        && fscanf(fp, "%llu", &rss_kb) == 1 && rss_kb > 0                 //
+    ) {
+        JOBS.job_rss_kb = (uint64_t)rss_kb;
+    }
+    fclose(fp);
+}
 
-    return true;
+/// @function `job_controller_save`
+/// @brief Persists the job memory estimate for the next session
+void job_controller_save(void) {
+    if (!ensure_cache_dir()) {
+        return;
+    }
+    FILE *fp = fopen(JOBS_CACHE_PATH, "w");
+    if (fp == NULL) {
+        fip_print(ID, FIP_WARN, "Could not write %s", JOBS_CACHE_PATH);
+        return;
+    }
+    fprintf(fp, "%s\n%llu\n", JOBS_CACHE_MAGIC,
+        (unsigned long long)JOBS.job_rss_kb);
+    fclose(fp);
 }
 
-bool extract_struct_signature(CXCursor cursor, fip_sig_data_t *data_sig) {
-    CXString cname = clang_getCursorSpelling(cursor);
-    const char *name_cstr = clang_getCString(cname);
-    if (strlen(name_cstr) == 0) {
-        clang_disposeString(cname);
+/// @function `job_controller_can_start`
+/// @brief Checks whether the resources of the machine allow starting one more
+/// job right now
+///
+/// @return `bool` Whether the job may be started
+bool job_controller_can_start(void) {
+    if (JOBS.running == 0) {
+        return true;
+    }
+    // The load average lags behind, so our own jobs are counted by themselves
+    // and only the load exceeding them is attributed to other processes
+    const double load = system_load();
+    const double foreign_load = load > JOBS.running ? load - JOBS.running : 0.0;
+    if ((double)(JOBS.running + 1) + foreign_load > (double)JOBS.cores) {
         return false;
     }
-    strncpy(data_sig->name, name_cstr, sizeof(data_sig->name) - 1);
-    clang_disposeString(cname);
-
-    // Count fields first
-    int field_count = 0;
-    clang_visitChildren(cursor, count_struct_fields_visitor, &field_count);
-    if (field_count <= 0 || field_count > 255) {
-        fip_print(ID, FIP_WARN, "Invalid struct field count: %d", field_count);
+    // Running jobs could still be far from their peak, so half of a job's
+    // memory is kept free for every one of them
+    const uint64_t available = available_memory_kb();
+    const uint64_t needed = JOBS.job_rss_kb + JOB_MEMORY_RESERVE_KB
+        + JOBS.running * (JOBS.job_rss_kb / 2);
+    if (available < needed) {
+        fip_print(ID, FIP_DEBUG,
+            "Holding back a job, %llu KiB available but %llu KiB needed",
+            (unsigned long long)available, (unsigned long long)needed);
         return false;
     }
-    data_sig->value_count = (uint8_t)field_count;
-
-    if (field_count > 0) {
-        data_sig->value_names = (char **)malloc(sizeof(char *) * field_count);
-        data_sig->value_types =
-            (fip_type_t *)malloc(sizeof(fip_type_t) * field_count);
-
-        // Extract field types
-        field_visitor_data type_visitor_data = {
-            .fields = data_sig->value_types,
-            .current_index = 0,
-            .module_id = ID,
-        };
-        clang_visitChildren(cursor, struct_field_visitor, &type_visitor_data);
+    return true;
+}
 
-        // Extract field names
-        field_name_visitor_data name_visitor_data = {
-            .field_names = data_sig->value_names,
-            .current_index = 0,
-            .module_id = ID,
-        };
-        clang_visitChildren(cursor, struct_field_name_visitor,
-            &name_visitor_data);
-
-        // Verify we processed all fields
-        if (type_visitor_data.current_index != field_count ||
-            name_visitor_data.current_index != field_count) {
-            fip_print(ID, FIP_WARN,
-                "Processed %d types and %d names but expected %d",
-                type_visitor_data.current_index,
-                name_visitor_data.current_index, field_count);
-
-            // Clean up allocated memory
-            for (int i = 0; i < name_visitor_data.current_index; i++) {
-                free(data_sig->value_names[i]);
-            }
-            free(data_sig->value_names);
-            free(data_sig->value_types);
-            return false;
-        }
+/// @function `job_controller_record`
+/// @brief Records the peak memory of a finished job
+///
+/// @param `peak_rss_kb` The peak resident memory of the job in KiB
+void job_controller_record(const uint64_t peak_rss_kb) {
+    // A job larger than the estimate raises it right away, smaller jobs only
+    // lower it slowly so a single small job does not invite an OOM kill
+    if (peak_rss_kb >= JOBS.job_rss_kb) {
+        JOBS.job_rss_kb = peak_rss_kb;
     } else {
-        data_sig->value_names = NULL;
-        data_sig->value_types = NULL;
+        JOBS.job_rss_kb = (JOBS.job_rss_kb * 7 + peak_rss_kb) / 8;
     }
-
-    return true;
 }
 
-bool extract_enum_signature(CXCursor cursor, fip_sig_enum_t *enum_sig) {
-    CXString cname = clang_getCursorSpelling(cursor);
-    const char *name_cstr = clang_getCString(cname);
-    if (strlen(name_cstr) == 0) {
-        clang_disposeString(cname);
-        return false;
-    }
-    strncpy(enum_sig->name, name_cstr, sizeof(enum_sig->name) - 1);
-    clang_disposeString(cname);
+/*
+ * ==============================================
+ * CONCURRENT PARSE Functions
+ * ==============================================
+ * The headers of a tag are independent of each
+ * other, so they are parsed on several threads
+ * at once. Every thread collects the symbols and
+ * dependencies of a header on its own, and once
+ * all headers are parsed they are merged in the
+ * order of the headers in the config. Within a
+ * header the symbols keep the order in which
+ * they appear in it. This way a tag has the same
+ * symbols in the same order as if its headers
+ * were parsed one after another, no matter
+ * which thread finished first, so the persisted
+ * symbol data and everything derived from it
+ * stays byte-identical across runs.
+ * ==============================================
+ */
 
-    CXType integer_type = clang_getEnumDeclIntegerType(cursor);
-    CXType canon = clang_getCanonicalType(integer_type);
-    fip_type_prim_e prim;
-    switch (canon.kind) {
-        case CXType_Char_U:
-        case CXType_UChar:
-            prim = FIP_U8;
-            break;
-        case CXType_UShort:
-            prim = FIP_U16;
-            break;
-        case CXType_UInt:
-            prim = FIP_U32;
-            break;
-        case CXType_ULong:
-        case CXType_ULongLong:
-            prim = FIP_U64;
-            break;
-        case CXType_Char_S:
-        case CXType_SChar:
-            prim = FIP_I8;
-            break;
-        case CXType_Short:
-            prim = FIP_I16;
-            break;
-        case CXType_Int:
-            prim = FIP_I32;
-            break;
-        case CXType_Long:
-        case CXType_LongLong:
-            prim = FIP_I64;
+#define PARSE_MAX_THREADS 8
+
+typedef struct {
+    char *header;
+    bool use_modules;
+    /// @var `symbols`
+    /// @brief The symbols found in the header, in the order of their position
+    fip_c_symbol_t *symbols;
+    size_t symbol_count;
+    /// @var `dependencies`
+    /// @brief All files the header depended on, in the order they were found
+    path_list_t dependencies;
+    /// @var `is_complete`
+    /// @brief Whether all files the header includes were found
+    bool is_complete;
+} parse_job_t;
+
+typedef struct {
+    parse_job_t *jobs;
+    size_t job_count;
+    atomic_size_t next_job;
+    /// @var `finished_count`
+    /// @brief The number of parsed headers, reported to the master as progress
+    atomic_size_t finished_count;
+    bool sends_progress;
+} parse_pool_t;
+
+/// @function `parse_pool_work`
+/// @brief Parses the headers of the pool until none is left. Only the calling
+/// thread of the pool may send messages to the master, so it is the only one
+/// reporting the progress
+///
+/// @param `pool` The pool to take the headers from
+/// @param `is_caller` Whether this is the thread which started the pool
+void parse_pool_work(parse_pool_t *pool, const bool is_caller) {
+    fip_c_symbol_collection_t *const outer_coll = curr_coll;
+    const path_list_t outer_dependencies = DEPENDENCIES;
+    fip_c_symbol_collection_t *scratch = (fip_c_symbol_collection_t *)malloc( //
+        sizeof(fip_c_symbol_collection_t));
+    curr_coll = scratch;
+    while (true) {
+        const size_t idx = atomic_fetch_add(&pool->next_job, 1);
+        if (idx >= pool->job_count) {
             break;
-        default:
-            fip_print(ID, FIP_WARN, "Unsupported underlying enum type for %s",
-                enum_sig->name);
-            return false;
+        }
+        parse_job_t *job = &pool->jobs[idx];
+        scratch->symbol_count = 0;
+        DEPENDENCIES = (path_list_t){0};
+        clock_t start = clock();
+        job->is_complete = parse_c_file(job->header, job->use_modules);
+        clock_t end = clock();
+        fip_print(ID, FIP_DEBUG, "parsing '%s' took %f s", job->header,
+            ((double)(end - start)) / CLOCKS_PER_SEC);
+        job->dependencies = DEPENDENCIES;
+        job->symbol_count = scratch->symbol_count;
+        job->symbols = (fip_c_symbol_t *)malloc( //
+            sizeof(fip_c_symbol_t) * job->symbol_count);
+        memcpy(job->symbols, scratch->symbols,
+            sizeof(fip_c_symbol_t) * job->symbol_count);
+        const size_t finished = atomic_fetch_add(&pool->finished_count, 1) + 1;
+        if (is_caller && pool->sends_progress) {
+            // The request which touched the tag waits for the parsing to
+            // finish
+            fip_slave_send_progress(ID, (uint32_t)finished,
+                (uint32_t)pool->job_count);
+        }
     }
-    enum_sig->type = prim;
-
-    int value_count = 0;
-    clang_visitChildren(cursor, count_enum_constants_visitor, &value_count);
-    if (value_count <= 0 || value_count > 255) {
-        fip_print(ID, FIP_WARN, "Invalid enum constant count: %d", value_count);
-        return false;
+    free(scratch);
+    curr_coll = outer_coll;
+    DEPENDENCIES = outer_dependencies;
+    if (!is_caller) {
+        // The thread-local buffers of the worker threads die with them
+        members_free();
+        stack_clear(&stack);
     }
-    enum_sig->value_count = (uint8_t)value_count;
+}
 
-    if (value_count > 0) {
-        enum_sig->tags = (char **)malloc(sizeof(char *) * value_count);
-        enum_sig->values = (size_t *)malloc(sizeof(size_t) * value_count);
-        enum_sig_visitor_data data = {.tags = enum_sig->tags,
-            .values = enum_sig->values,
-            .current_index = 0,
-            .module_id = ID};
-        clang_visitChildren(cursor, enum_sig_visitor, &data);
-        if (data.current_index != value_count) {
-            for (int i = 0; i < data.current_index; ++i) {
-                free(enum_sig->tags[i]);
-            }
-            free(enum_sig->tags);
-            free(enum_sig->values);
-            return false;
+#ifndef __WIN32__
+void *parse_worker(void *arg) {
+    parse_pool_work((parse_pool_t *)arg, false);
+    return NULL;
+}
+#endif
+
+/// @function `merge_parse_job`
+/// @brief Moves the symbols and dependencies of a parsed header into the
+/// current collection and the dependencies of the calling thread. Records
+/// already defined by an earlier header are dropped, just like they are when
+/// a single thread parses the headers one after another
+///
+/// @param `job` The parsed header to merge
+void merge_parse_job(parse_job_t *job) {
+    for (uint32_t i = 0; i < job->dependencies.len; i++) {
+        path_list_push(&DEPENDENCIES, job->dependencies.items[i]);
+    }
+    free(job->dependencies.items);
+    job->dependencies = (path_list_t){0};
+    size_t dropped_count = 0;
+    for (size_t i = 0; i < job->symbol_count; i++) {
+        fip_c_symbol_t *symbol = &job->symbols[i];
+        if (curr_coll->symbol_count >= MAX_SYMBOLS
+            || (symbol->type != FIP_SYM_FUNCTION
+                && symbol_name_exists(symbol_name(symbol)))) {
+            fip_free_sig(symbol->type, &symbol->sig);
+            dropped_count += curr_coll->symbol_count >= MAX_SYMBOLS;
+            continue;
         }
-    } else {
-        enum_sig->tags = NULL;
-        enum_sig->values = NULL;
+        curr_coll->symbols[curr_coll->symbol_count++] = *symbol;
     }
-
-    return true;
+    if (dropped_count > 0) {
+        fip_print(ID, FIP_WARN, "Maximum symbols reached, skipping %lu "
+            "symbols of %s", dropped_count, job->header);
+    }
+    free(job->symbols);
+    job->symbols = NULL;
 }
 
-enum CXChildVisitResult visit_ast_node( //
-    CXCursor cursor,                    //
-    [[maybe_unused]] CXCursor parent,   //
-    CXClientData client_data            //
+/// @function `parse_headers`
+/// @brief Parses all headers of the given config concurrently and adds their
+/// symbols to the current collection and their dependencies to the ones of
+/// the calling thread, both in the order of the headers
+///
+/// @param `config` The config whose headers to parse
+/// @param `sends_progress` Whether a request waits for the parsing, it is told
+/// about every parsed header then
+/// @return `bool` Whether all files the headers include were found
+bool parse_headers(                    //
+    const fip_module_config_t *config, //
+    const bool sends_progress          //
 ) {
-    const char *file_path = (const char *)client_data;
-
-    // Only process nodes from the file we're parsing (not from #includes)
-    CXSourceLocation location = clang_getCursorLocation(cursor);
-    CXFile file;
-    unsigned line, column, offset;
-    clang_getExpansionLocation(location, &file, &line, &column, &offset);
-
-    if (file) {
-        CXString filename = clang_getFileName(file);
-        const char *filename_cstr = clang_getCString(filename);
-
-        // Skip if this cursor is not from our target file
-        if (strcmp(filename_cstr, file_path) != 0) {
-            clang_disposeString(filename);
-            return CXChildVisit_Continue;
+    const size_t job_count = config->headers_len;
+    if (job_count == 0) {
+        return true;
+    }
+    parse_job_t *jobs = (parse_job_t *)calloc(job_count, sizeof(parse_job_t));
+    for (size_t i = 0; i < job_count; i++) {
+        jobs[i].header = config->headers[i];
+        jobs[i].use_modules = config->clang_modules;
+    }
+    parse_pool_t pool = {
+        .jobs = jobs,
+        .job_count = job_count,
+        .sends_progress = sends_progress,
+    };
+    atomic_init(&pool.next_job, 0);
+    atomic_init(&pool.finished_count, 0);
+#ifdef __WIN32__
+    parse_pool_work(&pool, true);
+#else
+    size_t thread_count = job_count;
+    if (thread_count > PARSE_MAX_THREADS) {
+        thread_count = PARSE_MAX_THREADS;
+    }
+    pthread_t threads[PARSE_MAX_THREADS];
+    size_t started = 0;
+    // Every thread holds a slot of the job controller, so the parsing shares
+    // the cores and the memory with the load of the machine like compilers
+    // do. The calling thread takes part in the parsing, so one thread less is
+    // spawned
+    JOBS.running++;
+    while (started + 1 < thread_count && job_controller_can_start()) {
+        if (pthread_create(&threads[started], NULL, parse_worker, &pool) != 0) {
+            break;
         }
-        clang_disposeString(filename);
+        started++;
+        JOBS.running++;
+    }
+    fip_print(ID, FIP_DEBUG, "Parsing the headers of tag '%s' on %lu threads",
+        config->tag, started + 1);
+    parse_pool_work(&pool, true);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
     }
+    JOBS.running -= (uint32_t)(started + 1);
+#endif
+    bool is_complete = true;
+    for (size_t i = 0; i < job_count; i++) {
+        is_complete = is_complete && jobs[i].is_complete;
+        merge_parse_job(&jobs[i]);
+    }
+    free(jobs);
+    fip_print(ID, FIP_INFO, "Found %lu symbols in the headers of tag '%s'",
+        curr_coll->symbol_count, config->tag);
+    return is_complete;
+}
 
-    enum CXCursorKind kind = clang_getCursorKind(cursor);
-    switch (kind) {
-        default:
-            return CXChildVisit_Recurse;
-        case CXCursor_FunctionDecl: {
-            // Get function name first to check if it's main
-            CXString name = clang_getCursorSpelling(cursor);
-            const char *name_cstr = clang_getCString(name);
-            fip_print(ID, FIP_TRACE, "Visit AST Node FunctionDecl: %s",
-                name_cstr);
-            // Skip main function
-            if (strcmp(name_cstr, "main") == 0) {
-                clang_disposeString(name);
-                return CXChildVisit_Continue;
-            }
-            clang_disposeString(name);
+/*
+ * ==============================================
+ * SYMBOL DATA Functions
+ * ==============================================
+ * Parsing the headers of a tag is by far the
+ * most expensive part of the module, while a
+ * build typically only touches one or two of the
+ * configured tags. No tag is parsed at startup,
+ * the symbols of a tag are loaded once a request
+ * first touches it. After every parse they are
+ * persisted to `.fip/cache/<tag>.sym` together
+ * with all files they were parsed from. The file
+ * starts with a small directory header locating
+ * its sections: the inputs, the names of all
+ * symbols sorted for a binary search and the
+ * encoded symbols. As long as none of the inputs
+ * changed the file is mapped instead of parsing
+ * the headers again. Every offset and record of
+ * a mapped file is checked against its size, a
+ * damaged file is dropped and the headers are
+ * parsed again. Symbol requests only look
+ * up the requested name in the directory of a
+ * mapped tag, its symbols are only decoded when
+ * the name is there.
+ * ==============================================
+ */
 
-            // Check if function has external linkage
-            enum CXLinkageKind linkage = clang_getCursorLinkage(cursor);
-            if (linkage != CXLinkage_External) {
-                fip_print(ID, FIP_TRACE, "Has no external linkage");
-                return CXChildVisit_Continue;
-            }
+#define SYMBOL_DATA_MAGIC "fip-sym4"
 
-            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
-                fip_print(                                                  //
-                    ID, FIP_WARN,                                           //
-                    "Maximum symbols reached, skipping remaining functions" //
-                );
-                return CXChildVisit_Break;
-            }
+typedef struct {
+    char magic[8];
+    /// @var `config_key`
+    /// @brief The hash of the configuration the headers were parsed with, see
+    /// `symbol_data_config_key`
+    uint64_t config_key;
+    /// @var `input_key`
+    /// @brief The hash of the sizes and mtimes of all inputs at the parse
+    uint64_t input_key;
+    uint32_t input_count;
+    uint32_t symbol_count;
+    /// @var `inputs_offset`
+    /// @brief The offset of the inputs, each terminated by a null byte. The
+    /// names of the symbols follow them
+    uint32_t inputs_offset;
+    /// @var `names_offset`
+    /// @brief The offset of the table of the offsets of all symbol names,
+    /// sorted by the names
+    uint32_t names_offset;
+    /// @var `symbols_offset`
+    /// @brief The offset of the symbols, each encoded as its type, line,
+    /// fingerprint, source file and signature
+    uint32_t symbols_offset;
+    /// @var `size`
+    /// @brief The size of the whole file, the header is written last
+    uint32_t size;
+} symbol_data_header_t;
+
+void watch_collection(const size_t coll_id, const uint32_t first_dependency);
+void drop_duplicate_dependencies(const uint32_t first_dependency);
+
+/// @function `symbol_data_path`
+/// @brief Writes the path of the symbol data file of the given tag to `path`
+void symbol_data_path(char path[256], const char *tag) {
+    snprintf(path, 256, ".fip/cache/%s.sym", tag);
+}
 
-            // Extract function information
-            fip_c_symbol_t symbol = {0};
-            strncpy(                                //
-                symbol.source_file_path, file_path, //
-                sizeof(symbol.source_file_path) - 1 //
-            );
-            symbol.line_number = (int)line;
-            symbol.type = FIP_SYM_FUNCTION;
+/// @function `symbol_data_config_key`
+/// @brief Hashes everything of the configuration of a tag which changes the
+/// symbols found in its headers without changing any of their inputs
+uint64_t symbol_data_config_key(const fip_module_config_t *config) {
+    const uint8_t version[] = {
+        FIP_MAJOR, FIP_MINOR, FIP_PATCH, config->clang_modules //
+    };
+    uint64_t key = hash_bytes(HASH_SEED, version, sizeof(version));
+    for (uint32_t i = 0; i < config->headers_len; i++) {
+        key = hash_string(key, config->headers[i]);
+    }
+    return key;
+}
 
-            if (extract_function_signature(cursor, &symbol.sig.fn)) {
-                curr_coll->symbols[curr_coll->symbol_count] = symbol;
+/// @function `symbol_data_map`
+/// @brief Maps the symbol data file of the given tag into memory
+///
+/// @param `data` Where to store the mapping
+/// @param `tag` The tag whose symbol data to map
+/// @return `bool` Whether the file could be mapped
+bool symbol_data_map(symbol_data_t *data, const char *tag) {
+    char path[256];
+    symbol_data_path(path, tag);
+#ifdef __WIN32__
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    const long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *bytes = size > 0 ? (char *)malloc((size_t)size) : NULL;
+    if (bytes == NULL || fread(bytes, 1, (size_t)size, fp) != (size_t)size) {
+        free(bytes);
+        fclose(fp);
+        return false;
+    }
+    fclose(fp);
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    const off_t size = st.st_size;
+    char *bytes = (char *)mmap( //
+        NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (bytes == MAP_FAILED) {
+        return false;
+    }
+#endif
+    data->bytes = bytes;
+    data->size = (size_t)size;
+    return true;
+}
 
-                fip_print(                                                  //
-                    ID, FIP_INFO, "Found extern function: '%s' at line %d", //
-                    symbol.sig.fn.name, symbol.line_number                  //
-                );
-                fip_print_sig_fn(ID, &symbol.sig.fn);
+/// @function `symbol_data_unmap`
+/// @brief Unmaps the given symbol data if it is mapped
+void symbol_data_unmap(symbol_data_t *data) {
+    if (data->bytes == NULL) {
+        return;
+    }
+#ifdef __WIN32__
+    free(data->bytes);
+#else
+    munmap(data->bytes, data->size);
+#endif
+    data->bytes = NULL;
+    data->size = 0;
+}
 
-                curr_coll->symbol_count++;
-            }
-            break;
+/// @function `symbol_data_inputs`
+/// @brief Reads the inputs listed in the given mapped symbol data
+///
+/// @param `data` The mapped symbol data
+/// @param `header` The header of the symbol data
+/// @param `inputs` The list to add the inputs to
+/// @return `bool` Whether all inputs could be read
+bool symbol_data_inputs(                //
+    const symbol_data_t *data,          //
+    const symbol_data_header_t *header, //
+    path_list_t *inputs                 //
+) {
+    size_t offset = header->inputs_offset;
+    for (uint32_t i = 0; i < header->input_count; i++) {
+        const char *input = data->bytes + offset;
+        const char *end = (const char *)memchr( //
+            input, '\0', header->names_offset - offset);
+        if (end == NULL) {
+            return false;
         }
-        case CXCursor_StructDecl: {
-            if (!clang_isCursorDefinition(cursor)) {
-                return CXChildVisit_Continue;
-            }
+        path_list_push(inputs, clone_string(input));
+        offset += (size_t)(end - input) + 1;
+    }
+    return true;
+}
 
-            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
-                fip_print(                                                //
-                    ID, FIP_WARN,                                         //
-                    "Maximum symbols reached, skipping remaining structs" //
-                );
-                return CXChildVisit_Break;
-            }
+// The longest name which fits into the fixed name buffers of signatures and
+// types, names of values and tags are allocated and can use the full length
+#define SYMBOL_DATA_MAX_NAME_LEN 127
 
-            // Extract struct information
-            fip_c_symbol_t symbol = {0};
-            strncpy(                                //
-                symbol.source_file_path, file_path, //
-                sizeof(symbol.source_file_path) - 1 //
-            );
-            symbol.line_number = (int)line;
-            symbol.type = FIP_SYM_DATA;
+/// @function `symbol_data_skip`
+/// @brief Skips the given number of bytes of the data at `*idx`
+///
+/// @return `bool` Whether the bytes lie within the data
+bool symbol_data_skip(const size_t len, size_t *idx, const size_t count) {
+    if (count > len - *idx) {
+        return false;
+    }
+    *idx += count;
+    return true;
+}
+
+/// @function `symbol_data_skip_name`
+/// @brief Skips a name prefixed by its length of the data at `*idx`
+///
+/// @return `bool` Whether the name lies within the data and is at most
+/// `max_len` characters long
+bool symbol_data_skip_name( //
+    const char *bytes,      //
+    const size_t len,       //
+    size_t *idx,            //
+    const size_t max_len    //
+) {
+    if (*idx >= len) {
+        return false;
+    }
+    const uint8_t name_len = (uint8_t)bytes[(*idx)++];
+    return name_len <= max_len && symbol_data_skip(len, idx, name_len);
+}
+
+/// @function `symbol_data_skip_count`
+/// @brief Reads an element count of the data at `*idx`
+///
+/// @return `bool` Whether the count lies within the data
+bool symbol_data_skip_count( //
+    const char *bytes,       //
+    const size_t len,        //
+    size_t *idx,             //
+    uint8_t *count           //
+) {
+    if (*idx >= len) {
+        return false;
+    }
+    *count = (uint8_t)bytes[(*idx)++];
+    return true;
+}
 
-            if (extract_struct_signature(cursor, &symbol.sig.data) //
-                && !symbol_name_exists(symbol.sig.data.name)       //
-            ) {
-                curr_coll->symbols[curr_coll->symbol_count] = symbol;
-                fip_print(                                         //
-                    ID, FIP_INFO, "Found struct: '%s' at line %d", //
-                    symbol.sig.data.name, symbol.line_number       //
-                );
-                curr_coll->symbol_count++;
+/// @function `symbol_data_skip_type`
+/// @brief Skips an encoded type of the data at `*idx`, the same way
+/// `fip_decode_type` would read it
+///
+/// @return `bool` Whether the type is valid and lies within the data
+bool symbol_data_skip_type(const char *bytes, const size_t len, size_t *idx) {
+    if (len - *idx < 2) {
+        return false;
+    }
+    const uint8_t kind = (uint8_t)bytes[*idx];
+    *idx += 2;
+    uint8_t count = 0;
+    switch (kind) {
+        case FIP_TYPE_PRIMITIVE:
+        case FIP_TYPE_RECURSIVE:
+            return symbol_data_skip(len, idx, 1);
+        case FIP_TYPE_PTR:
+            return symbol_data_skip_type(bytes, len, idx);
+        case FIP_TYPE_STRUCT:
+            if (!symbol_data_skip_name(bytes, len, idx,
+                    SYMBOL_DATA_MAX_NAME_LEN)
+                || !symbol_data_skip_count(bytes, len, idx, &count)) {
+                return false;
             }
-            break;
-        }
-        case CXCursor_EnumDecl: {
-            if (!clang_isCursorDefinition(cursor)) {
-                return CXChildVisit_Continue;
+            for (uint8_t i = 0; i < count; i++) {
+                if (!symbol_data_skip_type(bytes, len, idx)) {
+                    return false;
+                }
             }
+            return true;
+        case FIP_TYPE_ENUM:
+            return symbol_data_skip_name(bytes, len, idx,
+                       SYMBOL_DATA_MAX_NAME_LEN)
+                && symbol_data_skip(len, idx, 2)
+                && symbol_data_skip_count(bytes, len, idx, &count)
+                && symbol_data_skip(len, idx, sizeof(size_t) * count);
+        case FIP_TYPE_ARRAY:
+            return symbol_data_skip(len, idx, sizeof(size_t))
+                && symbol_data_skip_type(bytes, len, idx);
+        case FIP_TYPE_OPAQUE:
+            return symbol_data_skip_name(bytes, len, idx,
+                SYMBOL_DATA_MAX_NAME_LEN);
+    }
+    return false;
+}
 
-            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
-                fip_print(                                              //
-                    ID, FIP_WARN,                                       //
-                    "Maximum symbols reached, skipping remaining enums" //
-                );
-                return CXChildVisit_Break;
+/// @function `symbol_data_skip_sig`
+/// @brief Skips an encoded signature of the data at `*idx`, the same way
+/// `fip_decode_sig` would read it
+///
+/// @return `bool` Whether the signature is valid and lies within the data
+bool symbol_data_skip_sig(           //
+    const char *bytes,               //
+    const size_t len,                //
+    size_t *idx,                     //
+    const fip_msg_symbol_type_e type //
+) {
+    if (!symbol_data_skip_name(bytes, len, idx, SYMBOL_DATA_MAX_NAME_LEN)) {
+        return false;
+    }
+    uint8_t count = 0;
+    switch (type) {
+        case FIP_SYM_UNKNOWN:
+            return false;
+        case FIP_SYM_FUNCTION:
+            if (!symbol_data_skip_count(bytes, len, idx, &count)) {
+                return false;
             }
-
-            // Extract enum information
-            fip_c_symbol_t symbol = {0};
-            strncpy(                                //
-                symbol.source_file_path, file_path, //
-                sizeof(symbol.source_file_path) - 1 //
-            );
-            symbol.line_number = (int)line;
-            symbol.type = FIP_SYM_ENUM;
-
-            if (extract_enum_signature(cursor, &symbol.sig.enum_t) //
-                && !symbol_name_exists(symbol.sig.enum_t.name)     //
-            ) {
-                curr_coll->symbols[curr_coll->symbol_count] = symbol;
-                fip_print(                                       //
-                    ID, FIP_INFO, "Found enum: '%s' at line %d", //
-                    symbol.sig.enum_t.name, symbol.line_number   //
-                );
-                curr_coll->symbol_count++;
+            for (uint8_t i = 0; i < count; i++) {
+                if (!symbol_data_skip_name(bytes, len, idx,
+                        SYMBOL_DATA_MAX_NAME_LEN)
+                    || !symbol_data_skip(len, idx, 1)
+                    || !symbol_data_skip_type(bytes, len, idx)) {
+                    return false;
+                }
             }
-            break;
-        }
-        case CXCursor_TypedefDecl: {
-            if (curr_coll->symbol_count >= MAX_SYMBOLS) {
-                fip_print(                                                 //
-                    ID, FIP_WARN,                                          //
-                    "Maximum symbols reached, skipping remaining typedefs" //
-                );
-                return CXChildVisit_Break;
+            if (!symbol_data_skip_count(bytes, len, idx, &count)) {
+                return false;
             }
-
-            // Check if this typedef is an opaque type (typedef void* NAME)
-            CXType underlying = clang_getTypedefDeclUnderlyingType(cursor);
-            CXType canonical = clang_getCanonicalType(underlying);
-            bool is_opaque = false;
-            if (canonical.kind == CXType_Pointer) {
-                CXType pointee = clang_getPointeeType(canonical);
-                CXType pointee_canonical = clang_getCanonicalType(pointee);
-                if (pointee_canonical.kind == CXType_Void) {
-                    is_opaque = true;
+            for (uint8_t i = 0; i < count; i++) {
+                if (!symbol_data_skip(len, idx, 1)
+                    || !symbol_data_skip_type(bytes, len, idx)) {
+                    return false;
                 }
             }
-
-            if (!is_opaque) {
-                return CXChildVisit_Recurse;
+            return true;
+        case FIP_SYM_DATA:
+            if (!symbol_data_skip_count(bytes, len, idx, &count)) {
+                return false;
             }
-
-            CXString typedef_name = clang_getCursorSpelling(cursor);
-            const char *name_cstr = clang_getCString(typedef_name);
-            if (strlen(name_cstr) == 0) {
-                clang_disposeString(typedef_name);
-                return CXChildVisit_Continue;
+            for (uint8_t i = 0; i < count; i++) {
+                if (!symbol_data_skip_name(bytes, len, idx, UINT8_MAX)) {
+                    return false;
+                }
+            }
+            for (uint8_t i = 0; i < count; i++) {
+                if (!symbol_data_skip_type(bytes, len, idx)) {
+                    return false;
+                }
+            }
+            return true;
+        case FIP_SYM_ENUM:
+            if (!symbol_data_skip(len, idx, 1)
+                || !symbol_data_skip_count(bytes, len, idx, &count)) {
+                return false;
+            }
+            for (uint8_t i = 0; i < count; i++) {
+                if (!symbol_data_skip_name(bytes, len, idx, UINT8_MAX)) {
+                    return false;
+                }
             }
+            return symbol_data_skip(len, idx, sizeof(size_t) * count);
+        case FIP_SYM_OPAQUE:
+            return true;
+    }
+    return false;
+}
 
-            // Extract opaque type information
-            fip_c_symbol_t symbol = {0};
-            strncpy(                                //
-                symbol.source_file_path, file_path, //
-                sizeof(symbol.source_file_path) - 1 //
-            );
-            symbol.line_number = (int)line;
-            symbol.type = FIP_SYM_OPAQUE;
+/// @function `symbol_data_check`
+/// @brief Checks that every offset and length of the given mapped symbol data
+/// lies within the mapping, so it can be read without any further checks. The
+/// names have to be terminated before the name table and every symbol has to
+/// decode within the data, with the last one ending at its end
+///
+/// @param `data` The mapped symbol data
+/// @param `header` The header of the symbol data
+/// @return `bool` Whether the symbol data is intact
+bool symbol_data_check(                //
+    const symbol_data_t *data,         //
+    const symbol_data_header_t *header //
+) {
+    for (uint32_t i = 0; i < header->symbol_count; i++) {
+        uint32_t name_offset;
+        memcpy(&name_offset,
+            data->bytes + header->names_offset + sizeof(uint32_t) * i,
+            sizeof(uint32_t));
+        if (name_offset < header->inputs_offset
+            || name_offset >= header->names_offset
+            || memchr(data->bytes + name_offset, '\0',
+                   header->names_offset - name_offset)
+                == NULL) {
+            return false;
+        }
+    }
+    const char *bytes = data->bytes;
+    const size_t len = header->size;
+    size_t idx = header->symbols_offset;
+    for (uint32_t i = 0; i < header->symbol_count; i++) {
+        // The type, the line number and the fingerprint come first
+        const size_t record = idx;
+        if (!symbol_data_skip(len, &idx,
+                1 + sizeof(int32_t) + sizeof(uint64_t))) {
+            return false;
+        }
+        const fip_msg_symbol_type_e type = //
+            (fip_msg_symbol_type_e)bytes[record];
+        const char *path_end = (const char *)memchr( //
+            bytes + idx, '\0', len - idx);
+        if (path_end == NULL) {
+            return false;
+        }
+        idx = (size_t)(path_end - bytes) + 1;
+        // Every signature was encoded into a message buffer when it was saved
+        size_t sig_end = len;
+        if (sig_end - idx > FIP_MSG_SIZE) {
+            sig_end = idx + FIP_MSG_SIZE;
+        }
+        if (!symbol_data_skip_sig(bytes, sig_end, &idx, type)) {
+            return false;
+        }
+    }
+    return idx == len;
+}
 
-            strncpy(                               //
-                symbol.sig.opaque.name, name_cstr, //
-                sizeof(symbol.sig.opaque.name) - 1 //
-            );
-            symbol.sig.opaque.name[sizeof(symbol.sig.opaque.name) - 1] = '\0';
-            clang_disposeString(typedef_name);
+/// @function `symbol_data_open`
+/// @brief Maps and validates the persisted symbol data of the given collection,
+/// this is only done once per collection. The inputs of valid data are added
+/// to the dependencies right away, the answers to all requests touching the tag
+/// depend on them even if the tag is never loaded
+///
+/// @param `coll_id` The index of the collection in the `symbol_list`
+/// @return `bool` Whether the collection has valid symbol data
+bool symbol_data_open(const size_t coll_id) {
+    fip_c_symbol_collection_t *coll = &symbol_list.collection[coll_id];
+    symbol_data_t *data = &coll->data;
+    if (data->state != SYMBOL_DATA_UNCHECKED) {
+        return data->state == SYMBOL_DATA_VALID;
+    }
+    data->state = SYMBOL_DATA_MISSING;
+    if (!symbol_data_map(data, coll->tag)) {
+        return false;
+    }
+    symbol_data_header_t header = {0};
+    if (data->size >= sizeof(header)) {
+        memcpy(&header, data->bytes, sizeof(header));
+    }
+    const uint64_t config_key = //
+        symbol_data_config_key(&CONFIGS.configs[coll_id]);
+    path_list_t inputs = {0};
+    const bool is_valid =
+        memcmp(header.magic, SYMBOL_DATA_MAGIC, sizeof(header.magic)) == 0 //
+        && header.size == data->size                                       //
+        && header.config_key == config_key                                 //
+        && header.symbol_count <= MAX_SYMBOLS                              //
+        && header.inputs_offset >= sizeof(header)                          //
+        && header.inputs_offset <= header.names_offset                     //
+        && header.names_offset + sizeof(uint32_t) * header.symbol_count    //
+            <= header.symbols_offset                                       //
+        && header.symbols_offset <= header.size                            //
+        && symbol_data_inputs(data, &header, &inputs)                      //
+        && inputs.len > 0 && hash_inputs(&inputs) == header.input_key      //
+        && symbol_data_check(data, &header);
+    if (is_valid) {
+        data->state = SYMBOL_DATA_VALID;
+        const uint32_t first_dependency = DEPENDENCIES.len;
+        for (uint32_t i = 0; i < inputs.len; i++) {
+            record_dependency(inputs.items[i]);
+        }
+        drop_duplicate_dependencies(first_dependency);
+        write_dependencies();
+    } else {
+        fip_print(ID, FIP_DEBUG, "The symbol data of tag '%s' is stale",
+            coll->tag);
+        symbol_data_unmap(data);
+    }
+    path_list_free(&inputs);
+    return is_valid;
+}
 
-            if (!symbol_name_exists(symbol.sig.opaque.name)) {
-                curr_coll->symbols[curr_coll->symbol_count] = symbol;
-                fip_print(                                              //
-                    ID, FIP_INFO, "Found opaque type: '%s' at line %d", //
-                    symbol.sig.opaque.name, symbol.line_number          //
-                );
-                curr_coll->symbol_count++;
-            }
-            break;
+/// @function `symbol_data_has_name`
+/// @brief Looks up the given name in the directory of the given mapped symbol
+/// data without decoding any of its symbols
+///
+/// @param `data` The mapped symbol data
+/// @param `name` The name of the symbol
+/// @return `bool` Whether there is a symbol with the name
+bool symbol_data_has_name(const symbol_data_t *data, const char *name) {
+    symbol_data_header_t header;
+    memcpy(&header, data->bytes, sizeof(header));
+    const char *names = data->bytes + header.names_offset;
+    uint32_t low = 0;
+    uint32_t high = header.symbol_count;
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        uint32_t name_offset;
+        memcpy(&name_offset, names + sizeof(uint32_t) * mid, sizeof(uint32_t));
+        const int cmp = strcmp(data->bytes + name_offset, name);
+        if (cmp == 0) {
+            return true;
+        } else if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
     }
+    return false;
+}
 
-    return CXChildVisit_Recurse;
+/// @function `symbol_data_read`
+/// @brief Decodes all symbols of the given mapped symbol data into the given
+/// collection, records its inputs as dependencies and unmaps it
+///
+/// @param `coll` The collection to read the symbols of
+void symbol_data_read(fip_c_symbol_collection_t *coll) {
+    symbol_data_t *data = &coll->data;
+    symbol_data_header_t header;
+    memcpy(&header, data->bytes, sizeof(header));
+    path_list_t inputs = {0};
+    symbol_data_inputs(data, &header, &inputs);
+    for (uint32_t i = 0; i < inputs.len; i++) {
+        record_dependency(inputs.items[i]);
+    }
+    path_list_free(&inputs);
+
+    const char *cursor = data->bytes + header.symbols_offset;
+    const char *end = data->bytes + header.size;
+    coll->symbol_count = 0;
+    for (uint32_t i = 0; i < header.symbol_count && cursor < end; i++) {
+        fip_c_symbol_t *symbol = &coll->symbols[coll->symbol_count++];
+        *symbol = (fip_c_symbol_t){0};
+        symbol->type = (fip_msg_symbol_type_e)*cursor++;
+        int32_t line_number;
+        memcpy(&line_number, cursor, sizeof(int32_t));
+        cursor += sizeof(int32_t);
+        symbol->line_number = line_number;
+        memcpy(&symbol->fingerprint, cursor, sizeof(uint64_t));
+        cursor += sizeof(uint64_t);
+        strncpy(                                 //
+            symbol->source_file_path, cursor,    //
+            sizeof(symbol->source_file_path) - 1 //
+        );
+        cursor += strlen(cursor) + 1;
+        uint32_t idx = 0;
+        fip_decode_sig(cursor, &idx, symbol->type, &symbol->sig);
+        cursor += idx;
+    }
+    symbol_data_unmap(data);
+    fip_print(ID, FIP_INFO, "Loaded %lu symbols of tag '%s' from %u inputs",
+        coll->symbol_count, coll->tag, header.input_count);
 }
 
-void parse_c_file(char *c_file) {
-    CXIndex index = clang_createIndex(0, 0);
-    FILE *fp = popen("gcc -print-file-name=include", "r");
-    char buf[512];
-    if (fgets(buf, sizeof(buf), fp)) {
-        buf[strcspn(buf, "\n")] = 0; // strip newline
-        // buf now holds the include path, e.g.
-        // "/usr/lib/gcc/x86_64-pc-linux-gnu/15.2.1/include"
+/// @function `symbol_data_save`
+/// @brief Persists all symbols of the given collection, which have just been
+/// parsed. All dependencies recorded since `first_dependency` are the inputs
+/// the symbols were parsed from. The data is written to a file of its own and
+/// then moved over the old one, so other processes which still have the old
+/// data mapped keep reading it unchanged
+///
+/// @param `coll_id` The index of the collection in the `symbol_list`
+/// @param `first_dependency` The length of the dependencies before the parse
+void symbol_data_save(const size_t coll_id, const uint32_t first_dependency) {
+    if (!ensure_cache_dir()) {
+        return;
     }
-    pclose(fp);
-    const char *args[] = {
-        "-x",
-        "c",
-        "-std=gnu23",
-        "-I",
-        buf,
+    const fip_c_symbol_collection_t *coll = &symbol_list.collection[coll_id];
+    char path[256];
+    symbol_data_path(path, coll->tag);
+    char tmp_path[288];
+#ifdef __WIN32__
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, _getpid());
+#else
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int)getpid());
+#endif
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        fip_print(ID, FIP_WARN, "Could not write %s", tmp_path);
+        return;
+    }
+    const path_list_t inputs = {
+        .items = DEPENDENCIES.items + first_dependency,
+        .len = DEPENDENCIES.len - first_dependency,
     };
-    const size_t num_args = 5;
-    fip_print(ID, FIP_DEBUG, "Clang Parse Arguments:");
-    for (size_t i = 0; i < num_args; i++) {
-        fip_print(ID, FIP_DEBUG, "  %s", args[i]);
+    symbol_data_header_t header = {0};
+    // The header is written last, so a partially written file is never valid
+    fwrite(&header, sizeof(header), 1, fp);
+    memcpy(header.magic, SYMBOL_DATA_MAGIC, sizeof(header.magic));
+    header.config_key = symbol_data_config_key(&CONFIGS.configs[coll_id]);
+    header.input_key = hash_inputs(&inputs);
+    header.input_count = inputs.len;
+    header.symbol_count = (uint32_t)coll->symbol_count;
+
+    header.inputs_offset = (uint32_t)ftell(fp);
+    for (uint32_t i = 0; i < inputs.len; i++) {
+        fwrite(inputs.items[i], 1, strlen(inputs.items[i]) + 1, fp);
     }
-    CXTranslationUnit unit = clang_parseTranslationUnit(               //
-        index, c_file, args, num_args, NULL, 0, CXTranslationUnit_None //
-    );
+    uint32_t *order = (uint32_t *)malloc( //
+        sizeof(uint32_t) * (header.symbol_count + 1));
+    sort_symbols_by_name(coll, order);
+    // The names are replaced by their offsets in the sorted table
+    for (uint32_t i = 0; i < header.symbol_count; i++) {
+        const char *name = symbol_name(&coll->symbols[order[i]]);
+        order[i] = (uint32_t)ftell(fp);
+        fwrite(name, 1, strlen(name) + 1, fp);
+    }
+    header.names_offset = (uint32_t)ftell(fp);
+    fwrite(order, sizeof(uint32_t), header.symbol_count, fp);
+    free(order);
+
+    header.symbols_offset = (uint32_t)ftell(fp);
+    char sig_buffer[FIP_MSG_SIZE];
+    for (uint32_t i = 0; i < header.symbol_count; i++) {
+        const fip_c_symbol_t *symbol = &coll->symbols[i];
+        if (fip_size_sig(symbol->type, &symbol->sig) > sizeof(sig_buffer)) {
+            fip_print(ID, FIP_WARN, "Symbol '%s' is too large to be persisted",
+                symbol_name(symbol));
+            fclose(fp);
+            remove(tmp_path);
+            return;
+        }
+        const char type = (char)symbol->type;
+        const int32_t line_number = symbol->line_number;
+        fwrite(&type, 1, 1, fp);
+        fwrite(&line_number, sizeof(int32_t), 1, fp);
+        fwrite(&symbol->fingerprint, sizeof(uint64_t), 1, fp);
+        fwrite(symbol->source_file_path, 1,
+            strlen(symbol->source_file_path) + 1, fp);
+        uint32_t idx = 0;
+        fip_encode_sig(sig_buffer, &idx, symbol->type, &symbol->sig);
+        fwrite(sig_buffer, 1, idx, fp);
+    }
+    header.size = (uint32_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fp);
+    fclose(fp);
+#ifdef __WIN32__
+    const bool is_moved =
+        MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool is_moved = rename(tmp_path, path) == 0;
+#endif
+    if (!is_moved) {
+        fip_print(ID, FIP_WARN, "Could not replace %s", path);
+        remove(tmp_path);
+    }
+}
 
-    if (unit == NULL) {
-        fip_print(ID, FIP_WARN, "Unable to parse file %s", c_file);
+/// @function `collection_load`
+/// @brief Loads the symbols of the given collection unless they are loaded
+/// already. They are read from the persisted symbol data while none of its
+/// inputs changed, otherwise all headers of the tag are parsed and the symbol
+/// data is persisted for the next session
+///
+/// @param `coll_id` The index of the collection in the `symbol_list`
+void collection_load(const size_t coll_id) {
+    fip_c_symbol_collection_t *coll = &symbol_list.collection[coll_id];
+    if (coll->is_loaded) {
         return;
     }
+    const fip_module_config_t *config = &CONFIGS.configs[coll_id];
+    // Opening the data records its inputs once, they are recorded again below
+    // so they are the inputs of the collection
+    const bool has_data = symbol_data_open(coll_id);
+    const uint32_t first_dependency = DEPENDENCIES.len;
+    if (has_data) {
+        symbol_data_read(coll);
+    } else {
+        curr_coll = coll;
+        // Symbols parsed while an include was missing would stay persisted
+        // even once it exists, it is not among their inputs
+        if (parse_headers(config, true)) {
+            symbol_data_save(coll_id, first_dependency);
+        }
+    }
+    abi_cache_apply(coll);
+    symbol_index_build(coll);
+    watch_collection(coll_id, first_dependency);
+    drop_duplicate_dependencies(first_dependency);
+    write_dependencies();
+    coll->is_loaded = true;
+}
+
+/// @function `collection_load_for_name`
+/// @brief Loads the given collection if it could contain a symbol with the
+/// given name. A collection with valid symbol data is only loaded if its
+/// directory contains the name
+///
+/// @param `coll_id` The index of the collection in the `symbol_list`
+/// @param `name` The name of the requested symbol
+/// @return `bool` Whether the collection is loaded
+bool collection_load_for_name(const size_t coll_id, const char *name) {
+    fip_c_symbol_collection_t *coll = &symbol_list.collection[coll_id];
+    if (coll->is_loaded) {
+        return true;
+    }
+    if (symbol_data_open(coll_id) && !symbol_data_has_name(&coll->data, name)) {
+        return false;
+    }
+    collection_load(coll_id);
+    return true;
+}
 
-    fip_print(                                                             //
-        ID, FIP_INFO,                                                      //
-        "Scanning %s for extern functions with implementations...", c_file //
-    );
+/*
+ * ==============================================
+ * USAGE ANALYTICS Functions
+ * ==============================================
+ * Every tag imported or compiled, every symbol
+ * found and every cached object handed to the
+ * master counts as one use of it. The number of
+ * uses and the time of the last use are kept in
+ * `.fip/cache/usage.cache` across sessions. The
+ * master can query them with a usage request,
+ * prefetch the signatures of the most used
+ * symbols right after connecting and remove the
+ * cached objects which were not used for a given
+ * time with a cleanup request. Objects cached
+ * before their first recorded use are unknown to
+ * the table and are never removed.
+ * ==============================================
+ */
 
-    CXCursor cursor = clang_getTranslationUnitCursor(unit);
-    clang_visitChildren(cursor, visit_ast_node, (CXClientData)c_file);
+#define USAGE_CACHE_PATH ".fip/cache/usage.cache"
+#define USAGE_CACHE_MAGIC "fip-usage 1"
 
-    clang_disposeTranslationUnit(unit);
-    clang_disposeIndex(index);
+typedef struct {
+    fip_usage_kind_e kind;
+    char tag[128];
+    /// @var `name`
+    /// @brief The name of the symbol or the hash of the object, empty for tags
+    char name[128];
+    uint32_t count;
+    /// @var `last_used`
+    /// @brief The unix time in seconds of the last use
+    uint64_t last_used;
+} usage_entry_t;
+
+/// @var `USAGE`
+/// @brief All usage entries, sorted by their kind, tag and name
+usage_entry_t *USAGE;
+uint32_t USAGE_LEN;
+uint32_t USAGE_CAP;
+
+/// @var `usage_kind_chars`
+/// @brief The character each usage kind is stored as, indexed by the kind
+const char usage_kind_chars[] = "TSO";
+
+int usage_entry_cmp(const void *a, const void *b) {
+    const usage_entry_t *lhs = (const usage_entry_t *)a;
+    const usage_entry_t *rhs = (const usage_entry_t *)b;
+    if (lhs->kind != rhs->kind) {
+        return lhs->kind < rhs->kind ? -1 : 1;
+    }
+    const int tag_cmp = strcmp(lhs->tag, rhs->tag);
+    if (tag_cmp != 0) {
+        return tag_cmp;
+    }
+    return strcmp(lhs->name, rhs->name);
+}
 
-    fip_print(                                  //
-        ID, FIP_INFO, "Found %d symbols in %s", //
-        curr_coll->symbol_count, c_file         //
-    );
+/// @function `usage_load`
+/// @brief Loads the usage entries from the `.fip/cache/usage.cache` file. A
+/// missing or malformed cache file results in an empty table
+void usage_load(void) {
+    FILE *fp = fopen(USAGE_CACHE_PATH, "r");
+    if (fp == NULL) {
+        return;
+    }
+    char line[512];
+    if (!fgets(line, sizeof(line), fp)                                      //
+        || strncmp(line, USAGE_CACHE_MAGIC, strlen(USAGE_CACHE_MAGIC)) != 0 //
+    ) {
+        fclose(fp);
+        return;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        // Every line has the form `<kind>\t<count>\t<last used>\t<tag>\t<name>`
+        line[strcspn(line, "\n")] = '\0';
+        const char *kind = strchr(usage_kind_chars, line[0]);
+        if (line[0] == '\0' || kind == NULL || line[1] != '\t') {
+            continue;
+        }
+        char *count = line + 2;
+        char *last_used = strchr(count, '\t');
+        char *tag = last_used != NULL ? strchr(last_used + 1, '\t') : NULL;
+        char *name = tag != NULL ? strchr(tag + 1, '\t') : NULL;
+        if (name == NULL) {
+            continue;
+        }
+        *name++ = '\0';
+        if (USAGE_LEN == USAGE_CAP) {
+            USAGE_CAP = USAGE_CAP == 0 ? 64 : USAGE_CAP * 2;
+            USAGE = (usage_entry_t *)realloc( //
+                USAGE, sizeof(usage_entry_t) * USAGE_CAP);
+        }
+        usage_entry_t *entry = &USAGE[USAGE_LEN++];
+        *entry = (usage_entry_t){0};
+        entry->kind = (fip_usage_kind_e)(kind - usage_kind_chars);
+        entry->count = (uint32_t)strtoul(count, NULL, 10);
+        entry->last_used = (uint64_t)strtoull(last_used + 1, NULL, 10);
+        strncpy(entry->tag, tag + 1, sizeof(entry->tag) - 1);
+        strncpy(entry->name, name, sizeof(entry->name) - 1);
+    }
+    fclose(fp);
+    qsort(USAGE, USAGE_LEN, sizeof(usage_entry_t), usage_entry_cmp);
+}
+
+/// @function `usage_save`
+/// @brief Persists all usage entries for the next session
+void usage_save(void) {
+    if (!ensure_cache_dir()) {
+        return;
+    }
+    FILE *fp = fopen(USAGE_CACHE_PATH, "w");
+    if (fp == NULL) {
+        fip_print(ID, FIP_WARN, "Could not write %s", USAGE_CACHE_PATH);
+        return;
+    }
+    fprintf(fp, "%s\n", USAGE_CACHE_MAGIC);
+    for (uint32_t i = 0; i < USAGE_LEN; i++) {
+        const usage_entry_t *entry = &USAGE[i];
+        fprintf(fp, "%c\t%u\t%llu\t%s\t%s\n", usage_kind_chars[entry->kind],
+            entry->count, (unsigned long long)entry->last_used, entry->tag,
+            entry->name);
+    }
+    fclose(fp);
+}
+
+/// @function `usage_record`
+/// @brief Counts one use of the given tag, symbol or object. Entries seen for
+/// the first time are inserted at their sorted position
+///
+/// @param `kind` The kind of the used thing
+/// @param `tag` The tag it belongs to
+/// @param `name` The name of the symbol or the hash of the object, empty for
+/// tags
+void usage_record(               //
+    const fip_usage_kind_e kind, //
+    const char *tag,             //
+    const char *name             //
+) {
+    usage_entry_t key = {.kind = kind};
+    strncpy(key.tag, tag, sizeof(key.tag) - 1);
+    strncpy(key.name, name, sizeof(key.name) - 1);
+    // Find the first entry not sorting before the key
+    uint32_t low = 0;
+    uint32_t high = USAGE_LEN;
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        if (usage_entry_cmp(&USAGE[mid], &key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == USAGE_LEN || usage_entry_cmp(&USAGE[low], &key) != 0) {
+        if (USAGE_LEN == USAGE_CAP) {
+            USAGE_CAP = USAGE_CAP == 0 ? 64 : USAGE_CAP * 2;
+            USAGE = (usage_entry_t *)realloc( //
+                USAGE, sizeof(usage_entry_t) * USAGE_CAP);
+        }
+        memmove(&USAGE[low + 1], &USAGE[low],
+            sizeof(usage_entry_t) * (USAGE_LEN - low));
+        USAGE[low] = key;
+        USAGE_LEN++;
+    }
+    USAGE[low].count++;
+    USAGE[low].last_used = (uint64_t)time(NULL);
+}
+
+/// @function `usage_record_symbol`
+/// @brief Counts one use of the given symbol of the given collection. Using a
+/// symbol uses its tag as well
+///
+/// @param `coll` The collection containing the symbol
+/// @param `name` The name of the symbol
+void usage_record_symbol(                  //
+    const fip_c_symbol_collection_t *coll, //
+    const char *name                       //
+) {
+    usage_record(FIP_USAGE_TAG, coll->tag, "");
+    usage_record(FIP_USAGE_SYMBOL, coll->tag, name);
 }
 
 void handle_function_symbol_request(         //
@@ -1566,11 +4611,16 @@ void handle_function_symbol_request(         //
     bool sym_match = false;
     fip_print(ID, FIP_DEBUG, "symbol_list.count=%lu", symbol_list.count);
     for (size_t i = 0; i < symbol_list.count; i++) {
+        if (!collection_load_for_name(i, msg_fn->name)) {
+            continue;
+        }
         fip_c_symbol_collection_t *const collection =
             &symbol_list.collection[i];
         fip_print(ID, FIP_DEBUG, "collection->symbol_count=%lu",
             collection->symbol_count);
-        for (size_t j = 0; j < collection->symbol_count; j++) {
+        // Only the symbols sharing the requested name need to be checked
+        uint32_t j = symbol_index_find(collection, msg_fn->name);
+        for (; j != SYMBOL_INDEX_END; j = collection->index.next[j]) {
             const fip_c_symbol_t *symbol = &collection->symbols[j];
             if (symbol->type != FIP_SYM_FUNCTION) {
                 continue;
@@ -1602,8 +4652,8 @@ void handle_function_symbol_request(         //
                 if (sym_match) {
                     // We found the requested symbol
                     collection->needed = true;
-                    fip_clone_sig_fn(&sym_res->sig.fn, sym_fn);
-                    memcpy(sym_res->sig.fn.name, sym_fn->name, 128);
+                    usage_record_symbol(collection, sym_fn->name);
+                    sym_res->sig.fn = *sym_fn;
                     break;
                 }
             }
@@ -1626,11 +4676,16 @@ void handle_data_symbol_request(             //
     bool sym_match = false;
     fip_print(ID, FIP_DEBUG, "symbol_list.count=%lu", symbol_list.count);
     for (size_t i = 0; i < symbol_list.count; i++) {
+        if (!collection_load_for_name(i, msg_data->name)) {
+            continue;
+        }
         fip_c_symbol_collection_t *const collection =
             &symbol_list.collection[i];
         fip_print(ID, FIP_DEBUG, "collection->symbol_count=%lu",
             collection->symbol_count);
-        for (size_t j = 0; j < collection->symbol_count; j++) {
+        // Only the symbols sharing the requested name need to be checked
+        uint32_t j = symbol_index_find(collection, msg_data->name);
+        for (; j != SYMBOL_INDEX_END; j = collection->index.next[j]) {
             const fip_c_symbol_t *symbol = &collection->symbols[j];
             if (symbol->type != FIP_SYM_DATA) {
                 continue;
@@ -1653,8 +4708,8 @@ void handle_data_symbol_request(             //
                 if (sym_match) {
                     // We found the requested symbol
                     collection->needed = true;
-                    fip_clone_sig_data(&sym_res->sig.data, sym_data);
-                    memcpy(sym_res->sig.data.name, sym_data->name, 128);
+                    usage_record_symbol(collection, sym_data->name);
+                    sym_res->sig.data = *sym_data;
                     break;
                 }
             }
@@ -1677,11 +4732,16 @@ void handle_enum_symbol_request(             //
     bool sym_match = false;
     fip_print(ID, FIP_DEBUG, "symbol_list.count=%lu", symbol_list.count);
     for (size_t i = 0; i < symbol_list.count; i++) {
+        if (!collection_load_for_name(i, msg_enum->name)) {
+            continue;
+        }
         fip_c_symbol_collection_t *const collection =
             &symbol_list.collection[i];
         fip_print(ID, FIP_DEBUG, "collection->symbol_count=%lu",
             collection->symbol_count);
-        for (size_t j = 0; j < collection->symbol_count; j++) {
+        // Only the symbols sharing the requested name need to be checked
+        uint32_t j = symbol_index_find(collection, msg_enum->name);
+        for (; j != SYMBOL_INDEX_END; j = collection->index.next[j]) {
             const fip_c_symbol_t *symbol = &collection->symbols[j];
             if (symbol->type != FIP_SYM_ENUM) {
                 continue;
@@ -1702,8 +4762,8 @@ void handle_enum_symbol_request(             //
                 if (sym_match) {
                     // We found the requested symbol
                     collection->needed = true;
-                    fip_clone_sig_enum(&sym_res->sig.enum_t, sym_enum);
-                    memcpy(sym_res->sig.enum_t.name, sym_enum->name, 128);
+                    usage_record_symbol(collection, sym_enum->name);
+                    sym_res->sig.enum_t = *sym_enum;
                     break;
                 }
             }
@@ -1726,11 +4786,16 @@ void handle_opaque_symbol_request(           //
     bool sym_match = false;
     fip_print(ID, FIP_DEBUG, "symbol_list.count=%lu", symbol_list.count);
     for (size_t i = 0; i < symbol_list.count; i++) {
+        if (!collection_load_for_name(i, msg_opaque->name)) {
+            continue;
+        }
         fip_c_symbol_collection_t *const collection =
             &symbol_list.collection[i];
         fip_print(ID, FIP_DEBUG, "collection->symbol_count=%lu",
             collection->symbol_count);
-        for (size_t j = 0; j < collection->symbol_count; j++) {
+        // Only the symbols sharing the requested name need to be checked
+        uint32_t j = symbol_index_find(collection, msg_opaque->name);
+        for (; j != SYMBOL_INDEX_END; j = collection->index.next[j]) {
             const fip_c_symbol_t *symbol = &collection->symbols[j];
             if (symbol->type != FIP_SYM_OPAQUE) {
                 continue;
@@ -1740,8 +4805,8 @@ void handle_opaque_symbol_request(           //
             if (strcmp(sym_opaque->name, msg_opaque->name) == 0) {
                 sym_match = true;
                 collection->needed = true;
-                fip_clone_sig_opaque(&sym_res->sig.opaque, sym_opaque);
-                memcpy(sym_res->sig.opaque.name, sym_opaque->name, 128);
+                usage_record_symbol(collection, sym_opaque->name);
+                sym_res->sig.opaque = *sym_opaque;
                 break;
             }
         }
@@ -1783,109 +4848,1232 @@ void handle_symbol_request(    //
             handle_opaque_symbol_request(message, sym_res);
             break;
     }
+    const char *name = fip_sig_name(sym_res->type, &message->u.sym_req.sig);
+    if (sym_res->found) {
+        FIP_PROBE2(symbol_hit, sym_res->type, name);
+    } else {
+        FIP_PROBE2(symbol_miss, sym_res->type, name);
+    }
+    // The signature of the response is a shallow copy of the stored one, its
+    // arguments, fields and values still belong to the symbol. It is encoded
+    // right from there, so the response must not be freed
     fip_slave_send_message(ID, buffer, &response);
 }
 
-bool compile_module(                                  //
-    uint8_t *path_count,                              //
-    char paths[FIP_PATHS_SIZE],                       //
-    fip_module_config_t *config,                      //
-    [[maybe_unused]] const fip_msg_t *compile_message //
-) {
-    // Ensure .fip/cache directory exists
+void handle_subscribe_request(const fip_msg_t *message);
+
+/// @function `serve_lookup_message`
+/// @brief Handles a message which arrived on the lookup lane while a bulk
+/// transfer is in progress. Symbol and subscribe requests are answered right
+/// away, so they never need to wait for a tag import or compilation to finish
+///
+/// @param `buffer` The buffer containing the received message
+void serve_lookup_message(char buffer[FIP_MSG_SIZE]) {
+    fip_msg_t message = {0};
+    fip_decode_msg(buffer, &message);
+    if (message.type == FIP_MSG_SYMBOL_REQUEST) {
+        handle_symbol_request(buffer, &message);
+    } else if (message.type == FIP_MSG_SUBSCRIBE_REQUEST) {
+        handle_subscribe_request(&message);
+    } else {
+        fip_print(ID, FIP_WARN, "Ignoring %s during a bulk transfer",
+            fip_msg_type_str[message.type]);
+    }
+    fip_free_msg(&message);
+}
+
+/// @function `send_bulk_message`
+/// @brief Sends a message on the bulk lane chunk by chunk. In between the
+/// chunks all pending lookups are served, their responses overtake the rest of
+/// the bulk message
+///
+/// @param `buffer` The buffer in which the message will be encoded
+/// @param `message` The message to send
+void send_bulk_message(char buffer[FIP_MSG_SIZE], const fip_msg_t *message) {
+    fip_slave_queue_message(buffer, message);
+    char lookup_buffer[FIP_MSG_SIZE];
+    while (fip_slave_flush_frame(ID)) {
+        while (fip_slave_poll_message(FIP_LANE_LOOKUP, lookup_buffer)) {
+            serve_lookup_message(lookup_buffer);
+        }
+    }
+}
+
+/// @function `await_next_symbol_request`
+/// @brief Waits for the master to request the next symbol of a tag. Lookups
+/// arriving in the meantime are served right away
+///
+/// @param `buffer` The buffer in which the received messages are stored
+/// @return `bool` Whether the next symbol was requested
+bool await_next_symbol_request(char buffer[FIP_MSG_SIZE]) {
+    while (true) {
+        while (!fip_slave_receive_message(buffer)) {
+            fip_print(ID, FIP_WARN, "No message from master yet...");
+        }
+        if (fip_msg_lane((fip_msg_type_e)buffer[0]) == FIP_LANE_LOOKUP) {
+            serve_lookup_message(buffer);
+            continue;
+        }
+        fip_msg_t next_message = {0};
+        fip_decode_msg(buffer, &next_message);
+        if (next_message.type != FIP_MSG_TAG_NEXT_SYMBOL_REQUEST) {
+            fip_print(ID, FIP_ERROR,
+                "Unexpected message from master: %s, expected %s",
+                fip_msg_type_str[next_message.type],
+                fip_msg_type_str[FIP_MSG_TAG_NEXT_SYMBOL_REQUEST]);
+            fip_free_msg(&next_message);
+            return false;
+        }
+        fip_free_msg(&next_message);
+        return true;
+    }
+}
+
+/*
+ * ==============================================
+ * CACHE LOCK Functions
+ * ==============================================
+ * Two builds of the same repository running at
+ * the same time, like a build in a terminal and
+ * one of an editor, would both compile the same
+ * sources into the same objects of `.fip/cache`.
+ * They would not only do the work twice but also
+ * race on writing the object. So every object
+ * is only compiled while holding its lock file
+ * `.fip/cache/<hash>.lock`. A compilation finding
+ * the object locked waits until the lock is free
+ * and then checks the key of the object again,
+ * when the other process compiled it with the
+ * same inputs the object is reused as it is.
+ * Within a process the duplicates are already
+ * merged by the compile pool, and the jobs which
+ * wait for another process do not keep the pool
+ * from starting the remaining jobs. The locks are
+ * advisory locks, so the lock of a process which
+ * crashed is released by the operating system.
+ * ==============================================
+ */
+
+#define LOCK_POLL_MS 100
+
+typedef struct {
+    bool is_held;
 #ifdef __WIN32__
-    if (CreateDirectoryA(".fip", NULL) ||
-        GetLastError() == ERROR_ALREADY_EXISTS) {
-        if (!CreateDirectoryA(".fip/cache", NULL) &&
-            GetLastError() != ERROR_ALREADY_EXISTS) {
-            fip_print(ID, FIP_ERROR, "Failed to create .fip/cache directory");
+    HANDLE handle;
+#else
+    int fd;
+#endif
+} cache_lock_t;
+
+/// @function `cache_lock_acquire`
+/// @brief Takes the lock file at the given path. When the lock file can not
+/// be created at all nothing is locked and the caller proceeds without it
+///
+/// @param `lock` The lock to take
+/// @param `path` The path of the lock file
+/// @param `wait` Whether to wait until the lock is free
+/// @return `bool` False if `wait` is not set and another process holds the
+/// lock, true otherwise
+bool cache_lock_acquire(cache_lock_t *lock, const char *path, const bool wait) {
+    *lock = (cache_lock_t){0};
+#ifdef __WIN32__
+    // A file opened without sharing can not be opened a second time until
+    // its handle is closed, which also deletes it
+    while (true) {
+        lock->handle = CreateFileA(path, GENERIC_WRITE, 0, NULL, OPEN_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+        if (lock->handle != INVALID_HANDLE_VALUE) {
+            lock->is_held = true;
+            return true;
+        }
+        if (GetLastError() != ERROR_SHARING_VIOLATION) {
+            fip_print(ID, FIP_WARN, "Could not create lock '%s'", path);
+            return true;
+        }
+        if (!wait) {
             return false;
         }
+        msleep(LOCK_POLL_MS);
+    }
+#else
+    lock->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (lock->fd < 0) {
+        fip_print(ID, FIP_WARN, "Could not create lock '%s': %s", path,
+            strerror(errno));
+        return true;
+    }
+    fcntl(lock->fd, F_SETFD, FD_CLOEXEC);
+    struct flock region = {0};
+    region.l_type = F_WRLCK;
+    region.l_whence = SEEK_SET;
+    while (fcntl(lock->fd, wait ? F_SETLKW : F_SETLK, &region) != 0) {
+        if (errno == EINTR) {
+            continue;
+        }
+        const bool is_busy = errno == EACCES || errno == EAGAIN;
+        if (!is_busy) {
+            fip_print(ID, FIP_WARN, "Could not lock '%s': %s", path,
+                strerror(errno));
+        }
+        close(lock->fd);
+        return !is_busy;
+    }
+    lock->is_held = true;
+    return true;
+#endif
+}
+
+/// @function `cache_lock_release`
+/// @brief Releases the given lock if it is held
+void cache_lock_release(cache_lock_t *lock) {
+    if (!lock->is_held) {
+        return;
+    }
+#ifdef __WIN32__
+    CloseHandle(lock->handle);
+#else
+    close(lock->fd);
+#endif
+    lock->is_held = false;
+}
+
+/// @function `cached_key_matches`
+/// @brief Checks whether the given output exists and was built from the
+/// inputs of the given key
+///
+/// @param `output` The path of the built output
+/// @param `key_path` The path of the key file written next to it
+/// @param `key_str` The key of the current inputs
+/// @return `bool` Whether the output is up to date
+bool cached_key_matches(   //
+    const char *output,    //
+    const char *key_path,  //
+    const char key_str[17] //
+) {
+    struct stat output_st;
+    if (stat(output, &output_st) != 0) {
+        return false;
+    }
+    FILE *key_file = fopen(key_path, "r");
+    if (key_file == NULL) {
+        return false;
+    }
+    char cached_key[17] = {0};
+    const size_t read = fread(cached_key, 1, 16, key_file);
+    fclose(key_file);
+    return read == 16 && strcmp(cached_key, key_str) == 0;
+}
+
+/// @function `hash_file_stat`
+/// @brief Continues the given hash with the path, size and mtime of a file
+uint64_t hash_file_stat(uint64_t hash, const char *path) {
+    struct stat st = {0};
+    const int64_t stamp[2] = {
+        stat(path, &st) == 0 ? (int64_t)st.st_size : -1,
+        (int64_t)st.st_mtime,
+    };
+    hash = hash_bytes(hash, path, strlen(path) + 1);
+    return hash_bytes(hash, stamp, sizeof(stamp));
+}
+
+/// @function `compute_compile_key`
+/// @brief Computes the cache key of compiling one source of the given config.
+/// The key covers the command template, the source file and all headers of
+/// the tag, so any change to them results in a recompilation. The headers the
+/// source includes are only known from its depfile, see `hash_depfile`
+///
+/// @param `config` The config of the tag the source belongs to
+/// @param `source` The source file to compile
+/// @return `uint64_t` The cache key
+uint64_t compute_compile_key(          //
+    const fip_module_config_t *config, //
+    const char *source                 //
+) {
+    uint64_t key = HASH_SEED;
+    for (uint32_t i = 0; i < config->command_len; i++) {
+        const char *part = config->command[i];
+        key = hash_bytes(key, part, strlen(part) + 1);
+    }
+    key = hash_file_stat(key, source);
+    for (uint32_t i = 0; i < config->headers_len; i++) {
+        key = hash_file_stat(key, config->headers[i]);
+    }
+    return key;
+}
+
+/// @function `hash_depfile`
+/// @brief Continues the given key with all prerequisites listed in the given
+/// depfile. A missing depfile adds nothing to the key
+///
+/// @param `key` The key to continue
+/// @param `depfile` The path of the depfile
+/// @return `uint64_t` The continued key
+uint64_t hash_depfile(uint64_t key, const char *depfile) {
+    const path_list_t outer_dependencies = DEPENDENCIES;
+    DEPENDENCIES = (path_list_t){0};
+    record_depfile(depfile);
+    for (uint32_t i = 0; i < DEPENDENCIES.len; i++) {
+        key = hash_file_stat(key, DEPENDENCIES.items[i]);
+    }
+    path_list_free(&DEPENDENCIES);
+    DEPENDENCIES = outer_dependencies;
+    return key;
+}
+
+/// @function `build_command`
+/// @brief Builds the command of the given config with all substitutes
+/// replaced. The returned command has to be freed by the caller
+///
+/// @param `config` The config whose command template to use
+/// @param `sources` The replacement of the `__SOURCES__` substitute
+/// @param `output` The replacement of the `__OUTPUT__` substitute
+/// @param `depfile` The replacement of the `__DEPFILE__` substitute
+/// @return `char *` The command to execute
+char *build_command(                   //
+    const fip_module_config_t *config, //
+    const char *sources,               //
+    const char *output,                //
+    const char *depfile                //
+) {
+    size_t command_size = 0;
+    for (size_t i = 0; i < config->command_len; i++) {
+        const char *part = config->command[i];
+        if (strcmp(part, "__SOURCES__") == 0) {
+            part = sources;
+        } else if (strcmp(part, "__OUTPUT__") == 0) {
+            part = output;
+        } else if (strcmp(part, "__DEPFILE__") == 0) {
+            part = depfile;
+        }
+        command_size += strlen(part) + 1;
+    }
+    char *const command = (char *)malloc(command_size);
+    size_t idx = 0;
+    for (size_t i = 0; i < config->command_len; i++) {
+        const char *part = config->command[i];
+        if (strcmp(part, "__SOURCES__") == 0) {
+            part = sources;
+        } else if (strcmp(part, "__OUTPUT__") == 0) {
+            part = output;
+        } else if (strcmp(part, "__DEPFILE__") == 0) {
+            part = depfile;
+        }
+        const size_t len = strlen(part);
+        memcpy(command + idx, part, len);
+        idx += len;
+        command[idx] = ' ';
+        idx++;
+    }
+    command[command_size - 1] = '\0';
+    return command;
+}
+
+/// @function `command_has_depfile`
+/// @brief Checks whether the command of the given config lets the compiler
+/// write a depfile
+bool command_has_depfile(const fip_module_config_t *config) {
+    for (size_t i = 0; i < config->command_len; i++) {
+        if (strcmp(config->command[i], "__DEPFILE__") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef enum compile_job_state_e : uint8_t {
+    // The object is up to date, the source does not need to be compiled
+    COMPILE_JOB_UP_TO_DATE = 0,
+    // The object of the source is already listed in the paths
+    COMPILE_JOB_LISTED,
+    // The source needs to be compiled, its compiler was not started yet
+    COMPILE_JOB_PENDING,
+    // Another process compiles the same object, the job waits for its lock
+    COMPILE_JOB_LOCKED,
+    COMPILE_JOB_RUNNING,
+    // The compiler exited, its result was not handled yet
+    COMPILE_JOB_EXITED,
+    COMPILE_JOB_DONE,
+    COMPILE_JOB_FAILED,
+} compile_job_state_e;
+
+typedef struct {
+    const fip_module_config_t *config;
+    /// @var `pch_stub`
+    /// @brief The header the sources include to use the precompiled header
+    char pch_stub[32];
+    /// @var `has_pch`
+    /// @brief Whether the sources of the tag are compiled with the precompiled
+    /// header, cleared once a source fails to compile with it
+    bool has_pch;
+} compile_tag_t;
+
+typedef struct {
+    compile_job_state_e state;
+    /// @var `tag`
+    /// @brief The tag the source belongs to
+    compile_tag_t *tag;
+    const char *source;
+    /// @var `pch_stub`
+    /// @brief The header whose precompiled header is used, or NULL
+    const char *pch_stub;
+    char hash[FIP_PATH_SIZE + 1];
+    char output[32];
+    char key_path[32];
+    char depfile[32];
+    char log_path[32];
+    char lock_path[32];
+    char fail_path[32];
+    char key_str[17];
+    /// @var `inputs_key`
+    /// @brief The key of the inputs known before compiling, without the headers
+    /// listed in the depfile
+    uint64_t inputs_key;
+    /// @var `lock`
+    /// @brief The lock of the object, held from the start of the compiler
+    /// until its result is handled
+    cache_lock_t lock;
+    /// @var `output_text`
+    /// @brief The captured stdout and stderr of the compiler once it exited
+    char *output_text;
+    int exit_code;
+    /// @var `is_cached_failure`
+    /// @brief Whether the job exited with the failure recorded for the same
+    /// inputs instead of running the compiler
+    bool is_cached_failure;
+#ifndef __WIN32__
+    pid_t pid;
+#endif
+} compile_job_t;
+
+/// @function `compile_job_update_key`
+/// @brief Computes the key of the given job from its inputs and every header
+/// listed in the depfile of the last compilation of its source
+///
+/// @param `job` The job whose key to compute
+void compile_job_update_key(compile_job_t *job) {
+    const uint64_t key = hash_depfile(job->inputs_key, job->depfile);
+    snprintf(job->key_str, sizeof(job->key_str), "%016llx",
+        (unsigned long long)key);
+}
+
+/// @function `compile_job_load_failure`
+/// @brief Loads the failure recorded for the inputs of the given job. A source
+/// which failed to compile fails again until its inputs change, so its job
+/// exits right away with the recorded result
+///
+/// @param `job` The job whose failure to load
+/// @return `bool` Whether the job exited with the recorded failure
+bool compile_job_load_failure(compile_job_t *job) {
+    FILE *fail_file = open_failure(job->fail_path, job->key_str);
+    if (fail_file == NULL) {
+        return false;
+    }
+    if (fscanf(fail_file, "%d\n", &job->exit_code) != 1) {
+        fclose(fail_file);
+        return false;
+    }
+    job->output_text = read_rest(fail_file);
+    fclose(fail_file);
+    job->pch_stub = NULL;
+    job->is_cached_failure = true;
+    job->state = COMPILE_JOB_EXITED;
+    FIP_PROBE2(compile_cache_hit, job->source, true);
+    return true;
+}
+
+/// @function `compile_job_init`
+/// @brief Prepares the compilation of a single source file of a module. Every
+/// source gets its own object file in the `.fip/cache` directory. If the object
+/// already exists and its inputs did not change since it was compiled, the job
+/// is up to date and the compilation is skipped
+///
+/// @param `job` The job to prepare
+/// @param `paths` The paths array the objects are added to
+/// @param `earlier` The jobs prepared before this one
+/// @param `earlier_count` The number of jobs prepared before this one
+/// @param `config` The config of the module the source belongs to
+/// @param `source` The source file to compile
+/// @param `pch_stub` The header whose precompiled header is used, or NULL
+void compile_job_init(                 //
+    compile_job_t *job,                //
+    const char paths[FIP_PATHS_SIZE],  //
+    const compile_job_t *earlier,      //
+    const uint32_t earlier_count,      //
+    const fip_module_config_t *config, //
+    const char *source,                //
+    const char *pch_stub               //
+) {
+    *job = (compile_job_t){0};
+    job->source = source;
+    job->pch_stub = pch_stub;
+    // Hash the full path `.fip/cache/<tag>/<source>` as input so the string is
+    // always long enough for good hash distribution.
+    char hash_input[1024];
+    snprintf(hash_input, sizeof(hash_input), ".fip/cache/%s/%s", config->tag,
+        source);
+    fip_create_hash(job->hash, hash_input);
+
+    // Check if the hash is already part of the paths or of an earlier job, if
+    // it is we already compiled the source
+    job->state = COMPILE_JOB_LISTED;
+    if (strstr(paths, job->hash)) {
+        return;
+    }
+    for (uint32_t i = 0; i < earlier_count; i++) {
+        if (strcmp(earlier[i].hash, job->hash) == 0) {
+            return;
+        }
+    }
+
+#ifdef __WIN32__
+    const char *file_ext = ".obj";
+#else
+    const char *file_ext = ".o";
+#endif
+    snprintf(job->output, sizeof(job->output), ".fip/cache/%s%s", job->hash,
+        file_ext);
+    snprintf(job->key_path, sizeof(job->key_path), ".fip/cache/%s.key",
+        job->hash);
+    // The compiler writes the headers the source includes to the depfile if
+    // the command contains the `__DEPFILE__` substitute
+    snprintf(job->depfile, sizeof(job->depfile), ".fip/cache/%s.d", job->hash);
+    snprintf(job->log_path, sizeof(job->log_path), ".fip/cache/%s.log",
+        job->hash);
+    snprintf(job->lock_path, sizeof(job->lock_path), ".fip/cache/%s.lock",
+        job->hash);
+    snprintf(job->fail_path, sizeof(job->fail_path), ".fip/cache/%s.fail",
+        job->hash);
+
+    // Skip the compilation if the object is up to date. The headers the source
+    // includes are only known from the depfile of its last compilation, so
+    // without a depfile the source is always compiled again
+    job->inputs_key = compute_compile_key(config, source);
+    compile_job_update_key(job);
+    job->state = COMPILE_JOB_PENDING;
+    if (command_has_depfile(config)
+        && cached_key_matches(job->output, job->key_path, job->key_str)) {
+        fip_print(ID, FIP_INFO, "'%s' is up to date", source);
+        job->state = COMPILE_JOB_UP_TO_DATE;
+        FIP_PROBE2(compile_cache_hit, source, false);
+        return;
+    }
+    if (command_has_depfile(config) && compile_job_load_failure(job)) {
+        fip_print(ID, FIP_INFO, "'%s' did not change since it failed", source);
+    }
+}
+
+/// @function `compile_job_start`
+/// @brief Starts the compiler of the given job. On Windows the compiler runs
+/// to its end right away, elsewhere it runs in the background until it is
+/// collected by `compile_job_await`. When another process holds the lock of
+/// the object the job is locked instead, and when the other process already
+/// compiled it the job is up to date or exited with the failure it recorded
+///
+/// @param `job` The job to start
+/// @param `config` The config of the module the source belongs to
+/// @return `bool` Whether the compiler could be started
+bool compile_job_start(compile_job_t *job, const fip_module_config_t *config) {
+    // A job compiled again without the precompiled header still holds its lock
+    if (!job->lock.is_held) {
+        if (!cache_lock_acquire(&job->lock, job->lock_path, false)) {
+            if (job->state != COMPILE_JOB_LOCKED) {
+                fip_print(ID, FIP_INFO, "'%s' is compiled by another process",
+                    job->source);
+            }
+            job->state = COMPILE_JOB_LOCKED;
+            return true;
+        }
+        // Another process may have compiled the source meanwhile and written
+        // a new depfile
+        compile_job_update_key(job);
+        if (command_has_depfile(config)
+            && cached_key_matches(job->output, job->key_path, job->key_str)) {
+            fip_print(ID, FIP_INFO, "Reusing '%s' of another process",
+                job->hash);
+            cache_lock_release(&job->lock);
+            job->state = COMPILE_JOB_UP_TO_DATE;
+            FIP_PROBE2(compile_cache_hit, job->source, false);
+            return true;
+        }
+        if (command_has_depfile(config) && compile_job_load_failure(job)) {
+            fip_print(ID, FIP_INFO, "'%s' failed in another process",
+                job->source);
+            cache_lock_release(&job->lock);
+            return true;
+        }
+    }
+    // The precompiled header has to be included before anything else
+    char sources[1024];
+    if (job->pch_stub != NULL) {
+        snprintf(sources, sizeof(sources), "-include %s %s", job->pch_stub,
+            job->source);
     } else {
-        fip_print(ID, FIP_ERROR, "Failed to create .fip directory");
+        snprintf(sources, sizeof(sources), "%s", job->source);
+    }
+    char *const command = build_command(config, sources, job->output, //
+        job->depfile);
+    fip_print(ID, FIP_INFO, "Executing: %s", command);
+
+    // Remove the key first so that a failed compilation can never leave a
+    // stale object behind which looks up to date
+    remove(job->key_path);
+    remove(job->depfile);
+    FIP_PROBE2(compile_start, job->source, job->pch_stub != NULL);
+#ifdef __WIN32__
+    job->exit_code = fip_execute_and_capture(&job->output_text, command);
+    free(command);
+    job->state = COMPILE_JOB_EXITED;
+    FIP_PROBE2(compile_end, job->source, job->exit_code);
+    return true;
+#else
+    const int log_fd = open(job->log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log_fd < 0) {
+        fip_print(ID, FIP_ERROR, "Could not write '%s'", job->log_path);
+        free(command);
+        cache_lock_release(&job->lock);
+        return false;
+    }
+    const pid_t pid = fork();
+    if (pid == 0) {
+        // The compiler must neither read the messages of the master from stdin
+        // nor write into the messages to it on stdout
+        const int null_fd = open("/dev/null", O_RDONLY);
+        if (null_fd < 0 || dup2(null_fd, STDIN_FILENO) == -1 ||
+            dup2(log_fd, STDOUT_FILENO) == -1 ||
+            dup2(log_fd, STDERR_FILENO) == -1) {
+            _exit(127);
+        }
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        _exit(127);
+    }
+    close(log_fd);
+    free(command);
+    if (pid < 0) {
+        fip_print(ID, FIP_ERROR, "Failed to fork to compile '%s'", job->source);
+        cache_lock_release(&job->lock);
         return false;
     }
+    job->pid = pid;
+    job->state = COMPILE_JOB_RUNNING;
+    JOBS.running++;
+    return true;
+#endif
+}
+
+/// @function `compile_job_await`
+/// @brief Waits until one of the given jobs exited and returns it. The peak
+/// memory of every collected compiler is recorded in the job controller
+///
+/// @param `jobs` The jobs to wait for
+/// @param `job_count` The number of jobs
+/// @param `timeout_ms` How long to wait for a job to exit, -1 to wait until
+/// the last running job exited
+/// @return `compile_job_t *` The exited job, NULL if no job exited in time
+compile_job_t *compile_job_await( //
+    compile_job_t *jobs,          //
+    const uint32_t job_count,     //
+    const int timeout_ms          //
+) {
+    for (uint32_t i = 0; i < job_count; i++) {
+        if (jobs[i].state == COMPILE_JOB_EXITED) {
+            return &jobs[i];
+        }
+    }
+#ifdef __WIN32__
+    if (timeout_ms > 0) {
+        msleep(timeout_ms);
+    }
+    return NULL;
 #else
-    if (mkdir(".fip", 0755) != 0 && errno != EEXIST) {
-        fip_print(ID, FIP_ERROR, "Failed to create .fip directory: %s",
-            strerror(errno));
+    // Only the compilers of the jobs are waited for. Waiting for any child
+    // would also reap the children of `popen`, whose `pclose` then fails
+    const double start = fip_now_ms();
+    while (JOBS.running > 0) {
+        for (uint32_t i = 0; i < job_count; i++) {
+            compile_job_t *job = &jobs[i];
+            if (job->state != COMPILE_JOB_RUNNING) {
+                continue;
+            }
+            int status = 0;
+            struct rusage usage = {0};
+            const pid_t pid = wait4(job->pid, &status, WNOHANG, &usage);
+            if (pid == 0 || (pid < 0 && errno == EINTR)) {
+                continue;
+            }
+            if (pid < 0) {
+                fip_print(ID, FIP_ERROR, "Failed to wait for '%s': %s",
+                    job->source, strerror(errno));
+            }
+            JOBS.running--;
+            // `ru_maxrss` is given in KiB on Linux
+            job_controller_record((uint64_t)usage.ru_maxrss);
+            job->exit_code = pid > 0 && WIFEXITED(status) //
+                ? WEXITSTATUS(status)                     //
+                : -1;
+            job->state = COMPILE_JOB_EXITED;
+            FIP_PROBE2(compile_end, job->source, job->exit_code);
+            FILE *log = fopen(job->log_path, "r");
+            if (log != NULL) {
+                fseek(log, 0, SEEK_END);
+                const long log_size = ftell(log);
+                fseek(log, 0, SEEK_SET);
+                job->output_text = (char *)malloc((size_t)log_size + 1);
+                const size_t read = fread(job->output_text, 1,
+                    (size_t)log_size, log);
+                job->output_text[read] = '\0';
+                fclose(log);
+            }
+            remove(job->log_path);
+            return job;
+        }
+        if (timeout_ms >= 0 && fip_now_ms() - start >= (double)timeout_ms) {
+            return NULL;
+        }
+        msleep(FIP_SLAVE_DELAY_MS);
+    }
+    // Only jobs waiting for the locks of other processes are left
+    if (timeout_ms > 0) {
+        msleep(timeout_ms);
+    }
+    return NULL;
+#endif
+}
+
+/// @function `compile_job_finish`
+/// @brief Handles the result of an exited job. A successful compilation is
+/// marked as up to date by writing its key
+///
+/// @param `job` The exited job
+/// @param `config` The config of the module the source belongs to
+/// @return `bool` Whether the source was compiled successfully
+bool compile_job_finish(compile_job_t *job, const fip_module_config_t *config) {
+    assert(job->state == COMPILE_JOB_EXITED);
+    const bool is_ok = job->exit_code == 0;
+    // A failure is only recorded under the headers listed in the depfile the
+    // failed compilation wrote, without them a fix in an included header
+    // would still find the failure
+    struct stat depfile_st;
+    const bool has_depfile = command_has_depfile(config) //
+        && stat(job->depfile, &depfile_st) == 0;
+    if (is_ok || (!job->is_cached_failure && !has_depfile)) {
+        remove(job->fail_path);
+    } else if (!job->is_cached_failure && is_lasting_failure(job->exit_code)) {
+        compile_job_update_key(job);
+        FILE *fail_file = fopen(job->fail_path, "w");
+        if (fail_file != NULL) {
+            fprintf(fail_file, "%s\n%d\n%s", job->key_str, job->exit_code,
+                job->output_text ? job->output_text : "");
+            fclose(fail_file);
+        }
+    }
+    if (job->output_text && job->output_text[0]) {
+        fip_print(ID, is_ok ? FIP_INFO : FIP_ERROR, "%s", job->output_text);
+    }
+    free(job->output_text);
+    job->output_text = NULL;
+    if (!is_ok) {
+        fip_print(ID, FIP_ERROR,                                      //
+            "Compiling '%s' of module '%s' failed with exit code %d", //
+            job->source, config->tag, job->exit_code                  //
+        );
+        cache_lock_release(&job->lock);
+        job->state = COMPILE_JOB_FAILED;
+        return false;
+    }
+    // The key is written before the lock is released, so a process waiting
+    // for the lock finds the object up to date. It covers the headers listed
+    // in the depfile the compiler just wrote
+    compile_job_update_key(job);
+    FILE *key_file = fopen(job->key_path, "w");
+    if (key_file != NULL) {
+        fputs(job->key_str, key_file);
+        fclose(key_file);
+    }
+    cache_lock_release(&job->lock);
+    fip_print(ID, FIP_INFO, "Compiled '%s' successfully", job->hash);
+    job->state = COMPILE_JOB_DONE;
+    return true;
+}
+
+/// @function `add_object_path`
+/// @brief Records the dependencies of a compiled or up to date job and adds
+/// the hash of its object to the paths
+///
+/// @param `path_count` The number of paths already in the paths array
+/// @param `paths` The paths array to add the object's hash to
+/// @param `config` The config of the module the source belongs to
+/// @param `job` The job whose object to add
+/// @return `bool` Whether the hash could be added to the paths
+bool add_object_path(                  //
+    uint16_t *path_count,              //
+    char paths[FIP_PATHS_SIZE],        //
+    const fip_module_config_t *config, //
+    const compile_job_t *job           //
+) {
+    if (job->state == COMPILE_JOB_LISTED) {
+        return true;
+    }
+    usage_record(FIP_USAGE_OBJECT, config->tag, job->hash);
+    record_dependency(job->source);
+    if (command_has_depfile(config)) {
+        record_depfile(job->depfile);
+    }
+
+    // Add to paths array. For this we need to find the first null-byte
+    // character in the paths array, that's where we will place our hash at.
+    // The good thing is that we only need to check multiples of 8 so this
+    // check is rather easy.
+    // Because we know how many paths there already are in the paths string we
+    // can just offset by path_count * FIP_PATH_SIZE and increment path_count
+    // afterwards, as simple as that
+    const uint32_t offset = (uint32_t)*path_count * FIP_PATH_SIZE;
+    if (offset + FIP_PATH_SIZE > FIP_PATHS_SIZE) {
+        fip_print(ID, FIP_ERROR,
+            "An object response can hold at most %u objects",
+            FIP_PATHS_SIZE / FIP_PATH_SIZE);
+        fip_print(ID, FIP_ERROR, "Could not store hash '%s' in it",
+            job->hash);
+        return false;
+    }
+    memcpy(paths + offset, job->hash, FIP_PATH_SIZE);
+    (*path_count)++;
+    return true;
+}
+
+// The directory the precompiled headers and their stub headers are built in
+#define PCH_DIR ".fip/cache"
+
+/// @function `path_from_dir`
+/// @brief Writes the given relative path as seen from the given directory,
+/// both relative to the working directory, by going up once for every
+/// component of the directory
+///
+/// @param `out` Where to write the path to
+/// @param `out_size` The size of `out`
+/// @param `dir` The directory the path is seen from
+/// @param `path` The path relative to the working directory
+/// @return `bool` Whether the path fits into `out`
+bool path_from_dir(        //
+    char *out,             //
+    const size_t out_size, //
+    const char *dir,       //
+    const char *path       //
+) {
+    size_t len = 0;
+    const char *c = dir;
+    while (*c != '\0') {
+        const size_t component_len = strcspn(c, "/\\");
+        if (component_len == 2 && strncmp(c, "..", 2) == 0) {
+            return false;
+        }
+        if (component_len > 0 && !(component_len == 1 && *c == '.')) {
+            if (len + 3 >= out_size) {
+                return false;
+            }
+            memcpy(out + len, "../", 3);
+            len += 3;
+        }
+        c += component_len;
+        c += *c != '\0';
+    }
+    const int written = snprintf(out + len, out_size - len, "%s", path);
+    return written >= 0 && (size_t)written < out_size - len;
+}
+
+/// @function `read_prefix_include`
+/// @brief Reads the include directive a source starts with, only comments and
+/// whitespace may come before it. Quoted includes found next to the source are
+/// rewritten relative to the directory the precompiled header is built in
+///
+/// @param `source` The source file to read
+/// @param `pch_dir` The directory the precompiled header is built in
+/// @param `include` The prefix include to fill
+/// @return `bool` Whether the source starts with an include directive which
+/// can be precompiled
+bool read_prefix_include(     //
+    const char *source,       //
+    const char *pch_dir,      //
+    prefix_include_t *include //
+) {
+    FILE *fp = fopen(source, "r");
+    if (fp == NULL) {
+        return false;
+    }
+    char text[4096];
+    const size_t text_len = fread(text, 1, sizeof(text) - 1, fp);
+    fclose(fp);
+    text[text_len] = '\0';
+
+    const char *c = text;
+    while (*c != '\0') {
+        if (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n') {
+            c++;
+        } else if (c[0] == '/' && c[1] == '/') {
+            c = strchr(c, '\n');
+            if (c == NULL) {
+                return false;
+            }
+        } else if (c[0] == '/' && c[1] == '*') {
+            c = strstr(c + 2, "*/");
+            if (c == NULL) {
+                return false;
+            }
+            c += 2;
+        } else {
+            break;
+        }
+    }
+    if (*c++ != '#') {
+        return false;
+    }
+    while (*c == ' ' || *c == '\t') {
+        c++;
+    }
+    if (strncmp(c, "include", 7) != 0) {
+        return false;
+    }
+    c += 7;
+    while (*c == ' ' || *c == '\t') {
+        c++;
+    }
+    const char close = *c == '"' ? '"' : (*c == '<' ? '>' : '\0');
+    const char *end = close != '\0' ? strchr(c + 1, close) : NULL;
+    if (end == NULL || memchr(c, '\n', (size_t)(end - c)) != NULL) {
+        return false;
+    }
+    const int name_len = (int)(end - c - 1);
+
+    include->path[0] = '\0';
+    if (close == '"') {
+        // Quoted includes are searched next to the including file first
+        const char *slash = strrchr(source, '/');
+        const char *backslash = strrchr(source, '\\');
+        if (backslash != NULL && (slash == NULL || backslash > slash)) {
+            slash = backslash;
+        }
+        const int dir_len = slash != NULL ? (int)(slash - source + 1) : 0;
+        const int path_len = snprintf(include->path, sizeof(include->path),
+            "%.*s%.*s", dir_len, source, name_len, c + 1);
+        if (path_len < 0 || (size_t)path_len >= sizeof(include->path)) {
+            fip_print(ID, FIP_WARN, "The path of the include of '%s' is too "
+                "long to be precompiled", source);
+            return false;
+        }
+        struct stat st;
+        if (stat(include->path, &st) != 0) {
+            include->path[0] = '\0';
+        }
+    }
+    // The operand is written into a header in the precompiled header's
+    // directory, so an include found next to the source has to be reached
+    // from there
+    char path[sizeof(include->operand)];
+    if (include->path[0] == '\0') {
+        snprintf(path, sizeof(path), "%.*s", name_len, c + 1);
+    } else if (include->path[0] == '/' || include->path[1] == ':') {
+        snprintf(path, sizeof(path), "%s", include->path);
+    } else if (!path_from_dir(path, sizeof(path), pch_dir, include->path)) {
+        fip_print(ID, FIP_WARN, "The include '%s' of '%s' can not be reached "
+            "from '%s'", include->path, source, pch_dir);
+        return false;
+    }
+    const char open = include->path[0] == '\0' ? *c : '"';
+    const char closing = include->path[0] == '\0' ? close : '"';
+    const int operand_len = snprintf(include->operand,
+        sizeof(include->operand), "%c%s%c", open, path, closing);
+    if (operand_len < 0 || (size_t)operand_len >= sizeof(include->operand)) {
+        fip_print(ID, FIP_WARN, "The include '%s' of '%s' is too long to be "
+            "precompiled", path, source);
+        return false;
+    }
+    return true;
+}
+
+/// @function `prepare_pch`
+/// @brief Builds the precompiled header of a tag if all its sources start with
+/// the same include. The precompiled header is cached next to the objects and
+/// only built again once its inputs changed. The sources then include the
+/// header `pch_stub` first, which the compiler replaces by the precompiled
+/// header. Failing to build it is no error, the sources are then compiled
+/// without it
+///
+/// @param `config` The config of the tag
+/// @param `pch_stub` The path of the header the sources need to include
+/// @return `bool` Whether a precompiled header can be used
+bool prepare_pch(const fip_module_config_t *config, char pch_stub[32]) {
+    if (!config->auto_pch || config->sources_len < 2) {
+        return false;
+    }
+    prefix_include_t include = {0};
+    if (!read_prefix_include(config->sources[0], PCH_DIR, &include)) {
+        fip_print(ID, FIP_INFO, "'%s' does not start with an include",
+            config->sources[0]);
         return false;
     }
-    if (mkdir(".fip/cache", 0755) != 0 && errno != EEXIST) {
-        fip_print(ID, FIP_ERROR, "Failed to create .fip/cache directory: %s",
-            strerror(errno));
+    for (uint32_t i = 1; i < config->sources_len; i++) {
+        prefix_include_t other = {0};
+        if (!read_prefix_include(config->sources[i], PCH_DIR, &other) //
+            || strcmp(other.operand, include.operand) != 0            //
+        ) {
+            fip_print(ID, FIP_INFO,
+                "The sources of tag '%s' have no common prefix include",
+                config->tag);
+            return false;
+        }
+    }
+    // A header found through the include paths of the command can only be
+    // tracked through the depfile of the compiler, without it edits to the
+    // header would not invalidate the precompiled one
+    if (include.path[0] == '\0' && !command_has_depfile(config)) {
+        fip_print(ID, FIP_INFO,
+            "Can not track the inputs of %s without a depfile, compiling "
+            "tag '%s' without a precompiled header",
+            include.operand, config->tag);
         return false;
     }
-#endif
-    // TODO: Use the target information from the compile_message
-    // compile_message->u.com_req.target
 
-    // Check if the hash is already part of the paths, if it is we already
-    // compiled the module
-    const char *const hash = config->output;
-    if (strstr(paths, hash)) {
-        return true;
+    char hash_input[256];
+    snprintf(hash_input, sizeof(hash_input), ".fip/cache/%s/__pch__",
+        config->tag);
+    char hash[FIP_PATH_SIZE + 1] = {0};
+    fip_create_hash(hash, hash_input);
+    snprintf(pch_stub, 32, PCH_DIR "/%s.h", hash);
+    char output[32];
+    snprintf(output, sizeof(output), ".fip/cache/%s.h.gch", hash);
+    char key_path[32];
+    snprintf(key_path, sizeof(key_path), ".fip/cache/%s.h.key", hash);
+    char depfile[32];
+    snprintf(depfile, sizeof(depfile), ".fip/cache/%s.h.d", hash);
+
+    char lock_path[32];
+    snprintf(lock_path, sizeof(lock_path), ".fip/cache/%s.h.lock", hash);
+    char fail_path[32];
+    snprintf(fail_path, sizeof(fail_path), ".fip/cache/%s.h.fail", hash);
+
+    // The key of the last build also covers every header the precompiled
+    // header included back then, as listed in its depfile
+    uint64_t key = compute_compile_key(config, include.path);
+    key = hash_bytes(key, include.operand, strlen(include.operand) + 1);
+    const uint64_t inputs_key = key;
+    key = hash_depfile(key, depfile);
+    char key_str[17];
+    snprintf(key_str, sizeof(key_str), "%016llx", (unsigned long long)key);
+    // Nothing can be compiled before the header is precompiled, so waiting for
+    // another process precompiling it blocks
+    cache_lock_t lock;
+    cache_lock_acquire(&lock, lock_path, true);
+    if (cached_key_matches(output, key_path, key_str)) {
+        fip_print(ID, FIP_INFO, "Precompiled %s is up to date",
+            include.operand);
+        goto done;
     }
-
-    size_t command_size = 0;
-    for (size_t i = 0; i < config->command_len; i++) {
-        command_size += strlen(config->command[i]) + 1;
+    FILE *fail_file = open_failure(fail_path, key_str);
+    if (fail_file != NULL) {
+        fclose(fail_file);
+        fip_print(ID, FIP_INFO,
+            "Precompiling %s failed before, compiling tag '%s' without it",
+            include.operand, config->tag);
+        cache_lock_release(&lock);
+        return false;
     }
-    char *const command = (char *)malloc(command_size);
-    size_t idx = 0;
-    for (size_t i = 0; i < config->command_len; i++) {
-        const size_t len = strlen(config->command[i]);
-        memcpy(command + idx, config->command[i], len);
-        idx += len;
-        command[idx] = ' ';
-        idx++;
+
+    remove(key_path);
+    remove(depfile);
+    FILE *stub_file = fopen(pch_stub, "w");
+    if (stub_file == NULL) {
+        fip_print(ID, FIP_WARN, "Could not write '%s'", pch_stub);
+        cache_lock_release(&lock);
+        return false;
     }
-    command[command_size - 1] = '\0';
-    fip_print(ID, FIP_INFO, "Executing: %s", command);
+    fprintf(stub_file, "#include %s\n", include.operand);
+    fclose(stub_file);
 
+    char sources[64];
+    snprintf(sources, sizeof(sources), "-x c-header %s", pch_stub);
+    char *const command = build_command(config, sources, output, depfile);
+    fip_print(ID, FIP_INFO, "Executing: %s", command);
     char *compile_output = NULL;
-    int exit_code = fip_execute_and_capture(&compile_output, command);
+    const int exit_code = fip_execute_and_capture(&compile_output, command);
+    free(command);
     if (exit_code != 0) {
-        if (compile_output && compile_output[0]) {
-            fip_print(ID, FIP_ERROR, "%s", compile_output);
-        }
-        fip_print(ID, FIP_ERROR,                              //
-            "Compiling module '%s' failed with exit code %d", //
-            config->tag, exit_code                            //
-        );
-        free(compile_output);
-        free(command);
-        return false;
-    } else {
         if (compile_output && compile_output[0]) {
             fip_print(ID, FIP_INFO, "%s", compile_output);
         }
         free(compile_output);
-        free(command);
+        fip_print(ID, FIP_WARN,
+            "Precompiling %s failed, compiling tag '%s' without it",
+            include.operand, config->tag);
+        remove(output);
+        // Without a depfile the failure of a header found through the include
+        // paths could not be told apart from a later, fixed version of it
+        if (include.path[0] != '\0' && is_lasting_failure(exit_code)) {
+            fail_file = fopen(fail_path, "w");
+            if (fail_file != NULL) {
+                fprintf(fail_file, "%s\n", key_str);
+                fclose(fail_file);
+            }
+        }
+        cache_lock_release(&lock);
+        return false;
+    }
+    free(compile_output);
+    remove(fail_path);
+    key = hash_depfile(inputs_key, depfile);
+    snprintf(key_str, sizeof(key_str), "%016llx", (unsigned long long)key);
+    FILE *key_file = fopen(key_path, "w");
+    if (key_file != NULL) {
+        fputs(key_str, key_file);
+        fclose(key_file);
     }
+    fip_print(ID, FIP_INFO, "Precompiled %s for tag '%s'", include.operand,
+        config->tag);
 
-    fip_print(ID, FIP_INFO, "Compiled '%s' successfully", hash);
-    // Add to paths array. For this we need to find the first null-byte
-    // character in the paths array, that's where we will place our hash at.
-    // The good thing is that we only need to check multiples of 8 so this
-    // check is rather easy.
-    // Because we know how many paths there already are in the paths string we
-    // can just offset by path_count * FIP_PATH_SIZE and increment path_count
-    // afterwards, as simple as that
-    const uint16_t offset = *path_count * FIP_PATH_SIZE;
-    if (offset >= FIP_PATHS_SIZE) {
-        fip_print(                                          //
-            ID, FIP_ERROR, "The Paths array is full: %.*s", //
-            FIP_PATHS_SIZE, paths                           //
-        );
-        fip_print(ID, FIP_ERROR, "Could not store hash '%s' in it", hash);
-        return false;
+done:
+    cache_lock_release(&lock);
+    if (command_has_depfile(config)) {
+        record_depfile(depfile);
     }
-    memcpy(paths + offset, hash, FIP_PATH_SIZE);
-    (*path_count)++;
     return true;
 }
 
+/// @function `compile_tags`
+/// @brief Compiles the sources of all given tags. The sources of all tags share
+/// the jobs the job controller allows, so the sources of a tag do not wait for
+/// the slowest source of the tag before them
+///
+/// @param `path_count` The number of paths already in the paths array
+/// @param `paths` The paths array the objects are added to
+/// @param `tags` The tags to compile, in the order of the config
+/// @param `tag_count` The number of tags to compile
+/// @param `compile_message` The compile request
+/// @return `bool` Whether all sources of all tags were compiled successfully
+bool compile_tags(                                    //
+    uint16_t *path_count,                             //
+    char paths[FIP_PATHS_SIZE],                       //
+    compile_tag_t *tags,                              //
+    const uint32_t tag_count,                         //
+    [[maybe_unused]] const fip_msg_t *compile_message //
+) {
+    if (!ensure_cache_dir()) {
+        return false;
+    }
+    // TODO: Use the target information from the compile_message
+    // compile_message->u.com_req.target
+
+    uint32_t source_count = 0;
+    for (uint32_t i = 0; i < tag_count; i++) {
+        tags[i].has_pch = prepare_pch(tags[i].config, tags[i].pch_stub);
+        source_count += tags[i].config->sources_len;
+    }
+
+    // Every source is compiled on its own, so only the sources whose inputs
+    // changed since the last compilation need to be compiled again. As many
+    // sources are compiled in parallel as the job controller allows. Compiling
+    // all sources can take long, so the master is told about every step. The
+    // jobs of a tag follow the jobs of the tag before it, in the order of the
+    // sources
+    compile_job_t *jobs = (compile_job_t *)calloc( //
+        source_count + 1, sizeof(compile_job_t));
+    uint32_t started = 0;
+    uint32_t finished = 0;
+    uint32_t next_tag = 0;
+    uint32_t next_source = 0;
+    bool is_ok = true;
+    fip_slave_send_progress(ID, 0, source_count);
+    while (finished < source_count) {
+        // The jobs waiting for another process try to take its lock again
+        bool has_locked = false;
+        for (uint32_t i = 0; is_ok && i < started; i++) {
+            compile_job_t *job = &jobs[i];
+            if (job->state != COMPILE_JOB_LOCKED) {
+                continue;
+            }
+            if (!job_controller_can_start()) {
+                has_locked = true;
+                continue;
+            }
+            if (!compile_job_start(job, job->tag->config)) {
+                job->state = COMPILE_JOB_FAILED;
+                is_ok = false;
+            } else if (job->state == COMPILE_JOB_UP_TO_DATE) {
+                finished++;
+                fip_slave_send_progress(ID, finished, source_count);
+            }
+            has_locked = has_locked || job->state == COMPILE_JOB_LOCKED;
+        }
+        while (is_ok && started < source_count && job_controller_can_start()) {
+            while (next_source == tags[next_tag].config->sources_len) {
+                next_tag++;
+                next_source = 0;
+            }
+            compile_tag_t *tag = &tags[next_tag];
+            compile_job_t *job = &jobs[started];
+            compile_job_init(job, paths, jobs, started, tag->config,
+                tag->config->sources[next_source],
+                tag->has_pch ? tag->pch_stub : NULL);
+            job->tag = tag;
+            started++;
+            next_source++;
+            if (job->state == COMPILE_JOB_PENDING
+                && !compile_job_start(job, tag->config)) {
+                job->state = COMPILE_JOB_FAILED;
+                is_ok = false;
+            } else if (job->state == COMPILE_JOB_UP_TO_DATE
+                || job->state == COMPILE_JOB_LISTED) {
+                finished++;
+            }
+            has_locked = has_locked || job->state == COMPILE_JOB_LOCKED;
+        }
+        compile_job_t *job = compile_job_await(jobs, started,
+            is_ok && has_locked ? LOCK_POLL_MS : -1);
+        if (job == NULL) {
+            if (is_ok && has_locked) {
+                continue;
+            }
+            break;
+        }
+        // Headers without include guards can not be included twice, so a
+        // source failing with the precompiled header is compiled again without
+        // it, and so are all sources of its tag started after it
+        if (job->exit_code != 0 && job->pch_stub != NULL) {
+            free(job->output_text);
+            job->output_text = NULL;
+            if (job->tag->has_pch) {
+                fip_print(ID, FIP_WARN, "Compiling the sources of tag '%s' "
+                    "without precompiled header", job->tag->config->tag);
+                job->tag->has_pch = false;
+            }
+            job->pch_stub = NULL;
+            if (is_ok && !compile_job_start(job, job->tag->config)) {
+                job->state = COMPILE_JOB_FAILED;
+                is_ok = false;
+            }
+            if (job->state == COMPILE_JOB_RUNNING) {
+                continue;
+            }
+        }
+        if (job->state == COMPILE_JOB_EXITED) {
+            is_ok = compile_job_finish(job, job->tag->config) && is_ok;
+        }
+        finished++;
+        fip_slave_send_progress(ID, finished, source_count);
+    }
+    job_controller_save();
+    for (uint32_t i = 0; i < started; i++) {
+        cache_lock_release(&jobs[i].lock);
+    }
+
+    // The objects are listed in the order of the tags and their sources, no
+    // matter in which order their compilers finished, so the response is the
+    // same in every run
+    for (uint32_t i = 0; is_ok && i < source_count; i++) {
+        is_ok = add_object_path(path_count, paths, jobs[i].tag->config,
+            &jobs[i]);
+    }
+    free(jobs);
+    return is_ok;
+}
+
 void handle_compile_request(   //
     char buffer[FIP_MSG_SIZE], //
     const fip_msg_t *message   //
@@ -1902,24 +6090,30 @@ void handle_compile_request(   //
     obj_res->module_name[sizeof(obj_res->module_name) - 1] = '\0';
 
     // We need to go through all modules and see whether they need to be
-    // compiled
+    // compiled. All needed modules are compiled together
+    compile_tag_t *tags = (compile_tag_t *)calloc( //
+        symbol_list.count + 1, sizeof(compile_tag_t));
+    uint32_t tag_count = 0;
     for (size_t i = 0; i < symbol_list.count; i++) {
         fip_c_symbol_collection_t *const coll = &symbol_list.collection[i];
         if (!coll->needed) {
             continue;
         }
-        if (!compile_module(                          //
-                &obj_res->path_count, obj_res->paths, //
-                &CONFIGS.configs[i], message)         //
-        ) {
-            obj_res->has_obj = false;
-            obj_res->compilation_failed = true;
-            break;
-        }
-        obj_res->has_obj = true;
+        usage_record(FIP_USAGE_TAG, coll->tag, "");
+        tags[tag_count++].config = &CONFIGS.configs[i];
+    }
+    if (tag_count > 0) {
+        const bool is_ok = compile_tags(                                   //
+            &obj_res->path_count, obj_res->paths, tags, tag_count, message //
+        );
+        obj_res->has_obj = is_ok;
+        obj_res->compilation_failed = !is_ok;
     }
+    free(tags);
 
-    fip_slave_send_message(ID, buffer, &response);
+    // The master collects the dependencies once it has all object responses
+    write_dependencies();
+    send_bulk_message(buffer, &response);
 }
 
 void handle_tag_request(       //
@@ -1942,6 +6136,9 @@ void handle_tag_request(       //
             break;
         }
     }
+    if (is_present) {
+        collection_load(coll_id);
+    }
     response.u.tag_pres_res.is_present = is_present;
     fip_slave_send_message(ID, buffer, &response);
     fip_free_msg(&response);
@@ -1959,87 +6156,506 @@ void handle_tag_request(       //
     // this case.
     fip_c_symbol_collection_t *const coll = &symbol_list.collection[coll_id];
     coll->needed = true;
+    coll->abi_reported = true;
+    usage_record(FIP_USAGE_TAG, coll->tag, "");
+    size_t changed_count = 0;
     for (size_t i = 0; i < coll->symbol_count; i++) {
         fip_print(ID, FIP_INFO, "Sending symbol %u/%u", i, coll->symbol_count);
         // Wait for master to request the next symbol
-        while (!fip_slave_receive_message(buffer)) {
-            fip_print(ID, FIP_WARN, "No message from master yet...");
-        }
-        fip_msg_t next_message = {0};
-        fip_decode_msg(buffer, &next_message);
-        switch (next_message.type) {
-            default:
-                fip_print(ID, FIP_ERROR,
-                    "Unexpected message from master: %s, expected %s",
-                    fip_msg_type_str[next_message.type],
-                    fip_msg_type_str[FIP_MSG_TAG_NEXT_SYMBOL_REQUEST]);
-                fip_free_msg(&next_message);
-                return;
-            case FIP_MSG_TAG_NEXT_SYMBOL_REQUEST:
-                break;
+        if (!await_next_symbol_request(buffer)) {
+            return;
         }
         fip_c_symbol_t *const sym = &coll->symbols[i];
         response = (fip_msg_t){0};
         response.type = FIP_MSG_TAG_SYMBOL_RESPONSE;
         response.u.tag_sym_res.is_empty = false;
         response.u.tag_sym_res.type = sym->type;
-        switch (sym->type) {
-            case FIP_SYM_UNKNOWN:
-                continue;
-            case FIP_SYM_FUNCTION:
-                fip_clone_sig_fn(                   //
-                    &response.u.tag_sym_res.sig.fn, //
-                    &sym->sig.fn                    //
-                );
-                break;
-            case FIP_SYM_DATA:
-                fip_clone_sig_data(                   //
-                    &response.u.tag_sym_res.sig.data, //
-                    &sym->sig.data                    //
-                );
-                break;
-            case FIP_SYM_ENUM:
-                fip_clone_sig_enum(                     //
-                    &response.u.tag_sym_res.sig.enum_t, //
-                    &sym->sig.enum_t                    //
-                );
-                break;
-            case FIP_SYM_OPAQUE:
-                fip_clone_sig_opaque(                   //
-                    &response.u.tag_sym_res.sig.opaque, //
-                    &sym->sig.opaque                    //
-                );
-                break;
+        response.u.tag_sym_res.abi_changed = sym->abi_changed;
+        response.u.tag_sym_res.fingerprint = sym->fingerprint;
+        if (sym->abi_changed) {
+            fip_print(ID, FIP_DEBUG, "ABI of '%s' changed", symbol_name(sym));
+            changed_count++;
+        }
+        if (sym->type == FIP_SYM_UNKNOWN) {
+            continue;
         }
+        fip_clone_sig(sym->type, &response.u.tag_sym_res.sig, &sym->sig);
         // Send the next symbol to the master
-        fip_slave_send_message(ID, buffer, &response);
+        send_bulk_message(buffer, &response);
         fip_free_msg(&response);
     }
+    fip_print(ID, FIP_INFO, "%lu of %lu symbols of tag '%s' changed ABI",
+        changed_count, coll->symbol_count, coll->tag);
     // Wait for master to request the next symbol before sending the empty
     // symbol to it
-    while (!fip_slave_receive_message(buffer)) {
-        fip_print(ID, FIP_WARN, "No message from master yet...");
-    }
-    // Only print the first time we receive a message
-    fip_msg_t next_message = {0};
-    fip_decode_msg(buffer, &next_message);
-    switch (next_message.type) {
-        default:
-            fip_print(ID, FIP_ERROR,
-                "Unexpected message from master: %s, expected %s",
-                fip_msg_type_str[next_message.type],
-                fip_msg_type_str[FIP_MSG_TAG_NEXT_SYMBOL_REQUEST]);
-            fip_free_msg(&next_message);
-            return;
-        case FIP_MSG_TAG_NEXT_SYMBOL_REQUEST:
-            break;
+    if (!await_next_symbol_request(buffer)) {
+        return;
     }
     // Send "end of list" message
     response = (fip_msg_t){0};
     response.type = FIP_MSG_TAG_SYMBOL_RESPONSE;
     response.u.tag_sym_res.is_empty = true;
     response.u.tag_sym_res.type = FIP_SYM_UNKNOWN;
-    fip_slave_send_message(ID, buffer, &response);
+    send_bulk_message(buffer, &response);
+}
+
+/// @function `usage_order_cmp`
+/// @brief Orders usage entries by their use count and then by their last use,
+/// the most used entries first
+int usage_order_cmp(const void *a, const void *b) {
+    const usage_entry_t *lhs = *(const usage_entry_t *const *)a;
+    const usage_entry_t *rhs = *(const usage_entry_t *const *)b;
+    if (lhs->count != rhs->count) {
+        return lhs->count > rhs->count ? -1 : 1;
+    }
+    if (lhs->last_used != rhs->last_used) {
+        return lhs->last_used > rhs->last_used ? -1 : 1;
+    }
+    return usage_entry_cmp(lhs, rhs);
+}
+
+/// @function `find_usage_symbol`
+/// @brief Finds the symbol a usage entry refers to, if it still exists
+///
+/// @param `entry` The usage entry of the symbol
+/// @return `const fip_c_symbol_t *` The symbol, NULL if it is gone
+const fip_c_symbol_t *find_usage_symbol(const usage_entry_t *entry) {
+    for (size_t i = 0; i < symbol_list.count; i++) {
+        const fip_c_symbol_collection_t *coll = &symbol_list.collection[i];
+        if (strcmp(coll->tag, entry->tag) != 0) {
+            continue;
+        }
+        if (!collection_load_for_name(i, entry->name)) {
+            return NULL;
+        }
+        const uint32_t j = symbol_index_find(coll, entry->name);
+        return j != SYMBOL_INDEX_END ? &coll->symbols[j] : NULL;
+    }
+    return NULL;
+}
+
+void handle_usage_request(     //
+    char buffer[FIP_MSG_SIZE], //
+    const fip_msg_t *message   //
+) {
+    assert(message->type == FIP_MSG_USAGE_REQUEST);
+    fip_print(ID, FIP_INFO, "Usage Request Received");
+    const fip_msg_usage_request_t *usage_req = &message->u.usage_req;
+    const usage_entry_t **order = (const usage_entry_t **)malloc( //
+        sizeof(usage_entry_t *) * (USAGE_LEN + 1)                 //
+    );
+    for (uint32_t i = 0; i < USAGE_LEN; i++) {
+        order[i] = &USAGE[i];
+    }
+    qsort(order, USAGE_LEN, sizeof(usage_entry_t *), usage_order_cmp);
+
+    fip_msg_t response = {0};
+    uint32_t sent_count = 0;
+    for (uint32_t i = 0; i < USAGE_LEN; i++) {
+        if (usage_req->limit > 0 && sent_count == usage_req->limit) {
+            break;
+        }
+        const usage_entry_t *entry = order[i];
+        const fip_c_symbol_t *symbol = NULL;
+        if (usage_req->prefetch) {
+            // Symbols which vanished from the headers can not be prefetched
+            if (entry->kind != FIP_USAGE_SYMBOL) {
+                continue;
+            }
+            symbol = find_usage_symbol(entry);
+            if (symbol == NULL || symbol->type == FIP_SYM_UNKNOWN) {
+                continue;
+            }
+        }
+        response = (fip_msg_t){0};
+        response.type = FIP_MSG_USAGE_RESPONSE;
+        fip_msg_usage_response_t *usage_res = &response.u.usage_res;
+        usage_res->kind = entry->kind;
+        strncpy(usage_res->module_name, MODULE_NAME,
+            sizeof(usage_res->module_name) - 1);
+        memcpy(usage_res->tag, entry->tag, sizeof(usage_res->tag));
+        memcpy(usage_res->name, entry->name, sizeof(usage_res->name));
+        usage_res->use_count = entry->count;
+        usage_res->last_used = entry->last_used;
+        usage_res->type = FIP_SYM_UNKNOWN;
+        if (symbol != NULL) {
+            usage_res->type = symbol->type;
+            fip_clone_sig(symbol->type, &usage_res->sig, &symbol->sig);
+        }
+        send_bulk_message(buffer, &response);
+        fip_free_msg(&response);
+        sent_count++;
+    }
+    free(order);
+    fip_print(ID, FIP_INFO, "Sent %u of %u usage entries", sent_count,
+        USAGE_LEN);
+
+    // Send "end of list" message
+    response = (fip_msg_t){0};
+    response.type = FIP_MSG_USAGE_RESPONSE;
+    response.u.usage_res.is_empty = true;
+    send_bulk_message(buffer, &response);
+}
+
+/// @function `remove_cached_file`
+/// @brief Removes a file of the `.fip/cache` directory
+///
+/// @param `hash` The hash of the object the file belongs to
+/// @param `file_ext` The extension of the file
+/// @return `uint64_t` The size of the removed file, 0 if nothing was removed
+uint64_t remove_cached_file(const char *hash, const char *file_ext) {
+    char path[64];
+    snprintf(path, sizeof(path), ".fip/cache/%s%s", hash, file_ext);
+    struct stat st;
+    if (stat(path, &st) != 0 || remove(path) != 0) {
+        return 0;
+    }
+    return st.st_size > 0 ? (uint64_t)st.st_size : 1;
+}
+
+void handle_cleanup_request(   //
+    char buffer[FIP_MSG_SIZE], //
+    const fip_msg_t *message   //
+) {
+    assert(message->type == FIP_MSG_CLEANUP_REQUEST);
+    fip_print(ID, FIP_INFO, "Cleanup Request Received");
+    const uint64_t max_age_s = message->u.clean_req.max_age_s;
+    const uint64_t now = (uint64_t)time(NULL);
+#ifdef __WIN32__
+    const char *file_exts[] = {".obj", ".key", ".d", ".log", ".fail"};
+#else
+    const char *file_exts[] = {".o", ".key", ".d", ".log", ".fail"};
+#endif
+
+    fip_msg_t response = {0};
+    response.type = FIP_MSG_CLEANUP_RESPONSE;
+    fip_msg_cleanup_response_t *clean_res = &response.u.clean_res;
+    strncpy(clean_res->module_name, MODULE_NAME,
+        sizeof(clean_res->module_name) - 1);
+    // Removed entries are dropped while the table is compacted in place, so it
+    // stays sorted
+    uint32_t kept_count = 0;
+    for (uint32_t i = 0; i < USAGE_LEN; i++) {
+        const usage_entry_t *entry = &USAGE[i];
+        const bool is_stale = entry->kind == FIP_USAGE_OBJECT //
+            && entry->last_used < now                         //
+            && now - entry->last_used > max_age_s;
+        if (!is_stale) {
+            USAGE[kept_count++] = *entry;
+            continue;
+        }
+        uint64_t removed_bytes = 0;
+        for (uint8_t j = 0; j < sizeof(file_exts) / sizeof(file_exts[0]); j++) {
+            removed_bytes += remove_cached_file(entry->name, file_exts[j]);
+        }
+        if (removed_bytes > 0) {
+            fip_print(ID, FIP_DEBUG, "Removed '%s' of tag '%s'", entry->name,
+                entry->tag);
+            clean_res->removed_count++;
+            clean_res->removed_bytes += removed_bytes;
+        }
+    }
+    USAGE_LEN = kept_count;
+    usage_save();
+    fip_print(ID, FIP_INFO, "Removed %u stale objects",
+        clean_res->removed_count);
+    send_bulk_message(buffer, &response);
+}
+
+/*
+ * ==============================================
+ * CHANGE SUBSCRIPTION Functions
+ * ==============================================
+ * The master can subscribe to changes of whole
+ * tags or of single symbols. From then on the
+ * inputs of every collection, its headers and
+ * every file they include, are checked for a
+ * changed size or mtime whenever the master is
+ * idle. When the inputs of a collection changed
+ * its headers are parsed again and the old and
+ * new fingerprints of its symbols are compared.
+ * Every subscribed symbol which was added,
+ * removed or which changed its ABI is pushed to
+ * the master as a change notification, so it
+ * only needs to invalidate exactly the bindings
+ * of these symbols instead of the whole tag.
+ * ==============================================
+ */
+
+#define WATCH_INTERVAL_MS 250
+
+typedef struct {
+    /// @var `is_symbol`
+    /// @brief Whether `name` is the name of a single symbol instead of a tag
+    bool is_symbol;
+    char name[128];
+} subscription_t;
+
+typedef struct {
+    /// @var `inputs`
+    /// @brief All files the headers of the collection were parsed from
+    path_list_t inputs;
+    /// @var `key`
+    /// @brief The hash of the sizes and mtimes of all inputs at the last parse
+    uint64_t key;
+} coll_watch_t;
+
+subscription_t *SUBSCRIPTIONS;
+uint32_t SUBSCRIPTION_COUNT;
+uint32_t SUBSCRIPTION_CAP;
+coll_watch_t *WATCHES;
+double LAST_WATCH_MS;
+
+/// @function `hash_inputs`
+/// @brief Hashes the paths, sizes and mtimes of all given inputs
+uint64_t hash_inputs(const path_list_t *inputs) {
+    uint64_t key = HASH_SEED;
+    for (uint32_t i = 0; i < inputs->len; i++) {
+        key = hash_file_stat(key, inputs->items[i]);
+    }
+    return key;
+}
+
+/// @function `watch_collection`
+/// @brief Makes all dependencies recorded since `first_dependency` the inputs
+/// of the given collection, the collection has just been parsed from them
+///
+/// @param `coll_id` The index of the collection in the `symbol_list`
+/// @param `first_dependency` The length of the dependencies before the parse
+void watch_collection(const size_t coll_id, const uint32_t first_dependency) {
+    coll_watch_t *watch = &WATCHES[coll_id];
+    path_list_free(&watch->inputs);
+    for (uint32_t i = first_dependency; i < DEPENDENCIES.len; i++) {
+        path_list_push(&watch->inputs, clone_string(DEPENDENCIES.items[i]));
+    }
+    watch->key = hash_inputs(&watch->inputs);
+}
+
+/// @function `handle_subscribe_request`
+/// @brief Adds or removes the subscription of the given request
+///
+/// @param `message` The received subscribe request
+void handle_subscribe_request(const fip_msg_t *message) {
+    assert(message->type == FIP_MSG_SUBSCRIBE_REQUEST);
+    const fip_msg_subscribe_request_t *sub_req = &message->u.sub_req;
+    for (uint32_t i = 0; i < SUBSCRIPTION_COUNT; i++) {
+        subscription_t *sub = &SUBSCRIPTIONS[i];
+        if (sub->is_symbol != sub_req->is_symbol ||
+            strcmp(sub->name, sub_req->name) != 0) {
+            continue;
+        }
+        if (sub_req->unsubscribe) {
+            *sub = SUBSCRIPTIONS[--SUBSCRIPTION_COUNT];
+            fip_print(ID, FIP_INFO, "Unsubscribed from '%s'", sub_req->name);
+        }
+        return;
+    }
+    if (sub_req->unsubscribe) {
+        return;
+    }
+    if (SUBSCRIPTION_COUNT == SUBSCRIPTION_CAP) {
+        SUBSCRIPTION_CAP = SUBSCRIPTION_CAP == 0 ? 8 : SUBSCRIPTION_CAP * 2;
+        SUBSCRIPTIONS = (subscription_t *)realloc( //
+            SUBSCRIPTIONS, sizeof(subscription_t) * SUBSCRIPTION_CAP);
+    }
+    subscription_t *sub = &SUBSCRIPTIONS[SUBSCRIPTION_COUNT++];
+    sub->is_symbol = sub_req->is_symbol;
+    strncpy(sub->name, sub_req->name, sizeof(sub->name) - 1);
+    sub->name[sizeof(sub->name) - 1] = '\0';
+    fip_print(ID, FIP_INFO, "Subscribed to %s '%s'",
+        sub->is_symbol ? "symbol" : "tag", sub->name);
+    // Only the inputs of loaded collections are watched
+    for (size_t i = 0; i < symbol_list.count; i++) {
+        if (sub->is_symbol) {
+            collection_load_for_name(i, sub->name);
+        } else if (strcmp(symbol_list.collection[i].tag, sub->name) == 0) {
+            collection_load(i);
+        }
+    }
+    // The inputs are checked from the first idle moment on
+    LAST_WATCH_MS = 0;
+}
+
+/// @function `is_subscribed`
+/// @brief Checks whether the master subscribed to changes of the given symbol
+/// of the given collection, either directly or through its tag
+bool is_subscribed(const fip_c_symbol_collection_t *coll, const char *symbol) {
+    for (uint32_t i = 0; i < SUBSCRIPTION_COUNT; i++) {
+        const subscription_t *sub = &SUBSCRIPTIONS[i];
+        const char *name = sub->is_symbol ? symbol : coll->tag;
+        if (strcmp(sub->name, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @function `snapshot_fingerprints`
+/// @brief Copies the names and fingerprints of all symbols of the given
+/// collection into a sorted array, which has to be freed by the caller
+///
+/// @param `coll` The collection to take the snapshot of
+/// @param `count` Where to store the number of entries of the snapshot
+/// @return `abi_entry_t *` The snapshot, sorted by name
+abi_entry_t *snapshot_fingerprints(        //
+    const fip_c_symbol_collection_t *coll, //
+    size_t *count                          //
+) {
+    abi_entry_t *entries = (abi_entry_t *)calloc( //
+        coll->symbol_count + 1, sizeof(abi_entry_t));
+    *count = 0;
+    for (size_t i = 0; i < coll->symbol_count; i++) {
+        const fip_c_symbol_t *symbol = &coll->symbols[i];
+        if (symbol->type == FIP_SYM_UNKNOWN) {
+            continue;
+        }
+        abi_entry_t *entry = &entries[(*count)++];
+        strncpy(entry->name, symbol_name(symbol), sizeof(entry->name) - 1);
+        entry->fingerprint = symbol->fingerprint;
+    }
+    qsort(entries, *count, sizeof(abi_entry_t), abi_entry_cmp);
+    return entries;
+}
+
+/// @function `send_change`
+/// @brief Pushes a change notification of the given symbol to the master if
+/// the master subscribed to it
+///
+/// @param `buffer` The buffer in which the message will be encoded
+/// @param `coll` The collection the symbol belongs to
+/// @param `kind` The kind of the change
+/// @param `entry` The name and new fingerprint of the symbol
+/// @return `bool` Whether the notification was sent
+bool send_change(                          //
+    char buffer[FIP_MSG_SIZE],             //
+    const fip_c_symbol_collection_t *coll, //
+    const fip_msg_change_kind_e kind,      //
+    const abi_entry_t *entry               //
+) {
+    if (!is_subscribed(coll, entry->name)) {
+        return false;
+    }
+    fip_msg_t message = {0};
+    message.type = FIP_MSG_CHANGE_NOTIFICATION;
+    fip_msg_change_notification_t *change = &message.u.change;
+    change->kind = kind;
+    strncpy(change->module_name, MODULE_NAME, sizeof(change->module_name) - 1);
+    strncpy(change->tag, coll->tag, sizeof(change->tag) - 1);
+    strncpy(change->symbol, entry->name, sizeof(change->symbol) - 1);
+    change->fingerprint = kind == FIP_CHANGE_REMOVED ? 0 : entry->fingerprint;
+    fip_slave_send_message(ID, buffer, &message);
+    return true;
+}
+
+/// @function `drop_duplicate_dependencies`
+/// @brief Removes all dependencies recorded since `first_dependency` which
+/// were already recorded before, a parse repeated on a change records most of
+/// the same files again
+void drop_duplicate_dependencies(const uint32_t first_dependency) {
+    uint32_t len = first_dependency;
+    for (uint32_t i = first_dependency; i < DEPENDENCIES.len; i++) {
+        char *path = DEPENDENCIES.items[i];
+        bool is_duplicate = false;
+        for (uint32_t j = 0; j < len && !is_duplicate; j++) {
+            is_duplicate = strcmp(DEPENDENCIES.items[j], path) == 0;
+        }
+        if (is_duplicate) {
+            free(path);
+        } else {
+            DEPENDENCIES.items[len++] = path;
+        }
+    }
+    DEPENDENCIES.len = len;
+}
+
+/// @function `reindex_collection`
+/// @brief Parses all headers of the given collection again and pushes a change
+/// notification for every subscribed symbol which was added, removed or which
+/// changed its ABI
+///
+/// @param `buffer` The buffer in which the notifications will be encoded
+/// @param `coll_id` The index of the collection in the `symbol_list`
+void reindex_collection(char buffer[FIP_MSG_SIZE], const size_t coll_id) {
+    const fip_module_config_t *config = &CONFIGS.configs[coll_id];
+    fip_c_symbol_collection_t *coll = &symbol_list.collection[coll_id];
+    fip_print(ID, FIP_INFO, "Inputs of tag '%s' changed, parsing it again",
+        coll->tag);
+    size_t old_count;
+    abi_entry_t *old_entries = snapshot_fingerprints(coll, &old_count);
+    for (size_t i = 0; i < coll->symbol_count; i++) {
+        fip_c_symbol_t *symbol = &coll->symbols[i];
+        fip_free_sig(symbol->type, &symbol->sig);
+    }
+    coll->symbol_count = 0;
+
+    curr_coll = coll;
+    const uint32_t first_dependency = DEPENDENCIES.len;
+    if (parse_headers(config, false)) {
+        symbol_data_save(coll_id, first_dependency);
+    }
+    abi_cache_apply(coll);
+    symbol_index_build(coll);
+    watch_collection(coll_id, first_dependency);
+    drop_duplicate_dependencies(first_dependency);
+    write_dependencies();
+
+    size_t new_count;
+    abi_entry_t *new_entries = snapshot_fingerprints(coll, &new_count);
+    // Both snapshots are sorted, so a single walk over both finds all changes
+    size_t sent_count = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < old_count || j < new_count) {
+        int cmp;
+        if (i == old_count) {
+            cmp = 1;
+        } else if (j == new_count) {
+            cmp = -1;
+        } else {
+            cmp = abi_entry_cmp(&old_entries[i], &new_entries[j]);
+        }
+        if (cmp < 0) {
+            sent_count += send_change(buffer, coll, FIP_CHANGE_REMOVED,
+                &old_entries[i++]);
+        } else if (cmp > 0) {
+            sent_count += send_change(buffer, coll, FIP_CHANGE_ADDED,
+                &new_entries[j++]);
+        } else {
+            if (old_entries[i].fingerprint != new_entries[j].fingerprint) {
+                sent_count += send_change(buffer, coll, FIP_CHANGE_ABI,
+                    &new_entries[j]);
+            }
+            i++;
+            j++;
+        }
+    }
+    free(old_entries);
+    free(new_entries);
+    fip_print(ID, FIP_INFO, "Sent %lu change notifications for tag '%s'",
+        sent_count, coll->tag);
+}
+
+/// @function `watch_subscriptions`
+/// @brief Checks whether the inputs of any collection changed since it was
+/// last parsed and reindexes every changed collection. The inputs are only
+/// checked once every `WATCH_INTERVAL_MS` milliseconds
+///
+/// @param `buffer` The buffer in which the notifications will be encoded
+void watch_subscriptions(char buffer[FIP_MSG_SIZE]) {
+    const double now = fip_now_ms();
+    if (SUBSCRIPTION_COUNT == 0 || now - LAST_WATCH_MS < WATCH_INTERVAL_MS) {
+        return;
+    }
+    LAST_WATCH_MS = now;
+    for (size_t i = 0; i < symbol_list.count; i++) {
+        // Collections which are not loaded have nothing to compare against
+        if (!symbol_list.collection[i].is_loaded) {
+            continue;
+        }
+        if (hash_inputs(&WATCHES[i].inputs) != WATCHES[i].key) {
+            reindex_collection(buffer, i);
+        }
+    }
 }
 
 int main(int argc, char *argv[]) {
@@ -2102,6 +6718,8 @@ int main(int argc, char *argv[]) {
     }
     toml_free(toml);
     fip_print(ID, FIP_INFO, "Parsed %s.toml file", MODULE_NAME);
+    job_controller_init();
+    usage_load();
 
 send:
     // Send the connect message to the master now, as we are now able to
@@ -2118,36 +6736,47 @@ send:
     symbol_list.collection = (fip_c_symbol_collection_t *)malloc( //
         sizeof(fip_c_symbol_collection_t) * CONFIGS.count         //
     );
+    WATCHES = (coll_watch_t *)calloc(CONFIGS.count, sizeof(coll_watch_t));
 
-    // Print all tags of the config and all headers and the command of it
+    // Print all tags of the config and all headers and the command of it. The
+    // headers are only parsed once a request touches the tag
     for (size_t i = 0; i < CONFIGS.count; i++) {
         fip_module_config_t *config = &CONFIGS.configs[i];
-        curr_coll = &symbol_list.collection[i];
-        strcpy(curr_coll->tag, config->tag);
-        curr_coll->symbol_count = 0;
+        fip_c_symbol_collection_t *coll = &symbol_list.collection[i];
+        strcpy(coll->tag, config->tag);
+        coll->needed = false;
+        coll->abi_reported = false;
+        coll->is_loaded = false;
+        coll->data = (symbol_data_t){0};
+        coll->symbol_count = 0;
+        coll->index = (symbol_index_t){0};
 
         fip_print(ID, FIP_DEBUG, "[%s]", config->tag);
         for (size_t j = 0; j < config->headers_len; j++) {
             fip_print(ID, FIP_DEBUG, "headers[%lu]: %s", j, config->headers[j]);
-            fip_print(                                                      //
-                ID, FIP_DEBUG, "parsing header '%s'...", config->headers[j] //
-            );
-            clock_t start = clock();
-            parse_c_file(config->headers[j]);
-            clock_t end = clock();
-            double parse_time = ((double)(end - start)) / CLOCKS_PER_SEC;
-            fip_print(ID, FIP_DEBUG, "parsing '%s' took %f s",
-                config->headers[j], parse_time);
+        }
+        for (size_t j = 0; j < config->sources_len; j++) {
+            fip_print(ID, FIP_DEBUG, "sources[%lu]: %s", j, config->sources[j]);
         }
         for (size_t j = 0; j < config->command_len; j++) {
             fip_print(ID, FIP_DEBUG, "command[%lu]: %s", j, config->command[j]);
         }
     }
+    // No tag is loaded yet, this replaces the dependencies of the last session
+    // until the first request touches a tag
+    write_dependencies();
 
     // Main loop - wait for messages from master
     bool is_running = true;
     while (is_running) {
-        if (fip_slave_receive_message(msg_buf)) {
+        // Without subscriptions there is nothing to do until the next message
+        // arrives, with them the inputs are watched while no message is there
+        const bool has_message = SUBSCRIPTION_COUNT == 0
+            ? fip_slave_receive_message(msg_buf)
+            : fip_slave_poll_message(FIP_LANE_BULK, msg_buf);
+        if (!has_message) {
+            watch_subscriptions(msg_buf);
+        } else {
             // Only print the first time we receive a message
             fip_print(ID, FIP_DEBUG, "Received message");
             fip_msg_t message = {0};
@@ -2188,7 +6817,20 @@ send:
                     // function
                     assert(false);
                     break;
+                case FIP_MSG_SUBSCRIBE_REQUEST:
+                    handle_subscribe_request(&message);
+                    break;
+                case FIP_MSG_USAGE_REQUEST:
+                    handle_usage_request(msg_buf, &message);
+                    break;
+                case FIP_MSG_CLEANUP_REQUEST:
+                    handle_cleanup_request(msg_buf, &message);
+                    break;
                 case FIP_MSG_TAG_SYMBOL_RESPONSE:
+                case FIP_MSG_CHANGE_NOTIFICATION:
+                case FIP_MSG_USAGE_RESPONSE:
+                case FIP_MSG_CLEANUP_RESPONSE:
+                case FIP_MSG_PROGRESS:
                     // The slave should not receive a message it sends
                     assert(false);
                     break;
@@ -2197,6 +6839,16 @@ send:
                         ID, FIP_INFO,                             //
                         "Received Kill Command, shutting down..." //
                     );
+                    // Only a finished session moves the ABI baseline forward,
+                    // otherwise changes would never be reported to Flint
+                    if (message.u.kill.reason == FIP_KILL_FINISH) {
+                        for (size_t i = 0; i < symbol_list.count; i++) {
+                            if (symbol_list.collection[i].abi_reported) {
+                                abi_cache_save(&symbol_list.collection[i]);
+                            }
+                        }
+                    }
+                    usage_save();
                     is_running = false;
                     break;
             }
@@ -2210,6 +6862,15 @@ send:
     }
 
 kill:
+    for (size_t i = 0; WATCHES != NULL && i < symbol_list.count; i++) {
+        path_list_free(&WATCHES[i].inputs);
+        symbol_index_free(&symbol_list.collection[i].index);
+        symbol_data_unmap(&symbol_list.collection[i].data);
+    }
+    free(WATCHES);
+    free(SUBSCRIPTIONS);
+    free(USAGE);
+    path_list_free(&DEPENDENCIES);
     fip_slave_cleanup();
     fip_print(ID, FIP_INFO, "ending...");
     return 0;
@@ -31,13 +31,16 @@ int main() {
     if (!config_file.ok) {
         goto kill;
     }
+    // Apply the configured deadline bounds for the responses of the modules
+    fip_master_set_deadlines(&config_file);
 
     // Start all enabled interop modules
-    for (uint8_t i = 0; i < config_file.enabled_count; i++) {
+    for (uint32_t i = 0; i < config_file.enabled_count; i++) {
         const char *mod = config_file.enabled_modules[i];
         fip_print(0, FIP_INFO, "Starting the %s module...", mod);
         fip_spawn_interop_module(&interop_modules, cwd_path, mod);
     }
+    fip_master_free_config(&config_file);
 
     // Initialize master with the spawned modules
     if (!fip_master_init(&interop_modules)) {
@@ -47,16 +50,11 @@ int main() {
 
     // Wait for all connect messages from the IMs
     fip_print(0, FIP_INFO, "Waiting for all connect requests...");
-    fip_master_await_responses(       //
-        msg_buf,                      //
-        master_state.responses,       //
-        &master_state.response_count, //
-        FIP_MSG_CONNECT_REQUEST       //
-    );
+    fip_master_await_responses(msg_buf, NULL, FIP_MSG_CONNECT_REQUEST);
 
     // Check if each interop module has the correct version and whether it's
     // setup was ok
-    for (uint8_t i = 0; i < master_state.response_count; i++) {
+    for (uint32_t i = 0; i < master_state.response_count; i++) {
         const fip_msg_t *response = &master_state.responses[i];
         const fip_msg_connect_request_t *req = &response->u.con_req;
         assert(response->type == FIP_MSG_CONNECT_REQUEST);
@@ -86,6 +84,21 @@ int main() {
     // Create a single message which will be re-used for all messages
     fip_msg_t msg = {0};
 
+    // Fetch the most used symbols of the last sessions right away, so their
+    // signatures are known before they are requested
+    if (config_file.prefetch_count > 0) {
+        msg.type = FIP_MSG_USAGE_REQUEST;
+        msg.u.usage_req.limit = config_file.prefetch_count;
+        msg.u.usage_req.prefetch = true;
+        fip_usage_list_t *usage = fip_master_usage_request(msg_buf, &msg);
+        for (size_t i = 0; usage != NULL && i < usage->count; i++) {
+            fip_print(0, FIP_DEBUG, "prefetched[%u]: used %u times", i,
+                usage->entries[i].use_count);
+            fip_print_sig(0, usage->entries[i].type, &usage->entries[i].sig);
+        }
+        fip_free_usage_list(usage);
+    }
+
     // Send the tag request message to all connected interop modules
     msg.type = FIP_MSG_TAG_REQUEST;
     strcpy(msg.u.tag_req.tag, "c");
@@ -96,25 +109,8 @@ int main() {
                 sig_list.list->count);
             for (size_t i = 0; i < sig_list.list->count; i++) {
                 fip_print(0, FIP_DEBUG, "sig[%u]:", i);
-                switch (sig_list.list->sigs[i].type) {
-                    case FIP_SYM_UNKNOWN:
-                        fip_print(0, FIP_DEBUG, "UNKNOWN");
-                        break;
-                    case FIP_SYM_FUNCTION:
-                        fip_print_sig_fn(0, &sig_list.list->sigs[i].sig.fn);
-                        break;
-                    case FIP_SYM_DATA:
-                        fip_print_sig_data(0, &sig_list.list->sigs[i].sig.data);
-                        break;
-                    case FIP_SYM_ENUM:
-                        fip_print_sig_enum(0,
-                            &sig_list.list->sigs[i].sig.enum_t);
-                        break;
-                    case FIP_SYM_OPAQUE:
-                        fip_print_sig_opaque(0,
-                            &sig_list.list->sigs[i].sig.opaque);
-                        break;
-                }
+                fip_print_sig(0, sig_list.list->sigs[i].type,
+                    &sig_list.list->sigs[i].sig);
             }
             break;
         case FIP_TAG_REQUEST_STATUS_ERR_FAULTY:
@@ -132,38 +128,17 @@ int main() {
     }
     fip_free_sig_list(sig_list.list);
 
-    // Search the add function
+    // Search the add function. Its signature is known at build time, so the
+    // request is encoded at build time too instead of being constructed and
+    // encoded here
     // extern def add(mut i32* lhs, mut i32 rhs);
-    // msg.type = FIP_MSG_SYMBOL_REQUEST;
-    // msg.u.sym_req.type = FIP_SYM_FUNCTION;
-    // strcpy(msg.u.sym_req.sig.fn.name, "add");
-    // msg.u.sym_req.sig.fn.rets_len = 0;
-    // msg.u.sym_req.sig.fn.rets = NULL;
-    //
-    // msg.u.sym_req.sig.fn.args_len = 2;
-    // msg.u.sym_req.sig.fn.args = malloc(sizeof(fip_sig_fn_arg_t) * 2);
-    //
-    // memset(msg.u.sym_req.sig.fn.args[0].name, 0,
-    //     sizeof(msg.u.sym_req.sig.fn.args[0].name));
-    // msg.u.sym_req.sig.fn.args[0].type.type = FIP_TYPE_PTR;
-    // msg.u.sym_req.sig.fn.args[0].type.is_mutable = true;
-    // msg.u.sym_req.sig.fn.args[0].type.u.ptr.base_type =
-    //     malloc(sizeof(fip_type_t));
-    // msg.u.sym_req.sig.fn.args[0].type.u.ptr.base_type->type =
-    //     FIP_TYPE_PRIMITIVE;
-    // msg.u.sym_req.sig.fn.args[0].type.u.ptr.base_type->is_mutable = false;
-    // msg.u.sym_req.sig.fn.args[0].type.u.ptr.base_type->u.prim = FIP_I32;
-    //
-    // memset(msg.u.sym_req.sig.fn.args[1].name, 0,
-    //     sizeof(msg.u.sym_req.sig.fn.args[1].name));
-    // msg.u.sym_req.sig.fn.args[1].type.type = FIP_TYPE_PRIMITIVE;
-    // msg.u.sym_req.sig.fn.args[1].type.is_mutable = true;
-    // msg.u.sym_req.sig.fn.args[1].type.u.prim = FIP_I32;
-    //
-    // msg.u.sym_req.sig.fn.rets_len = 0;
-    // msg.u.sym_req.sig.fn.rets = NULL;
-    //
-    // if (!fip_master_symbol_request(msg_buf, &msg)) {
+    // static FIP_ENCODED_FN_REQUEST(add_request, "add",
+    //     FIP_ENC_ARGS(2,
+    //         FIP_ENC_ARG(FIP_ENC_PTR(true, FIP_ENC_PRIM(false, FIP_I32))),
+    //         FIP_ENC_ARG(FIP_ENC_PRIM(true, FIP_I32))),
+    //     FIP_ENC_RETS(0));
+    // if (!fip_master_symbol_request_encoded(msg_buf,
+    //         FIP_ENCODED(add_request))) {
     //     fip_print(0, FIP_INFO, "Goto kill");
     //     goto kill;
     // }
@@ -178,6 +153,10 @@ int main() {
         goto kill;
     }
 
+    // List every file the modules depended on, so an outer build system only
+    // runs the master again once one of them changed
+    fip_master_write_depfile(".fip/cache/example_master.d", "example_master");
+
 kill:
     // Broadcast kill message
     fip_free_msg(&msg);